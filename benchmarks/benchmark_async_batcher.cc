@@ -0,0 +1,150 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "api_status.h"
+#include "err_constants.h"
+#include "generic_event.h"
+#include "logger/async_batcher.h"
+#include "logger/event_record.h"
+#include "logger/message_sender.h"
+#include "serialization/payload_serializer.h"
+#include "utility/watchdog.h"
+
+namespace r = reinforcement_learning;
+namespace l = reinforcement_learning::logger;
+namespace u = reinforcement_learning::utility;
+
+// Counts the heap allocations of the benchmark thread while counting_allocations is set
+static thread_local bool counting_allocations = false;
+static std::atomic<size_t> allocation_count{0};
+
+void* operator new(size_t size) {
+  if (counting_allocations) {
+    ++allocation_count;
+  }
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+namespace {
+  const size_t EVENTS_PER_ITERATION = 1024;
+
+  class null_message_sender : public l::i_message_sender {
+  public:
+    int send(const uint16_t, const buffer&, r::api_status*) override { return r::error_code::success; }
+    int init(r::api_status*) override { return r::error_code::success; }
+  };
+
+  void make_events(std::vector<r::generic_event>& events) {
+    events.clear();
+    const r::timestamp ts;
+    for (size_t i = 0; i < EVENTS_PER_ITERATION; ++i) {
+      const auto id = "benchmark-event-id-" + std::to_string(i);
+      events.emplace_back(id.c_str(), ts, r::generic_event::payload_type_t::PayloadType_Outcome,
+        l::outcome_serializer::numeric_event(1.f), r::event_content_type::IDENTITY, "app_id");
+    }
+  }
+
+  template <typename TAppend>
+  size_t count_allocations(TAppend append) {
+    counting_allocations = true;
+    const size_t before = allocation_count;
+    append();
+    const size_t count = allocation_count - before;
+    counting_allocations = false;
+    return count;
+  }
+}
+
+// async_batcher::append of ready events: event_record keeps the closure inline and the queue reuses its ring,
+// so allocations_per_event is expected to be 0
+static void bench_async_batcher_append(benchmark::State& state) {
+  u::async_batcher_config config;
+  config.send_batch_interval_ms = 1000 * 1000; // flushed by hand between iterations
+  u::watchdog watchdog;
+  int shared_state = 0;
+  l::async_batcher<r::generic_event, l::fb_collection_serializer> batcher(
+    new null_message_sender(), watchdog, shared_state, nullptr, config);
+  r::api_status status;
+  batcher.init(&status);
+
+  std::vector<r::generic_event> events;
+  const auto append_all = [&]() {
+    for (auto& evt : events) {
+      const auto size = evt.get_payload().size();
+      batcher.append(l::event_record<r::generic_event>(l::event_record<r::generic_event>::ready_event{ std::move(evt) }),
+        "benchmark-event-id", size, &status);
+    }
+  };
+
+  // let the queue reach its working size
+  make_events(events);
+  append_all();
+  batcher.run_iteration(&status);
+
+  size_t allocations = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    make_events(events);
+    state.ResumeTiming();
+
+    allocations += count_allocations(append_all);
+
+    state.PauseTiming();
+    batcher.run_iteration(&status);
+    state.ResumeTiming();
+  }
+
+  const auto appended = static_cast<double>(state.iterations() * EVENTS_PER_ITERATION);
+  state.SetItemsProcessed(state.iterations() * EVENTS_PER_ITERATION);
+  state.counters["allocations_per_event"] = benchmark::Counter(allocations / appended);
+}
+
+// What async_batcher used to queue: a std::list of std::function, sharing the move only event with the closure
+static void bench_std_function_list_append(benchmark::State& state) {
+  std::list<std::pair<std::function<int(r::generic_event&, r::api_status*)>, size_t>> queue;
+
+  std::vector<r::generic_event> events;
+  const auto append_all = [&]() {
+    for (auto& evt : events) {
+      const auto size = evt.get_payload().size();
+      auto shared = std::make_shared<r::generic_event>(std::move(evt));
+      queue.emplace_back([shared](r::generic_event& out_evt, r::api_status*) {
+        out_evt = std::move(*shared);
+        return r::error_code::success;
+      }, size);
+    }
+  };
+
+  size_t allocations = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    make_events(events);
+    state.ResumeTiming();
+
+    allocations += count_allocations(append_all);
+
+    state.PauseTiming();
+    queue.clear();
+    state.ResumeTiming();
+  }
+
+  const auto appended = static_cast<double>(state.iterations() * EVENTS_PER_ITERATION);
+  state.SetItemsProcessed(state.iterations() * EVENTS_PER_ITERATION);
+  state.counters["allocations_per_event"] = benchmark::Counter(allocations / appended);
+}
+
+BENCHMARK(bench_async_batcher_append);
+BENCHMARK(bench_std_function_list_append);
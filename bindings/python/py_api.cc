@@ -308,6 +308,7 @@ PYBIND11_MODULE(rl_client, m) {
     .def_property_readonly_static("INTERACTION_SENDER_IMPLEMENTATION", [](py::object /*self*/) { return rl::name::INTERACTION_SENDER_IMPLEMENTATION; })
     .def_property_readonly_static("INTERACTION_USE_COMPRESSION", [](py::object /*self*/) { return rl::name::INTERACTION_USE_COMPRESSION; })
     .def_property_readonly_static("INTERACTION_USE_DEDUP", [](py::object /*self*/) { return rl::name::INTERACTION_USE_DEDUP; })
+    .def_property_readonly_static("INTERACTION_USE_BATCH_COMPRESSION", [](py::object /*self*/) { return rl::name::INTERACTION_USE_BATCH_COMPRESSION; })
     .def_property_readonly_static("INTERACTION_QUEUE_MODE", [](py::object /*self*/) { return rl::name::INTERACTION_QUEUE_MODE; })
     .def_property_readonly_static("OBSERVATION_EH_HOST", [](py::object /*self*/) { return rl::name::OBSERVATION_EH_HOST; })
     .def_property_readonly_static("OBSERVATION_EH_NAME", [](py::object /*self*/) { return rl::name::OBSERVATION_EH_NAME; })
@@ -326,17 +327,36 @@ PYBIND11_MODULE(rl_client, m) {
     .def_property_readonly_static("SEND_BATCH_INTERVAL_MS", [](py::object /*self*/) { return rl::name::SEND_BATCH_INTERVAL_MS; })
     .def_property_readonly_static("USE_COMPRESSION", [](py::object /*self*/) { return rl::name::USE_COMPRESSION; })
     .def_property_readonly_static("USE_DEDUP", [](py::object /*self*/) { return rl::name::USE_DEDUP; })
+    .def_property_readonly_static("USE_BATCH_COMPRESSION", [](py::object /*self*/) { return rl::name::USE_BATCH_COMPRESSION; })
     .def_property_readonly_static("QUEUE_MODE", [](py::object /*self*/) { return rl::name::QUEUE_MODE; })
+    .def_property_readonly_static("QUEUE_BLOCK_TIMEOUT_MS", [](py::object /*self*/) { return rl::name::QUEUE_BLOCK_TIMEOUT_MS; })
+    .def_property_readonly_static("SEND_BATCH_TARGET_BYTES", [](py::object /*self*/) { return rl::name::SEND_BATCH_TARGET_BYTES; })
+    .def_property_readonly_static("SEND_BATCH_MIN_INTERVAL_MS", [](py::object /*self*/) { return rl::name::SEND_BATCH_MIN_INTERVAL_MS; })
+    .def_property_readonly_static("SEND_BATCH_LATENCY_BUDGET_MS", [](py::object /*self*/) { return rl::name::SEND_BATCH_LATENCY_BUDGET_MS; })
+    .def_property_readonly_static("COALESCE_OUTCOMES", [](py::object /*self*/) { return rl::name::COALESCE_OUTCOMES; })
+    .def_property_readonly_static("DEFERRED_SERIALIZATION", [](py::object /*self*/) { return rl::name::DEFERRED_SERIALIZATION; })
+    .def_property_readonly_static("QUEUE_PRIORITY_CB", [](py::object /*self*/) { return rl::name::QUEUE_PRIORITY_CB; })
+    .def_property_readonly_static("QUEUE_PRIORITY_CA", [](py::object /*self*/) { return rl::name::QUEUE_PRIORITY_CA; })
+    .def_property_readonly_static("QUEUE_PRIORITY_MULTI_SLOT", [](py::object /*self*/) { return rl::name::QUEUE_PRIORITY_MULTI_SLOT; })
+    .def_property_readonly_static("QUEUE_PRIORITY_DEFERRED", [](py::object /*self*/) { return rl::name::QUEUE_PRIORITY_DEFERRED; })
+    .def_property_readonly_static("QUEUE_PRIORITY_APPRENTICE", [](py::object /*self*/) { return rl::name::QUEUE_PRIORITY_APPRENTICE; })
+    .def_property_readonly_static("METRICS_DUMP_INTERVAL_MS", [](py::object /*self*/) { return rl::name::METRICS_DUMP_INTERVAL_MS; })
     .def_property_readonly_static("EH_TEST", [](py::object /*self*/) { return rl::name::EH_TEST; })
     .def_property_readonly_static("TRACE_LOG_IMPLEMENTATION", [](py::object /*self*/) { return rl::name::TRACE_LOG_IMPLEMENTATION; })
     .def_property_readonly_static("INTERACTION_FILE_NAME", [](py::object /*self*/) { return rl::name::INTERACTION_FILE_NAME; })
     .def_property_readonly_static("OBSERVATION_FILE_NAME", [](py::object /*self*/) { return rl::name::OBSERVATION_FILE_NAME; })
     .def_property_readonly_static("TIME_PROVIDER_IMPLEMENTATION", [](py::object /*self*/) { return rl::name::TIME_PROVIDER_IMPLEMENTATION; })
+    .def_property_readonly_static("TIME_PROVIDER_PRECISION_US", [](py::object /*self*/) { return rl::name::TIME_PROVIDER_PRECISION_US; })
     .def_property_readonly_static("HTTP_CLIENT_DISABLE_CERT_VALIDATION", [](py::object /*self*/) { return rl::name::HTTP_CLIENT_DISABLE_CERT_VALIDATION; })
     .def_property_readonly_static("HTTP_CLIENT_TIMEOUT", [](py::object /*self*/) { return rl::name::HTTP_CLIENT_TIMEOUT; })
     .def_property_readonly_static("MODEL_FILE_NAME", [](py::object /*self*/) { return rl::name::MODEL_FILE_NAME; })
     .def_property_readonly_static("MODEL_FILE_MUST_EXIST", [](py::object /*self*/) { return rl::name::MODEL_FILE_MUST_EXIST; })
     .def_property_readonly_static("ZSTD_COMPRESSION_LEVEL", [](py::object /*self*/) { return rl::name::ZSTD_COMPRESSION_LEVEL; })
+    .def_property_readonly_static("ZSTD_DICTIONARY_FILE", [](py::object /*self*/) { return rl::name::ZSTD_DICTIONARY_FILE; })
+    .def_property_readonly_static("ZSTD_DICTIONARY_ID", [](py::object /*self*/) { return rl::name::ZSTD_DICTIONARY_ID; })
+    .def_property_readonly_static("DEDUP_LRU_CAPACITY", [](py::object /*self*/) { return rl::name::DEDUP_LRU_CAPACITY; })
+    .def_property_readonly_static("DEDUP_LRU_REFRESH_BATCHES", [](py::object /*self*/) { return rl::name::DEDUP_LRU_REFRESH_BATCHES; })
+    .def_property_readonly_static("DEDUP_TARGETS", [](py::object /*self*/) { return rl::name::DEDUP_TARGETS; })
     .def_property_readonly_static("AZURE_STORAGE_BLOB", [](py::object /*self*/) { return rl::value::AZURE_STORAGE_BLOB; })
     .def_property_readonly_static("NO_MODEL_DATA", [](py::object /*self*/) { return rl::value::NO_MODEL_DATA; })
     .def_property_readonly_static("FILE_MODEL_DATA", [](py::object /*self*/) { return rl::value::FILE_MODEL_DATA; })
@@ -350,11 +370,21 @@ PYBIND11_MODULE(rl_client, m) {
     .def_property_readonly_static("CONSOLE_TRACE_LOGGER", [](py::object /*self*/) { return rl::value::CONSOLE_TRACE_LOGGER; })
     .def_property_readonly_static("NULL_TIME_PROVIDER", [](py::object /*self*/) { return rl::value::NULL_TIME_PROVIDER; })
     .def_property_readonly_static("CLOCK_TIME_PROVIDER", [](py::object /*self*/) { return rl::value::CLOCK_TIME_PROVIDER; })
+    .def_property_readonly_static("COARSE_CLOCK_TIME_PROVIDER", [](py::object /*self*/) { return rl::value::COARSE_CLOCK_TIME_PROVIDER; })
     .def_property_readonly_static("LEARNING_MODE_ONLINE", [](py::object /*self*/) { return rl::value::LEARNING_MODE_ONLINE; })
     .def_property_readonly_static("LEARNING_MODE_APPRENTICE", [](py::object /*self*/) { return rl::value::LEARNING_MODE_APPRENTICE; })
     .def_property_readonly_static("LEARNING_MODE_LOGGINGONLY", [](py::object /*self*/) { return rl::value::LEARNING_MODE_LOGGINGONLY; })
     .def_property_readonly_static("CONTENT_ENCODING_IDENTITY", [](py::object /*self*/) { return rl::value::CONTENT_ENCODING_IDENTITY; })
     .def_property_readonly_static("CONTENT_ENCODING_DEDUP", [](py::object /*self*/) { return rl::value::CONTENT_ENCODING_DEDUP; })
+    .def_property_readonly_static("CONTENT_ENCODING_ZSTD", [](py::object /*self*/) { return rl::value::CONTENT_ENCODING_ZSTD; })
+    .def_property_readonly_static("CONTENT_ENCODING_DEDUP_ZSTD", [](py::object /*self*/) { return rl::value::CONTENT_ENCODING_DEDUP_ZSTD; })
+    .def_property_readonly_static("DEDUP_TARGET_ACTIONS", [](py::object /*self*/) { return rl::value::DEDUP_TARGET_ACTIONS; })
+    .def_property_readonly_static("DEDUP_TARGET_SLOTS", [](py::object /*self*/) { return rl::value::DEDUP_TARGET_SLOTS; })
+    .def_property_readonly_static("DEDUP_TARGET_SHARED", [](py::object /*self*/) { return rl::value::DEDUP_TARGET_SHARED; })
     .def_property_readonly_static("QUEUE_MODE_DROP", [](py::object /*self*/) { return rl::value::QUEUE_MODE_DROP; })
-    .def_property_readonly_static("QUEUE_MODE_BLOCK", [](py::object /*self*/) { return rl::value::QUEUE_MODE_BLOCK; });
+    .def_property_readonly_static("QUEUE_MODE_BLOCK", [](py::object /*self*/) { return rl::value::QUEUE_MODE_BLOCK; })
+    .def_property_readonly_static("QUEUE_MODE_NONBLOCKING", [](py::object /*self*/) { return rl::value::QUEUE_MODE_NONBLOCKING; })
+    .def_property_readonly_static("QUEUE_PRIORITY_LOW", [](py::object /*self*/) { return rl::value::QUEUE_PRIORITY_LOW; })
+    .def_property_readonly_static("QUEUE_PRIORITY_NORMAL", [](py::object /*self*/) { return rl::value::QUEUE_PRIORITY_NORMAL; })
+    .def_property_readonly_static("QUEUE_PRIORITY_HIGH", [](py::object /*self*/) { return rl::value::QUEUE_PRIORITY_HIGH; });
 }
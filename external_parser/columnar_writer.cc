@@ -0,0 +1,385 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "columnar_writer.h"
+#include "io/logger.h"
+
+#include "zstd.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace log_converter {
+using namespace columnar;
+
+namespace {
+template <typename T>
+void append_bytes(std::vector<char> &out, const std::vector<T> &values) {
+  const char *begin = reinterpret_cast<const char *>(values.data());
+  out.insert(out.end(), begin, begin + values.size() * sizeof(T));
+}
+
+bool has_offsets(column_type type) {
+  return type == column_type::string || type == column_type::uint32_list ||
+         type == column_type::float32_list;
+}
+} // namespace
+
+constexpr size_t columnar_writer::DEFAULT_ROWS_PER_GROUP;
+constexpr size_t columnar_writer::DEFAULT_BYTES_PER_GROUP;
+constexpr size_t columnar_writer::MAX_BYTES_PER_GROUP;
+constexpr int columnar_writer::DEFAULT_COMPRESSION_LEVEL;
+
+void columnar_writer::string_column::append(const std::string &value) {
+  values.insert(values.end(), value.begin(), value.end());
+  offsets.push_back(static_cast<uint32_t>(values.size()));
+}
+
+void columnar_writer::string_column::clear() {
+  offsets.resize(1);
+  values.clear();
+}
+
+columnar_writer::columnar_writer(const std::string &file_name,
+                                 size_t rows_per_group,
+                                 size_t bytes_per_group, int compression_level)
+    : _outfile(file_name, std::ios::binary | std::ios::trunc),
+      _rows_per_group(rows_per_group),
+      _bytes_per_group(std::min(bytes_per_group, MAX_BYTES_PER_GROUP)),
+      _compression_level(compression_level) {
+  if (!_outfile.is_open()) {
+    VW::io::logger::log_error("Failed to open [{}] for writing", file_name);
+    return;
+  }
+  const uint32_t file_header[] = {FILE_MAGIC, FILE_VERSION};
+  _outfile.write(reinterpret_cast<const char *>(file_header),
+                 sizeof(file_header));
+}
+
+columnar_writer::~columnar_writer() { flush(); }
+
+void columnar_writer::write(joined_event::joined_event &&je) {
+  if (_finished) {
+    VW::io::logger::log_error(
+        "Event [{}] written after the end of the columnar file, dropping it",
+        je.interaction_metadata.event_id);
+    return;
+  }
+  add_row(je);
+  if (_rows >= _rows_per_group || value_bytes() >= _bytes_per_group) {
+    write_row_group();
+  }
+}
+
+size_t columnar_writer::value_bytes() const {
+  return _event_ids.values.size() + _model_ids.values.size() +
+         _contexts.values.size() +
+         _actions.values.size() * sizeof(uint32_t) +
+         (_probabilities.values.size() + _rewards.values.size() +
+          _original_rewards.values.size()) *
+             sizeof(float);
+}
+
+void columnar_writer::flush() {
+  if (_finished || !_outfile.is_open()) {
+    return;
+  }
+  write_row_group();
+
+  _outfile.write(reinterpret_cast<const char *>(_row_group_offsets.data()),
+                 _row_group_offsets.size() * sizeof(uint64_t));
+  const footer_trailer trailer{_row_group_offsets.size(), FILE_MAGIC,
+                               FILE_VERSION};
+  _outfile.write(reinterpret_cast<const char *>(&trailer), sizeof(trailer));
+  _outfile.flush();
+  _finished = true;
+}
+
+void columnar_writer::add_row(joined_event::joined_event &je) {
+  const auto *typed_data = je.get_hold_of_typed_data();
+  if (typed_data == nullptr) {
+    return;
+  }
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  float probability_of_drop = 0.f;
+  float continuous_action = nan;
+
+  switch (je.interaction_metadata.payload_type) {
+  case v2::PayloadType_CB: {
+    const auto *cb = static_cast<const joined_event::cb_joined_event *>(typed_data);
+    const auto &interaction = cb->interaction_data;
+    _actions.values.insert(_actions.values.end(), interaction.actions.begin(),
+                           interaction.actions.end());
+    _probabilities.values.insert(_probabilities.values.end(),
+                                 interaction.probabilities.begin(),
+                                 interaction.probabilities.end());
+    _rewards.values.push_back(cb->reward);
+    _original_rewards.values.push_back(cb->original_reward);
+    probability_of_drop = interaction.probabilityOfDrop;
+    break;
+  }
+  case v2::PayloadType_CCB:
+  case v2::PayloadType_Slates: {
+    const bool ccb = je.interaction_metadata.payload_type == v2::PayloadType_CCB;
+    const auto &multi_slot_interaction =
+        ccb ? static_cast<const joined_event::ccb_joined_event *>(typed_data)
+                  ->multi_slot_interaction
+            : static_cast<const joined_event::slates_joined_event *>(typed_data)
+                  ->multi_slot_interaction;
+    // the chosen action of each slot, so that both lists stay aligned
+    for (const auto &slot : multi_slot_interaction.interaction_data) {
+      _actions.values.push_back(slot.actions.empty() ? 0 : slot.actions[0]);
+      _probabilities.values.push_back(
+          slot.probabilities.empty() ? nan : slot.probabilities[0]);
+    }
+    if (ccb) {
+      const auto *ccb_je =
+          static_cast<const joined_event::ccb_joined_event *>(typed_data);
+      _rewards.values.insert(_rewards.values.end(), ccb_je->rewards.begin(),
+                             ccb_je->rewards.end());
+      _original_rewards.values.insert(_original_rewards.values.end(),
+                                      ccb_je->original_rewards.begin(),
+                                      ccb_je->original_rewards.end());
+    } else {
+      const auto *slates_je =
+          static_cast<const joined_event::slates_joined_event *>(typed_data);
+      _rewards.values.push_back(slates_je->reward);
+      _original_rewards.values.push_back(slates_je->original_reward);
+    }
+    probability_of_drop = multi_slot_interaction.probability_of_drop;
+    break;
+  }
+  case v2::PayloadType_CA: {
+    const auto *ca = static_cast<const joined_event::ca_joined_event *>(typed_data);
+    _probabilities.values.push_back(ca->interaction_data.pdf_value);
+    _rewards.values.push_back(ca->reward);
+    _original_rewards.values.push_back(ca->original_reward);
+    probability_of_drop = ca->interaction_data.probabilityOfDrop;
+    continuous_action = ca->interaction_data.action;
+    break;
+  }
+  default:
+    break;
+  }
+
+  _actions.end_row();
+  _probabilities.end_row();
+  _rewards.end_row();
+  _original_rewards.end_row();
+
+  _event_ids.append(je.interaction_metadata.event_id);
+  _timestamps.push_back(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          je.joined_event_timestamp.time_since_epoch())
+          .count());
+  _payload_types.push_back(
+      static_cast<uint8_t>(je.interaction_metadata.payload_type));
+  _model_ids.append(je.model_id);
+  _skip_learn.push_back(je.is_joined_event_learnable() ? 0 : 1);
+  _pass_probabilities.push_back(je.interaction_metadata.pass_probability);
+  _drop_probabilities.push_back(probability_of_drop);
+  _continuous_actions.push_back(continuous_action);
+  _contexts.append(je.context);
+  ++_rows;
+}
+
+void columnar_writer::write_row_group() {
+  if (_rows == 0) {
+    return;
+  }
+
+  _row_group_offsets.push_back(static_cast<uint64_t>(_outfile.tellp()));
+  const row_group_header header{ROW_GROUP_MAGIC, _rows, COLUMN_COUNT, 0};
+  _outfile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  write_column(column_id::event_id, column_type::string, _event_ids.offsets,
+               _event_ids.values);
+  write_column(column_id::timestamp, column_type::int64, _timestamps);
+  write_column(column_id::payload_type, column_type::uint8, _payload_types);
+  write_column(column_id::model_id, column_type::string, _model_ids.offsets,
+               _model_ids.values);
+  write_column(column_id::skip_learn, column_type::uint8, _skip_learn);
+  write_column(column_id::pass_probability, column_type::float32,
+               _pass_probabilities);
+  write_column(column_id::probability_of_drop, column_type::float32,
+               _drop_probabilities);
+  write_column(column_id::actions, column_type::uint32_list, _actions.offsets,
+               _actions.values);
+  write_column(column_id::probabilities, column_type::float32_list,
+               _probabilities.offsets, _probabilities.values);
+  write_column(column_id::rewards, column_type::float32_list, _rewards.offsets,
+               _rewards.values);
+  write_column(column_id::original_rewards, column_type::float32_list,
+               _original_rewards.offsets, _original_rewards.values);
+  write_column(column_id::continuous_action, column_type::float32,
+               _continuous_actions);
+  write_column(column_id::context, column_type::string, _contexts.offsets,
+               _contexts.values);
+
+  _event_ids.clear();
+  _timestamps.clear();
+  _payload_types.clear();
+  _model_ids.clear();
+  _skip_learn.clear();
+  _pass_probabilities.clear();
+  _drop_probabilities.clear();
+  _actions.clear();
+  _probabilities.clear();
+  _rewards.clear();
+  _original_rewards.clear();
+  _continuous_actions.clear();
+  _contexts.clear();
+  _rows = 0;
+}
+
+template <typename T>
+void columnar_writer::write_column(column_id id, column_type type,
+                                   const std::vector<T> &values) {
+  _raw.clear();
+  append_bytes(_raw, values);
+  write_raw_column(id, type);
+}
+
+template <typename T>
+void columnar_writer::write_column(column_id id, column_type type,
+                                   const std::vector<uint32_t> &offsets,
+                                   const std::vector<T> &values) {
+  _raw.clear();
+  append_bytes(_raw, offsets);
+  append_bytes(_raw, values);
+  write_raw_column(id, type);
+}
+
+void columnar_writer::write_raw_column(column_id id, column_type type) {
+  column_header header{static_cast<uint32_t>(id), type, compression_type::none,
+                       0, _raw.size(), _raw.size()};
+  const char *stored = _raw.data();
+
+  if (_compression_level > 0 && !_raw.empty()) {
+    _compressed.resize(ZSTD_compressBound(_raw.size()));
+    const size_t size =
+        ZSTD_compress(_compressed.data(), _compressed.size(), _raw.data(),
+                      _raw.size(), _compression_level);
+    if (!ZSTD_isError(size) && size < _raw.size()) {
+      header.compression = compression_type::zstd;
+      header.stored_size = size;
+      stored = _compressed.data();
+    }
+  }
+
+  _outfile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  _outfile.write(stored, static_cast<std::streamsize>(header.stored_size));
+}
+
+bool columnar_reader::open(const std::string &file_name) {
+  _file.open(file_name, std::ios::binary);
+  if (!_file.is_open()) {
+    VW::io::logger::log_error("Failed to open [{}]", file_name);
+    return false;
+  }
+
+  uint32_t file_header[2];
+  footer_trailer trailer;
+  _file.seekg(0, std::ios::end);
+  const auto size = static_cast<uint64_t>(_file.tellg());
+  _file.seekg(0);
+  if (size < sizeof(file_header) + sizeof(trailer) ||
+      !_file.read(reinterpret_cast<char *>(file_header), sizeof(file_header)) ||
+      file_header[0] != FILE_MAGIC || file_header[1] != FILE_VERSION) {
+    VW::io::logger::log_error("[{}] is not a columnar file of version [{}]",
+                              file_name, FILE_VERSION);
+    return false;
+  }
+
+  _file.seekg(static_cast<std::streamoff>(size - sizeof(trailer)));
+  if (!_file.read(reinterpret_cast<char *>(&trailer), sizeof(trailer)) ||
+      trailer.magic != FILE_MAGIC ||
+      trailer.row_group_count >
+          (size - sizeof(file_header) - sizeof(trailer)) / sizeof(uint64_t)) {
+    VW::io::logger::log_error("[{}] has no valid footer, it may be truncated",
+                              file_name);
+    return false;
+  }
+
+  _row_group_offsets.resize(static_cast<size_t>(trailer.row_group_count));
+  const uint64_t offsets_size = trailer.row_group_count * sizeof(uint64_t);
+  _file.seekg(static_cast<std::streamoff>(size - sizeof(trailer) - offsets_size));
+  return static_cast<bool>(
+      _file.read(reinterpret_cast<char *>(_row_group_offsets.data()),
+                 static_cast<std::streamsize>(offsets_size)));
+}
+
+bool columnar_reader::read_column(size_t row_group, column_id id,
+                                  column_data &column) {
+  if (row_group >= _row_group_offsets.size()) {
+    return false;
+  }
+
+  _file.clear();
+  _file.seekg(static_cast<std::streamoff>(_row_group_offsets[row_group]));
+  row_group_header group;
+  if (!_file.read(reinterpret_cast<char *>(&group), sizeof(group)) ||
+      group.magic != ROW_GROUP_MAGIC) {
+    VW::io::logger::log_error("Row group [{}] is corrupted", row_group);
+    return false;
+  }
+
+  for (uint32_t i = 0; i < group.column_count; ++i) {
+    column_header header;
+    if (!_file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+      break;
+    }
+    if (header.id != static_cast<uint32_t>(id)) {
+      _file.seekg(static_cast<std::streamoff>(header.stored_size),
+                  std::ios::cur);
+      continue;
+    }
+
+    _stored.resize(static_cast<size_t>(header.stored_size));
+    if (!_file.read(_stored.data(),
+                    static_cast<std::streamsize>(_stored.size()))) {
+      break;
+    }
+
+    std::vector<char> raw;
+    if (header.compression == compression_type::zstd) {
+      raw.resize(static_cast<size_t>(header.raw_size));
+      const size_t size = ZSTD_decompress(raw.data(), raw.size(),
+                                          _stored.data(), _stored.size());
+      if (ZSTD_isError(size) || size != raw.size()) {
+        VW::io::logger::log_error(
+            "Column [{}] of row group [{}] failed to decompress",
+            header.id, row_group);
+        return false;
+      }
+    } else {
+      raw.swap(_stored);
+    }
+
+    column.type = header.type;
+    column.rows = group.rows;
+    column.offsets.clear();
+    size_t values_begin = 0;
+    if (has_offsets(header.type)) {
+      values_begin = (static_cast<size_t>(group.rows) + 1) * sizeof(uint32_t);
+      if (raw.size() < values_begin) {
+        VW::io::logger::log_error("Column [{}] of row group [{}] is truncated",
+                                  header.id, row_group);
+        return false;
+      }
+      column.offsets.resize(group.rows + 1);
+      std::memcpy(column.offsets.data(), raw.data(), values_begin);
+    }
+    column.values.assign(raw.begin() + values_begin, raw.end());
+    return true;
+  }
+
+  VW::io::logger::log_error("Column [{}] not found in row group [{}]",
+                            static_cast<uint32_t>(id), row_group);
+  return false;
+}
+} // namespace log_converter
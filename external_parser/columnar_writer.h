@@ -0,0 +1,216 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include "event_writer.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace log_converter {
+namespace columnar {
+// File layout, all integers in native byte order since the structs are written
+// and read as is, files only move between machines of the same endianness:
+//   file header   FILE_MAGIC, FILE_VERSION (uint32 each)
+//   row groups    row_group_header, then column_count columns, each a
+//                 column_header followed by stored_size bytes
+//   footer        the offset of each row group (uint64 each), then
+//                 footer_trailer
+// A column holds one value per row of its row group. String and list columns
+// start with rows + 1 uint32 offsets into the values that follow them, row
+// groups are cut before their values outgrow them.
+// Columns are zstd compressed unless that doesn't make them smaller.
+constexpr uint32_t FILE_MAGIC = 0x4C435756;      //'VWCL'
+constexpr uint32_t ROW_GROUP_MAGIC = 0x47524356; //'VCRG'
+constexpr uint32_t FILE_VERSION = 1;
+
+enum class column_type : uint8_t {
+  uint8 = 0,
+  uint32 = 1,
+  int64 = 2,
+  float32 = 3,
+  string = 4,
+  uint32_list = 5,
+  float32_list = 6,
+};
+
+enum class compression_type : uint8_t { none = 0, zstd = 1 };
+
+enum class column_id : uint32_t {
+  // interaction event id
+  event_id = 0,
+  // microseconds since epoch
+  timestamp = 1,
+  // v2::PayloadType
+  payload_type = 2,
+  model_id = 3,
+  skip_learn = 4,
+  pass_probability = 5,
+  probability_of_drop = 6,
+  // cb: every action, ccb and slates: the chosen action of each slot,
+  // ca: empty
+  actions = 7,
+  // probabilities of the actions above, ca: the pdf value of the action
+  probabilities = 8,
+  // ccb: one per slot, one otherwise
+  rewards = 9,
+  original_rewards = 10,
+  // ca only, NaN otherwise
+  continuous_action = 11,
+  // the context, as in DSJSON
+  context = 12,
+};
+constexpr uint32_t COLUMN_COUNT = 13;
+
+struct row_group_header {
+  uint32_t magic;
+  uint32_t rows;
+  uint32_t column_count;
+  uint32_t reserved;
+};
+
+struct column_header {
+  uint32_t id;
+  column_type type;
+  compression_type compression;
+  uint16_t reserved;
+  uint64_t raw_size;
+  uint64_t stored_size;
+};
+
+struct footer_trailer {
+  uint64_t row_group_count;
+  uint32_t magic;
+  uint32_t version;
+};
+
+// A column of a row group as read back
+struct column_data {
+  column_type type;
+  uint32_t rows = 0;
+  // rows + 1 offsets into values, string and list columns only
+  std::vector<uint32_t> offsets;
+  std::vector<char> values;
+
+  template <typename T> const T *as() const {
+    return reinterpret_cast<const T *>(values.data());
+  }
+  std::string string_at(size_t row) const {
+    return std::string(values.data() + offsets[row],
+                       offsets[row + 1] - offsets[row]);
+  }
+};
+} // namespace columnar
+
+// Writes joined events as rows of a columnar file, see columnar above, so
+// that analytics read only the columns they need instead of parsing DSJSON
+class columnar_writer : public event_writer {
+public:
+  static constexpr size_t DEFAULT_ROWS_PER_GROUP = 64 * 1024;
+  static constexpr size_t DEFAULT_BYTES_PER_GROUP = 256 * 1024 * 1024;
+  // a row adds less than 2GB (the size limit of a flatbuffer), so the values
+  // of a group stay within the uint32 offsets
+  static constexpr size_t MAX_BYTES_PER_GROUP = 1024 * 1024 * 1024;
+  static constexpr int DEFAULT_COMPRESSION_LEVEL = 3;
+
+  // a row group is cut once it has rows_per_group rows or its string and list
+  // values add up to bytes_per_group, at most MAX_BYTES_PER_GROUP
+  columnar_writer(const std::string &file_name,
+                  size_t rows_per_group = DEFAULT_ROWS_PER_GROUP,
+                  size_t bytes_per_group = DEFAULT_BYTES_PER_GROUP,
+                  int compression_level = DEFAULT_COMPRESSION_LEVEL);
+  ~columnar_writer() override;
+
+  columnar_writer(const columnar_writer &) = delete;
+  columnar_writer &operator=(const columnar_writer &) = delete;
+
+  bool is_open() const override { return _outfile.is_open(); }
+
+  void write(joined_event::joined_event &&je) override;
+  // row groups are cut on their number of rows and bytes only
+  void end_chunk() override {}
+  // writes the last row group and the footer, events written after it are
+  // dropped
+  void flush() override;
+
+private:
+  struct string_column {
+    std::vector<uint32_t> offsets{0};
+    std::vector<char> values;
+
+    void append(const std::string &value);
+    void clear();
+  };
+
+  template <typename T> struct list_column {
+    std::vector<uint32_t> offsets{0};
+    std::vector<T> values;
+
+    void end_row() { offsets.push_back(static_cast<uint32_t>(values.size())); }
+    void clear() {
+      offsets.resize(1);
+      values.clear();
+    }
+  };
+
+  void add_row(joined_event::joined_event &je);
+  // bytes of the values of the string and list columns of the row group
+  size_t value_bytes() const;
+  void write_row_group();
+  template <typename T>
+  void write_column(columnar::column_id id, columnar::column_type type,
+                    const std::vector<T> &values);
+  template <typename T>
+  void write_column(columnar::column_id id, columnar::column_type type,
+                    const std::vector<uint32_t> &offsets,
+                    const std::vector<T> &values);
+  void write_raw_column(columnar::column_id id, columnar::column_type type);
+
+  std::ofstream _outfile;
+  const size_t _rows_per_group;
+  const size_t _bytes_per_group;
+  const int _compression_level;
+  bool _finished = false;
+  uint32_t _rows = 0;
+  std::vector<uint64_t> _row_group_offsets;
+
+  string_column _event_ids;
+  std::vector<int64_t> _timestamps;
+  std::vector<uint8_t> _payload_types;
+  string_column _model_ids;
+  std::vector<uint8_t> _skip_learn;
+  std::vector<float> _pass_probabilities;
+  std::vector<float> _drop_probabilities;
+  list_column<uint32_t> _actions;
+  list_column<float> _probabilities;
+  list_column<float> _rewards;
+  list_column<float> _original_rewards;
+  std::vector<float> _continuous_actions;
+  string_column _contexts;
+
+  // reused across columns
+  std::vector<char> _raw;
+  std::vector<char> _compressed;
+};
+
+// Reads back the columns of a file written by columnar_writer, one column of
+// one row group at a time
+class columnar_reader {
+public:
+  bool open(const std::string &file_name);
+
+  size_t row_group_count() const { return _row_group_offsets.size(); }
+  // skips over the other columns of the row group
+  bool read_column(size_t row_group, columnar::column_id id,
+                   columnar::column_data &column);
+
+private:
+  std::ifstream _file;
+  std::vector<uint64_t> _row_group_offsets;
+  std::vector<char> _stored;
+};
+} // namespace log_converter
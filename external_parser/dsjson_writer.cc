@@ -0,0 +1,137 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "dsjson_writer.h"
+#include "log_converter.h"
+
+namespace log_converter {
+constexpr size_t dsjson_writer::PENDING_PER_THREAD;
+constexpr size_t dsjson_writer::FILE_BUFFER_SIZE;
+
+dsjson_writer::dsjson_writer(const std::string &file_name, size_t threads)
+    : _file_buffer(FILE_BUFFER_SIZE),
+      _max_pending(threads * PENDING_PER_THREAD) {
+  // only taken into account if set before opening the file
+  _outfile.rdbuf()->pubsetbuf(_file_buffer.data(), _file_buffer.size());
+  _outfile.open(file_name, std::ofstream::out);
+  for (size_t i = 0; i < threads; ++i) {
+    _threads.emplace_back(&dsjson_writer::worker, this);
+  }
+}
+
+dsjson_writer::~dsjson_writer() {
+  flush();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _work_cv.notify_all();
+  for (auto &thread : _threads) {
+    thread.join();
+  }
+  _outfile.close();
+}
+
+void dsjson_writer::write(joined_event::joined_event &&je) {
+  if (!_current) {
+    _current = get_chunk();
+  }
+  _current->events.push_back(std::move(je));
+}
+
+void dsjson_writer::end_chunk() {
+  if (!_current || _current->events.empty()) {
+    return;
+  }
+
+  if (_threads.empty()) {
+    convert(*_current);
+    write_chunk(std::move(_current));
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _work.push_back(_current.get());
+    _pending.push_back(std::move(_current));
+  }
+  _work_cv.notify_one();
+  write_done_chunks(false);
+}
+
+void dsjson_writer::flush() {
+  end_chunk();
+  write_done_chunks(true);
+  _outfile.flush();
+}
+
+void dsjson_writer::convert(chunk &c) {
+  for (auto &je : c.events) {
+    build_json(c.output, je);
+  }
+}
+
+std::unique_ptr<dsjson_writer::chunk> dsjson_writer::get_chunk() {
+  if (_free_chunks.empty()) {
+    return std::unique_ptr<chunk>(new chunk());
+  }
+  auto c = std::move(_free_chunks.back());
+  _free_chunks.pop_back();
+  return c;
+}
+
+void dsjson_writer::write_chunk(std::unique_ptr<chunk> &&c) {
+  _outfile.write(c->output.GetString(), c->output.GetSize());
+  // keeps the capacity of both for the next chunks
+  c->events.clear();
+  c->output.Clear();
+  c->done = false;
+  _free_chunks.push_back(std::move(c));
+}
+
+void dsjson_writer::write_done_chunks(bool wait_all) {
+  while (true) {
+    std::unique_ptr<chunk> front;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (_pending.empty()) {
+        return;
+      }
+      if (!_pending.front()->done) {
+        // past _max_pending the reader waits for the workers to catch up
+        if (!wait_all && _pending.size() <= _max_pending) {
+          return;
+        }
+        _done_cv.wait(lock, [this] { return _pending.front()->done; });
+      }
+      front = std::move(_pending.front());
+      _pending.pop_front();
+    }
+    write_chunk(std::move(front));
+  }
+}
+
+void dsjson_writer::worker() {
+  while (true) {
+    chunk *c = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _work_cv.wait(lock, [this] { return _stop || !_work.empty(); });
+      if (_stop) {
+        return;
+      }
+      c = _work.front();
+      _work.pop_front();
+    }
+
+    convert(*c);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      c->done = true;
+    }
+    _done_cv.notify_all();
+  }
+}
+} // namespace log_converter
@@ -0,0 +1,78 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include "event_writer.h"
+
+#include <rapidjson/stringbuffer.h>
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace log_converter {
+
+// Writes joined events to a DSJSON file. Events are grouped in chunks, one per
+// regular message of the joined log, which are converted on worker threads if
+// any and written to the file in the order they were added, one chunk at a
+// time. Chunks and their buffers are reused once written.
+class dsjson_writer : public event_writer {
+public:
+  dsjson_writer(const std::string &file_name, size_t threads);
+  // writes whatever is left
+  ~dsjson_writer() override;
+
+  dsjson_writer(const dsjson_writer &) = delete;
+  dsjson_writer &operator=(const dsjson_writer &) = delete;
+
+  bool is_open() const override { return _outfile.is_open(); }
+
+  void write(joined_event::joined_event &&je) override;
+  // the events written so far make a chunk of their own
+  void end_chunk() override;
+  // converts and writes every pending chunk
+  void flush() override;
+
+private:
+  struct chunk {
+    std::vector<joined_event::joined_event> events;
+    rapidjson::StringBuffer output;
+    bool done = false;
+  };
+
+  static void convert(chunk &c);
+  std::unique_ptr<chunk> get_chunk();
+  void write_chunk(std::unique_ptr<chunk> &&c);
+  // writes the converted chunks at the front of _pending, waiting for all of
+  // them if wait_all
+  void write_done_chunks(bool wait_all);
+  void worker();
+
+  // chunks converted ahead of the file, per worker
+  static constexpr size_t PENDING_PER_THREAD = 4;
+  static constexpr size_t FILE_BUFFER_SIZE = 1 << 20;
+
+  std::vector<char> _file_buffer;
+  std::ofstream _outfile;
+  std::unique_ptr<chunk> _current;
+  std::vector<std::unique_ptr<chunk>> _free_chunks;
+
+  size_t _max_pending = 0;
+  std::mutex _mutex;
+  std::condition_variable _work_cv;
+  std::condition_variable _done_cv;
+  // submission order, only the front is written and only once done
+  std::deque<std::unique_ptr<chunk>> _pending;
+  // chunks no worker picked up yet
+  std::deque<chunk *> _work;
+  bool _stop = false;
+  std::vector<std::thread> _threads;
+};
+} // namespace log_converter
@@ -131,7 +131,8 @@ struct cb_joined_event : public typed_joined_event {
     std::vector<reward::outcome_event> &outcome_events) override {
     reward = default_reward;
     // original reward is used to record the observed reward of apprentice mode
-    original_reward = reward_function(outcome_events, default_reward);
+    original_reward =
+        reward::calculate(reward_function, outcome_events, default_reward);
 
     if (interaction_metadata.learning_mode == v2::LearningModeType_Apprentice) {
       set_apprentice_reward();
@@ -266,7 +267,8 @@ struct ccb_joined_event : public typed_joined_event {
 
     for (size_t i = 0; i < num_of_slots; i++) {
       if (outcomes_map.find(i) != outcomes_map.end()) {
-        original_rewards[i] = reward_function(outcomes_map[i], default_reward);
+        original_rewards[i] = reward::calculate(reward_function, outcomes_map[i],
+                                                default_reward);
       }
     }
 
@@ -355,7 +357,8 @@ struct slates_joined_event : public typed_joined_event {
       const metadata::event_metadata_info &metadata_info,
       std::vector<reward::outcome_event> &outcome_events) override {
     reward = default_reward;
-    original_reward = reward_function(outcome_events, default_reward);
+    original_reward =
+        reward::calculate(reward_function, outcome_events, default_reward);
 
     if (metadata_info.learning_mode == v2::LearningModeType_Apprentice) {
       VW::io::logger::log_warn( "Apprentice mode is not implmeneted for slates.");
@@ -436,7 +439,8 @@ struct ca_joined_event : public typed_joined_event {
                  std::vector<reward::outcome_event> &outcome_events) override {
     reward = default_reward;
     // original reward is used to record the observed reward of apprentice mode
-    original_reward = reward_function(outcome_events, default_reward);
+    original_reward =
+        reward::calculate(reward_function, outcome_events, default_reward);
 
     if (interaction_metadata.learning_mode == v2::LearningModeType_Apprentice) {
       VW::io::logger::log_warn(
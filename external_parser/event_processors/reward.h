@@ -3,118 +3,147 @@
 #include "metadata.h"
 #include "generated/v2/OutcomeEvent_generated.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 namespace reward {
 
+// Outcomes are joined to the interaction of their event id, which is all
+// that's kept of their metadata
 struct outcome_event {
-  outcome_event()
-      : metadata({}), s_index(""), index(-1), s_value(""), value(0),
-        enqueued_time_utc(TimePoint()), action_taken(false) {}
-  metadata::event_metadata_info metadata;
-  v2::IndexValue index_type;
-  std::string s_index;
-  int index;
-  std::string s_value;
-  float value;
+  // numeric value, literal values don't count towards rewards
+  float value = 0.f;
+  int index = -1;
+  v2::IndexValue index_type = v2::IndexValue_NONE;
+  bool action_taken = false;
   TimePoint enqueued_time_utc;
-  bool action_taken;
+  // literal index e.g. a ccb slot id, empty otherwise
+  std::string s_index;
 };
 
-using RewardFunctionType =
-    float (*)(const std::vector<outcome_event> &, float default_reward);
+// The values of the outcomes that count towards a reward, i.e. not the
+// activations, laid out contiguously along with when they were enqueued
+struct outcome_values {
+  std::vector<float> values;
+  std::vector<TimePoint> enqueued_times;
 
-inline float
-average(const std::vector<outcome_event> &outcome_events, float default_reward) {
-  float sum = 0.f;
-  size_t N = 0;
+  void clear() {
+    values.clear();
+    enqueued_times.clear();
+  }
 
-  for (const auto &o : outcome_events) {
-    if (!o.action_taken) {
-      sum += o.value;
-      N++;
+  void append(const std::vector<outcome_event> &outcome_events) {
+    for (const auto &o : outcome_events) {
+      if (!o.action_taken) {
+        values.push_back(o.value);
+        enqueued_times.push_back(o.enqueued_time_utc);
+      }
     }
   }
+};
 
-  return N == 0 ? default_reward : sum/N;
-}
-
-inline float
-sum(const std::vector<outcome_event> &outcome_events, float default_reward) {
-  float sum = 0.f;
-  size_t N = 0;
-
-  for (const auto &o : outcome_events) {
-    if (!o.action_taken) {
-      sum += o.value;
-      N++;
+// may reorder outcomes.values
+using RewardFunctionType = float (*)(outcome_values &outcomes,
+                                     float default_reward);
+
+namespace detail {
+// independent lanes so that the loops vectorize
+constexpr size_t LANES = 8;
+
+template <typename reduce_t>
+inline float reduce(const float *values, size_t size, float init,
+                    reduce_t reduce_op) {
+  float lanes[LANES];
+  std::fill(lanes, lanes + LANES, init);
+  size_t i = 0;
+  for (; i + LANES <= size; i += LANES) {
+    for (size_t lane = 0; lane < LANES; ++lane) {
+      lanes[lane] = reduce_op(lanes[lane], values[i + lane]);
     }
   }
+  for (; i < size; ++i) {
+    lanes[0] = reduce_op(lanes[0], values[i]);
+  }
+  float result = lanes[0];
+  for (size_t lane = 1; lane < LANES; ++lane) {
+    result = reduce_op(result, lanes[lane]);
+  }
+  return result;
+}
 
-  return N == 0 ? default_reward : sum;
+inline float sum(const float *values, size_t size) {
+  return reduce(values, size, 0.f, [](float a, float b) { return a + b; });
 }
+} // namespace detail
 
-inline float
-min(const std::vector<outcome_event> &outcome_events, float default_reward) {
-  float min_reward = std::numeric_limits<float>::max();
+inline float average(outcome_values &outcomes, float default_reward) {
+  const auto &values = outcomes.values;
+  return values.empty() ? default_reward
+                        : detail::sum(values.data(), values.size()) /
+                              values.size();
+}
 
-  for (const auto &o : outcome_events) {
-    if (!o.action_taken && o.value < min_reward) {
-      min_reward = o.value;
-    }
-  }
-  return min_reward == std::numeric_limits<float>::max()
-                     ? default_reward : min_reward;
+inline float sum(outcome_values &outcomes, float default_reward) {
+  const auto &values = outcomes.values;
+  return values.empty() ? default_reward
+                        : detail::sum(values.data(), values.size());
 }
 
-inline float
-max(const std::vector<outcome_event> &outcome_events, float default_reward) {
-  float max_reward = std::numeric_limits<float>::min();
+inline float min(outcome_values &outcomes, float default_reward) {
+  const float init = std::numeric_limits<float>::max();
+  const float min_reward =
+      detail::reduce(outcomes.values.data(), outcomes.values.size(), init,
+                     [](float a, float b) { return b < a ? b : a; });
+  return min_reward == init ? default_reward : min_reward;
+}
 
-  for (const auto &o : outcome_events) {
-    if (!o.action_taken && o.value > max_reward) {
-      max_reward = o.value;
-    }
-  }
-  return max_reward ==  std::numeric_limits<float>::min()
-                     ? default_reward : max_reward;
+inline float max(outcome_values &outcomes, float default_reward) {
+  const float init = std::numeric_limits<float>::lowest();
+  const float max_reward =
+      detail::reduce(outcomes.values.data(), outcomes.values.size(), init,
+                     [](float a, float b) { return b > a ? b : a; });
+  return max_reward == init ? default_reward : max_reward;
 }
 
-inline float
-median(const std::vector<outcome_event> &outcome_events, float default_reward) {
-  std::vector<float> values;
-  for (const auto &o : outcome_events) {
-    if (!o.action_taken) {
-      values.push_back(o.value);
-    }
+inline float median(outcome_values &outcomes, float default_reward) {
+  auto &values = outcomes.values;
+  const size_t size = values.size();
+  if (size == 0) {
+    return default_reward;
   }
 
-  int outcome_events_size = values.size();
-
-  if (outcome_events_size > 0) {
-    sort(values.begin(), values.end());
-    if (outcome_events_size % 2 == 0) {
-      return (values[outcome_events_size / 2 - 1] +
-              values[outcome_events_size / 2]) /
-            2;
-    } else {
-      return values[outcome_events_size / 2];
-    }
+  // partial sort in place instead of sorting a copy
+  const auto middle = values.begin() + size / 2;
+  std::nth_element(values.begin(), middle, values.end());
+  if (size % 2 == 0) {
+    const float lower = *std::max_element(values.begin(), middle);
+    return (lower + *middle) / 2;
   }
-
-  return default_reward;
+  return *middle;
 }
 
-inline float
-earliest(const std::vector<outcome_event> &outcome_events, float default_reward) {
+inline float earliest(outcome_values &outcomes, float default_reward) {
   auto oldest_valid_observation = TimePoint::max();
   float earliest_reward = default_reward;
 
-  for (const auto &o : outcome_events) {
-    if (!o.action_taken && o.enqueued_time_utc < oldest_valid_observation) {
-      oldest_valid_observation = o.enqueued_time_utc;
-      earliest_reward = o.value;
+  for (size_t i = 0; i < outcomes.values.size(); ++i) {
+    if (outcomes.enqueued_times[i] < oldest_valid_observation) {
+      oldest_valid_observation = outcomes.enqueued_times[i];
+      earliest_reward = outcomes.values[i];
     }
   }
 
   return earliest_reward;
 }
+
+// reward of outcome_events, gathered in buffers reused across calls
+inline float calculate(RewardFunctionType reward_function,
+                       const std::vector<outcome_event> &outcome_events,
+                       float default_reward) {
+  static thread_local outcome_values outcomes;
+  outcomes.clear();
+  outcomes.append(outcome_events);
+  return reward_function(outcomes, default_reward);
+}
 } // namespace reward
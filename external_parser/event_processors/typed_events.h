@@ -2,11 +2,15 @@
 
 #include "generated/v2/CaEvent_generated.h"
 #include "generated/v2/CbEvent_generated.h"
+#include "generated/v2/Event_generated.h"
 #include "generated/v2/Metadata_generated.h"
 #include "generated/v2/MultiSlotEvent_generated.h"
 #include "joined_event.h"
 #include "loop.h"
 #include "zstd.h"
+#include "zstd_dictionaries.h"
+
+#include <memory>
 
 namespace v2 = reinforcement_learning::messages::flatbuff::v2;
 
@@ -220,50 +224,148 @@ template <> struct event_processor<v2::CaEvent> {
   }
 };
 
-template <typename T>
-bool process_compression(const uint8_t *data, size_t size,
-                         const v2::Metadata &metadata, const T *&payload,
-                         flatbuffers::DetachedBuffer &detached_buffer) {
+// decompression contexts are reused across events, one per parsing thread
+inline ZSTD_DCtx *get_thread_dctx() {
+  static thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx *)> dctx(
+      ZSTD_createDCtx(), ZSTD_freeDCtx);
+  return dctx.get();
+}
 
-  if (metadata.encoding() == v2::EventEncoding_Zstd) {
-    size_t buff_size = ZSTD_getFrameContentSize(data, size);
-    if (buff_size == ZSTD_CONTENTSIZE_ERROR) {
+inline bool is_compressed(const v2::Metadata &metadata) {
+  return metadata.encoding() == v2::EventEncoding_Zstd ||
+         metadata.encoding() == v2::EventEncoding_ZstdDictionary;
+}
+
+// decompresses a zstd encoded event payload into detached_buffer, warnings
+// are only logged if log_warnings is set
+inline bool decompress_payload(const uint8_t *data, size_t size,
+                               const v2::Metadata &metadata,
+                               flatbuffers::DetachedBuffer &detached_buffer,
+                               bool log_warnings = true) {
+  size_t buff_size = ZSTD_getFrameContentSize(data, size);
+  if (buff_size == ZSTD_CONTENTSIZE_ERROR) {
+    if (log_warnings) {
       VW::io::logger::log_warn("Received ZSTD_CONTENTSIZE_ERROR while "
                                "decompressing event with id: "
                                "[{}] of type: [{}]",
                                metadata.id()->c_str(), metadata.payload_type());
-      return false;
     }
-    if (buff_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+    return false;
+  }
+  if (buff_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+    if (log_warnings) {
       VW::io::logger::log_warn("Received ZSTD_CONTENTSIZE_UNKNOWN while "
                                "decompressing event with id: "
                                "[{}] of type: [{}]",
                                metadata.id()->c_str(), metadata.payload_type());
-      return false;
     }
+    return false;
+  }
 
-    std::unique_ptr<uint8_t[]> buff_data(
-        flatbuffers::DefaultAllocator().allocate(buff_size));
-    size_t res = ZSTD_decompress(buff_data.get(), buff_size, data, size);
+  const ZSTD_DDict *ddict = nullptr;
+  if (metadata.encoding() == v2::EventEncoding_ZstdDictionary) {
+    uint32_t dictionary_id = ZSTD_getDictID_fromFrame(data, size);
+    ddict = zstd_dictionaries::instance().get(dictionary_id);
+    if (ddict == nullptr) {
+      if (log_warnings) {
+        VW::io::logger::log_warn("Unknown zstd dictionary [{}] while "
+                                 "decompressing event with id: "
+                                 "[{}] of type: [{}]",
+                                 dictionary_id, metadata.id()->c_str(),
+                                 metadata.payload_type());
+      }
+      return false;
+    }
+  }
 
-    if (ZSTD_isError(res)) {
+  std::unique_ptr<uint8_t[]> buff_data(
+      flatbuffers::DefaultAllocator().allocate(buff_size));
+  size_t res =
+      ddict != nullptr
+          ? ZSTD_decompress_usingDDict(get_thread_dctx(), buff_data.get(),
+                                       buff_size, data, size, ddict)
+          : ZSTD_decompressDCtx(get_thread_dctx(), buff_data.get(),
+                                buff_size, data, size);
+
+  if (ZSTD_isError(res)) {
+    if (log_warnings) {
       VW::io::logger::log_warn(
           "Received [{}] error while decompressing event with id: "
           "[{}] of type: [{}]",
           ZSTD_getErrorName(res), metadata.id()->c_str(),
           metadata.payload_type());
-      return false;
     }
+    return false;
+  }
 
-    auto data_ptr = buff_data.release();
+  auto data_ptr = buff_data.release();
 
-    detached_buffer =
-        flatbuffers::DetachedBuffer(nullptr, false, data_ptr, 0, data_ptr, res);
-    payload = flatbuffers::GetRoot<T>(detached_buffer.data());
+  detached_buffer =
+      flatbuffers::DetachedBuffer(nullptr, false, data_ptr, 0, data_ptr, res);
+  return true;
+}
+
+// decompressed is the payload decompressed ahead of time by one of the binary
+// parser's worker threads, if any
+template <typename T>
+bool process_compression(const uint8_t *data, size_t size,
+                         const v2::Metadata &metadata, const T *&payload,
+                         flatbuffers::DetachedBuffer &detached_buffer,
+                         const flatbuffers::DetachedBuffer *decompressed = nullptr) {
 
+  if (decompressed != nullptr && decompressed->data() != nullptr) {
+    payload = flatbuffers::GetRoot<T>(decompressed->data());
+  } else if (is_compressed(metadata)) {
+    if (!decompress_payload(data, size, metadata, detached_buffer)) {
+      return false;
+    }
+    payload = flatbuffers::GetRoot<T>(detached_buffer.data());
   } else {
     payload = flatbuffers::GetRoot<T>(data);
   }
   return true;
 }
+
+// batches logged with batch compression (content encoding ZSTD or DEDUP_ZSTD)
+// carry their events in a zstd compressed EventBatch
+inline bool process_batch_compression(const v2::EventBatch &batch,
+                                      const v2::EventBatch *&events_batch,
+                                      flatbuffers::DetachedBuffer &detached_buffer) {
+  const auto *compressed = batch.compressed_events();
+  if (compressed == nullptr) {
+    events_batch = &batch;
+    return true;
+  }
+
+  size_t buff_size =
+      ZSTD_getFrameContentSize(compressed->data(), compressed->size());
+  if (buff_size == ZSTD_CONTENTSIZE_ERROR ||
+      buff_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+    VW::io::logger::log_warn("Invalid compressed content in event batch with "
+                             "content encoding: [{}]",
+                             batch.metadata() && batch.metadata()->content_encoding()
+                                 ? batch.metadata()->content_encoding()->c_str()
+                                 : "");
+    return false;
+  }
+
+  std::unique_ptr<uint8_t[]> buff_data(
+      flatbuffers::DefaultAllocator().allocate(buff_size));
+  size_t res = ZSTD_decompressDCtx(get_thread_dctx(), buff_data.get(),
+                                   buff_size, compressed->data(),
+                                   compressed->size());
+
+  if (ZSTD_isError(res)) {
+    VW::io::logger::log_warn(
+        "Received [{}] error while decompressing event batch",
+        ZSTD_getErrorName(res));
+    return false;
+  }
+
+  auto data_ptr = buff_data.release();
+  detached_buffer =
+      flatbuffers::DetachedBuffer(nullptr, false, data_ptr, 0, data_ptr, res);
+  events_batch = v2::GetEventBatch(detached_buffer.data());
+  return true;
+}
 } // namespace typed_event
\ No newline at end of file
@@ -0,0 +1,23 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include "event_processors/joined_event.h"
+
+namespace log_converter {
+
+// Destination of the joined events of a converted log, e.g. a DSJSON file
+class event_writer {
+public:
+  virtual ~event_writer() = default;
+
+  virtual bool is_open() const = 0;
+  virtual void write(joined_event::joined_event &&je) = 0;
+  // called at the end of each regular message of the joined log
+  virtual void end_chunk() = 0;
+  // called once the input is exhausted, writes everything added so far
+  virtual void flush() = 0;
+};
+} // namespace log_converter
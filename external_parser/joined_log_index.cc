@@ -0,0 +1,221 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "joined_log_index.h"
+#include "event_processors/timestamp_helper.h"
+#include "generated/v2/FileFormat_generated.h"
+#include "io/logger.h"
+#include "mapped_file_reader.h"
+#include "parse_example_binary.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+
+namespace VW {
+namespace external {
+namespace {
+static_assert(sizeof(joined_log_index::index_entry) == 32,
+              "index entries are saved as is");
+
+struct index_header {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t file_size;
+  uint64_t entry_count;
+};
+
+int64_t to_seconds(const v2::TimeStamp &ts) {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             timestamp_to_chrono(ts).time_since_epoch())
+      .count();
+}
+
+void read_time_range(const char *payload, uint32_t payload_size,
+                     joined_log_index::index_entry &entry) {
+  auto verifier = flatbuffers::Verifier(
+      reinterpret_cast<const uint8_t *>(payload), payload_size);
+  auto joined_payload = flatbuffers::GetRoot<v2::JoinedPayload>(payload);
+  if (!joined_payload->Verify(verifier) || joined_payload->events() == nullptr) {
+    return;
+  }
+
+  int64_t min_time = std::numeric_limits<int64_t>::max();
+  int64_t max_time = std::numeric_limits<int64_t>::min();
+  for (const auto *joined_event : *joined_payload->events()) {
+    const auto *ts = joined_event->timestamp();
+    if (ts == nullptr || is_empty_timestamp(*ts)) {
+      continue;
+    }
+    const auto time = to_seconds(*ts);
+    min_time = std::min(min_time, time);
+    max_time = std::max(max_time, time);
+  }
+  if (min_time <= max_time) {
+    entry.min_time = min_time;
+    entry.max_time = max_time;
+  }
+}
+} // namespace
+
+constexpr uint32_t joined_log_index::INDEX_MAGIC;
+constexpr uint32_t joined_log_index::INDEX_VERSION;
+
+bool joined_log_index::build(mapped_file_reader &reader) {
+  _entries.clear();
+  _file_size = reader.size();
+  if (!reader.set_range(0, _file_size)) {
+    return false;
+  }
+
+  unsigned int payload_type;
+  const char *payload;
+  uint32_t payload_size;
+  while (true) {
+    const uint64_t offset = reader.offset();
+    if (!reader.next(payload_type, payload, payload_size)) {
+      return false;
+    }
+    if (payload_type == MSG_TYPE_EOF) {
+      return true;
+    }
+    if (payload_type != MSG_TYPE_CHECKPOINT &&
+        payload_type != MSG_TYPE_REGULAR) {
+      continue;
+    }
+
+    index_entry entry{payload_type, payload_size, offset, 0, 0};
+    if (payload_type == MSG_TYPE_REGULAR) {
+      read_time_range(payload, payload_size, entry);
+    }
+    _entries.push_back(entry);
+  }
+}
+
+bool joined_log_index::save(const std::string &file_name) const {
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    VW::io::logger::log_error("Failed to open index file [{}] for writing",
+                              file_name);
+    return false;
+  }
+
+  const index_header header{INDEX_MAGIC, INDEX_VERSION, _file_size,
+                            _entries.size()};
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(_entries.data()),
+             _entries.size() * sizeof(index_entry));
+  return static_cast<bool>(file);
+}
+
+bool joined_log_index::load(const std::string &file_name, uint64_t file_size) {
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  index_header header;
+  if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      header.magic != INDEX_MAGIC || header.version != INDEX_VERSION) {
+    VW::io::logger::log_warn("[{}] is not a joined log index", file_name);
+    return false;
+  }
+  if (header.file_size != file_size) {
+    VW::io::logger::log_warn("Index [{}] was built for a file of [{}] bytes, "
+                             "the data file has [{}]",
+                             file_name, header.file_size, file_size);
+    return false;
+  }
+
+  std::vector<index_entry> entries(static_cast<size_t>(header.entry_count));
+  if (!file.read(reinterpret_cast<char *>(entries.data()),
+                 entries.size() * sizeof(index_entry))) {
+    VW::io::logger::log_warn("Index [{}] is truncated", file_name);
+    return false;
+  }
+
+  _entries = std::move(entries);
+  _file_size = file_size;
+  return true;
+}
+
+size_t joined_log_index::checkpoint_count() const {
+  return std::count_if(_entries.begin(), _entries.end(),
+                       [](const index_entry &entry) {
+                         return entry.payload_type == MSG_TYPE_CHECKPOINT;
+                       });
+}
+
+bool joined_log_index::shard_range(size_t shard, size_t shards,
+                                   uint64_t &begin, uint64_t &end) const {
+  std::vector<uint64_t> checkpoints;
+  for (const auto &entry : _entries) {
+    if (entry.payload_type == MSG_TYPE_CHECKPOINT) {
+      checkpoints.push_back(entry.offset);
+    }
+  }
+
+  if (shard >= shards || checkpoints.empty()) {
+    return false;
+  }
+
+  const size_t first = shard * checkpoints.size() / shards;
+  const size_t last = (shard + 1) * checkpoints.size() / shards;
+  if (first == last) {
+    return false;
+  }
+
+  begin = checkpoints[first];
+  end = last < checkpoints.size() ? checkpoints[last] : _file_size;
+  return true;
+}
+
+bool joined_log_index::time_range(int64_t start_time, int64_t end_time,
+                                  uint64_t &begin, uint64_t &end) const {
+  bool has_checkpoint = false;
+  uint64_t checkpoint = 0;
+  bool found = false;
+  uint64_t new_begin = begin;
+  uint64_t new_end = end;
+
+  for (const auto &entry : _entries) {
+    if (entry.offset < begin) {
+      continue;
+    }
+    if (entry.offset >= end) {
+      break;
+    }
+
+    if (entry.payload_type == MSG_TYPE_CHECKPOINT) {
+      if (found && new_end == end) {
+        // first checkpoint after a match, kept unless another match follows
+        new_end = entry.offset;
+      }
+      has_checkpoint = true;
+      checkpoint = entry.offset;
+      continue;
+    }
+
+    const bool in_window =
+        entry.max_time >= start_time && entry.min_time <= end_time;
+    if (!in_window || !has_checkpoint) {
+      continue;
+    }
+    if (!found) {
+      found = true;
+      new_begin = checkpoint;
+    }
+    new_end = end;
+  }
+
+  if (!found) {
+    return false;
+  }
+  begin = new_begin;
+  end = new_end;
+  return true;
+}
+} // namespace external
+} // namespace VW
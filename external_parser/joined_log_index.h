@@ -0,0 +1,64 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VW {
+namespace external {
+class mapped_file_reader;
+
+// Offsets of the checkpoint and regular messages of a binary joined log, with
+// the range of JoinedEvent timestamps of each regular message. Checkpoints
+// carry everything needed to join the messages after them, so the ranges
+// below always start at one and a file can be split among processes or
+// skipped to a time window without a sequential scan.
+//
+// Saved as a sidecar file: a header (magic, version, size of the indexed
+// file, entry count) followed by the entries as laid out in index_entry.
+class joined_log_index {
+public:
+  struct index_entry {
+    uint32_t payload_type;
+    uint32_t payload_size;
+    // offset of the message in the file, i.e. of its payload type
+    uint64_t offset;
+    // seconds since epoch, 0 for checkpoints and messages without timestamps
+    int64_t min_time;
+    int64_t max_time;
+  };
+
+  static constexpr uint32_t INDEX_MAGIC = 0x58495756; //'VWIX'
+  static constexpr uint32_t INDEX_VERSION = 1;
+
+  // scans the whole mapping, the reader is left at the end of the file
+  bool build(mapped_file_reader &reader);
+  bool save(const std::string &file_name) const;
+  // fails if the index doesn't belong to a file of file_size bytes
+  bool load(const std::string &file_name, uint64_t file_size);
+
+  const std::vector<index_entry> &entries() const { return _entries; }
+  size_t checkpoint_count() const;
+
+  // [begin, end[ of the messages of shard out of shards, split on checkpoints.
+  // Returns false for an empty shard.
+  bool shard_range(size_t shard, size_t shards, uint64_t &begin,
+                   uint64_t &end) const;
+
+  // narrows [begin, end[ to the checkpoints around the regular messages with
+  // events in [start_time, end_time]. Messages between those checkpoints are
+  // kept whole, events outside of the window aren't filtered out. Returns
+  // false if no message is left.
+  bool time_range(int64_t start_time, int64_t end_time, uint64_t &begin,
+                  uint64_t &end) const;
+
+private:
+  std::vector<index_entry> _entries;
+  uint64_t _file_size = 0;
+};
+} // namespace external
+} // namespace VW
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Open addressing map from the event ids of a batch to the position of their
+// group of events in the batch. Ids are kept as pointers into the batch
+// payload, which outlives the batch, so nothing is copied. Clearing is
+// constant time and the table is reused across batches.
+class event_id_index {
+public:
+  // position of the group of id, or group_if_new after inserting it
+  size_t find_or_insert(const char *id, size_t size, size_t group_if_new,
+                        bool &inserted) {
+    if ((_size + 1) * 2 > _slots.size()) {
+      grow();
+    }
+
+    const uint64_t id_hash = hash(id, size);
+    const size_t mask = _slots.size() - 1;
+    for (size_t i = id_hash & mask;; i = (i + 1) & mask) {
+      auto &slot = _slots[i];
+      if (slot.generation != _generation) {
+        slot = {id, id_hash, static_cast<uint32_t>(size),
+                static_cast<uint32_t>(group_if_new), _generation};
+        ++_size;
+        inserted = true;
+        return group_if_new;
+      }
+      if (slot.hash == id_hash && slot.size == size &&
+          std::memcmp(slot.id, id, size) == 0) {
+        inserted = false;
+        return slot.group;
+      }
+    }
+  }
+
+  void clear() {
+    _size = 0;
+    if (++_generation == 0) {
+      // slots of old batches could be mistaken for the current one
+      for (auto &slot : _slots) {
+        slot.generation = 0;
+      }
+      _generation = 1;
+    }
+  }
+
+  size_t size() const { return _size; }
+
+private:
+  struct slot {
+    const char *id;
+    uint64_t hash;
+    uint32_t size;
+    uint32_t group;
+    // the slot is used if it matches the current generation
+    uint32_t generation;
+  };
+
+  // FNV-1a
+  static uint64_t hash(const char *id, size_t size) {
+    uint64_t value = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+      value ^= static_cast<unsigned char>(id[i]);
+      value *= 1099511628211ull;
+    }
+    return value;
+  }
+
+  void grow() {
+    const size_t capacity = _slots.empty() ? 64 : _slots.size() * 2;
+    std::vector<slot> slots(capacity, slot{nullptr, 0, 0, 0, 0});
+    const size_t mask = slots.size() - 1;
+    for (const auto &old : _slots) {
+      if (old.generation != _generation) {
+        continue;
+      }
+      size_t i = old.hash & mask;
+      while (slots[i].generation == _generation) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = old;
+    }
+    _slots.swap(slots);
+  }
+
+  std::vector<slot> _slots;
+  size_t _size = 0;
+  uint32_t _generation = 1;
+};
@@ -1,5 +1,7 @@
 #include "joiners/example_joiner.h"
+#include "dsjson_writer.h"
 #include "log_converter.h"
+#include "parse_example_external.h"
 
 #include "event_processors/typed_events.h"
 #include "generated/v2/DedupInfo_generated.h"
@@ -8,33 +10,64 @@
 #include "zstd.h"
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
 #include <limits.h>
 #include <time.h>
+#include <unordered_set>
 
 // VW headers
 #include "parse_example_json.h"
 #include "parser.h"
 #include "scope_exit.h"
 
+namespace {
+// what the features parsed from an action depend on besides its JSON: the
+// hash function and seed, probed with a word and a number as --hash strings
+// hashes numbers to themselves, the bit mask and the ignored namespaces
+std::string hashing_parameters(vw &all) {
+  const uint64_t namespace_hash = VW::hash_space(all, "dedup_cache");
+  std::string parameters = std::to_string(namespace_hash);
+  for (const char *probe : {"feature", "1"}) {
+    parameters +=
+        ' ' + std::to_string(VW::hash_feature(all, probe, namespace_hash));
+  }
+  parameters += ' ' + std::to_string(all.parse_mask) + ' ';
+  for (int ns = 0; ns < 256; ++ns) {
+    if (all.ignore_some && all.ignore[ns]) {
+      parameters += std::to_string(ns) + ',';
+    }
+  }
+  return parameters;
+}
+} // namespace
+
 example_joiner::example_joiner(vw *vw)
     : _vw(vw), _reward_calculation(&reward::earliest), _binary_to_json(false) {}
 
 example_joiner::example_joiner(vw *vw, bool binary_to_json,
-                               std::string outfile_name)
+                               std::string outfile_name,
+                               size_t converter_threads)
     : _vw(vw), _reward_calculation(&reward::earliest),
       _binary_to_json(binary_to_json) {
-  _outfile.open(outfile_name, std::ofstream::out);
+  if (_binary_to_json) {
+    _event_writer = VW::make_unique<log_converter::dsjson_writer>(
+        outfile_name, converter_threads);
+  }
 }
 
+example_joiner::example_joiner(
+    vw *vw, std::unique_ptr<log_converter::event_writer> &&event_writer)
+    : _vw(vw), _reward_calculation(&reward::earliest), _binary_to_json(true),
+      _event_writer(std::move(event_writer)) {}
+
 example_joiner::~example_joiner() {
   // cleanup examples
   _dedup_cache.clear(return_example_f, this);
   for (auto *ex : _example_pool) {
     VW::dealloc_examples(ex, 1);
   }
-  if (_binary_to_json) {
-    _outfile.close();
-  }
+  // writes the events left
+  _event_writer.reset();
 }
 
 example *example_joiner::get_or_create_example() {
@@ -69,6 +102,13 @@ void example_joiner::return_example_f(void *vw, example *ex) {
 }
 
 bool example_joiner::process_event(const v2::JoinedEvent &joined_event) {
+  return process_event_with_payload(joined_event, nullptr, nullptr);
+}
+
+bool example_joiner::process_event_with_payload(
+    const v2::JoinedEvent &joined_event,
+    const flatbuffers::DetachedBuffer *decompressed_payload,
+    const std::vector<example *> *parsed_examples) {
   if (joined_event.event() == nullptr || joined_event.timestamp() == nullptr) {
     VW::io::logger::log_error(
         "JoinedEvent is malformed, can not process JoinedEvent");
@@ -83,10 +123,10 @@ bool example_joiner::process_event(const v2::JoinedEvent &joined_event) {
     return false;
   }
 
-  std::string id = event->meta()->id()->str();
+  const auto *id = event->meta()->id();
 
   if (event->meta()->payload_type() == v2::PayloadType_DedupInfo) {
-    if (!process_dedup(*event, *event->meta())) {
+    if (!process_dedup(*event, *event->meta(), decompressed_payload)) {
       // clean everything this batch is ruined without the dedup info
       // dedup cache will clear itself up when next dedup payload arrives
       clear_batch_info();
@@ -94,12 +134,18 @@ bool example_joiner::process_event(const v2::JoinedEvent &joined_event) {
     }
     return true;
   }
-  if (_batch_grouped_events.find(id) != _batch_grouped_events.end()) {
-    _batch_grouped_events[id].push_back(&joined_event);
-  } else {
-    _batch_grouped_events.insert({id, {&joined_event}});
-    _batch_event_order.emplace(id);
+  bool inserted = false;
+  const size_t group_index = _batch_group_index.find_or_insert(
+      id->c_str(), id->size(), _batch_group_count, inserted);
+  if (inserted) {
+    if (_batch_group_count == _batch_groups.size()) {
+      _batch_groups.emplace_back();
+    }
+    _batch_groups[_batch_group_count++].id = id;
   }
+  _batch_groups[group_index].events.push_back(
+      {joined_event.event()->data(), joined_event.event()->size(),
+       joined_event.timestamp(), decompressed_payload, parsed_examples});
   return true;
 }
 
@@ -163,11 +209,12 @@ void example_joiner::set_reward_function(const v2::RewardFunctionType type,
 }
 
 void example_joiner::clear_batch_info() {
-  _batch_grouped_events.clear();
-  _batch_grouped_examples.clear();
-  while (!_batch_event_order.empty()) {
-    _batch_event_order.pop();
+  for (size_t i = _next_batch_group; i < _batch_group_count; ++i) {
+    reset_event_group(_batch_groups[i]);
   }
+  _batch_group_count = 0;
+  _next_batch_group = 0;
+  _batch_group_index.clear();
 }
 
 void example_joiner::clear_vw_examples(v_array<example *> &examples) {
@@ -179,23 +226,27 @@ void example_joiner::clear_vw_examples(v_array<example *> &examples) {
   examples.push_back(&VW::get_unused_example(_vw));
 }
 
-void example_joiner::clear_event_id_batch_info(const std::string &id) {
-  _batch_grouped_events.erase(id);
-  if (!_batch_event_order.empty() && _batch_event_order.front() == id) {
-    _batch_event_order.pop();
+void example_joiner::pop_event_group() {
+  reset_event_group(_batch_groups[_next_batch_group]);
+  if (++_next_batch_group == _batch_group_count) {
+    clear_batch_info();
   }
-  _batch_grouped_examples.erase(id);
 }
 
-void example_joiner::invalidate_joined_event(const std::string &id) {
-  if (_batch_grouped_examples.find(id) != _batch_grouped_examples.end()) {
-    _batch_grouped_examples[id].ok = false;
-  }
+void example_joiner::reset_event_group(event_group &group) {
+  group.id = nullptr;
+  // keeps the capacity for the next batches
+  group.events.clear();
+  group.joined = joined_event::joined_event();
+  group.has_interaction = false;
 }
 
-bool example_joiner::process_interaction(const v2::Event &event,
+bool example_joiner::process_interaction(event_group &group,
+                                         const v2::Event &event,
                                          const v2::Metadata &metadata,
                                          const TimePoint &enqueued_time_utc,
+                                         const flatbuffers::DetachedBuffer *decompressed_payload,
+                                         const std::vector<example *> *parsed_examples,
                                          v_array<example *> &examples) {
 
   std::string payload_type(EnumNamePayloadType(metadata.payload_type()));
@@ -218,7 +269,7 @@ bool example_joiner::process_interaction(const v2::Event &event,
     const v2::CbEvent *cb = nullptr;
     if (!typed_event::process_compression<v2::CbEvent>(
             event.payload()->data(), event.payload()->size(), metadata, cb,
-            _detached_buffer) ||
+            _detached_buffer, decompressed_payload) ||
         cb == nullptr) {
       return false;
     }
@@ -238,7 +289,7 @@ bool example_joiner::process_interaction(const v2::Event &event,
     const v2::MultiSlotEvent *multislot = nullptr;
     if (!typed_event::process_compression<v2::MultiSlotEvent>(
             event.payload()->data(), event.payload()->size(), metadata,
-            multislot, _detached_buffer) ||
+            multislot, _detached_buffer, decompressed_payload) ||
         multislot == nullptr) {
       return false;
     }
@@ -260,7 +311,7 @@ bool example_joiner::process_interaction(const v2::Event &event,
     const v2::CaEvent *ca = nullptr;
     if (!typed_event::process_compression<v2::CaEvent>(
             event.payload()->data(), event.payload()->size(), metadata, ca,
-            _detached_buffer) ||
+            _detached_buffer, decompressed_payload) ||
         ca == nullptr) {
       return false;
     }
@@ -284,7 +335,18 @@ bool example_joiner::process_interaction(const v2::Event &event,
     return false;
   }
 
-  if (!_binary_to_json) {
+  if (!_dedup_cache.expand_texts(je.context)) {
+    VW::io::logger::log_warn("Deduped slot or shared namespace missing from the "
+                             "dedup cache for event with id: [{}]. Skipping "
+                             "interaction from processing.",
+                             metadata.id()->c_str());
+    return false;
+  }
+
+  if (!_binary_to_json && parsed_examples != nullptr &&
+      !parsed_examples->empty()) {
+    add_parsed_examples(*parsed_examples, metadata.payload_type(), examples);
+  } else if (!_binary_to_json) {
     std::string context(je.context);
     try {
       if (_vw->audit || _vw->hash_inv) {
@@ -307,112 +369,183 @@ bool example_joiner::process_interaction(const v2::Event &event,
     }
   }
 
-  _batch_grouped_examples.emplace(
-      std::make_pair<std::string, joined_event::joined_event>(
-          metadata.id()->str(), std::move(je)));
+  // the first interaction of an id wins
+  if (!group.has_interaction) {
+    group.joined = std::move(je);
+    group.has_interaction = true;
+  }
   return true;
 }
 
-bool example_joiner::process_outcome(const v2::Event &event,
-                                     const v2::Metadata &metadata,
-                                     const TimePoint &enqueued_time_utc) {
-  reward::outcome_event o_event;
-  o_event.metadata = {metadata.app_id() ? metadata.app_id()->str() : "",
-                      metadata.payload_type(),
-                      metadata.pass_probability(),
-                      metadata.encoding(),
-                      metadata.id()->str(),
-                      v2::LearningModeType_Online};
+void example_joiner::add_parsed_examples(
+    const std::vector<example *> &parsed_examples,
+    v2::PayloadType payload_type, v_array<example *> &examples) {
+  for (size_t i = 0; i < parsed_examples.size(); ++i) {
+    // the first one goes to the example vw handed in
+    example *to_ex = examples[0];
+    if (i > 0) {
+      to_ex = &VW::get_unused_example(_vw);
+      examples.push_back(to_ex);
+    }
+    const example &from = *parsed_examples[i];
+    example &to = *to_ex;
+    for (auto ns : from.indices) {
+      to.indices.push_back(ns);
+      const auto &from_fs = from.feature_space[ns];
+      auto &to_fs = to.feature_space[ns];
+      for (size_t j = 0; j < from_fs.values.size(); ++j) {
+        to_fs.values.push_back(from_fs.values[j]);
+        to_fs.indicies.push_back(from_fs.indicies[j]);
+      }
+      to_fs.sum_feat_sq += from_fs.sum_feat_sq;
+    }
+    // the json parser labels the shared example of a CB context
+    if (payload_type == v2::PayloadType_CB) {
+      for (const auto &cost : from.l.cb.costs) {
+        to.l.cb.costs.push_back(cost);
+      }
+    }
+  }
+}
 
-  o_event.enqueued_time_utc = enqueued_time_utc;
+bool example_joiner::process_outcome(event_group &group,
+                                     const v2::Event &event,
+                                     const v2::Metadata &metadata,
+                                     const TimePoint &enqueued_time_utc,
+                                     const flatbuffers::DetachedBuffer *decompressed_payload) {
+  // outcomes that precede their interaction are dropped, unparsed
+  if (!group.has_interaction) {
+    return true;
+  }
 
   const v2::OutcomeEvent *outcome = nullptr;
   if (!typed_event::process_compression<v2::OutcomeEvent>(
           event.payload()->data(), event.payload()->size(), metadata, outcome,
-          _detached_buffer) ||
+          _detached_buffer, decompressed_payload) ||
       outcome == nullptr) {
     // invalidate joined_event so that we don't learn from it
-    invalidate_joined_event(metadata.id()->str());
+    group.joined.ok = false;
     return false;
   }
 
-  if (outcome->value_type() == v2::OutcomeValue_literal) {
-    o_event.s_value = outcome->value_as_literal()->c_str();
-  } else if (outcome->value_type() == v2::OutcomeValue_numeric) {
+  auto &outcome_events = group.joined.outcome_events;
+  outcome_events.emplace_back();
+  reward::outcome_event &o_event = outcome_events.back();
+  o_event.enqueued_time_utc = enqueued_time_utc;
+
+  // literal values don't count towards the reward and aren't kept
+  if (outcome->value_type() == v2::OutcomeValue_numeric) {
     o_event.value = outcome->value_as_numeric()->value();
   }
 
   o_event.index_type = outcome->index_type();
 
   if (outcome->index_type() == v2::IndexValue_literal) {
-    o_event.s_index = outcome->index_as_literal()->c_str();
+    const auto *index = outcome->index_as_literal();
+    o_event.s_index.assign(index->c_str(), index->size());
   } else if (outcome->index_type() == v2::IndexValue_numeric) {
     o_event.index = outcome->index_as_numeric()->index();
   }
 
   o_event.action_taken = outcome->action_taken();
 
-  if (_batch_grouped_examples.find(metadata.id()->str()) !=
-      _batch_grouped_examples.end()) {
-    auto &joined_event = _batch_grouped_examples[metadata.id()->str()];
-    joined_event.outcome_events.push_back(o_event);
+  // outcomes of the same event id coalesced by the client, each one counts on its own
+  if (outcome->numeric_values() != nullptr) {
+    outcome_events.reserve(outcome_events.size() +
+                           outcome->numeric_values()->size());
+    for (const float value : *outcome->numeric_values()) {
+      outcome_events.push_back(outcome_events.back());
+      outcome_events.back().value = value;
+    }
   }
 
   return true;
 }
 
 bool example_joiner::process_dedup(const v2::Event &event,
-                                   const v2::Metadata &metadata) {
+                                   const v2::Metadata &metadata,
+                                   const flatbuffers::DetachedBuffer *decompressed_payload) {
 
   const v2::DedupInfo *dedup = nullptr;
   if (!typed_event::process_compression<v2::DedupInfo>(
           event.payload()->data(), event.payload()->size(), metadata, dedup,
-          _detached_buffer) ||
+          _detached_buffer, decompressed_payload) ||
       dedup == nullptr) {
     return false;
   }
 
-  if (dedup->ids()->size() != dedup->values()->size()) {
+  if (dedup->ids() == nullptr || dedup->values() == nullptr ||
+      dedup->ids()->size() != dedup->values()->size()) {
     VW::io::logger::log_error(
         "Can not process dedup payload, id and value sizes do not match");
     return false;
   }
 
+  // incremental payloads build on the objects of previous batches, dropping
+  // only the ones the client evicted. Other clients may still hold them
+  const uint64_t client_id = dedup->client_id();
+  if (dedup->incremental() && dedup->evicted_ids() != nullptr) {
+    for (auto dedup_id : *dedup->evicted_ids()) {
+      if (client_id != 0) {
+        _dedup_cache.release(client_id, dedup_id, return_example_f, this);
+      } else {
+        _dedup_cache.remove(dedup_id, return_example_f, this);
+      }
+    }
+  }
+
   v_array<example *> examples;
 
   for (size_t i = 0; i < dedup->ids()->size(); i++) {
     auto dedup_id = dedup->ids()->Get(i);
-    if (!_dedup_cache.exists(dedup_id)) {
-
+    if (_dedup_cache.exists(dedup_id)) {
+      _dedup_cache.update(dedup_id);
+    } else if (lru_dedup_cache::is_text(dedup_id)) {
+      // slots and shared namespaces are expanded back into the context
+      _dedup_cache.add_text(dedup_id, dedup->values()->Get(i)->c_str(),
+                            dedup->values()->Get(i)->size());
+    } else {
       examples.push_back(get_or_create_example());
-
-      try {
-        if (_vw->audit || _vw->hash_inv) {
-          VW::template read_line_json_s<true>(
-              *_vw, examples,
-              const_cast<char *>(dedup->values()->Get(i)->c_str()),
-              dedup->values()->Get(i)->size(), get_or_create_example_f, this);
-        } else {
-          VW::template read_line_json_s<false>(
-              *_vw, examples,
-              const_cast<char *>(dedup->values()->Get(i)->c_str()),
-              dedup->values()->Get(i)->size(), get_or_create_example_f, this);
+      const auto *value = dedup->values()->Get(i);
+
+      if (!_persistent_dedup_cache.restore(dedup_id, value->c_str(),
+                                           value->size(), *examples[0])) {
+        try {
+          if (_vw->audit || _vw->hash_inv) {
+            VW::template read_line_json_s<true>(
+                *_vw, examples, const_cast<char *>(value->c_str()),
+                value->size(), get_or_create_example_f, this);
+          } else {
+            VW::template read_line_json_s<false>(
+                *_vw, examples, const_cast<char *>(value->c_str()),
+                value->size(), get_or_create_example_f, this);
+          }
+        } catch (VW::vw_exception &e) {
+          VW::io::logger::log_error("JSON parsing during dedup processing "
+                                    "failed with error: [{}]",
+                                    e.what());
+          return false;
         }
-      } catch (VW::vw_exception &e) {
-        VW::io::logger::log_error("JSON parsing during dedup processing failed "
-                                  "with error: [{}]",
-                                  e.what());
-        return false;
+        _persistent_dedup_cache.store(dedup_id, value->c_str(), value->size(),
+                                      *examples[0]);
       }
 
       _dedup_cache.add(dedup_id, examples[0]);
       examples.clear();
-    } else {
-      _dedup_cache.update(dedup_id);
+    }
+    if (client_id != 0) {
+      _dedup_cache.hold(client_id, dedup_id);
     }
   }
 
-  if (dedup->ids()->size() > 0) {
+  if (client_id != 0 && !dedup->incremental()) {
+    // a full dictionary replaces what the client held
+    std::unordered_set<uint64_t> kept(dedup->ids()->begin(),
+                                      dedup->ids()->end());
+    _dedup_cache.release_others(client_id, kept, return_example_f, this);
+  }
+
+  if (!dedup->incremental() && dedup->ids()->size() > 0) {
     // location of first item in dedup payload will be the "last" item in the
     // cache that we care about keeping
     _dedup_cache.clear_after(dedup->ids()->Get(0), return_example_f, this);
@@ -424,27 +557,29 @@ bool example_joiner::process_dedup(const v2::Event &event,
 bool example_joiner::process_joined(v_array<example *> &examples) {
   _current_je_is_skip_learn = false;
 
-  if (_batch_event_order.empty()) {
+  if (!processing_batch()) {
     return true;
   }
 
-  auto id = _batch_event_order.front();
+  auto &group = _batch_groups[_next_batch_group];
   bool multiline = false;
 
-  for (auto &joined_event : _batch_grouped_events[id]) {
-    auto event = flatbuffers::GetRoot<v2::Event>(joined_event->event()->data());
+  for (auto &grouped : group.events) {
+    auto event = flatbuffers::GetRoot<v2::Event>(grouped.event);
     auto metadata = event->meta();
-    auto enqueued_time_utc = get_enqueued_time(joined_event->timestamp(),
+    auto enqueued_time_utc = get_enqueued_time(grouped.timestamp,
                                                metadata->client_time_utc(),
                                                _loop_info.use_client_time);
     const auto &payload_type = metadata->payload_type();
 
     if (payload_type == v2::PayloadType_Outcome) {
-      process_outcome(*event, *metadata, enqueued_time_utc);
+      process_outcome(group, *event, *metadata, enqueued_time_utc,
+                      grouped.decompressed_payload);
     } else {
       multiline = (payload_type != v2::PayloadType_CA);
-      if (!process_interaction(*event, *metadata, enqueued_time_utc,
-                               examples)) {
+      if (!process_interaction(group, *event, *metadata, enqueued_time_utc,
+                               grouped.decompressed_payload,
+                               grouped.parsed_examples, examples)) {
         continue;
       }
     }
@@ -480,32 +615,32 @@ bool example_joiner::process_joined(v_array<example *> &examples) {
       }
 
       if (_binary_to_json) {
-        log_converter::build_json(_outfile, *je);
+        _event_writer->write(std::move(*je));
       }
     }
 
-    clear_event_id_batch_info(id);
+    pop_event_group();
     if (clear_examples) {
       clear_vw_examples(examples);
     }
   });
 
-  if (_batch_grouped_examples.find(id) == _batch_grouped_examples.end()) {
+  if (!group.has_interaction) {
     // can't learn from this interaction
     VW::io::logger::log_warn("Events with event id [{}] were processed but "
                              "no valid interaction found. Skipping..",
-                             id);
+                             group.id->c_str());
     clear_examples = true;
     return false;
   }
 
-  je = &_batch_grouped_examples[id];
+  je = &group.joined;
   if (!je->ok) {
     // don't learn from this interaction
     VW::io::logger::log_warn(
         "Interaction with event id [{}] has been invalidated due to malformed "
         "observation. Skipping...",
-        id);
+        group.id->c_str());
     clear_examples = true;
     return false;
   }
@@ -565,16 +700,131 @@ void example_joiner::persist_metrics() {
   }
 }
 
-bool example_joiner::processing_batch() { return !_batch_event_order.empty(); }
+bool example_joiner::processing_batch() {
+  return _next_batch_group < _batch_group_count;
+}
 bool example_joiner::current_event_is_skip_learn() {
   return _current_je_is_skip_learn;
 }
-void example_joiner::on_new_batch() {}
-void example_joiner::on_batch_read() {}
+void example_joiner::on_new_batch() {
+  if (_event_writer) {
+    // one chunk per regular message
+    _event_writer->end_chunk();
+  }
+}
+void example_joiner::on_batch_read() {
+  if (_join_window.enabled()) {
+    hold_batch_in_window();
+  }
+}
+
+bool example_joiner::release_held_events() {
+  if (!_join_window.enabled() || _held_events_released) {
+    return false;
+  }
+  _held_events_released = true;
+  _join_window.release(true);
+  add_released_groups();
+
+  if (_join_window.late_outcomes() > 0 ||
+      _join_window.orphaned_outcomes() > 0) {
+    VW::io::logger::log_warn("The join window dropped [{}] late outcomes and "
+                             "[{}] outcomes without an interaction",
+                             _join_window.late_outcomes(),
+                             _join_window.orphaned_outcomes());
+  }
+  return processing_batch();
+}
+
+void example_joiner::hold_batch_in_window() {
+  TimePoint latest_time;
+  for (size_t i = 0; i < _batch_group_count; ++i) {
+    const auto &group = _batch_groups[i];
+    _window_events.clear();
+    for (const auto &grouped : group.events) {
+      auto event = flatbuffers::GetRoot<v2::Event>(grouped.event);
+      const auto *metadata = event->meta();
+      const auto time = get_enqueued_time(
+          grouped.timestamp, metadata->client_time_utc(),
+          _loop_info.use_client_time);
+      latest_time = std::max(latest_time, time);
+      _window_events.push_back(
+          {grouped.event, grouped.event_size, grouped.timestamp, time,
+           metadata->payload_type() != v2::PayloadType_Outcome});
+    }
+    _join_window.add(group.id->c_str(), group.id->size(), _window_events);
+  }
+  clear_batch_info();
+
+  _join_window.advance(latest_time);
+  _join_window.release(false);
+  add_released_groups();
+}
+
+void example_joiner::add_released_groups() {
+  for (size_t i = 0; i < _join_window.released(); ++i) {
+    _held_events.clear();
+    _join_window.released_events(i, _held_events);
+
+    if (_batch_group_count == _batch_groups.size()) {
+      _batch_groups.emplace_back();
+    }
+    auto &group = _batch_groups[_batch_group_count++];
+    for (const auto &held : _held_events) {
+      group.events.push_back(
+          {held.data, held.size, held.timestamp, nullptr, nullptr});
+    }
+    group.id =
+        flatbuffers::GetRoot<v2::Event>(_held_events.front().data)->meta()->id();
+  }
+}
+
+void example_joiner::on_input_done() {
+  if (_event_writer) {
+    _event_writer->flush();
+  }
+}
 
 metrics::joiner_metrics example_joiner::get_metrics() {
+  _joiner_metrics.number_of_late_outcomes = _join_window.late_outcomes();
+  _joiner_metrics.number_of_orphaned_outcomes =
+      _join_window.orphaned_outcomes();
+  _joiner_metrics.number_of_join_window_spills = _join_window.spills();
+  _joiner_metrics.number_of_early_releases = _join_window.early_releases();
+  _joiner_metrics.number_of_dedup_cache_hits = _persistent_dedup_cache.hits();
+  _joiner_metrics.number_of_dedup_cache_stores =
+      _persistent_dedup_cache.stores();
   return _joiner_metrics;
 }
 
 void example_joiner::apply_cli_overrides(vw *all,
-                                         const input_options &parsed_options) {}
+                                         const input_options &parsed_options) {
+  const auto &ext_opts = *parsed_options.ext_opts;
+  if (ext_opts.binary_parser_join_window < 0) {
+    throw std::runtime_error("Invalid argument to --binary_parser_join_window " +
+      std::to_string(ext_opts.binary_parser_join_window));
+  }
+  if (ext_opts.binary_parser_join_window_memory < 0) {
+    throw std::runtime_error(
+      "Invalid argument to --binary_parser_join_window_memory " +
+      std::to_string(ext_opts.binary_parser_join_window_memory));
+  }
+  _join_window.configure(
+      std::chrono::seconds(ext_opts.binary_parser_join_window),
+      static_cast<size_t>(ext_opts.binary_parser_join_window_memory) << 20,
+      ext_opts.binary_parser_join_window_spill);
+
+  const auto &dedup_cache_file = ext_opts.binary_parser_dedup_cache;
+  if (dedup_cache_file.empty()) {
+    return;
+  }
+  if (all->audit || all->hash_inv) {
+    VW::io::logger::log_warn("--binary_parser_dedup_cache is ignored with "
+                             "--audit and --invert_hash, the cached features "
+                             "have no audit information");
+  } else if (!_persistent_dedup_cache.open(dedup_cache_file,
+                                           hashing_parameters(*all))) {
+    throw std::runtime_error("Failed to open the dedup cache " +
+                             dedup_cache_file);
+  }
+}
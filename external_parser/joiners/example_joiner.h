@@ -2,12 +2,17 @@
 
 #include "error_constants.h"
 
+#include "event_writer.h"
+#include "joiners/event_id_index.h"
+#include "joiners/join_window.h"
+
 #include "event_processors/joined_event.h"
 #include "event_processors/loop.h"
 #include "example.h"
 #include "joiners/i_joiner.h"
 #include "lru_dedup_cache.h"
 #include "metrics/metrics.h"
+#include "persistent_dedup_cache.h"
 #include "v_array.h"
 
 #include <fstream>
@@ -18,7 +23,13 @@
 class example_joiner : public i_joiner {
 public:
   example_joiner(vw *vw); // TODO rule of 5
-  example_joiner(vw *vw, bool binary_to_json, std::string outfile_name);
+  // converter_threads converts the joined events to DSJSON off the joining
+  // thread, 0 converts them inline
+  example_joiner(vw *vw, bool binary_to_json, std::string outfile_name,
+                 size_t converter_threads = 0);
+  // converts the joined events to event_writer instead of learning from them
+  example_joiner(vw *vw,
+                 std::unique_ptr<log_converter::event_writer> &&event_writer);
 
   virtual ~example_joiner();
 
@@ -39,6 +50,10 @@ public:
   // groups all events interactions with their event observations based on their
   // id. The grouped events can be processed when process_joined() is called
   bool process_event(const v2::JoinedEvent &joined_event) override;
+  bool process_event_with_payload(
+      const v2::JoinedEvent &joined_event,
+      const flatbuffers::DetachedBuffer *decompressed_payload,
+      const std::vector<example *> *parsed_examples) override;
 
   /**
    * Takes all grouped events, processes them (e.g. decompression) and populates
@@ -55,10 +70,12 @@ public:
    *
    * --- Assumptions ---
    *
-   * Interactions precede observations
+   * Interactions precede observations within a batch. With a join window
+   * (--binary_parser_join_window) events are held across batches instead and
+   * observations may come before their interaction, see join_window
    *
-   * If an interaction is processed without problems it will create an entry in
-   * _batched_grouped_examples with key the id (event id). If an interaction
+   * If an interaction is processed without problems it will fill in the
+   * joined event of the group of its id (event id). If an interaction
    * was not processed correctly due to an error then the corresponding
    * outcome(s) will be ignored and we will not learn from that interaction
    *
@@ -83,24 +100,62 @@ public:
   void on_new_batch() override;
 
   void on_batch_read() override;
+  void on_input_done() override;
+  bool release_held_events() override;
 
   metrics::joiner_metrics get_metrics() override;
 
   void persist_metrics() override;
 
 private:
-  bool process_dedup(const v2::Event &event, const v2::Metadata &metadata);
-
-  bool process_interaction(const v2::Event &event, const v2::Metadata &metadata,
+  // an Event and the timestamp of its JoinedEvent, in the batch payload or
+  // held by the join window
+  struct grouped_event {
+    const uint8_t *event;
+    uint32_t event_size;
+    const v2::TimeStamp *timestamp;
+    const flatbuffers::DetachedBuffer *decompressed_payload;
+    const std::vector<example *> *parsed_examples;
+  };
+
+  // all the events of an event id in a batch, and the joined event built
+  // from them
+  struct event_group {
+    // points into the batch payload
+    const flatbuffers::String *id = nullptr;
+    std::vector<grouped_event> events;
+    joined_event::joined_event joined;
+    bool has_interaction = false;
+  };
+
+  bool process_dedup(const v2::Event &event, const v2::Metadata &metadata,
+                     const flatbuffers::DetachedBuffer *decompressed_payload);
+
+  bool process_interaction(event_group &group, const v2::Event &event,
+                           const v2::Metadata &metadata,
                            const TimePoint &enqueued_time_utc,
+                           const flatbuffers::DetachedBuffer *decompressed_payload,
+                           const std::vector<example *> *parsed_examples,
+                           v_array<example *> &examples);
+  // copies the examples parsed from a context off vw's thread into examples,
+  // as read_line_json_s would have filled them in
+  void add_parsed_examples(const std::vector<example *> &parsed_examples,
+                           v2::PayloadType payload_type,
                            v_array<example *> &examples);
 
-  bool process_outcome(const v2::Event &event, const v2::Metadata &metadata,
-                       const TimePoint &enqueued_time_utc);
+  bool process_outcome(event_group &group, const v2::Event &event,
+                       const v2::Metadata &metadata,
+                       const TimePoint &enqueued_time_utc,
+                       const flatbuffers::DetachedBuffer *decompressed_payload);
 
   void clear_batch_info();
-  void clear_event_id_batch_info(const std::string &id);
-  void invalidate_joined_event(const std::string &id);
+  // moves the events of the batch to the join window and replaces the batch
+  // with the event ids it releases
+  void hold_batch_in_window();
+  void add_released_groups();
+  // done with the group at the front of the batch
+  void pop_event_group();
+  void reset_event_group(event_group &group);
   void clear_vw_examples(v_array<example *> &examples);
 
   example *get_or_create_example();
@@ -112,14 +167,22 @@ private:
   static void return_example_f(void *vw, example *ex);
 
   lru_dedup_cache _dedup_cache;
-  // from event id to all the information required to create a complete
-  // (multi)example
-  std::unordered_map<std::string, joined_event::joined_event>
-      _batch_grouped_examples;
-  // from event id to all the events that have that event id
-  std::unordered_map<std::string, std::vector<const v2::JoinedEvent *>>
-      _batch_grouped_events;
-  std::queue<std::string> _batch_event_order;
+  // parsed actions kept across runs, see --binary_parser_dedup_cache
+  persistent_dedup_cache _persistent_dedup_cache;
+  // event groups of the batch in the order their ids first appear, only the
+  // first _batch_group_count are in use. Groups are kept across batches and
+  // reused along with their buffers
+  std::vector<event_group> _batch_groups;
+  size_t _batch_group_count = 0;
+  // next group for process_joined
+  size_t _next_batch_group = 0;
+  // from event id to its group, one lookup per event
+  event_id_index _batch_group_index;
+
+  join_window _join_window;
+  std::vector<join_window::event> _window_events;
+  std::vector<join_window::held_event> _held_events;
+  bool _held_events_released = false;
 
   std::vector<example *> _example_pool;
 
@@ -136,5 +199,5 @@ private:
   bool _current_je_is_skip_learn;
 
   bool _binary_to_json;
-  std::ofstream _outfile;
+  std::unique_ptr<log_converter::event_writer> _event_writer;
 };
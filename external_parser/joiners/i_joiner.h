@@ -48,6 +48,17 @@ public:
   // groups all events interactions with their event observations based on their
   // id. The grouped events can be processed when process_joined() is called
   virtual bool process_event(const v2::JoinedEvent &joined_event) = 0;
+  // Same as process_event for an event whose payload was decompressed ahead of
+  // time, e.g. by the worker threads of the binary parser. decompressed_payload
+  // is null or empty if the payload wasn't decompressed. parsed_examples is
+  // null or empty unless the context of the interaction was parsed already,
+  // the examples stay owned by the caller until the batch is processed
+  virtual bool process_event_with_payload(
+      const v2::JoinedEvent &joined_event,
+      const flatbuffers::DetachedBuffer *decompressed_payload,
+      const std::vector<example *> *parsed_examples) {
+    return process_event(joined_event);
+  }
   // Takes all grouped events, processes them (e.g. decompression) and populates
   // the examples array with complete example(s) ready to be used by vw for
   // training
@@ -65,6 +76,13 @@ public:
 
   virtual void on_batch_read() = 0;
 
+  // the whole input was read, e.g. to flush converted events
+  virtual void on_input_done() {}
+
+  // the input ended, events held across batches for a join are released to
+  // process_joined. Returns true if there are any
+  virtual bool release_held_events() { return false; }
+
   virtual void persist_metrics() {}
 
   virtual metrics::joiner_metrics get_metrics() = 0;
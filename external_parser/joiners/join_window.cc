@@ -0,0 +1,247 @@
+#include "joiners/join_window.h"
+#include "io/logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+// events are held as records of a header followed by the event, each part
+// padded to 8 bytes so that the events can be read in place
+struct record_header {
+  uint32_t size;
+  uint32_t is_interaction;
+  v2::TimeStamp timestamp;
+};
+
+constexpr size_t padded(size_t size) { return (size + 7) & ~size_t(7); }
+constexpr size_t HEADER_SIZE = padded(sizeof(record_header));
+
+template <typename visit_t>
+void for_each_record(const std::vector<uint8_t> &records, visit_t visit) {
+  size_t offset = 0;
+  while (offset + HEADER_SIZE <= records.size()) {
+    const auto *header =
+        reinterpret_cast<const record_header *>(records.data() + offset);
+    visit(*header, records.data() + offset + HEADER_SIZE);
+    offset += HEADER_SIZE + padded(header->size);
+  }
+}
+} // namespace
+
+void join_window::configure(std::chrono::seconds max_age, size_t memory_cap,
+                            const std::string &spill_file) {
+  _max_age = max_age;
+  _memory_cap = memory_cap;
+  _spill_file_name = spill_file;
+}
+
+void join_window::add(const char *id, size_t id_size,
+                      const std::vector<event> &events) {
+  const event *interaction = nullptr;
+  for (const auto &e : events) {
+    if (e.is_interaction) {
+      interaction = &e;
+      break;
+    }
+  }
+
+  std::string key(id, id_size);
+  auto found = _held.find(key);
+  const bool is_new = found == _held.end();
+  // outcomes of an id that isn't held can't be joined anymore once they are
+  // older than the window
+  const bool drop_late = is_new && interaction == nullptr;
+  const auto is_late = [this](const event &e) {
+    return e.time + _max_age < _latest_time;
+  };
+
+  if (is_new) {
+    if (drop_late &&
+        std::all_of(events.begin(), events.end(), is_late)) {
+      _late_outcomes += events.size();
+      return;
+    }
+    found = _held.emplace(std::move(key), held_id()).first;
+    found->second.id = &found->first;
+    found->second.deadline = _deadlines.end();
+    _memory += found->first.size();
+  }
+
+  auto &held = found->second;
+  const bool had_interaction = held.has_interaction;
+  const event *first = nullptr;
+  for (const auto &e : events) {
+    if (drop_late && is_late(e)) {
+      ++_late_outcomes;
+      continue;
+    }
+    if (first == nullptr) {
+      first = &e;
+    }
+    append_record(held, e);
+  }
+
+  if (interaction != nullptr && !had_interaction) {
+    set_deadline(held, interaction->time + _max_age);
+  } else if (is_new) {
+    set_deadline(held, first->time + _max_age);
+  }
+}
+
+void join_window::advance(TimePoint time) {
+  _latest_time = std::max(_latest_time, time);
+}
+
+void join_window::release(bool all) {
+  _released.clear();
+
+  while (!_deadlines.empty() &&
+         (all || _deadlines.begin()->first <= _latest_time)) {
+    release_id(*_deadlines.begin()->second, false);
+  }
+
+  if (_memory_cap == 0 || _memory <= _memory_cap) {
+    return;
+  }
+
+  // the ids due last wait in the spill file
+  if (!_spill_file_name.empty() && !_spill_failed) {
+    auto it = _deadlines.end();
+    while (_memory > _memory_cap && it != _deadlines.begin()) {
+      --it;
+      auto &held = *it->second;
+      if (!held.records.empty() && !spill(held)) {
+        break;
+      }
+    }
+  }
+
+  while (_memory > _memory_cap && !_deadlines.empty()) {
+    release_id(*_deadlines.begin()->second, true);
+  }
+}
+
+void join_window::released_events(size_t index,
+                                  std::vector<held_event> &events) const {
+  const auto &records = _released[index];
+  for (const bool interactions : {true, false}) {
+    for_each_record(records, [&](const record_header &header,
+                                 const uint8_t *data) {
+      if ((header.is_interaction != 0) == interactions) {
+        events.push_back({data, header.size, &header.timestamp});
+      }
+    });
+  }
+}
+
+void join_window::append_record(held_id &held, const event &e) {
+  record_header header;
+  header.size = e.size;
+  header.is_interaction = e.is_interaction ? 1 : 0;
+  header.timestamp = *e.timestamp;
+
+  const size_t offset = held.records.size();
+  const size_t record_size = HEADER_SIZE + padded(e.size);
+  held.records.resize(offset + record_size, 0);
+  std::memcpy(held.records.data() + offset, &header, sizeof(header));
+  std::memcpy(held.records.data() + offset + HEADER_SIZE, e.data, e.size);
+  _memory += record_size;
+
+  if (e.is_interaction) {
+    held.has_interaction = true;
+  } else {
+    ++held.outcomes;
+  }
+}
+
+void join_window::set_deadline(held_id &held, TimePoint deadline) {
+  if (held.deadline != _deadlines.end()) {
+    _deadlines.erase(held.deadline);
+  }
+  held.deadline = _deadlines.emplace(deadline, &held);
+}
+
+void join_window::release_id(held_id &held, bool early) {
+  _memory -= held.records.size() + held.id->size();
+
+  if (held.has_interaction) {
+    _released.emplace_back();
+    auto &records = _released.back();
+    if (held.spilled.empty()) {
+      records = std::move(held.records);
+    } else if (read_back(held, records)) {
+      records.insert(records.end(), held.records.begin(), held.records.end());
+    } else {
+      VW::io::logger::log_error("Failed to read the events of event id [{}] "
+                                "back from the join window spill file [{}], "
+                                "skipping them",
+                                *held.id, _spill_file_name);
+      _released.pop_back();
+    }
+    if (early) {
+      ++_early_releases;
+    }
+  } else {
+    _orphaned_outcomes += held.outcomes;
+  }
+
+  if (!held.spilled.empty() && --_ids_in_spill_file == 0) {
+    // nothing left in the spill file, it is written over from the start
+    _spill_size = 0;
+  }
+  _deadlines.erase(held.deadline);
+  _held.erase(_held.find(*held.id));
+}
+
+bool join_window::spill(held_id &held) {
+  if (!_spill_file.is_open()) {
+    _spill_file.open(_spill_file_name, std::ios::in | std::ios::out |
+                                           std::ios::binary | std::ios::trunc);
+    if (!_spill_file.is_open()) {
+      VW::io::logger::log_error("Failed to open the join window spill file "
+                                "[{}], event ids will be released early",
+                                _spill_file_name);
+      _spill_failed = true;
+      return false;
+    }
+  }
+
+  _spill_file.clear();
+  _spill_file.seekp(static_cast<std::streamoff>(_spill_size));
+  _spill_file.write(reinterpret_cast<const char *>(held.records.data()),
+                    static_cast<std::streamsize>(held.records.size()));
+  if (!_spill_file) {
+    VW::io::logger::log_error("Failed to write to the join window spill file "
+                              "[{}], event ids will be released early",
+                              _spill_file_name);
+    // the ids already in the file can still be read back
+    _spill_failed = true;
+    return false;
+  }
+
+  if (held.spilled.empty()) {
+    ++_ids_in_spill_file;
+  }
+  held.spilled.emplace_back(_spill_size, held.records.size());
+  _spill_size += held.records.size();
+  _memory -= held.records.size();
+  ++_spills;
+  // frees the memory, the id gets new records from scratch
+  std::vector<uint8_t>().swap(held.records);
+  return true;
+}
+
+bool join_window::read_back(const held_id &held,
+                            std::vector<uint8_t> &records) {
+  _spill_file.clear();
+  for (const auto &range : held.spilled) {
+    const size_t offset = records.size();
+    records.resize(offset + range.second);
+    _spill_file.seekg(static_cast<std::streamoff>(range.first));
+    if (!_spill_file.read(reinterpret_cast<char *>(records.data() + offset),
+                          static_cast<std::streamsize>(range.second))) {
+      return false;
+    }
+  }
+  return true;
+}
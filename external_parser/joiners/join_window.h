@@ -0,0 +1,121 @@
+#pragma once
+
+#include "event_processors/timestamp_helper.h"
+#include "generated/v2/FileFormat_generated.h"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+Join state carried across the messages of a binary log, so that interactions
+and outcomes that were split between messages, or read out of order, still
+get joined.
+
+The events of an event id are held until max_age after its interaction, or
+after its first outcome while the interaction wasn't read, going by the latest
+event time read so far. The interaction is released along with all of the
+outcomes held for it. Outcomes that are older than that when read and don't
+match a held id are late, held outcomes whose interaction never came are
+orphaned. Both are dropped and counted.
+
+Events are copied out of their message. When the held events go over the
+memory cap, the ids released last are written to the spill file and read back
+when released. Without a spill file the ids released first are released
+early instead.
+*/
+class join_window {
+public:
+  // an event read from a message
+  struct event {
+    const uint8_t *data;
+    uint32_t size;
+    const v2::TimeStamp *timestamp;
+    TimePoint time;
+    bool is_interaction;
+  };
+
+  // a held event, valid until the next release
+  struct held_event {
+    const uint8_t *data;
+    uint32_t size;
+    const v2::TimeStamp *timestamp;
+  };
+
+  join_window() = default;
+  join_window(const join_window &) = delete;
+  join_window &operator=(const join_window &) = delete;
+
+  // max_age of 0 disables the window, memory_cap of 0 doesn't cap it
+  void configure(std::chrono::seconds max_age, size_t memory_cap,
+                 const std::string &spill_file);
+  bool enabled() const { return _max_age.count() > 0; }
+
+  // holds the events of id read in a message
+  void add(const char *id, size_t id_size, const std::vector<event> &events);
+  // moves the latest event time forward
+  void advance(TimePoint time);
+
+  // releases the ids that are due, or all of them at the end of the input,
+  // in the order they are due
+  void release(bool all);
+  size_t released() const { return _released.size(); }
+  // events of a released id, interactions first
+  void released_events(size_t index, std::vector<held_event> &events) const;
+
+  size_t held() const { return _held.size(); }
+  size_t memory() const { return _memory; }
+
+  size_t late_outcomes() const { return _late_outcomes; }
+  size_t orphaned_outcomes() const { return _orphaned_outcomes; }
+  size_t spills() const { return _spills; }
+  size_t early_releases() const { return _early_releases; }
+
+private:
+  struct held_id;
+  using deadline_map = std::multimap<TimePoint, held_id *>;
+
+  struct held_id {
+    const std::string *id = nullptr;
+    // records of the events in memory, see append_record
+    std::vector<uint8_t> records;
+    // [offset, size[ of the records written to the spill file
+    std::vector<std::pair<uint64_t, uint64_t>> spilled;
+    bool has_interaction = false;
+    size_t outcomes = 0;
+    deadline_map::iterator deadline;
+  };
+
+  void append_record(held_id &held, const event &e);
+  void set_deadline(held_id &held, TimePoint deadline);
+  void release_id(held_id &held, bool early);
+  bool spill(held_id &held);
+  bool read_back(const held_id &held, std::vector<uint8_t> &records);
+
+  std::chrono::seconds _max_age{0};
+  size_t _memory_cap = 0;
+  std::string _spill_file_name;
+  std::fstream _spill_file;
+  bool _spill_failed = false;
+  uint64_t _spill_size = 0;
+
+  TimePoint _latest_time;
+  std::unordered_map<std::string, held_id> _held;
+  deadline_map _deadlines;
+  // bytes of the records in memory and of their ids
+  size_t _memory = 0;
+  // ids with records in the spill file
+  size_t _ids_in_spill_file = 0;
+
+  // records of the released ids, in memory
+  std::vector<std::vector<uint8_t>> _released;
+
+  size_t _late_outcomes = 0;
+  size_t _orphaned_outcomes = 0;
+  size_t _spills = 0;
+  size_t _early_releases = 0;
+};
@@ -54,9 +54,9 @@ bool multistep_example_joiner::process_event(const v2::JoinedEvent &joined_event
       auto outcome = flatbuffers::GetRoot<v2::OutcomeEvent>(event->payload()->data());
       const char* id =  outcome->index_type() == v2::IndexValue_literal ? outcome->index_as_literal()->c_str() : nullptr;
       if (id == nullptr) {
-        _episodic_outcomes.push_back(process_outcome(enqueued_time_utc, meta, *outcome));
+        process_outcome(enqueued_time_utc, meta, *outcome, _episodic_outcomes);
       } else {
-        _outcomes[std::string(id)].push_back(process_outcome(enqueued_time_utc, meta, *outcome));
+        process_outcome(enqueued_time_utc, meta, *outcome, _outcomes[std::string(id)]);
       }
       break;
     }
@@ -204,22 +204,24 @@ bool multistep_example_joiner::populate_order() {
   return true;
 }
 
-reward::outcome_event multistep_example_joiner::process_outcome(
-  const TimePoint&, const v2::Metadata &metadata, const v2::OutcomeEvent& event) {
-  reward::outcome_event o_event;
-  o_event.metadata = {metadata.app_id() ? metadata.app_id()->str() : "",
-                      metadata.payload_type(),
-                      metadata.pass_probability(),
-                      metadata.encoding(),
-                      metadata.id()->str()};
-
-  if (event.value_type() == v2::OutcomeValue_literal) {
-    o_event.s_value = event.value_as_literal()->c_str();
-  } else if (event.value_type() == v2::OutcomeValue_numeric) {
+void multistep_example_joiner::process_outcome(
+  const TimePoint&, const v2::Metadata &metadata, const v2::OutcomeEvent& event,
+  std::vector<reward::outcome_event>& outcomes) {
+  outcomes.emplace_back();
+  reward::outcome_event& o_event = outcomes.back();
+  if (event.value_type() == v2::OutcomeValue_numeric) {
     o_event.value = event.value_as_numeric()->value();
   }
   o_event.action_taken = event.action_taken();
-  return o_event;
+
+  // outcomes of the same episode coalesced by the client, each one counts on its own
+  if (event.numeric_values() != nullptr) {
+    outcomes.reserve(outcomes.size() + event.numeric_values()->size());
+    for (const float value : *event.numeric_values()) {
+      outcomes.push_back(outcomes.back());
+      outcomes.back().value = value;
+    }
+  }
 }
 
 joined_event::multistep_joined_event multistep_example_joiner::process_interaction(
@@ -271,7 +273,7 @@ bool multistep_example_joiner::process_joined(v_array<example *> &examples) {
     }
   }
   const auto& id = _order.front();
-  const float reward = _rewards.front();
+  const float reward = _rewards[_next_reward];
   const auto& interactions = _interactions[id];
   if (interactions.size() != 1) {
     return false;
@@ -279,7 +281,7 @@ bool multistep_example_joiner::process_joined(v_array<example *> &examples) {
   const auto& interaction = interactions[0];
   auto joined = process_interaction(interaction, examples);
 
-  const auto outcomes = _outcomes[id];
+  const auto &outcomes = _outcomes[id];
   
   for (const auto& o: outcomes) {
     joined.outcome_events.push_back(o);
@@ -291,7 +293,7 @@ bool multistep_example_joiner::process_joined(v_array<example *> &examples) {
   bool clear_examples = false;
   auto guard = VW::scope_exit([&] {
     _order.pop_front();
-    _rewards.pop_front();
+    ++_next_reward;
     if (clear_examples) {
       VW::return_multiple_example(*_vw, examples);
       examples.push_back(&VW::get_unused_example(_vw));
@@ -324,18 +326,22 @@ void multistep_example_joiner::on_new_batch() {
   _outcomes.clear();
   _episodic_outcomes.clear();
   _rewards.clear();
+  _next_reward = 0;
   _sorted = false;
 }
 
 void multistep_example_joiner::populate_episodic_rewards() {
+  _rewards.clear();
+  _rewards.reserve(_order.size());
+  reward::outcome_values outcomes;
   for (const std::string& id: _order) {
-    std::vector<reward::outcome_event> outcomes = _episodic_outcomes;
-    const auto outcomes_per_step = _outcomes[id];
-    outcomes.insert(outcomes.end(), std::make_move_iterator(outcomes_per_step.begin()), 
-                    std::make_move_iterator(outcomes_per_step.end()));
+    outcomes.clear();
+    outcomes.append(_episodic_outcomes);
+    outcomes.append(_outcomes[id]);
     _rewards.push_back(_reward_calculation.value()(outcomes, _loop_info.default_reward));
   }
   _multistep_reward_calculation.value()(_rewards);
+  _next_reward = 0;
 }
 
 void multistep_example_joiner::on_batch_read() {
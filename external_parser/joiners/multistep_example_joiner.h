@@ -15,6 +15,7 @@
 #include <queue>
 #include <deque>
 #include <unordered_map>
+#include <vector>
 // VW headers
 // vw.h has to come before json_utils.h
 // clang-format off
@@ -36,20 +37,23 @@ std::map<const char *, multistep_reward_funtion_type> const multistep_reward_fun
   { "suffix_mean", multistep_reward_funtion_type::SuffixMean },
 }};
 
-using MultistepRewardFunctionType = void (*)(std::deque<float> &);
+using MultistepRewardFunctionType = void (*)(std::vector<float> &);
 
-inline void multistep_reward_identity(std::deque<float> &) {}
+inline void multistep_reward_identity(std::vector<float> &) {}
 
-inline void multistep_reward_suffix_sum(std::deque<float> &rewards) {
-  for (size_t i = 1; i < rewards.size(); ++i) {
-    rewards[rewards.size() - 1 - i] += rewards[rewards.size() - i];
+inline void multistep_reward_suffix_sum(std::vector<float> &rewards) {
+  float suffix_sum = 0.f;
+  for (auto it = rewards.rbegin(); it != rewards.rend(); ++it) {
+    suffix_sum += *it;
+    *it = suffix_sum;
   }
 }
 
-inline void multistep_reward_suffix_mean(std::deque<float> &rewards) {
+inline void multistep_reward_suffix_mean(std::vector<float> &rewards) {
   multistep_reward_suffix_sum(rewards);
-  for (size_t i = 0; i < rewards.size(); ++i) {
-    rewards[i] /= rewards.size() - i;
+  const size_t size = rewards.size();
+  for (size_t i = 0; i < size; ++i) {
+    rewards[i] /= static_cast<float>(size - i);
   }
 }
 
@@ -88,8 +92,9 @@ private:
 
 private:
   bool populate_order();
-  reward::outcome_event
-  process_outcome(const TimePoint& timestamp, const v2::Metadata &metadata, const v2::OutcomeEvent& event);
+  // appends the outcomes of event, more than one if the client coalesced them
+  void process_outcome(const TimePoint& timestamp, const v2::Metadata &metadata, const v2::OutcomeEvent& event,
+                       std::vector<reward::outcome_event>& outcomes);
   joined_event::multistep_joined_event
   process_interaction(const Parsed<v2::MultiStepEvent> &event_meta,
                       v_array<example *> &examples);
@@ -112,7 +117,8 @@ private:
   std::vector<reward::outcome_event> _episodic_outcomes;
 
   std::deque<std::string> _order;
-  std::deque<float> _rewards;
+  std::vector<float> _rewards;
+  size_t _next_reward = 0;
 
   bool _sorted = false;
 
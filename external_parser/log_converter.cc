@@ -4,30 +4,80 @@
 #include <rapidjson/writer.h>
 #include <rapidjson/ostreamwrapper.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace log_converter {
 namespace rj = rapidjson;
+namespace {
+char *write_digits(char *out, uint32_t value, int digits) {
+  for (int i = digits - 1; i >= 0; --i) {
+    out[i] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  return out + digits;
+}
+} // namespace
+
+size_t format_timestamp(const TimePoint &tp, char (&out)[TIMESTAMP_SIZE]) {
+  // same output as date::format("%FT%TZ") at microsecond precision, without
+  // going through a stream for each event
+  const auto us = date::floor<std::chrono::microseconds>(tp);
+  const auto day = date::floor<date::days>(us);
+  const date::year_month_day ymd(day);
+  const int year = static_cast<int>(ymd.year());
+  if (year < 0 || year > 9999) {
+    const auto formatted = date::format("%FT%TZ", us);
+    const size_t size = std::min(formatted.size(), TIMESTAMP_SIZE - 1);
+    std::memcpy(out, formatted.data(), size);
+    out[size] = '\0';
+    return size;
+  }
+
+  auto time_of_day = static_cast<uint64_t>((us - day).count());
+  const auto micros = static_cast<uint32_t>(time_of_day % 1000000);
+  time_of_day /= 1000000;
+
+  char *end = out;
+  end = write_digits(end, static_cast<uint32_t>(year), 4);
+  *end++ = '-';
+  end = write_digits(end, static_cast<unsigned>(ymd.month()), 2);
+  *end++ = '-';
+  end = write_digits(end, static_cast<unsigned>(ymd.day()), 2);
+  *end++ = 'T';
+  end = write_digits(end, static_cast<uint32_t>(time_of_day / 3600), 2);
+  *end++ = ':';
+  end = write_digits(end, static_cast<uint32_t>(time_of_day / 60 % 60), 2);
+  *end++ = ':';
+  end = write_digits(end, static_cast<uint32_t>(time_of_day % 60), 2);
+  *end++ = '.';
+  end = write_digits(end, micros, 6);
+  *end++ = 'Z';
+  *end = '\0';
+  return static_cast<size_t>(end - out);
+}
 
-void build_json(std::ofstream &outfile,
+void build_json(rj::StringBuffer &out_buffer,
                 joined_event::joined_event &je) {
   switch (je.interaction_metadata.payload_type) {
   case v2::PayloadType_CB:
-    build_cb_json(outfile, je);
+    build_cb_json(out_buffer, je);
     break;
   case v2::PayloadType_CCB:
-    build_ccb_json(outfile, je);
+    build_ccb_json(out_buffer, je);
     break;
   case v2::PayloadType_CA:
-    build_ca_json(outfile, je);
+    build_ca_json(out_buffer, je);
     break;
   case v2::PayloadType_Slates:
-    build_slates_json(outfile, je);
+    build_slates_json(out_buffer, je);
     break;
   default:
     break;
   }
 }
 
-void build_cb_json(std::ofstream &outfile,
+void build_cb_json(rj::StringBuffer &out_buffer,
                    joined_event::joined_event &je) {
   auto cb_je = reinterpret_cast<const joined_event::cb_joined_event *>(
       je.get_hold_of_typed_data());
@@ -36,8 +86,9 @@ void build_cb_json(std::ofstream &outfile,
   const auto &interaction_data = cb_je->interaction_data;
   const auto &probabilities = interaction_data.probabilities;
   const auto &actions = interaction_data.actions;
+  // a failed event leaves no partial line behind
+  const size_t line_start = out_buffer.GetSize();
   try {
-    rj::StringBuffer out_buffer;
     rj::Writer<rj::StringBuffer> writer(out_buffer);
 
     writer.StartObject();
@@ -74,7 +125,8 @@ void build_cb_json(std::ofstream &outfile,
         writer.Double(o.value);
       }
       writer.Key("EventId", strlen("EventId"), true);
-      writer.String(o.metadata.event_id.c_str(), o.metadata.event_id.length(), true);
+      writer.String(je.interaction_metadata.event_id.c_str(),
+                    je.interaction_metadata.event_id.length(), true);
 
       writer.Key("ActionTaken", strlen("ActionTaken"), true);
       writer.Bool(o.action_taken);
@@ -84,12 +136,12 @@ void build_cb_json(std::ofstream &outfile,
 
     writer.EndArray();
 
-    std::string ts_str = date::format(
-        "%FT%TZ",
-        date::floor<std::chrono::microseconds>(je.joined_event_timestamp));
+    char ts_str[TIMESTAMP_SIZE];
+    const size_t ts_size =
+        format_timestamp(je.joined_event_timestamp, ts_str);
 
     writer.Key("Timestamp", strlen("Timestamp"), true);
-    writer.String(ts_str.c_str(), ts_str.length(), true);
+    writer.String(ts_str, ts_size, true);
 
     writer.Key("Version", strlen("Version"), true);
     writer.String("1", strlen("1"), true);
@@ -134,15 +186,16 @@ void build_cb_json(std::ofstream &outfile,
 
     writer.EndObject();
 
-    outfile << out_buffer.GetString() << std::endl;
+    out_buffer.Put('\n');
   } catch (const std::exception &e) {
+    out_buffer.Pop(out_buffer.GetSize() - line_start);
     VW::io::logger::log_error(
         "convert event: [{}] from binary to json format failed: [{}].",
         interaction_data.eventId, e.what());
   }
 }
 
-void build_ccb_json(std::ofstream &outfile,
+void build_ccb_json(rj::StringBuffer &out_buffer,
                     joined_event::joined_event &je) {
   const std::string &event_id = je.interaction_metadata.event_id;
 
@@ -156,18 +209,18 @@ void build_ccb_json(std::ofstream &outfile,
 
   bool skip_learn = !je.is_joined_event_learnable();
 
+  const size_t line_start = out_buffer.GetSize();
   try {
-    rj::StringBuffer out_buffer;
     rj::Writer<rj::StringBuffer> writer(out_buffer);
 
     writer.StartObject();
 
-    std::string ts_str = date::format(
-      "%FT%TZ",
-      date::floor<std::chrono::microseconds>(je.joined_event_timestamp));
+    char ts_str[TIMESTAMP_SIZE];
+    const size_t ts_size =
+        format_timestamp(je.joined_event_timestamp, ts_str);
 
     writer.Key("Timestamp");
-    writer.String(ts_str.c_str(), ts_str.length(), true);
+    writer.String(ts_str, ts_size, true);
 
     if (skip_learn) {
       writer.Key("_skipLearn");
@@ -225,16 +278,15 @@ void build_ccb_json(std::ofstream &outfile,
           }
 
           writer.Key("EventId");
-          writer.String(o.metadata.event_id.c_str(),
-            o.metadata.event_id.length(), true);
+          writer.String(event_id.c_str(), event_id.length(), true);
 
           writer.Key("Index");
 
           if (o.index_type == v2::IndexValue_literal) {
             writer.String(o.s_index.c_str(), o.s_index.length(), true);
           } else {
-            writer.String(std::to_string(o.index).c_str(),
-              std::to_string(o.index).length(), true);
+            const auto index = std::to_string(o.index);
+            writer.String(index.c_str(), index.length(), true);
           }
 
           writer.Key("ActionTaken");
@@ -273,23 +325,24 @@ void build_ccb_json(std::ofstream &outfile,
     }
 
     writer.EndObject();
-    outfile << out_buffer.GetString() << std::endl;
+    out_buffer.Put('\n');
 
   } catch (const std::exception &e) {
+    out_buffer.Pop(out_buffer.GetSize() - line_start);
     VW::io::logger::log_error(
       "convert event: [{}] from binary to json format failed: [{}].",
       event_id, e.what());
   }
 }
 
-void build_ca_json(std::ofstream &outfile, joined_event::joined_event &je) {
+void build_ca_json(rj::StringBuffer &out_buffer, joined_event::joined_event &je) {
   auto ca_je = reinterpret_cast<const joined_event::ca_joined_event *>(
       je.get_hold_of_typed_data());
   float cost = -1.f * ca_je->reward;
 
   const auto &interaction_data = ca_je->interaction_data;
+  const size_t line_start = out_buffer.GetSize();
   try {
-    rj::StringBuffer out_buffer;
     rj::Writer<rj::StringBuffer> writer(out_buffer);
 
     writer.StartObject();
@@ -304,12 +357,12 @@ void build_ca_json(std::ofstream &outfile, joined_event::joined_event &je) {
     writer.Double(interaction_data.action);
     writer.EndObject();
 
-    std::string ts_str = date::format(
-        "%FT%TZ",
-        date::floor<std::chrono::microseconds>(je.joined_event_timestamp));
+    char ts_str[TIMESTAMP_SIZE];
+    const size_t ts_size =
+        format_timestamp(je.joined_event_timestamp, ts_str);
 
     writer.Key("Timestamp", strlen("Timestamp"), true);
-    writer.String(ts_str.c_str(), ts_str.length(), true);
+    writer.String(ts_str, ts_size, true);
 
     writer.Key("Version", strlen("Version"), true);
     writer.String("1", strlen("1"), true);
@@ -341,15 +394,16 @@ void build_ca_json(std::ofstream &outfile, joined_event::joined_event &je) {
 
     writer.EndObject();
 
-    outfile << out_buffer.GetString() << std::endl;
+    out_buffer.Put('\n');
   } catch (const std::exception &e) {
+    out_buffer.Pop(out_buffer.GetSize() - line_start);
     VW::io::logger::log_error(
         "convert event: [{}] from binary to json format failed: [{}].",
         interaction_data.eventId, e.what());
   }
 }
 
-void build_slates_json(std::ofstream &outfile, joined_event::joined_event &je) {
+void build_slates_json(rj::StringBuffer &out_buffer, joined_event::joined_event &je) {
   const std::string &event_id = je.interaction_metadata.event_id;
 
   auto slates_je = reinterpret_cast<const joined_event::slates_joined_event *>(
@@ -358,18 +412,18 @@ void build_slates_json(std::ofstream &outfile, joined_event::joined_event &je) {
   float cost = -1.f * slates_je->reward;
   bool skip_learn = !je.is_joined_event_learnable();
 
+  const size_t line_start = out_buffer.GetSize();
   try {
-    rj::StringBuffer out_buffer;
     rj::Writer<rj::StringBuffer> writer(out_buffer);
 
     writer.StartObject();
 
-    std::string ts_str = date::format(
-      "%FT%TZ",
-      date::floor<std::chrono::microseconds>(je.joined_event_timestamp));
+    char ts_str[TIMESTAMP_SIZE];
+    const size_t ts_size =
+        format_timestamp(je.joined_event_timestamp, ts_str);
 
     writer.Key("Timestamp");
-    writer.String(ts_str.c_str(), ts_str.length(), true);
+    writer.String(ts_str, ts_size, true);
 
     writer.Key("Version");
     writer.String("1");
@@ -392,7 +446,7 @@ void build_slates_json(std::ofstream &outfile, joined_event::joined_event &je) {
         writer.Double(o.value);
       }
       writer.Key("EventId", strlen("EventId"), true);
-      writer.String(o.metadata.event_id.c_str(), o.metadata.event_id.length(), true);
+      writer.String(event_id.c_str(), event_id.length(), true);
 
       writer.Key("ActionTaken", strlen("ActionTaken"), true);
       writer.Bool(o.action_taken);
@@ -449,9 +503,10 @@ void build_slates_json(std::ofstream &outfile, joined_event::joined_event &je) {
     }
 
     writer.EndObject();
-    outfile << out_buffer.GetString() << std::endl;
+    out_buffer.Put('\n');
 
   } catch (const std::exception &e) {
+    out_buffer.Pop(out_buffer.GetSize() - line_start);
     VW::io::logger::log_error(
       "convert event: [{}] from binary to json format failed: [{}].",
       event_id, e.what());
@@ -13,12 +13,18 @@
 namespace v2 = reinforcement_learning::messages::flatbuff::v2;
 
 namespace log_converter {
-void build_json(std::ofstream &outfile,
+// "2021-04-13T15:08:46.000000Z" and its terminating null
+constexpr size_t TIMESTAMP_SIZE = 32;
+size_t format_timestamp(const TimePoint &tp, char (&out)[TIMESTAMP_SIZE]);
+
+// each append a DSJSON line to out_buffer, nothing if the event fails to
+// convert
+void build_json(rapidjson::StringBuffer &out_buffer,
                 joined_event::joined_event &je);
-void build_cb_json(std::ofstream &outfile,
+void build_cb_json(rapidjson::StringBuffer &out_buffer,
                    joined_event::joined_event &je);
-void build_ccb_json(std::ofstream &outfile,
+void build_ccb_json(rapidjson::StringBuffer &out_buffer,
                    joined_event::joined_event &je);
-void build_ca_json(std::ofstream &outfile, joined_event::joined_event &je);
-void build_slates_json(std::ofstream &outfile, joined_event::joined_event &je);
+void build_ca_json(rapidjson::StringBuffer &out_buffer, joined_event::joined_event &je);
+void build_slates_json(rapidjson::StringBuffer &out_buffer, joined_event::joined_event &je);
 } // namespace log_converter
@@ -1,11 +1,58 @@
 #include "lru_dedup_cache.h"
 
+#include <vector>
+
 void lru_dedup_cache::add(uint64_t dedup_id, example *ex) {
   dedup_examples.emplace(dedup_id, ex);
   lru.push_front(dedup_id);
   lru_pos.emplace(dedup_id, lru.begin());
 }
 
+void lru_dedup_cache::add_text(uint64_t dedup_id, const char *text,
+                               size_t size) {
+  dedup_texts.emplace(dedup_id, std::string(text, size));
+  lru.push_front(dedup_id);
+  lru_pos.emplace(dedup_id, lru.begin());
+}
+
+bool lru_dedup_cache::expand_texts(std::string &context) const {
+  static const char aid_prefix[] = "{\"__aid\":";
+  static const size_t aid_prefix_length = sizeof(aid_prefix) - 1;
+
+  auto reference = context.find(aid_prefix);
+  if (reference == std::string::npos) {
+    return true;
+  }
+
+  std::string expanded;
+  expanded.reserve(context.size() * 2);
+  size_t copied = 0;
+  for (; reference != std::string::npos;
+       reference = context.find(aid_prefix, reference + 1)) {
+    size_t end = reference + aid_prefix_length;
+    uint64_t dedup_id = 0;
+    while (end < context.size() && context[end] >= '0' && context[end] <= '9') {
+      dedup_id = dedup_id * 10 + (context[end] - '0');
+      ++end;
+    }
+    if (end >= context.size() || context[end] != '}' || !is_text(dedup_id)) {
+      // actions are left for the json parser
+      continue;
+    }
+
+    auto text = dedup_texts.find(dedup_id);
+    if (text == dedup_texts.end()) {
+      return false;
+    }
+    expanded.append(context, copied, reference - copied);
+    expanded.append(text->second);
+    copied = end + 1;
+  }
+  expanded.append(context, copied, std::string::npos);
+  context.swap(expanded);
+  return true;
+}
+
 void lru_dedup_cache::update(uint64_t dedup_id) {
   // existing move to front
   auto position = lru_pos[dedup_id];
@@ -17,19 +64,20 @@ void lru_dedup_cache::update(uint64_t dedup_id) {
 void lru_dedup_cache::clear_after(uint64_t first_id,
                                   release_example_f release_example,
                                   void *context) {
-  // erase the rest
+  // erase the rest, except the objects clients hold across payloads
   auto iter = lru_pos[first_id];
   // point to the element right after
   iter++;
-  auto first_pos = iter;
   while (iter != lru.end()) {
     auto dedup_id = *iter;
+    if (holders.find(dedup_id) != holders.end()) {
+      iter++;
+      continue;
+    }
     lru_pos.erase(dedup_id);
-    release_example(context, dedup_examples[dedup_id]);
-    dedup_examples.erase(dedup_id);
-    iter++;
+    erase_item(dedup_id, release_example, context);
+    iter = lru.erase(iter);
   }
-  lru.erase(first_pos, lru.end());
 }
 
 void lru_dedup_cache::clear(release_example_f release_example, void *context) {
@@ -37,10 +85,77 @@ void lru_dedup_cache::clear(release_example_f release_example, void *context) {
     release_example(context, dedup_item.second);
   }
   dedup_examples.clear();
+  dedup_texts.clear();
   lru_pos.clear();
   lru.clear();
+  client_objects.clear();
+  holders.clear();
+}
+
+void lru_dedup_cache::hold(uint64_t client_id, uint64_t dedup_id) {
+  if (client_objects[client_id].insert(dedup_id).second) {
+    ++holders[dedup_id];
+  }
+}
+
+void lru_dedup_cache::release(uint64_t client_id, uint64_t dedup_id,
+                              release_example_f release_example,
+                              void *context) {
+  auto objects = client_objects.find(client_id);
+  if (objects == client_objects.end() || objects->second.erase(dedup_id) == 0) {
+    return;
+  }
+  auto count = holders.find(dedup_id);
+  if (--count->second == 0) {
+    holders.erase(count);
+    remove(dedup_id, release_example, context);
+  }
+}
+
+void lru_dedup_cache::release_others(uint64_t client_id,
+                                     const std::unordered_set<uint64_t> &kept,
+                                     release_example_f release_example,
+                                     void *context) {
+  auto objects = client_objects.find(client_id);
+  if (objects == client_objects.end()) {
+    return;
+  }
+  std::vector<uint64_t> released;
+  for (auto dedup_id : objects->second) {
+    if (kept.find(dedup_id) == kept.end()) {
+      released.push_back(dedup_id);
+    }
+  }
+  for (auto dedup_id : released) {
+    release(client_id, dedup_id, release_example, context);
+  }
+}
+
+void lru_dedup_cache::remove(uint64_t dedup_id,
+                             release_example_f release_example,
+                             void *context) {
+  auto position = lru_pos.find(dedup_id);
+  if (position == lru_pos.end()) {
+    return;
+  }
+  lru.erase(position->second);
+  lru_pos.erase(position);
+  erase_item(dedup_id, release_example, context);
 }
 
 bool lru_dedup_cache::exists(uint64_t dedup_id) {
-  return dedup_examples.find(dedup_id) != dedup_examples.end();
+  return dedup_examples.find(dedup_id) != dedup_examples.end() ||
+         dedup_texts.find(dedup_id) != dedup_texts.end();
+}
+
+void lru_dedup_cache::erase_item(uint64_t dedup_id,
+                                 release_example_f release_example,
+                                 void *context) {
+  auto text = dedup_texts.find(dedup_id);
+  if (text != dedup_texts.end()) {
+    dedup_texts.erase(text);
+    return;
+  }
+  release_example(context, dedup_examples[dedup_id]);
+  dedup_examples.erase(dedup_id);
 }
\ No newline at end of file
@@ -3,7 +3,9 @@
 #include "example.h"
 
 #include <list>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 /*
 LRU dedup cache
@@ -14,27 +16,67 @@ assume that anything after that can be evicted as it was not in the new dedup
 payload. If two dedup payloads are identical then nothing will be evicted.
 
 Assumption: dedup payloads are dictionaries and so they have unique items
+
+Incremental dedup payloads only carry the objects that are new to the reader,
+the client tells which ones to drop through explicit eviction records. Several
+clients share a stream, so these objects are held per client id: an eviction
+or a full payload only releases the objects of its client, and an object is
+dropped once no client holds it. clear_after leaves held objects in place.
+
+Slots and shared namespaces can be deduped as well. Their ids carry the target
+in the top byte and they are kept as text, expand_texts puts them back into
+the context before it is parsed. Action references are resolved by VW.
 */
 struct lru_dedup_cache {
   // from dictionary id to example object
   // right now holding one dedup dictionary at a time, could be exented to a
   // map of maps holding more than one dedup dictionaries at a time
   std::unordered_map<uint64_t, example *> dedup_examples;
+  // from dictionary id to the JSON of a deduped slot or shared namespace
+  std::unordered_map<uint64_t, std::string> dedup_texts;
   std::list<uint64_t> lru;
   using list_iterator = std::list<uint64_t>::iterator;
   std::unordered_map<uint64_t, list_iterator> lru_pos;
+  // from client id to the objects it holds, and from object to its number of
+  // holders
+  std::unordered_map<uint64_t, std::unordered_set<uint64_t>> client_objects;
+  std::unordered_map<uint64_t, size_t> holders;
 
   using release_example_f = void (*)(void *, example *);
   static void noop_release_example_f(void *, example *) { return; }
 
 public:
+  // true for the ids of objects that are kept as text
+  static bool is_text(uint64_t dedup_id) { return (dedup_id >> 56) != 0; }
+
   void add(uint64_t dedup_id, example *ex);
+  void add_text(uint64_t dedup_id, const char *text, size_t size);
+  // replaces the {"__aid":<id>} references to text objects in context, returns
+  // false if one of them is not in the cache
+  bool expand_texts(std::string &context) const;
   void update(uint64_t dedup_id);
   void clear_after(uint64_t dedup_id,
                    release_example_f release_example =
                        lru_dedup_cache::noop_release_example_f,
                    void *context = nullptr);
   bool exists(uint64_t dedup_id);
+  void remove(uint64_t dedup_id,
+              release_example_f release_example =
+                  lru_dedup_cache::noop_release_example_f,
+              void *context = nullptr);
+  // the object must be in the cache, holding it twice is a no-op
+  void hold(uint64_t client_id, uint64_t dedup_id);
+  // removes the object once its last holder releases it
+  void release(uint64_t client_id, uint64_t dedup_id,
+               release_example_f release_example =
+                   lru_dedup_cache::noop_release_example_f,
+               void *context = nullptr);
+  // releases the objects of client_id that are not in kept, for full payloads
+  void release_others(uint64_t client_id,
+                      const std::unordered_set<uint64_t> &kept,
+                      release_example_f release_example =
+                          lru_dedup_cache::noop_release_example_f,
+                      void *context = nullptr);
   void clear(release_example_f release_example =
                  lru_dedup_cache::noop_release_example_f,
              void *context = nullptr);
@@ -45,4 +87,8 @@ public:
   lru_dedup_cache(lru_dedup_cache &&) = delete;
   lru_dedup_cache &operator=(const lru_dedup_cache &) = delete;
   lru_dedup_cache &operator=(lru_dedup_cache &&) = delete;
+
+private:
+  void erase_item(uint64_t dedup_id, release_example_f release_example,
+                  void *context);
 };
\ No newline at end of file
@@ -0,0 +1,202 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "mapped_file_reader.h"
+#include "io/logger.h"
+#include "parse_example_binary.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VW {
+namespace external {
+namespace {
+uint32_t read_uint32(const char *data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+} // namespace
+
+mapped_file_reader::~mapped_file_reader() { close(); }
+
+void mapped_file_reader::close() {
+#ifdef _WIN32
+  if (_data != nullptr) {
+    UnmapViewOfFile(_data);
+  }
+  if (_mapping != nullptr) {
+    CloseHandle(_mapping);
+  }
+  if (_file != nullptr) {
+    CloseHandle(_file);
+  }
+  _mapping = nullptr;
+  _file = nullptr;
+#else
+  if (_data != nullptr) {
+    munmap(const_cast<char *>(_data), static_cast<size_t>(_size));
+  }
+#endif
+  _data = nullptr;
+  _size = _offset = _end = 0;
+}
+
+bool mapped_file_reader::open(const std::string &file_name) {
+  close();
+#ifdef _WIN32
+  // files such as the dedup cache are appended to while they are mapped
+  HANDLE file = CreateFileA(file_name.c_str(), GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    VW::io::logger::log_critical("Failed to open [{}] for mapping", file_name);
+    return false;
+  }
+  _file = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    VW::io::logger::log_critical("Failed to get the size of [{}]", file_name);
+    return false;
+  }
+  _size = static_cast<uint64_t>(size.QuadPart);
+  _end = _size;
+  if (_size == 0) {
+    return true;
+  }
+
+  _mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (_mapping == nullptr) {
+    VW::io::logger::log_critical("Failed to map [{}]", file_name);
+    return false;
+  }
+  _data = static_cast<const char *>(
+      MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (_data == nullptr) {
+    VW::io::logger::log_critical("Failed to map [{}]", file_name);
+    return false;
+  }
+#else
+  int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    VW::io::logger::log_critical("Failed to open [{}] for mapping: [{}]",
+                                 file_name, std::strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    VW::io::logger::log_critical("Failed to get the size of [{}]: [{}]",
+                                 file_name, std::strerror(errno));
+    ::close(fd);
+    return false;
+  }
+  _size = static_cast<uint64_t>(st.st_size);
+  _end = _size;
+  if (_size == 0) {
+    ::close(fd);
+    return true;
+  }
+
+  void *data =
+      mmap(nullptr, static_cast<size_t>(_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file open
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    VW::io::logger::log_critical("Failed to map [{}]: [{}]", file_name,
+                                 std::strerror(errno));
+    _size = _end = 0;
+    return false;
+  }
+  // the file is read front to back once
+  madvise(data, static_cast<size_t>(_size), MADV_SEQUENTIAL);
+  _data = static_cast<const char *>(data);
+#endif
+  return true;
+}
+
+bool mapped_file_reader::set_range(uint64_t begin, uint64_t end) {
+  if (begin > end || end > _size) {
+    VW::io::logger::log_critical("Range [{}, {}[ is outside of a file of [{}] "
+                                 "bytes",
+                                 begin, end, _size);
+    return false;
+  }
+  _offset = begin;
+  _end = end;
+  return true;
+}
+
+bool mapped_file_reader::next(unsigned int &payload_type,
+                              const char *&payload, uint32_t &payload_size) {
+  payload = nullptr;
+  payload_size = 0;
+
+  const uint64_t remaining = _end - _offset;
+  if (remaining == 0) {
+    // the file doesn't have to end with an EOF message
+    payload_type = MSG_TYPE_EOF;
+    return true;
+  }
+
+  if (remaining < 2 * sizeof(uint32_t)) {
+    payload_type = remaining >= sizeof(uint32_t) ? read_uint32(_data + _offset)
+                                                 : 0;
+    if (payload_type == MSG_TYPE_EOF) {
+      return true;
+    }
+    VW::io::logger::log_critical("Truncated message header at offset [{}], "
+                                 "input ends at [{}]",
+                                 _offset, _end);
+    return false;
+  }
+
+  payload_type = read_uint32(_data + _offset);
+  if (payload_type == MSG_TYPE_EOF) {
+    return true;
+  }
+
+  if (payload_type == MSG_TYPE_FILEMAGIC) {
+    // the version is inline, in place of the payload size
+    payload = _data + _offset + sizeof(uint32_t);
+    payload_size = sizeof(uint32_t);
+    _offset += 2 * sizeof(uint32_t);
+    return true;
+  }
+
+  payload_size = read_uint32(_data + _offset + sizeof(uint32_t));
+  _offset += 2 * sizeof(uint32_t);
+
+  // payloads are followed by size % 8 padding bytes, see read_padding
+  const uint64_t padded_size =
+      static_cast<uint64_t>(payload_size) + payload_size % 8;
+  if (_end - _offset < payload_size) {
+    VW::io::logger::log_critical(
+        "Message payload of size [{}] at offset [{}] goes past the end of the "
+        "input at [{}]",
+        payload_size, _offset, _end);
+    return false;
+  }
+
+  payload = _data + _offset;
+  _offset += std::min<uint64_t>(padded_size, _end - _offset);
+  return true;
+}
+} // namespace external
+} // namespace VW
@@ -0,0 +1,58 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace VW {
+namespace external {
+
+// Reads the messages of a binary joined log mapped in memory. Payloads are
+// handed out as pointers into the mapping, valid for the lifetime of the
+// reader, so nothing is copied and the OS reads ahead of the parser.
+class mapped_file_reader {
+public:
+  mapped_file_reader() = default;
+  ~mapped_file_reader();
+
+  mapped_file_reader(const mapped_file_reader &) = delete;
+  mapped_file_reader &operator=(const mapped_file_reader &) = delete;
+
+  // the file can be written to by others while it is mapped, bytes past the
+  // size it had when opened are not seen
+  bool open(const std::string &file_name);
+  // unmaps the file, payloads handed out are invalidated
+  void close();
+
+  // next message of the file, MSG_TYPE_EOF at the end of the file. The file
+  // magic's version is returned as its payload. Returns false if the message
+  // doesn't fit in the file
+  bool next(unsigned int &payload_type, const char *&payload,
+            uint32_t &payload_size);
+
+  // restricts reading to the messages in [begin, end[, begin being the
+  // offset of a message e.g. a checkpoint found through joined_log_index
+  bool set_range(uint64_t begin, uint64_t end);
+
+  // bytes of the file read so far
+  uint64_t offset() const { return _offset; }
+  uint64_t size() const { return _size; }
+  // the whole mapping, for files laid out as something else than messages
+  const char *data() const { return _data; }
+
+private:
+  const char *_data = nullptr;
+  uint64_t _size = 0;
+  uint64_t _offset = 0;
+  uint64_t _end = 0;
+#ifdef _WIN32
+  void *_file = nullptr;
+  void *_mapping = nullptr;
+#endif
+};
+} // namespace external
+} // namespace VW
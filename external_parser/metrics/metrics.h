@@ -10,5 +10,13 @@ struct joiner_metrics {
   TimePoint first_event_timestamp = TimePoint();
   std::string first_event_id = "";
   std::string last_event_id = "";
+  // see join_window
+  size_t number_of_late_outcomes = 0;
+  size_t number_of_orphaned_outcomes = 0;
+  size_t number_of_join_window_spills = 0;
+  size_t number_of_early_releases = 0;
+  // see persistent_dedup_cache
+  size_t number_of_dedup_cache_hits = 0;
+  size_t number_of_dedup_cache_stores = 0;
 };
 } // namespace metrics
@@ -79,8 +79,27 @@ bool read_padding(io_buf &input, uint32_t previous_payload_size,
 namespace VW {
 namespace external {
 binary_parser::binary_parser(std::unique_ptr<i_joiner> &&joiner)
+    : binary_parser(std::move(joiner), 0) {}
+
+binary_parser::binary_parser(std::unique_ptr<i_joiner> &&joiner,
+                             size_t threads, vw *parse_all)
     : _example_joiner(std::move(joiner)), _payload(nullptr), _payload_size(0),
-      _total_size_read(0) {}
+      _total_size_read(0), _batch_size_read(0) {
+  if (threads > 0) {
+    // enough read ahead to keep every worker busy while vw consumes examples
+    _pipeline =
+        VW::make_unique<payload_pipeline>(threads, 4 * threads, parse_all);
+  }
+}
+
+bool binary_parser::map_file(const std::string &file_name) {
+  auto mapped_file = VW::make_unique<mapped_file_reader>();
+  if (!mapped_file->open(file_name)) {
+    return false;
+  }
+  _mapped_file = std::move(mapped_file);
+  return true;
+}
 
 binary_parser::~binary_parser() {}
 
@@ -164,6 +183,14 @@ bool binary_parser::skip_over_unknown_payload(io_buf &input) {
 }
 
 bool binary_parser::read_checkpoint_msg(io_buf &input) {
+  if (!read_checkpoint_payload(input)) {
+    return false;
+  }
+  apply_checkpoint(_payload);
+  return true;
+}
+
+bool binary_parser::read_checkpoint_payload(io_buf &input) {
   _payload = nullptr;
   if (!read_payload_size(input, _payload_size)) {
     VW::io::logger::log_critical(
@@ -184,10 +211,13 @@ bool binary_parser::read_checkpoint_msg(io_buf &input) {
   }
 
   _total_size_read += _payload_size;
+  return true;
+}
 
+void binary_parser::apply_checkpoint(const char *payload) {
   // TODO: fb verification: what if verification fails, crash or default to
   // something sensible?
-  auto checkpoint_info = flatbuffers::GetRoot<v2::CheckpointInfo>(_payload);
+  auto checkpoint_info = flatbuffers::GetRoot<v2::CheckpointInfo>(payload);
   _example_joiner->set_reward_function(checkpoint_info->reward_function_type());
   _example_joiner->set_default_reward(checkpoint_info->default_reward());
   _example_joiner->set_learning_mode_config(
@@ -195,36 +225,17 @@ bool binary_parser::read_checkpoint_msg(io_buf &input) {
   _example_joiner->set_problem_type_config(
       checkpoint_info->problem_type_config());
   _example_joiner->set_use_client_time(checkpoint_info->use_client_time());
-
-  return true;
 }
 
 bool binary_parser::read_regular_msg(io_buf &input,
                                      v_array<example *> &examples,
                                      bool &ignore_msg) {
-  _payload = nullptr;
   ignore_msg = false;
 
-  if (!read_payload_size(input, _payload_size)) {
-    VW::io::logger::log_warn(
-        "Failed to read regular message payload size, after having read "
-        "[{}] bytes from the file",
-        _total_size_read);
-    return false;
-  }
-
-  _total_size_read += sizeof(_payload_size);
-
-  if (!read_payload(input, _payload, _payload_size)) {
-    VW::io::logger::log_warn("Failed to read regular message payload of "
-                             "size [{}], after having read "
-                             "[{}] bytes from the file",
-                             _payload_size, _total_size_read);
+  if (!read_regular_payload(input)) {
     return false;
   }
 
-  _total_size_read += _payload_size;
-
   if (!_example_joiner->joiner_ready()) {
     VW::io::logger::log_warn(
         "Read regular message before any checkpoint data "
@@ -245,15 +256,58 @@ bool binary_parser::read_regular_msg(io_buf &input,
         _payload_size, _total_size_read);
     return false;
   }
+
+  _batch_size_read = _total_size_read;
+  return process_joined_payload(*joined_payload, nullptr, nullptr, examples);
+}
+
+bool binary_parser::read_regular_payload(io_buf &input) {
+  _payload = nullptr;
+
+  if (!read_payload_size(input, _payload_size)) {
+    VW::io::logger::log_warn(
+        "Failed to read regular message payload size, after having read "
+        "[{}] bytes from the file",
+        _total_size_read);
+    return false;
+  }
+
+  _total_size_read += sizeof(_payload_size);
+
+  if (!read_payload(input, _payload, _payload_size)) {
+    VW::io::logger::log_warn("Failed to read regular message payload of "
+                             "size [{}], after having read "
+                             "[{}] bytes from the file",
+                             _payload_size, _total_size_read);
+    return false;
+  }
+
+  _total_size_read += _payload_size;
+  return true;
+}
+
+bool binary_parser::process_joined_payload(
+    const v2::JoinedPayload &joined_payload,
+    const std::vector<flatbuffers::DetachedBuffer> *decompressed_payloads,
+    const std::vector<std::vector<example *>> *parsed_examples,
+    v_array<example *> &examples) {
   _example_joiner->on_new_batch();
 
-  for (const auto *event : *joined_payload->events()) {
+  const auto &events = *joined_payload.events();
+  for (flatbuffers::uoffset_t i = 0; i < events.size(); ++i) {
     // process and group events in batch
-    if (!_example_joiner->process_event(*event)) {
+    const auto *decompressed_payload =
+        decompressed_payloads != nullptr ? &(*decompressed_payloads)[i]
+                                         : nullptr;
+    const auto *parsed = parsed_examples != nullptr && i < parsed_examples->size()
+                             ? &(*parsed_examples)[i]
+                             : nullptr;
+    if (!_example_joiner->process_event_with_payload(
+            *events.Get(i), decompressed_payload, parsed)) {
       VW::io::logger::log_error("Processing of an event from JoinedPayload "
                                 "failed after having read [{}] "
                                 "bytes from the file, skipping JoinedPayload",
-                                _total_size_read);
+                                _batch_size_read);
       return false;
     }
   }
@@ -272,7 +326,7 @@ bool binary_parser::process_next_in_batch(v_array<example *> &examples) {
           "Processing of a joined event from a JoinedEvent "
           "failed after having read [{}] "
           "bytes from the file, proceeding to next message",
-          _total_size_read);
+          _batch_size_read);
     }
     // else skip learn event, just process next event
   }
@@ -307,16 +361,236 @@ bool binary_parser::advance_to_next_payload_type(io_buf &input,
 }
 
 void binary_parser::persist_metrics(
-    std::vector<std::pair<std::string, size_t>> &) {
+    std::vector<std::pair<std::string, size_t>> &list_metrics) {
   _example_joiner->persist_metrics();
+
+  const auto metrics = _example_joiner->get_metrics();
+  if (metrics.number_of_late_outcomes > 0) {
+    list_metrics.emplace_back("late_outcomes", metrics.number_of_late_outcomes);
+  }
+  if (metrics.number_of_orphaned_outcomes > 0) {
+    list_metrics.emplace_back("orphaned_outcomes",
+                              metrics.number_of_orphaned_outcomes);
+  }
+  if (metrics.number_of_join_window_spills > 0) {
+    list_metrics.emplace_back("join_window_spills",
+                              metrics.number_of_join_window_spills);
+  }
+  if (metrics.number_of_early_releases > 0) {
+    list_metrics.emplace_back("join_window_early_releases",
+                              metrics.number_of_early_releases);
+  }
+  if (metrics.number_of_dedup_cache_hits > 0) {
+    list_metrics.emplace_back("dedup_cache_hits",
+                              metrics.number_of_dedup_cache_hits);
+  }
+  if (metrics.number_of_dedup_cache_stores > 0) {
+    list_metrics.emplace_back("dedup_cache_stores",
+                              metrics.number_of_dedup_cache_stores);
+  }
+}
+
+void binary_parser::fill_pipeline(io_buf &input) {
+  unsigned int payload_type;
+  while (!_input_done && !_pipeline->full()) {
+    if (!advance_to_next_payload_type(input, payload_type)) {
+      _input_done = true;
+      break;
+    }
+
+    switch (payload_type) {
+    case MSG_TYPE_FILEMAGIC: {
+      _input_done = !read_version(input);
+      break;
+    }
+    case MSG_TYPE_HEADER: {
+      _input_done = !read_header(input);
+      break;
+    }
+    case MSG_TYPE_CHECKPOINT:
+    case MSG_TYPE_REGULAR: {
+      // checkpoints go through the pipeline too so that they apply to the
+      // messages that follow them in the file
+      const bool read = payload_type == MSG_TYPE_CHECKPOINT
+                            ? read_checkpoint_payload(input)
+                            : read_regular_payload(input);
+      if (!read) {
+        // a regular message that can't be read ends the file as well, the
+        // next payload type can't be found without its size
+        _input_done = true;
+        break;
+      }
+      auto message = VW::make_unique<pipeline_message>();
+      message->type = payload_type;
+      message->payload_copy.assign(_payload, _payload + _payload_size);
+      message->payload = message->payload_copy.data();
+      message->payload_size = _payload_size;
+      message->total_size_read = _total_size_read;
+      _pipeline->submit(std::move(message));
+      break;
+    }
+    case MSG_TYPE_EOF: {
+      _input_done = true;
+      break;
+    }
+    default: {
+      VW::io::logger::log_warn(
+          "Payload type not recognized [0x{:x}], after having read [{}] "
+          "bytes from the file, attempting to skip payload",
+          payload_type, _total_size_read);
+      _input_done = !skip_over_unknown_payload(input);
+      break;
+    }
+    }
+  }
+}
+
+bool binary_parser::process_message(pipeline_message &message,
+                                    v_array<example *> &examples) {
+  if (message.type == MSG_TYPE_CHECKPOINT) {
+    apply_checkpoint(message.payload);
+    return false;
+  }
+
+  if (!_example_joiner->joiner_ready()) {
+    VW::io::logger::log_warn(
+        "Read regular message before any checkpoint data "
+        "after having read [{}] bytes from the file. Events will be ignored.",
+        message.total_size_read);
+    return false;
+  }
+
+  if (!message.verified) {
+    VW::io::logger::log_warn(
+        "JoinedPayload of size [{}] verification failed after having read [{}] "
+        "bytes from the file, skipping JoinedPayload",
+        message.payload_size, message.total_size_read);
+    return false;
+  }
+
+  _batch_size_read = message.total_size_read;
+  auto joined_payload =
+      flatbuffers::GetRoot<v2::JoinedPayload>(message.payload);
+  return process_joined_payload(*joined_payload,
+                                &message.decompressed_payloads,
+                                &message.parsed_examples, examples);
+}
+
+bool binary_parser::parse_pipelined(io_buf &input,
+                                    v_array<example *> &examples) {
+  while (true) {
+    fill_pipeline(input);
+    _current_message = _pipeline->next();
+    if (!_current_message) {
+      return false;
+    }
+    if (process_message(*_current_message, examples)) {
+      return true;
+    }
+  }
+}
+
+bool binary_parser::read_mapped_message(
+    std::unique_ptr<pipeline_message> &message) {
+  unsigned int payload_type;
+  const char *payload;
+  uint32_t payload_size;
+  while (_mapped_file->next(payload_type, payload, payload_size)) {
+    switch (payload_type) {
+    case MSG_TYPE_FILEMAGIC: {
+      if (*payload != BINARY_PARSER_VERSION) {
+        VW::io::logger::log_critical(
+            "File version [{}] does not match the parser version [{}]",
+            static_cast<size_t>(*payload), BINARY_PARSER_VERSION);
+        return false;
+      }
+      break;
+    }
+    case MSG_TYPE_HEADER: {
+      // TODO:: consume header
+      break;
+    }
+    case MSG_TYPE_CHECKPOINT:
+    case MSG_TYPE_REGULAR: {
+      message = VW::make_unique<pipeline_message>();
+      message->type = payload_type;
+      message->total_size_read = _mapped_file->offset();
+      message->payload_size = payload_size;
+      if (reinterpret_cast<uintptr_t>(payload) % 8 == 0) {
+        message->payload = payload;
+      } else {
+        // flatbuffers are read in place only if aligned as written, payloads
+        // of files that didn't pad them are copied
+        message->payload_copy.assign(payload, payload + payload_size);
+        message->payload = message->payload_copy.data();
+      }
+      return true;
+    }
+    case MSG_TYPE_EOF: {
+      return false;
+    }
+    default: {
+      VW::io::logger::log_warn(
+          "Payload type not recognized [0x{:x}], after having read [{}] "
+          "bytes from the file, skipping payload",
+          payload_type, _mapped_file->offset());
+      break;
+    }
+    }
+  }
+  return false;
+}
+
+bool binary_parser::parse_mapped(v_array<example *> &examples) {
+  while (true) {
+    if (_pipeline) {
+      std::unique_ptr<pipeline_message> message;
+      while (!_input_done && !_pipeline->full()) {
+        if (read_mapped_message(message)) {
+          _pipeline->submit(std::move(message));
+        } else {
+          _input_done = true;
+        }
+      }
+      _current_message = _pipeline->next();
+      if (!_current_message) {
+        return false;
+      }
+    } else {
+      if (!read_mapped_message(_current_message)) {
+        return false;
+      }
+      if (_current_message->type == MSG_TYPE_REGULAR) {
+        payload_pipeline::prepare(*_current_message);
+      }
+    }
+
+    if (process_message(*_current_message, examples)) {
+      return true;
+    }
+  }
 }
 
 bool binary_parser::parse_examples(vw *, io_buf &io_buf,
                                    v_array<example *> &examples) {
-  if (process_next_in_batch(examples)) {
+  if (process_next_in_batch(examples) || parse_input(io_buf, examples)) {
     return true;
   }
 
+  // events held for a join across messages are processed once the input ends
+  return _example_joiner->release_held_events() &&
+         process_next_in_batch(examples);
+}
+
+bool binary_parser::parse_input(io_buf &io_buf, v_array<example *> &examples) {
+  if (_mapped_file) {
+    return parse_mapped(examples);
+  }
+
+  if (_pipeline) {
+    return parse_pipelined(io_buf, examples);
+  }
+
   unsigned int payload_type;
   while (advance_to_next_payload_type(io_buf, payload_type)) {
     switch (payload_type) {
@@ -5,7 +5,9 @@
 #pragma once
 
 #include "joiners/i_joiner.h"
+#include "mapped_file_reader.h"
 #include "parse_example_external.h"
+#include "payload_pipeline.h"
 
 constexpr size_t BINARY_PARSER_VERSION = 1;
 
@@ -22,7 +24,17 @@ class binary_parser : public parser {
 public:
   binary_parser(
       std::unique_ptr<i_joiner> &&joiner); // taking ownership of joiner
+  // with threads > 0 regular messages are read ahead and prepared by that many
+  // worker threads, which also parse interactions with parse_all if given, see
+  // payload_pipeline
+  binary_parser(std::unique_ptr<i_joiner> &&joiner, size_t threads,
+                vw *parse_all = nullptr);
   ~binary_parser();
+  // reads the messages from a mapping of file_name instead of the io_buf
+  // handed to parse_examples, payloads are processed in place
+  bool map_file(const std::string &file_name);
+  // null unless map_file succeeded
+  mapped_file_reader *mapped_file() { return _mapped_file.get(); }
   bool parse_examples(vw *all, io_buf &io_buf,
                       v_array<example *> &examples) override;
   bool read_version(io_buf &input);
@@ -30,17 +42,42 @@ public:
   bool read_checkpoint_msg(io_buf &input);
   bool read_regular_msg(io_buf &input, v_array<example *> &examples,
                         bool &ignore_msg);
+  bool read_regular_payload(io_buf &input);
   bool skip_over_unknown_payload(io_buf &input);
   bool advance_to_next_payload_type(io_buf &input, unsigned int &payload_type);
   void persist_metrics(
       std::vector<std::pair<std::string, size_t>> &list_metrics) override;
 
 private:
+  bool read_checkpoint_payload(io_buf &input);
+  void apply_checkpoint(const char *payload);
+  bool process_joined_payload(
+      const v2::JoinedPayload &joined_payload,
+      const std::vector<flatbuffers::DetachedBuffer> *decompressed_payloads,
+      const std::vector<std::vector<example *>> *parsed_examples,
+      v_array<example *> &examples);
   bool process_next_in_batch(v_array<example *> &examples);
+  void fill_pipeline(io_buf &input);
+  bool parse_pipelined(io_buf &input, v_array<example *> &examples);
+  bool process_message(pipeline_message &message,
+                       v_array<example *> &examples);
+  bool read_mapped_message(std::unique_ptr<pipeline_message> &message);
+  bool parse_mapped(v_array<example *> &examples);
+  bool parse_input(io_buf &input, v_array<example *> &examples);
+
   std::unique_ptr<i_joiner> _example_joiner;
   char *_payload;
   uint32_t _payload_size;
   uint64_t _total_size_read;
+  // bytes read up to the end of the batch being processed, behind
+  // _total_size_read when messages are read ahead
+  uint64_t _batch_size_read;
+
+  std::unique_ptr<mapped_file_reader> _mapped_file;
+  std::unique_ptr<payload_pipeline> _pipeline;
+  bool _input_done = false;
+  // message whose events are being processed, the joiner points into it
+  std::unique_ptr<pipeline_message> _current_message;
 };
 } // namespace external
 } // namespace VW
\ No newline at end of file
@@ -10,7 +10,11 @@ namespace VW {
 namespace external {
 
 binary_json_converter::binary_json_converter(std::unique_ptr<i_joiner> &&joiner)
-    : _parser(std::move(joiner)) {}
+    : _joiner(joiner.get()), _parser(std::move(joiner)) {}
+
+binary_json_converter::binary_json_converter(std::unique_ptr<i_joiner> &&joiner,
+                                             size_t parser_threads)
+    : _joiner(joiner.get()), _parser(std::move(joiner), parser_threads) {}
 
 binary_json_converter::~binary_json_converter() = default;
 
@@ -19,6 +23,7 @@ bool binary_json_converter::parse_examples(vw *all, io_buf &io_buf,
   while (_parser.parse_examples(all, io_buf, examples)) {
     // do nothing
   }
+  _joiner->on_input_done();
   // vw will not learn, just exit
   return false;
 }
@@ -14,11 +14,15 @@ namespace external {
 class binary_json_converter : public parser {
 public:
   binary_json_converter(std::unique_ptr<i_joiner>&& joiner);  //taking ownership of joiner
+  // parser_threads as in binary_parser
+  binary_json_converter(std::unique_ptr<i_joiner>&& joiner, size_t parser_threads);
   ~binary_json_converter();
   bool parse_examples(vw *all, io_buf& io_buf, v_array<example *> &examples) override;
   void persist_metrics(std::vector<std::pair<std::string, size_t>>& list_metrics) override;
 
 private:
+  // owned by _parser
+  i_joiner *_joiner;
   binary_parser _parser;
 };
 } // namespace external
@@ -3,15 +3,23 @@
 // license as described in the file LICENSE.
 
 #include "parse_args.h"
+#include "columnar_writer.h"
+#include "dsjson_writer.h"
+#include "joined_log_index.h"
 #include "parse_example_binary.h"
 #include "parse_example_converter.h"
 #include "io/logger.h"
 #include "joiners/example_joiner.h"
 #include "joiners/multistep_example_joiner.h"
 #include "utils.h"
+#include "zstd_dictionaries.h"
 
 #include <memory>
 #include <cstdio>
+#include <limits>
+#include <sstream>
+
+#include "date.h"
 
 namespace VW {
 namespace external {
@@ -70,15 +78,89 @@ void apply_cli_overrides(std::unique_ptr<i_joiner>& joiner, vw *all, const input
     }
     joiner->set_reward_function(reward_function, true);
   }
+  for (const auto &dictionary_file : parsed_options.ext_opts->zstd_dictionaries) {
+    zstd_dictionaries::instance().load(dictionary_file);
+  }
   joiner->apply_cli_overrides(all, parsed_options);
 }
 
+namespace {
+bool parse_time(const std::string &value, int64_t &seconds) {
+  std::istringstream in(value);
+  date::sys_seconds time;
+  in >> date::parse("%FT%TZ", time);
+  if (in.fail()) {
+    return false;
+  }
+  seconds = time.time_since_epoch().count();
+  return true;
+}
+
+// restricts a mapped file to a shard and/or a time window using its index,
+// which is loaded from --binary_parser_index or built and saved there
+void select_messages(binary_parser &parser, const parser_options &options) {
+  auto &mapped_file = *parser.mapped_file();
+
+  joined_log_index index;
+  const auto &index_file = options.binary_parser_index;
+  if (index_file.empty() || !index.load(index_file, mapped_file.size())) {
+    if (!index.build(mapped_file)) {
+      throw std::runtime_error("Failed to index the data file");
+    }
+    if (!index_file.empty() && !index.save(index_file)) {
+      throw std::runtime_error("Failed to save the index to " + index_file);
+    }
+  }
+
+  const bool sharded = options.binary_parser_shards > 1;
+  const bool windowed = !options.binary_parser_start_time.empty() ||
+                        !options.binary_parser_end_time.empty();
+  uint64_t begin = 0;
+  uint64_t end = mapped_file.size();
+  if (sharded) {
+    if (options.binary_parser_shard < 0 ||
+        options.binary_parser_shard >= options.binary_parser_shards) {
+      throw std::runtime_error("Invalid argument to --binary_parser_shard " +
+        std::to_string(options.binary_parser_shard));
+    }
+    if (!index.shard_range(options.binary_parser_shard,
+                           options.binary_parser_shards, begin, end)) {
+      begin = end = 0;
+    }
+  }
+  if (windowed && begin < end) {
+    int64_t start_time = std::numeric_limits<int64_t>::min();
+    int64_t end_time = std::numeric_limits<int64_t>::max();
+    if (!options.binary_parser_start_time.empty() &&
+        !parse_time(options.binary_parser_start_time, start_time)) {
+      throw std::runtime_error("Invalid argument to --binary_parser_start_time " +
+        options.binary_parser_start_time);
+    }
+    if (!options.binary_parser_end_time.empty() &&
+        !parse_time(options.binary_parser_end_time, end_time)) {
+      throw std::runtime_error("Invalid argument to --binary_parser_end_time " +
+        options.binary_parser_end_time);
+    }
+    if (!index.time_range(start_time, end_time, begin, end)) {
+      begin = end = 0;
+    }
+  }
+  // an index built by scanning leaves the reader at the end
+  mapped_file.set_range(begin, end);
+}
+} // namespace
+
 std::unique_ptr<parser>
 parser::get_external_parser(vw *all, const input_options &parsed_options) {
   if (parsed_options.ext_opts->binary) {
+    if (parsed_options.ext_opts->binary_parser_threads < 0) {
+      throw std::runtime_error("Invalid argument to --binary_parser_threads " +
+        std::to_string(parsed_options.ext_opts->binary_parser_threads));
+    }
     bool binary_to_json = parsed_options.ext_opts->binary_to_json;
+    bool binary_to_columnar = parsed_options.ext_opts->binary_to_columnar;
     std::unique_ptr<i_joiner> joiner(nullptr);
-    if (binary_to_json) {
+    if (binary_to_json || binary_to_columnar) {
       const auto& infile_path = all->data_filename;
       const auto& infile_name = infile_path.substr(
         0, infile_path.find_last_of('.'));
@@ -90,11 +172,28 @@ parser::get_external_parser(vw *all, const input_options &parsed_options) {
         " be binary format, file provided: " + infile_path);
       }
 
-      std::string outfile_name = infile_name + ".dsjson";
-      joiner = VW::make_unique<example_joiner>(all, binary_to_json, outfile_name);
+      std::unique_ptr<log_converter::event_writer> event_writer;
+      std::string outfile_name;
+      if (binary_to_columnar) {
+        outfile_name = infile_name + ".columnar";
+        event_writer = VW::make_unique<log_converter::columnar_writer>(outfile_name);
+      } else {
+        if (parsed_options.ext_opts->binary_to_json_threads < 0) {
+          throw std::runtime_error("Invalid argument to --binary_to_json_threads " +
+            std::to_string(parsed_options.ext_opts->binary_to_json_threads));
+        }
+        outfile_name = infile_name + ".dsjson";
+        event_writer = VW::make_unique<log_converter::dsjson_writer>(outfile_name,
+          static_cast<size_t>(parsed_options.ext_opts->binary_to_json_threads));
+      }
+      if (!event_writer->is_open()) {
+        throw std::runtime_error("Could not open the output file " + outfile_name);
+      }
+      joiner = VW::make_unique<example_joiner>(all, std::move(event_writer));
       apply_cli_overrides(joiner, all, parsed_options);
 
-      return VW::make_unique<binary_json_converter>(std::move(joiner));
+      return VW::make_unique<binary_json_converter>(std::move(joiner),
+        static_cast<size_t>(parsed_options.ext_opts->binary_parser_threads));
 
     } else {
       joiner = VW::make_unique<example_joiner>(all);
@@ -108,8 +207,28 @@ parser::get_external_parser(vw *all, const input_options &parsed_options) {
     if (all->options->was_supplied("extra_metrics")) {
       all->example_parser->metrics = VW::make_unique<dsjson_metrics>();
     }
-    
-    return VW::make_unique<binary_parser>(std::move(joiner));
+
+    // the multistep joiner parses its own way, audit writes to vw
+    vw *parse_all = parsed_options.ext_opts->multistep || all->audit ||
+        all->hash_inv ? nullptr : all;
+    auto parser = VW::make_unique<binary_parser>(std::move(joiner),
+      static_cast<size_t>(parsed_options.ext_opts->binary_parser_threads),
+      parse_all);
+    const auto &ext_opts = *parsed_options.ext_opts;
+    const bool select = !ext_opts.binary_parser_index.empty() ||
+                        ext_opts.binary_parser_shards > 1 ||
+                        !ext_opts.binary_parser_start_time.empty() ||
+                        !ext_opts.binary_parser_end_time.empty();
+    if (ext_opts.binary_parser_mmap || select) {
+      if (!parser->map_file(all->data_filename)) {
+        throw std::runtime_error("Could not map the data file: " +
+          all->data_filename);
+      }
+      if (select) {
+        select_messages(*parser, ext_opts);
+      }
+    }
+    return std::move(parser);
   }
   throw std::runtime_error("external parser type not recognised");
 }
@@ -126,6 +245,13 @@ void parser::set_parse_args(VW::config::option_group_definition &in_options,
     .add(
       VW::config::make_option("binary_to_json", parsed_options.ext_opts->binary_to_json)
         .help("convert binary joined log into dsjson format"))
+    .add(
+      VW::config::make_option("binary_to_json_threads", parsed_options.ext_opts->binary_to_json_threads)
+        .default_value(0)
+        .help("Convert the events of each message to dsjson on that many threads, the output keeps the order of the input"))
+    .add(
+      VW::config::make_option("binary_to_columnar", parsed_options.ext_opts->binary_to_columnar)
+        .help("convert binary joined log into a columnar file of typed columns, see columnar_writer.h"))
     .add(
       VW::config::make_option("multistep", parsed_options.ext_opts->multistep)
         .help("multistep binary joiner"))
@@ -147,6 +273,47 @@ void parser::set_parse_args(VW::config::option_group_definition &in_options,
     .add(
       VW::config::make_option("learning_mode", parsed_options.ext_opts->learning_mode)
         .help("Override the learning mode from the file, valid values: Online, Apprentice, LoggingOnly"))
+    .add(
+      VW::config::make_option("zstd_dictionary", parsed_options.ext_opts->zstd_dictionaries)
+        .help("zstd dictionary file used by the client to compress payloads, can be repeated"))
+    .add(
+      VW::config::make_option("binary_parser_threads", parsed_options.ext_opts->binary_parser_threads)
+        .default_value(0)
+        .help("Worker threads verifying, decompressing and parsing the messages of the binary file ahead of vw, 0 (default) does it inline. Examples keep the order of the file"))
+    .add(
+      VW::config::make_option("binary_parser_mmap", parsed_options.ext_opts->binary_parser_mmap)
+        .help("Map the data file in memory and process the messages in place instead of copying them through vw's input buffer"))
+    .add(
+      VW::config::make_option("binary_parser_index", parsed_options.ext_opts->binary_parser_index)
+        .help("Index of the checkpoints and messages of the data file, built and saved there if missing or stale. Implies --binary_parser_mmap"))
+    .add(
+      VW::config::make_option("binary_parser_shards", parsed_options.ext_opts->binary_parser_shards)
+        .default_value(1)
+        .help("Split the data file on its checkpoints in that many shards, see --binary_parser_shard. Implies --binary_parser_mmap"))
+    .add(
+      VW::config::make_option("binary_parser_shard", parsed_options.ext_opts->binary_parser_shard)
+        .default_value(0)
+        .help("Shard of the data file to process, from 0 to --binary_parser_shards - 1"))
+    .add(
+      VW::config::make_option("binary_parser_start_time", parsed_options.ext_opts->binary_parser_start_time)
+        .help("Skip to the checkpoint before the first events at or after this time, e.g. 2021-01-30T10:20:30Z. Implies --binary_parser_mmap"))
+    .add(
+      VW::config::make_option("binary_parser_end_time", parsed_options.ext_opts->binary_parser_end_time)
+        .help("Stop at the checkpoint after the last events at or before this time. Implies --binary_parser_mmap"))
+    .add(
+      VW::config::make_option("binary_parser_join_window", parsed_options.ext_opts->binary_parser_join_window)
+        .default_value(0)
+        .help("Hold interactions for that many seconds of event time to join them with outcomes from later messages, or read before them. 0 (default) joins the events of each message on their own"))
+    .add(
+      VW::config::make_option("binary_parser_join_window_memory", parsed_options.ext_opts->binary_parser_join_window_memory)
+        .default_value(1024)
+        .help("Memory in MB the events held by --binary_parser_join_window can take, 0 for no cap. Events over the cap go to --binary_parser_join_window_spill or are joined early"))
+    .add(
+      VW::config::make_option("binary_parser_join_window_spill", parsed_options.ext_opts->binary_parser_join_window_spill)
+        .help("File the events held by --binary_parser_join_window are written to when they go over --binary_parser_join_window_memory"))
+    .add(
+      VW::config::make_option("binary_parser_dedup_cache", parsed_options.ext_opts->binary_parser_dedup_cache)
+        .help("File the parsed features of deduped actions are kept in across runs, created if missing. Later runs over the same logs restore the actions from it instead of parsing them"))
     ;
 }
 
@@ -14,6 +14,8 @@ struct parser_options {
   bool is_enabled();
   bool binary;
   bool binary_to_json;
+  int binary_to_json_threads;
+  bool binary_to_columnar;
   bool multistep;
   float default_reward;
   std::string multistep_reward;
@@ -21,6 +23,18 @@ struct parser_options {
   std::string reward_function;
   std::string learning_mode;
   bool use_client_time;
+  std::vector<std::string> zstd_dictionaries;
+  int binary_parser_threads;
+  bool binary_parser_mmap;
+  std::string binary_parser_index;
+  int binary_parser_shard;
+  int binary_parser_shards;
+  std::string binary_parser_start_time;
+  std::string binary_parser_end_time;
+  int binary_parser_join_window;
+  int binary_parser_join_window_memory;
+  std::string binary_parser_join_window_spill;
+  std::string binary_parser_dedup_cache;
 };
 
 int parse_examples(vw *all, io_buf &io_buf, v_array<example *> &examples);
@@ -0,0 +1,193 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#include "payload_pipeline.h"
+#include "event_processors/typed_events.h"
+#include "generated/v2/Event_generated.h"
+#include "generated/v2/FileFormat_generated.h"
+#include "parse_example_binary.h"
+
+// VW headers
+#include "parse_example_json.h"
+#include "parser.h"
+
+namespace {
+example &new_example(void *all) {
+  auto *ex = VW::alloc_examples(1);
+  static_cast<vw *>(all)->example_parser->lbl_parser.default_label(&ex->l);
+  return *ex;
+}
+
+template <typename T>
+void parse_context(const v2::Event &event,
+                   const flatbuffers::DetachedBuffer &decompressed, vw &all,
+                   std::vector<example *> &parsed) {
+  const T *payload = nullptr;
+  flatbuffers::DetachedBuffer unused;
+  // compressed payloads that failed to decompress are left to the joiner
+  if ((typed_event::is_compressed(*event.meta()) &&
+       decompressed.data() == nullptr) ||
+      !typed_event::process_compression<T>(
+          event.payload()->data(), event.payload()->size(), *event.meta(),
+          payload, unused, &decompressed) ||
+      payload == nullptr || payload->context() == nullptr) {
+    return;
+  }
+
+  std::string context =
+      typed_event::event_processor<T>::get_context(*payload);
+  if (context.find("\"__aid\"") != std::string::npos) {
+    return;
+  }
+
+  v_array<example *> examples;
+  examples.push_back(&new_example(&all));
+  try {
+    VW::template read_line_json_s<false>(all, examples, &context[0],
+                                         context.size(), new_example, &all);
+  } catch (VW::vw_exception &) {
+    // parsed again by the joiner, which reports the error in file order
+    for (auto *ex : examples) {
+      VW::dealloc_examples(ex, 1);
+    }
+    return;
+  }
+  parsed.assign(examples.begin(), examples.end());
+}
+} // namespace
+
+namespace VW {
+namespace external {
+pipeline_message::~pipeline_message() {
+  for (auto &examples : parsed_examples) {
+    for (auto *ex : examples) {
+      VW::dealloc_examples(ex, 1);
+    }
+  }
+}
+
+payload_pipeline::payload_pipeline(size_t threads, size_t max_pending,
+                                   vw *parse_all)
+    : _max_pending(max_pending), _parse_all(parse_all) {
+  for (size_t i = 0; i < threads; ++i) {
+    _threads.emplace_back(&payload_pipeline::worker, this);
+  }
+}
+
+payload_pipeline::~payload_pipeline() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _work_cv.notify_all();
+  for (auto &thread : _threads) {
+    thread.join();
+  }
+}
+
+bool payload_pipeline::full() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _pending.size() >= _max_pending;
+}
+
+bool payload_pipeline::empty() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _pending.empty();
+}
+
+void payload_pipeline::submit(std::unique_ptr<pipeline_message> &&message) {
+  const bool needs_work = message->type == MSG_TYPE_REGULAR;
+  std::unique_ptr<pending_message> pending(
+      new pending_message{std::move(message), !needs_work});
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (needs_work) {
+      _work.push_back(pending.get());
+    }
+    _pending.push_back(std::move(pending));
+  }
+  if (needs_work) {
+    _work_cv.notify_one();
+  }
+}
+
+std::unique_ptr<pipeline_message> payload_pipeline::next() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  if (_pending.empty()) {
+    return nullptr;
+  }
+  _done_cv.wait(lock, [this] { return _pending.front()->done; });
+  auto message = std::move(_pending.front()->message);
+  _pending.pop_front();
+  return message;
+}
+
+void payload_pipeline::worker() {
+  while (true) {
+    pending_message *pending = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _work_cv.wait(lock, [this] { return _stop || !_work.empty(); });
+      if (_stop) {
+        return;
+      }
+      pending = _work.front();
+      _work.pop_front();
+    }
+
+    prepare(*pending->message, _parse_all);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      pending->done = true;
+    }
+    _done_cv.notify_all();
+  }
+}
+
+void payload_pipeline::prepare(pipeline_message &message, vw *parse_all) {
+  const auto *data = reinterpret_cast<const uint8_t *>(message.payload);
+  auto verifier = flatbuffers::Verifier(data, message.payload_size);
+  auto joined_payload = flatbuffers::GetRoot<v2::JoinedPayload>(data);
+  message.verified = joined_payload->Verify(verifier);
+  if (!message.verified || joined_payload->events() == nullptr) {
+    return;
+  }
+
+  const auto &events = *joined_payload->events();
+  message.decompressed_payloads.resize(events.size());
+  if (parse_all != nullptr) {
+    message.parsed_examples.resize(events.size());
+  }
+  for (flatbuffers::uoffset_t i = 0; i < events.size(); ++i) {
+    const auto *joined_event = events.Get(i);
+    if (joined_event->event() == nullptr) {
+      continue;
+    }
+    auto event = flatbuffers::GetRoot<v2::Event>(joined_event->event()->data());
+    if (event->meta() == nullptr || event->meta()->id() == nullptr ||
+        event->payload() == nullptr) {
+      continue;
+    }
+    if (typed_event::is_compressed(*event->meta())) {
+      // failures are left to the joiner, which reports them in file order
+      typed_event::decompress_payload(event->payload()->data(),
+                                      event->payload()->size(), *event->meta(),
+                                      message.decompressed_payloads[i], false);
+    }
+
+    if (parse_all == nullptr) {
+      continue;
+    }
+    if (event->meta()->payload_type() == v2::PayloadType_CB) {
+      parse_context<v2::CbEvent>(*event, message.decompressed_payloads[i],
+                                 *parse_all, message.parsed_examples[i]);
+    } else if (event->meta()->payload_type() == v2::PayloadType_CA) {
+      parse_context<v2::CaEvent>(*event, message.decompressed_payloads[i],
+                                 *parse_all, message.parsed_examples[i]);
+    }
+  }
+}
+} // namespace external
+} // namespace VW
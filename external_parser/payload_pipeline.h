@@ -0,0 +1,100 @@
+// Copyright (c) by respective owners including Yahoo!, Microsoft, and
+// individual contributors. All rights reserved. Released under a BSD (revised)
+// license as described in the file LICENSE.
+
+#pragma once
+
+#include "flatbuffers/flatbuffers.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct example;
+struct vw;
+
+namespace VW {
+namespace external {
+
+// A message read from the joined log. The payload points either into a
+// mapping of the file that outlives the message, or into payload_copy
+struct pipeline_message {
+  pipeline_message() = default;
+  ~pipeline_message();
+  pipeline_message(const pipeline_message &) = delete;
+  pipeline_message &operator=(const pipeline_message &) = delete;
+
+  unsigned int type;
+  const char *payload = nullptr;
+  uint32_t payload_size = 0;
+  std::vector<char> payload_copy;
+  // bytes read from the file up to the end of the message, for logging
+  uint64_t total_size_read = 0;
+
+  // filled in by the workers for MSG_TYPE_REGULAR messages
+  bool verified = false;
+  // decompressed payload of each event of the JoinedPayload, empty for the
+  // events that aren't compressed or failed to decompress
+  std::vector<flatbuffers::DetachedBuffer> decompressed_payloads;
+  // examples parsed from the context of each CB and CA interaction that
+  // doesn't reference dedup objects, empty for the other events. Owned by the
+  // message
+  std::vector<std::vector<example *>> parsed_examples;
+};
+
+// Prepares the regular messages of a joined log on worker threads: the
+// JoinedPayload is verified and the compressed event payloads decompressed.
+// With a vw to parse with, the contexts of the interactions that don't
+// reference dedup objects are parsed as well; the others depend on the dedup
+// payloads read before them and are parsed in order on vw's parser thread.
+// Messages are handed back in the order they were submitted, whichever worker
+// finishes first, so that the examples reach vw in the order of the file.
+class payload_pipeline {
+public:
+  // max_pending bounds the messages read ahead of the one being consumed.
+  // parse_all is only read from, it must not audit features
+  payload_pipeline(size_t threads, size_t max_pending,
+                   vw *parse_all = nullptr);
+  ~payload_pipeline();
+
+  payload_pipeline(const payload_pipeline &) = delete;
+  payload_pipeline &operator=(const payload_pipeline &) = delete;
+
+  bool full() const;
+  bool empty() const;
+
+  // messages other than MSG_TYPE_REGULAR are passed through as is
+  void submit(std::unique_ptr<pipeline_message> &&message);
+
+  // oldest submitted message, waiting for its workers if needed. null if
+  // nothing is pending
+  std::unique_ptr<pipeline_message> next();
+
+  static void prepare(pipeline_message &message, vw *parse_all = nullptr);
+
+private:
+  struct pending_message {
+    std::unique_ptr<pipeline_message> message;
+    bool done;
+  };
+
+  void worker();
+
+  const size_t _max_pending;
+  vw *const _parse_all;
+  mutable std::mutex _mutex;
+  std::condition_variable _work_cv;
+  std::condition_variable _done_cv;
+  // submission order, only the front is popped and only once done
+  std::deque<std::unique_ptr<pending_message>> _pending;
+  // regular messages no worker picked up yet
+  std::deque<pending_message *> _work;
+  bool _stop = false;
+  std::vector<std::thread> _threads;
+};
+} // namespace external
+} // namespace VW
@@ -0,0 +1,248 @@
+#include "persistent_dedup_cache.h"
+#include "io/logger.h"
+
+#include <cstring>
+
+namespace {
+constexpr uint32_t RECORD_MARKER = 0x52434456; //'VDCR'
+
+struct file_header {
+  uint32_t magic;
+  uint32_t version;
+};
+
+// follows the record header for each namespace of the example, then come the
+// feature indices and the feature values
+struct namespace_header {
+  uint64_t feature_count;
+  float sum_feat_sq;
+  uint32_t index;
+};
+
+constexpr size_t padded(size_t size) { return (size + 7) & ~size_t(7); }
+
+size_t namespace_size(size_t feature_count) {
+  return sizeof(namespace_header) + feature_count * sizeof(uint64_t) +
+         padded(feature_count * sizeof(float));
+}
+
+// FNV-1a, tells apart hashing parameters and JSON values that share a dedup
+// id, the file is not exposed to anything else
+uint64_t fnv1a(const char *data, size_t size) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+} // namespace
+
+constexpr uint32_t persistent_dedup_cache::CACHE_MAGIC;
+constexpr uint32_t persistent_dedup_cache::CACHE_VERSION;
+
+bool persistent_dedup_cache::open(const std::string &file_name,
+                                  const std::string &hashing_parameters) {
+  _file_name = file_name;
+  _signature = fnv1a(hashing_parameters.data(), hashing_parameters.size());
+
+  uint64_t valid_size = 0;
+  if (std::ifstream(file_name).good() && !load(valid_size)) {
+    // the file is truncated below, it can't stay mapped
+    _mapped_file.close();
+    _entries.clear();
+    valid_size = 0;
+  }
+
+  auto mode = std::ios::in | std::ios::out | std::ios::binary;
+  if (valid_size == 0) {
+    mode |= std::ios::trunc;
+  }
+  _file.open(file_name, mode);
+  if (!_file.is_open()) {
+    VW::io::logger::log_error("Failed to open dedup cache [{}] for writing",
+                              file_name);
+    _mapped_file.close();
+    _entries.clear();
+    return false;
+  }
+
+  if (valid_size == 0) {
+    const file_header header{CACHE_MAGIC, CACHE_VERSION};
+    _file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    valid_size = sizeof(header);
+  }
+  _file_size = valid_size;
+  return true;
+}
+
+bool persistent_dedup_cache::load(uint64_t &valid_size) {
+  if (!_mapped_file.open(_file_name)) {
+    return false;
+  }
+
+  const char *data = _mapped_file.data();
+  const uint64_t size = _mapped_file.size();
+  file_header header{0, 0};
+  if (size >= sizeof(header)) {
+    std::memcpy(&header, data, sizeof(header));
+  }
+  if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION) {
+    VW::io::logger::log_warn("[{}] is not a dedup cache of version [{}], it "
+                             "is written over",
+                             _file_name, CACHE_VERSION);
+    return false;
+  }
+
+  uint64_t offset = sizeof(header);
+  while (size - offset >= sizeof(record_header)) {
+    const auto *record =
+        reinterpret_cast<const record_header *>(data + offset);
+    if (record->marker != RECORD_MARKER || record->size % 8 != 0 ||
+        size - offset - sizeof(record_header) < record->size) {
+      break;
+    }
+    if (record->signature == _signature) {
+      _entries[record->dedup_id] = {data + offset, offset};
+    }
+    offset += sizeof(record_header) + record->size;
+  }
+
+  if (offset != size) {
+    // e.g. a run stopped while appending
+    VW::io::logger::log_warn("Dedup cache [{}] ends with [{}] bytes that are "
+                             "not a record, they are written over",
+                             _file_name, size - offset);
+  }
+  valid_size = offset;
+  return true;
+}
+
+bool persistent_dedup_cache::restore(uint64_t dedup_id, const char *json,
+                                     size_t json_size, example &ex) {
+  auto found = _entries.find(dedup_id);
+  if (found == _entries.end()) {
+    return false;
+  }
+
+  const char *record = found->second.mapped;
+  if (record == nullptr) {
+    // appended by this run, read back from the file
+    _file.clear();
+    _file.seekg(static_cast<std::streamoff>(found->second.offset));
+    _buffer.resize(sizeof(record_header));
+    if (!_file.read(_buffer.data(), sizeof(record_header))) {
+      return false;
+    }
+    const uint32_t size =
+        reinterpret_cast<const record_header *>(_buffer.data())->size;
+    _buffer.resize(sizeof(record_header) + size);
+    if (!_file.read(_buffer.data() + sizeof(record_header), size)) {
+      return false;
+    }
+    record = _buffer.data();
+  }
+
+  const auto &header = *reinterpret_cast<const record_header *>(record);
+  if (header.json_size != json_size ||
+      header.json_hash != fnv1a(json, json_size) ||
+      !restore_features(header, record + sizeof(record_header), ex)) {
+    return false;
+  }
+  ++_hits;
+  return true;
+}
+
+bool persistent_dedup_cache::restore_features(const record_header &header,
+                                              const char *features,
+                                              example &ex) const {
+  // the record is checked whole before ex is touched
+  size_t offset = 0;
+  for (uint32_t i = 0; i < header.namespace_count; ++i) {
+    if (header.size - offset < sizeof(namespace_header)) {
+      return false;
+    }
+    const auto *ns = reinterpret_cast<const namespace_header *>(features + offset);
+    if (ns->index > 255 || (header.size - offset - sizeof(namespace_header)) /
+                                   (sizeof(uint64_t) + sizeof(float)) <
+                               ns->feature_count) {
+      return false;
+    }
+    offset += namespace_size(static_cast<size_t>(ns->feature_count));
+  }
+  if (offset != header.size) {
+    return false;
+  }
+
+  offset = 0;
+  for (uint32_t i = 0; i < header.namespace_count; ++i) {
+    const auto *ns = reinterpret_cast<const namespace_header *>(features + offset);
+    const auto count = static_cast<size_t>(ns->feature_count);
+    const auto *indices = reinterpret_cast<const uint64_t *>(ns + 1);
+    const auto *values = reinterpret_cast<const float *>(indices + count);
+
+    ex.indices.push_back(static_cast<namespace_index>(ns->index));
+    auto &fs = ex.feature_space[ns->index];
+    for (size_t j = 0; j < count; ++j) {
+      fs.values.push_back(values[j]);
+      fs.indicies.push_back(indices[j]);
+    }
+    fs.sum_feat_sq = ns->sum_feat_sq;
+    offset += namespace_size(count);
+  }
+  return true;
+}
+
+void persistent_dedup_cache::store(uint64_t dedup_id, const char *json,
+                                   size_t json_size, const example &ex) {
+  if (!enabled() || _write_failed) {
+    return;
+  }
+
+  size_t size = 0;
+  for (auto ns : ex.indices) {
+    size += namespace_size(ex.feature_space[ns].values.size());
+  }
+
+  _buffer.assign(sizeof(record_header) + size, 0);
+  auto *header = reinterpret_cast<record_header *>(_buffer.data());
+  header->marker = RECORD_MARKER;
+  header->size = static_cast<uint32_t>(size);
+  header->signature = _signature;
+  header->dedup_id = dedup_id;
+  header->json_hash = fnv1a(json, json_size);
+  header->json_size = static_cast<uint32_t>(json_size);
+  header->namespace_count = static_cast<uint32_t>(ex.indices.size());
+
+  char *features = _buffer.data() + sizeof(record_header);
+  for (auto index : ex.indices) {
+    const auto &fs = ex.feature_space[index];
+    const size_t count = fs.values.size();
+    auto *ns = reinterpret_cast<namespace_header *>(features);
+    ns->feature_count = count;
+    ns->sum_feat_sq = fs.sum_feat_sq;
+    ns->index = index;
+    auto *indices = reinterpret_cast<uint64_t *>(ns + 1);
+    auto *values = reinterpret_cast<float *>(indices + count);
+    for (size_t j = 0; j < count; ++j) {
+      indices[j] = fs.indicies[j];
+      values[j] = fs.values[j];
+    }
+    features += namespace_size(count);
+  }
+
+  _file.clear();
+  _file.seekp(static_cast<std::streamoff>(_file_size));
+  _file.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+  if (!_file) {
+    VW::io::logger::log_error("Failed to write to dedup cache [{}], new "
+                              "entries are not cached",
+                              _file_name);
+    _write_failed = true;
+    return;
+  }
+
+  _entries[dedup_id] = {nullptr, _file_size};
+  _file_size += _buffer.size();
+  ++_stores;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "example.h"
+#include "mapped_file_reader.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+Persistent dedup cache
+Deduped actions are parsed from their JSON once per dedup payload they appear
+in, on every run over the same logs. This cache keeps the parsed and hashed
+features of each action in a file so that later runs, and later files of the
+same run, restore them instead of parsing them again.
+
+Entries are keyed by dedup id and by a hash of a description of the vw
+hashing parameters the features were hashed with, so runs with different hashing
+parameters share the file without using each other's entries. Dedup ids are
+content hashes of the JSON, an entry is only used if the hash and size of the
+JSON it was parsed from match as well.
+
+The file is a header (magic, version) followed by records of a record_header
+and the features of each namespace, everything padded to 8 bytes. It is
+mapped when opened and new entries are appended to it. Features are restored
+without audit information.
+*/
+class persistent_dedup_cache {
+public:
+  static constexpr uint32_t CACHE_MAGIC = 0x43445756; //'VWDC'
+  static constexpr uint32_t CACHE_VERSION = 1;
+
+  persistent_dedup_cache() = default;
+  persistent_dedup_cache(const persistent_dedup_cache &) = delete;
+  persistent_dedup_cache &operator=(const persistent_dedup_cache &) = delete;
+
+  // maps the entries of file_name saved with the same hashing parameters and
+  // appends new ones to it, the file is created if missing. Returns false if
+  // it can't be written to
+  bool open(const std::string &file_name,
+            const std::string &hashing_parameters);
+  bool enabled() const { return _file.is_open(); }
+
+  // fills ex with the features cached for dedup_id and its JSON, returns
+  // false if they aren't cached
+  bool restore(uint64_t dedup_id, const char *json, size_t json_size,
+               example &ex);
+  // caches the features of ex, parsed from the JSON of dedup_id
+  void store(uint64_t dedup_id, const char *json, size_t json_size,
+             const example &ex);
+
+  size_t entries() const { return _entries.size(); }
+  size_t hits() const { return _hits; }
+  size_t stores() const { return _stores; }
+
+private:
+  struct record_header {
+    uint32_t marker;
+    // bytes of the features after the header
+    uint32_t size;
+    uint64_t signature;
+    uint64_t dedup_id;
+    uint64_t json_hash;
+    uint32_t json_size;
+    uint32_t namespace_count;
+  };
+
+  struct entry {
+    // the record in the mapping, or nullptr if it was appended since
+    const char *mapped;
+    uint64_t offset;
+  };
+
+  // indexes the records of the mapped file, valid_size is where they end
+  bool load(uint64_t &valid_size);
+  bool restore_features(const record_header &header, const char *features,
+                        example &ex) const;
+
+  std::string _file_name;
+  uint64_t _signature = 0;
+  VW::external::mapped_file_reader _mapped_file;
+  std::fstream _file;
+  bool _write_failed = false;
+  uint64_t _file_size = 0;
+  std::unordered_map<uint64_t, entry> _entries;
+  // records read back from the file or serialized by store
+  std::vector<char> _buffer;
+
+  size_t _hits = 0;
+  size_t _stores = 0;
+};
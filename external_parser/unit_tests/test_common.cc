@@ -1,5 +1,6 @@
 #include "test_common.h"
 
+#include "event_processors/typed_events.h"
 #include "io/io_adapter.h"
 #include "parser.h"
 
@@ -110,7 +111,11 @@ std::vector<const v2::JoinedEvent *> wrap_into_joined_events(
     std::vector<char> event_batch_buffer = {buffer.begin() + PREAMBLE_LENGTH,
                                             buffer.begin() + PREAMBLE_LENGTH +
                                                 payload_size};
-    auto event_batch = v2::GetEventBatch(event_batch_buffer.data());
+    const v2::EventBatch *event_batch = nullptr;
+    flatbuffers::DetachedBuffer decompressed_batch;
+    BOOST_REQUIRE(typed_event::process_batch_compression(
+        *v2::GetEventBatch(event_batch_buffer.data()), event_batch,
+        decompressed_batch));
     BOOST_REQUIRE_GE(event_batch->events()->size(), 1);
 
     int day = 30;
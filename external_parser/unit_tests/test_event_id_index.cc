@@ -0,0 +1,43 @@
+#include "joiners/event_id_index.h"
+#include "test_common.h"
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_CASE(event_id_index_groups_ids_in_order_of_appearance) {
+  event_id_index index;
+  std::vector<std::string> ids;
+  for (size_t i = 0; i < 1000; ++i) {
+    ids.push_back("event_" + std::to_string(i % 300));
+  }
+
+  // the index is reused across batches
+  for (size_t batch = 0; batch < 3; ++batch) {
+    size_t groups = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      bool inserted = false;
+      const size_t group = index.find_or_insert(ids[i].c_str(), ids[i].size(),
+                                                groups, inserted);
+      BOOST_CHECK_EQUAL(inserted, i < 300);
+      BOOST_CHECK_EQUAL(group, i % 300);
+      if (inserted) {
+        ++groups;
+      }
+    }
+    BOOST_CHECK_EQUAL(index.size(), 300);
+    index.clear();
+    BOOST_CHECK_EQUAL(index.size(), 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(event_id_index_compares_whole_ids) {
+  event_id_index index;
+  const std::string id = "abcd";
+  bool inserted = false;
+  BOOST_CHECK_EQUAL(index.find_or_insert(id.c_str(), 3, 0, inserted), 0);
+  BOOST_CHECK(inserted);
+  BOOST_CHECK_EQUAL(index.find_or_insert(id.c_str(), 4, 1, inserted), 1);
+  BOOST_CHECK(inserted);
+  BOOST_CHECK_EQUAL(index.find_or_insert("abc", 3, 2, inserted), 0);
+  BOOST_CHECK(!inserted);
+}
@@ -1,7 +1,29 @@
 #include "joiners/example_joiner.h"
+#include "joiners/multistep_example_joiner.h"
 #include "test_common.h"
 #include <boost/test/unit_test.hpp>
 
+#include "generated/v2/Event_generated.h"
+
+namespace {
+// wraps an event payload into a joined event, as the joiner would write it
+flatbuffers::DetachedBuffer
+make_joined_event(v2::PayloadType type, const char *id,
+                  const flatbuffers::DetachedBuffer &payload) {
+  v2::TimeStamp ts(2021, 1, 1, 0, 0, 0, 0);
+  flatbuffers::FlatBufferBuilder event_fbb;
+  auto meta = v2::CreateMetadataDirect(event_fbb, id, &ts, "", type, 1.f);
+  auto payload_vector = event_fbb.CreateVector(payload.data(), payload.size());
+  event_fbb.Finish(v2::CreateEvent(event_fbb, meta, payload_vector));
+
+  flatbuffers::FlatBufferBuilder fbb;
+  auto event_vector =
+      fbb.CreateVector(event_fbb.GetBufferPointer(), event_fbb.GetSize());
+  fbb.Finish(v2::CreateJoinedEvent(fbb, event_vector, &ts));
+  return fbb.Release();
+}
+} // namespace
+
 BOOST_AUTO_TEST_CASE(example_joiner_test_ca) {
   auto vw = VW::initialize("--quiet --binary_parser --cats 4 --min_value 1 "
                            "--max_value 100 --bandwidth 1",
@@ -255,3 +277,57 @@ BOOST_AUTO_TEST_CASE(example_joiner_test_stickyness) {
 
   VW::finish(*vw);
 }
+
+BOOST_AUTO_TEST_CASE(multistep_example_joiner_test_coalesced_outcomes) {
+  auto vw = VW::initialize("--quiet --binary_parser --cb_explore_adf", nullptr,
+                           false, nullptr, nullptr);
+
+  multistep_example_joiner joiner(vw);
+  joiner.set_problem_type_config(v2::ProblemType_CB, true);
+  joiner.set_reward_function(v2::RewardFunctionType_Sum, true);
+  joiner.set_use_client_time(true, true);
+  BOOST_REQUIRE_EQUAL(joiner.joiner_ready(), true);
+
+  std::vector<flatbuffers::DetachedBuffer> joined_events;
+  {
+    flatbuffers::FlatBufferBuilder fbb;
+    const std::string context =
+        R"({"A":{"f":1},"_multi":[{"B":{"b":1}},{"B":{"b":2}}]})";
+    std::vector<uint8_t> context_bytes(context.begin(), context.end());
+    std::vector<uint64_t> actions = {1, 2};
+    std::vector<float> probabilities = {0.9f, 0.1f};
+    fbb.Finish(v2::CreateMultiStepEventDirect(
+        fbb, "1", nullptr, &actions, &context_bytes, &probabilities, "model"));
+    joined_events.push_back(
+        make_joined_event(v2::PayloadType_MultiStep, "episode", fbb.Release()));
+  }
+  {
+    // an episodic outcome the client coalesced with two more values
+    flatbuffers::FlatBufferBuilder fbb;
+    auto value = v2::CreateNumericOutcome(fbb, 1.f).Union();
+    std::vector<float> more_values = {2.f, 3.f};
+    fbb.Finish(v2::CreateOutcomeEventDirect(fbb, v2::OutcomeValue_numeric,
+                                            value, v2::IndexValue_NONE, 0,
+                                            false, &more_values));
+    joined_events.push_back(
+        make_joined_event(v2::PayloadType_Outcome, "episode", fbb.Release()));
+  }
+
+  joiner.on_new_batch();
+  for (const auto &je : joined_events) {
+    joiner.process_event(*flatbuffers::GetRoot<v2::JoinedEvent>(je.data()));
+  }
+  joiner.on_batch_read();
+
+  v_array<example *> examples;
+  examples.push_back(&VW::get_unused_example(vw));
+  BOOST_REQUIRE_EQUAL(joiner.process_joined(examples), true);
+  // shared example, two actions and the newline example
+  BOOST_REQUIRE_EQUAL(examples.size(), 4);
+  BOOST_REQUIRE_EQUAL(examples[1]->l.cb.costs.size(), 1);
+  // every coalesced value counts towards the sum
+  BOOST_CHECK_EQUAL(examples[1]->l.cb.costs[0].cost, -6);
+
+  clear_examples(examples, vw);
+  VW::finish(*vw);
+}
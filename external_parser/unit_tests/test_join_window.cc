@@ -0,0 +1,148 @@
+#include "joiners/join_window.h"
+#include "test_common.h"
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <string>
+
+namespace {
+// events are opaque to the window, their payloads are strings here
+struct test_event {
+  std::string payload;
+  int second;
+  bool is_interaction;
+  v2::TimeStamp timestamp;
+};
+
+test_event interaction(const std::string &payload, int second) {
+  return {payload, second, true, v2::TimeStamp(2021, 1, 1, 0, 0, second, 0)};
+}
+
+test_event outcome(const std::string &payload, int second) {
+  return {payload, second, false, v2::TimeStamp(2021, 1, 1, 0, 0, second, 0)};
+}
+
+void add(join_window &window, const std::string &id,
+         const std::vector<test_event> &events) {
+  std::vector<join_window::event> window_events;
+  for (const auto &e : events) {
+    window_events.push_back(
+        {reinterpret_cast<const uint8_t *>(e.payload.data()),
+         static_cast<uint32_t>(e.payload.size()), &e.timestamp,
+         timestamp_to_chrono(e.timestamp), e.is_interaction});
+  }
+  window.add(id.c_str(), id.size(), window_events);
+}
+
+void advance(join_window &window, int second) {
+  window.advance(
+      timestamp_to_chrono(v2::TimeStamp(2021, 1, 1, 0, 0, second, 0)));
+}
+
+std::vector<std::string> released_payloads(const join_window &window,
+                                           size_t index) {
+  std::vector<join_window::held_event> events;
+  window.released_events(index, events);
+  std::vector<std::string> payloads;
+  for (const auto &e : events) {
+    payloads.emplace_back(reinterpret_cast<const char *>(e.data), e.size);
+  }
+  return payloads;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(join_window_joins_events_across_messages) {
+  join_window window;
+  window.configure(std::chrono::seconds(10), 0, "");
+  BOOST_CHECK(window.enabled());
+
+  // the outcome is read before its interaction, in another message
+  add(window, "id_1", {outcome("o_1", 1)});
+  add(window, "id_2", {interaction("i_2", 2)});
+  advance(window, 2);
+  window.release(false);
+  BOOST_CHECK_EQUAL(window.released(), 0);
+  BOOST_CHECK_EQUAL(window.held(), 2);
+
+  add(window, "id_1", {interaction("i_1", 3), outcome("o_1b", 4)});
+  add(window, "id_2", {outcome("o_2", 5)});
+  advance(window, 12);
+  window.release(false);
+  // id_2 is due at 12, id_1 at 13
+  BOOST_REQUIRE_EQUAL(window.released(), 1);
+  BOOST_CHECK_EQUAL(released_payloads(window, 0).at(0), "i_2");
+  BOOST_CHECK_EQUAL(released_payloads(window, 0).at(1), "o_2");
+
+  advance(window, 13);
+  window.release(false);
+  BOOST_REQUIRE_EQUAL(window.released(), 1);
+  const std::vector<std::string> expected = {"i_1", "o_1", "o_1b"};
+  const auto payloads = released_payloads(window, 0);
+  BOOST_CHECK_EQUAL_COLLECTIONS(payloads.begin(), payloads.end(),
+                                expected.begin(), expected.end());
+  BOOST_CHECK_EQUAL(window.held(), 0);
+  BOOST_CHECK_EQUAL(window.memory(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(join_window_counts_late_and_orphaned_outcomes) {
+  join_window window;
+  window.configure(std::chrono::seconds(10), 0, "");
+
+  add(window, "id_1", {interaction("i_1", 30)});
+  advance(window, 30);
+  // older than the window and not held
+  add(window, "id_2", {outcome("o_2", 5), outcome("o_2b", 10)});
+  // within the window but its interaction never comes
+  add(window, "id_3", {outcome("o_3", 25)});
+  BOOST_CHECK_EQUAL(window.late_outcomes(), 2);
+  BOOST_CHECK_EQUAL(window.held(), 2);
+
+  window.release(true);
+  BOOST_CHECK_EQUAL(window.released(), 1);
+  BOOST_CHECK_EQUAL(window.orphaned_outcomes(), 1);
+  BOOST_CHECK_EQUAL(window.held(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(join_window_spills_over_the_memory_cap) {
+  const std::string spill_file = "join_window_test.spill";
+  const std::string payload(100, 'x');
+  {
+    join_window window;
+    window.configure(std::chrono::seconds(100), 1000, spill_file);
+
+    for (int i = 0; i < 20; ++i) {
+      add(window, "id_" + std::to_string(i),
+          {interaction(payload + std::to_string(i), i)});
+    }
+    add(window, "id_19", {outcome("o_19", 20)});
+    advance(window, 20);
+    window.release(false);
+    BOOST_CHECK_EQUAL(window.released(), 0);
+    BOOST_CHECK_LE(window.memory(), 1000);
+    BOOST_CHECK_GT(window.spills(), 0);
+    BOOST_CHECK_EQUAL(window.held(), 20);
+
+    window.release(true);
+    BOOST_REQUIRE_EQUAL(window.released(), 20);
+    for (size_t i = 0; i < 20; ++i) {
+      BOOST_CHECK_EQUAL(released_payloads(window, i).at(0),
+                        payload + std::to_string(i));
+    }
+    BOOST_CHECK_EQUAL(released_payloads(window, 19).at(1), "o_19");
+    BOOST_CHECK_EQUAL(window.early_releases(), 0);
+  }
+  std::remove(spill_file.c_str());
+
+  // without a spill file the ids due first are released early
+  join_window window;
+  window.configure(std::chrono::seconds(100), 1000, "");
+  for (int i = 0; i < 20; ++i) {
+    add(window, "id_" + std::to_string(i),
+        {interaction(payload + std::to_string(i), i)});
+  }
+  window.release(false);
+  BOOST_CHECK_LE(window.memory(), 1000);
+  BOOST_REQUIRE_GT(window.released(), 0);
+  BOOST_CHECK_EQUAL(window.early_releases(), window.released());
+  BOOST_CHECK_EQUAL(released_payloads(window, 0).at(0), payload + "0");
+}
@@ -0,0 +1,121 @@
+#include "joined_log_index.h"
+#include "mapped_file_reader.h"
+#include "parse_example_binary.h"
+#include "test_common.h"
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <limits>
+
+namespace {
+const std::string &indexed_file() {
+  static const std::string file_name =
+      get_test_files_location() +
+      "/valid_joined_logs/average_reward_100_interactions.fb";
+  return file_name;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(joined_log_index_build_save_and_load) {
+  VW::external::mapped_file_reader reader;
+  BOOST_REQUIRE(reader.open(indexed_file()));
+
+  VW::external::joined_log_index index;
+  BOOST_REQUIRE(index.build(reader));
+  BOOST_CHECK_EQUAL(index.checkpoint_count(), 2);
+  BOOST_REQUIRE_EQUAL(index.entries().size(), 4);
+  for (const auto &entry : index.entries()) {
+    if (entry.payload_type == MSG_TYPE_REGULAR) {
+      BOOST_CHECK_GT(entry.min_time, 0);
+      BOOST_CHECK_LE(entry.min_time, entry.max_time);
+    }
+  }
+
+  std::string index_file =
+      get_test_files_location() + "/test_outputs/average_reward.fb.idx";
+  BOOST_REQUIRE(index.save(index_file));
+
+  VW::external::joined_log_index loaded;
+  BOOST_REQUIRE(loaded.load(index_file, reader.size()));
+  BOOST_REQUIRE_EQUAL(loaded.entries().size(), index.entries().size());
+  for (size_t i = 0; i < index.entries().size(); ++i) {
+    BOOST_CHECK_EQUAL(loaded.entries()[i].offset, index.entries()[i].offset);
+    BOOST_CHECK_EQUAL(loaded.entries()[i].min_time,
+                      index.entries()[i].min_time);
+  }
+
+  // an index of another file is rebuilt
+  VW::external::joined_log_index stale;
+  BOOST_CHECK(!stale.load(index_file, reader.size() + 8));
+
+  std::remove(index_file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(joined_log_index_shards_cover_the_file) {
+  VW::external::mapped_file_reader reader;
+  BOOST_REQUIRE(reader.open(indexed_file()));
+  VW::external::joined_log_index index;
+  BOOST_REQUIRE(index.build(reader));
+
+  const uint64_t first_checkpoint = index.entries().front().offset;
+  for (size_t shards = 1; shards <= 3; ++shards) {
+    uint64_t covered_until = first_checkpoint;
+    for (size_t shard = 0; shard < shards; ++shard) {
+      uint64_t begin = 0;
+      uint64_t end = reader.size();
+      if (!index.shard_range(shard, shards, begin, end)) {
+        // more shards than checkpoints
+        continue;
+      }
+      BOOST_CHECK_EQUAL(begin, covered_until);
+      BOOST_CHECK_LT(begin, end);
+      covered_until = end;
+    }
+    BOOST_CHECK_EQUAL(covered_until, reader.size());
+  }
+
+  // every shard is read from its checkpoint
+  uint64_t begin = 0;
+  uint64_t end = 0;
+  BOOST_REQUIRE(index.shard_range(1, 2, begin, end));
+  BOOST_REQUIRE(reader.set_range(begin, end));
+  unsigned int payload_type;
+  const char *payload;
+  uint32_t payload_size;
+  BOOST_REQUIRE(reader.next(payload_type, payload, payload_size));
+  BOOST_CHECK_EQUAL(payload_type, MSG_TYPE_CHECKPOINT);
+  BOOST_REQUIRE(reader.next(payload_type, payload, payload_size));
+  BOOST_CHECK_EQUAL(payload_type, MSG_TYPE_REGULAR);
+  BOOST_REQUIRE(reader.next(payload_type, payload, payload_size));
+  BOOST_CHECK_EQUAL(payload_type, MSG_TYPE_EOF);
+}
+
+BOOST_AUTO_TEST_CASE(joined_log_index_time_range) {
+  VW::external::mapped_file_reader reader;
+  BOOST_REQUIRE(reader.open(indexed_file()));
+  VW::external::joined_log_index index;
+  BOOST_REQUIRE(index.build(reader));
+
+  int64_t min_time = std::numeric_limits<int64_t>::max();
+  int64_t max_time = std::numeric_limits<int64_t>::min();
+  for (const auto &entry : index.entries()) {
+    if (entry.payload_type == MSG_TYPE_REGULAR) {
+      min_time = std::min(min_time, entry.min_time);
+      max_time = std::max(max_time, entry.max_time);
+    }
+  }
+
+  uint64_t begin = 0;
+  uint64_t end = reader.size();
+  BOOST_REQUIRE(index.time_range(min_time, max_time, begin, end));
+  BOOST_CHECK_EQUAL(begin, index.entries().front().offset);
+  BOOST_CHECK_EQUAL(end, reader.size());
+
+  begin = 0;
+  end = reader.size();
+  BOOST_CHECK(!index.time_range(max_time + 1,
+                                std::numeric_limits<int64_t>::max(), begin,
+                                end));
+  BOOST_CHECK(!index.time_range(std::numeric_limits<int64_t>::min(),
+                                min_time - 1, begin, end));
+}
@@ -1,9 +1,12 @@
+#include "columnar_writer.h"
 #include "test_common.h"
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
 #include <stdio.h>
 
 std::string get_json_event(std::string infile_path, std::string outfile_path,
-    v2::ProblemType problem_type=v2::ProblemType_CB) {
+    v2::ProblemType problem_type=v2::ProblemType_CB,
+    const std::string &extra_args = "") {
   std::string infile_name = get_test_files_location() + infile_path;
   std::string command;
 
@@ -24,6 +27,7 @@ std::string get_json_event(std::string infile_path, std::string outfile_path,
           infile_name;
       break;
   }
+  command += " " + extra_args;
 
   auto vw = VW::initialize(command, nullptr, false, nullptr, nullptr);
 
@@ -255,3 +259,90 @@ BOOST_AUTO_TEST_CASE(log_converter_slates_format) {
 
   BOOST_CHECK_EQUAL(converted_json, expected_json);
 }
+
+BOOST_AUTO_TEST_CASE(log_converter_threads_keep_the_order_of_the_input) {
+  std::string infile_path = "valid_joined_logs/average_reward_100_interactions.fb";
+  std::string outfile_path = "valid_joined_logs/average_reward_100_interactions.dsjson";
+
+  std::string converted_json = get_json_event(infile_path, outfile_path);
+  BOOST_CHECK_EQUAL(
+      std::count(converted_json.begin(), converted_json.end(), '\n'), 100);
+
+  std::string threaded_json = get_json_event(infile_path, outfile_path,
+      v2::ProblemType_CB, "--binary_to_json_threads 2 --binary_parser_threads 2");
+  BOOST_CHECK_EQUAL(threaded_json, converted_json);
+}
+
+BOOST_AUTO_TEST_CASE(log_converter_columnar_format) {
+  std::string infile_name = get_test_files_location() +
+      "valid_joined_logs/average_reward_100_interactions.fb";
+  std::string outfile_name = get_test_files_location() +
+      "valid_joined_logs/average_reward_100_interactions.columnar";
+
+  auto vw = VW::initialize("--quiet --binary_to_columnar --binary_parser "
+      "--cb_explore_adf -d " + infile_name, nullptr, false, nullptr, nullptr);
+  v_array<example *> examples;
+  examples.push_back(&VW::get_unused_example(vw));
+  while (vw->example_parser->reader(vw, vw->example_parser->input, examples) > 0) {
+    examples.push_back(&VW::get_unused_example(vw));
+  }
+  clear_examples(examples, vw);
+  VW::finish(*vw);
+
+  namespace columnar = log_converter::columnar;
+  log_converter::columnar_reader reader;
+  BOOST_REQUIRE(reader.open(outfile_name));
+  BOOST_REQUIRE_EQUAL(reader.row_group_count(), 1);
+
+  columnar::column_data column;
+  BOOST_REQUIRE(reader.read_column(0, columnar::column_id::event_id, column));
+  BOOST_CHECK_EQUAL(column.rows, 100);
+  BOOST_CHECK_EQUAL(column.string_at(0), "91f71c8");
+
+  BOOST_REQUIRE(reader.read_column(0, columnar::column_id::rewards, column));
+  BOOST_CHECK_EQUAL(column.offsets[1], 1);
+  BOOST_CHECK_CLOSE(column.as<float>()[0], 2.3333333f, 0.0001f);
+
+  BOOST_REQUIRE(reader.read_column(0, columnar::column_id::actions, column));
+  BOOST_CHECK_EQUAL(column.offsets[1], 2);
+  BOOST_CHECK_EQUAL(column.as<uint32_t>()[0], 2);
+
+  remove(outfile_name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(log_converter_columnar_cuts_row_groups_on_bytes) {
+  std::string outfile_name =
+      get_test_files_location() + "/test_outputs/columnar_bytes.columnar";
+  const std::string context(100, 'x');
+  {
+    // two rows of contexts per row group
+    log_converter::columnar_writer writer(
+        outfile_name, log_converter::columnar_writer::DEFAULT_ROWS_PER_GROUP,
+        2 * context.size());
+    for (int i = 0; i < 5; ++i) {
+      auto cb = VW::make_unique<joined_event::cb_joined_event>();
+      cb->interaction_data.actions = {1, 2};
+      cb->interaction_data.probabilities = {0.5f, 0.5f};
+      writer.write(joined_event::joined_event(
+          TimePoint(),
+          {"", v2::PayloadType_CB, 1.f, v2::EventEncoding_Identity,
+           std::to_string(i), v2::LearningModeType_Online},
+          std::string(context), "model", std::move(cb)));
+    }
+  }
+
+  namespace columnar = log_converter::columnar;
+  log_converter::columnar_reader reader;
+  BOOST_REQUIRE(reader.open(outfile_name));
+  BOOST_REQUIRE_EQUAL(reader.row_group_count(), 3);
+
+  columnar::column_data column;
+  BOOST_REQUIRE(reader.read_column(1, columnar::column_id::context, column));
+  BOOST_CHECK_EQUAL(column.rows, 2);
+  BOOST_CHECK_EQUAL(column.string_at(1), context);
+  BOOST_REQUIRE(reader.read_column(2, columnar::column_id::event_id, column));
+  BOOST_CHECK_EQUAL(column.rows, 1);
+  BOOST_CHECK_EQUAL(column.string_at(0), "4");
+
+  remove(outfile_name.c_str());
+}
@@ -125,4 +125,104 @@ BOOST_AUTO_TEST_CASE(test_lru_update) {
 
   clear_examples(examples, vw);
   VW::finish(*vw);
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(test_lru_remove_evicted_examples) {
+  auto vw = VW::initialize("--cb_explore_adf --binary_parser --quiet", nullptr,
+                           false, nullptr, nullptr);
+
+  v_array<example *> examples;
+  examples.push_back(&VW::get_unused_example(vw));
+  examples.push_back(&VW::get_unused_example(vw));
+  uint64_t dedup_id_0 = 0;
+  uint64_t dedup_id_1 = 1;
+
+  lru_dedup_cache dedup_cache;
+  dedup_cache.add(dedup_id_0, examples[0]);
+  dedup_cache.add(dedup_id_1, examples[1]);
+
+  // eviction records drop a single example and leave the rest in place
+  dedup_cache.remove(dedup_id_1);
+  BOOST_CHECK_EQUAL(dedup_cache.exists(dedup_id_0), true);
+  BOOST_CHECK_EQUAL(dedup_cache.exists(dedup_id_1), false);
+  BOOST_CHECK_EQUAL(dedup_cache.lru.size(), 1);
+
+  // unknown ids are ignored
+  dedup_cache.remove(dedup_id_1);
+  BOOST_CHECK_EQUAL(dedup_cache.dedup_examples.size(), 1);
+
+  clear_examples(examples, vw);
+  VW::finish(*vw);
+}
+
+BOOST_AUTO_TEST_CASE(test_lru_expand_text_objects) {
+  lru_dedup_cache dedup_cache;
+  // slot and shared namespace ids have their target in the top byte
+  uint64_t shared_id = (2ULL << 56) | 7;
+  uint64_t slot_id = (1ULL << 56) | 8;
+  std::string shared = R"({"id":"a"})";
+  std::string slot = R"({"s":1})";
+  dedup_cache.add_text(shared_id, shared.c_str(), shared.size());
+  dedup_cache.add_text(slot_id, slot.c_str(), slot.size());
+  BOOST_CHECK_EQUAL(dedup_cache.exists(shared_id), true);
+
+  std::string context = R"({"User":{"__aid":)" + std::to_string(shared_id) +
+                        R"(},"_multi":[{"__aid":5}],"_slots":[{"__aid":)" +
+                        std::to_string(slot_id) + "}]}";
+  BOOST_CHECK_EQUAL(dedup_cache.expand_texts(context), true);
+  // action references are left for the json parser
+  BOOST_CHECK_EQUAL(
+      context,
+      R"({"User":{"id":"a"},"_multi":[{"__aid":5}],"_slots":[{"s":1}]})");
+
+  // evicted text objects can't be expanded anymore
+  dedup_cache.remove(slot_id);
+  BOOST_CHECK_EQUAL(dedup_cache.dedup_texts.size(), 1);
+  std::string missing = R"({"_slots":[{"__aid":)" + std::to_string(slot_id) + "}]}";
+  BOOST_CHECK_EQUAL(dedup_cache.expand_texts(missing), false);
+}
+
+BOOST_AUTO_TEST_CASE(test_lru_objects_held_by_clients) {
+  auto vw = VW::initialize("--cb_explore_adf --binary_parser --quiet", nullptr,
+                           false, nullptr, nullptr);
+
+  v_array<example *> examples;
+  examples.push_back(&VW::get_unused_example(vw));
+  examples.push_back(&VW::get_unused_example(vw));
+  examples.push_back(&VW::get_unused_example(vw));
+  uint64_t dedup_id_0 = 0;
+  uint64_t dedup_id_1 = 1;
+  uint64_t dedup_id_2 = 2;
+  uint64_t client_a = 10;
+  uint64_t client_b = 11;
+
+  lru_dedup_cache dedup_cache;
+  dedup_cache.add(dedup_id_0, examples[0]);
+  dedup_cache.add(dedup_id_1, examples[1]);
+  dedup_cache.hold(client_a, dedup_id_0);
+  dedup_cache.hold(client_a, dedup_id_1);
+  dedup_cache.hold(client_b, dedup_id_0);
+  // holding twice counts once
+  dedup_cache.hold(client_b, dedup_id_0);
+
+  // client b still holds the object client a evicted
+  dedup_cache.release(client_a, dedup_id_0);
+  BOOST_CHECK_EQUAL(dedup_cache.exists(dedup_id_0), true);
+  dedup_cache.release(client_b, dedup_id_0);
+  BOOST_CHECK_EQUAL(dedup_cache.exists(dedup_id_0), false);
+
+  // a full payload of another client doesn't clear held objects
+  dedup_cache.add(dedup_id_2, examples[2]);
+  dedup_cache.clear_after(dedup_id_2);
+  BOOST_CHECK_EQUAL(dedup_cache.exists(dedup_id_1), true);
+
+  // a full payload of client a releases what it doesn't list
+  dedup_cache.hold(client_a, dedup_id_2);
+  dedup_cache.release_others(client_a, {dedup_id_2});
+  BOOST_CHECK_EQUAL(dedup_cache.exists(dedup_id_1), false);
+  BOOST_CHECK_EQUAL(dedup_cache.exists(dedup_id_2), true);
+  BOOST_CHECK_EQUAL(dedup_cache.lru.size(), 1);
+  BOOST_CHECK_EQUAL(dedup_cache.holders.size(), 1);
+
+  clear_examples(examples, vw);
+  VW::finish(*vw);
+}
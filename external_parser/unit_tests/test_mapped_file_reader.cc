@@ -0,0 +1,84 @@
+#include "mapped_file_reader.h"
+#include "parse_example_binary.h"
+#include "test_common.h"
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+
+namespace {
+void write_file(const std::string &file_name, const std::vector<char> &buffer) {
+  std::ofstream file(file_name, std::ios::binary);
+  file.write(buffer.data(), buffer.size());
+}
+
+void append_uint32(std::vector<char> &buffer, uint32_t value) {
+  const char *bytes = reinterpret_cast<const char *>(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(mapped_file_reader_reads_messages_in_place) {
+  std::string file_name =
+      get_test_files_location() + "/test_outputs/mapped_messages.fb";
+
+  std::vector<char> buffer;
+  append_uint32(buffer, MSG_TYPE_FILEMAGIC);
+  append_uint32(buffer, BINARY_PARSER_VERSION);
+  append_uint32(buffer, MSG_TYPE_REGULAR);
+  append_uint32(buffer, 4);
+  append_uint32(buffer, 0x01020304);
+  // padding of a 4 bytes payload
+  append_uint32(buffer, 0);
+  append_uint32(buffer, MSG_TYPE_EOF);
+  write_file(file_name, buffer);
+
+  VW::external::mapped_file_reader reader;
+  BOOST_REQUIRE(reader.open(file_name));
+  BOOST_CHECK_EQUAL(reader.size(), buffer.size());
+
+  unsigned int payload_type;
+  const char *payload;
+  uint32_t payload_size;
+  BOOST_REQUIRE(reader.next(payload_type, payload, payload_size));
+  BOOST_CHECK_EQUAL(payload_type, MSG_TYPE_FILEMAGIC);
+  BOOST_CHECK_EQUAL(static_cast<size_t>(*payload), BINARY_PARSER_VERSION);
+
+  BOOST_REQUIRE(reader.next(payload_type, payload, payload_size));
+  BOOST_CHECK_EQUAL(payload_type, MSG_TYPE_REGULAR);
+  BOOST_CHECK_EQUAL(payload_size, 4);
+  BOOST_CHECK_EQUAL(*reinterpret_cast<const uint32_t *>(payload), 0x01020304);
+  // payloads of aligned files are aligned in the mapping
+  BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(payload) % 8, 0);
+
+  BOOST_REQUIRE(reader.next(payload_type, payload, payload_size));
+  BOOST_CHECK_EQUAL(payload_type, MSG_TYPE_EOF);
+
+  std::remove(file_name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(mapped_file_reader_truncated_payload) {
+  std::string file_name =
+      get_test_files_location() + "/test_outputs/mapped_truncated.fb";
+
+  std::vector<char> buffer;
+  append_uint32(buffer, MSG_TYPE_REGULAR);
+  append_uint32(buffer, 16);
+  append_uint32(buffer, 0);
+  write_file(file_name, buffer);
+
+  VW::external::mapped_file_reader reader;
+  BOOST_REQUIRE(reader.open(file_name));
+
+  unsigned int payload_type;
+  const char *payload;
+  uint32_t payload_size;
+  BOOST_CHECK_EQUAL(reader.next(payload_type, payload, payload_size), false);
+
+  std::remove(file_name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(mapped_file_reader_missing_file) {
+  VW::external::mapped_file_reader reader;
+  BOOST_CHECK_EQUAL(
+      reader.open(get_test_files_location() + "/does_not_exist.fb"), false);
+}
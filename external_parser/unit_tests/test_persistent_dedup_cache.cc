@@ -0,0 +1,220 @@
+#include "persistent_dedup_cache.h"
+#include "test_common.h"
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+const std::string json_0 = R"({"A":{"f":0.2}})";
+const std::string json_1 = R"({"B":{"g":0.5,"h":1}})";
+
+example *new_example(v_array<example *> &examples, vw *vw) {
+  examples.push_back(&VW::get_unused_example(vw));
+  return examples.back();
+}
+
+// a parsed action as the json parser would leave it
+void fill_example(example &ex, unsigned char ns, size_t features) {
+  ex.indices.push_back(ns);
+  for (size_t i = 0; i < features; ++i) {
+    ex.feature_space[ns].indicies.push_back(100 + i);
+    ex.feature_space[ns].values.push_back(0.5f * (i + 1));
+    ex.feature_space[ns].sum_feat_sq += 0.25f * (i + 1) * (i + 1);
+  }
+}
+
+void check_example(example &ex, unsigned char ns, size_t features) {
+  BOOST_REQUIRE_EQUAL(ex.indices.size(), 1);
+  BOOST_CHECK_EQUAL(ex.indices[0], ns);
+  auto &fs = ex.feature_space[ns];
+  BOOST_REQUIRE_EQUAL(fs.values.size(), features);
+  BOOST_REQUIRE_EQUAL(fs.indicies.size(), features);
+  float sum_feat_sq = 0.f;
+  for (size_t i = 0; i < features; ++i) {
+    BOOST_CHECK_EQUAL(fs.indicies[i], 100 + i);
+    BOOST_CHECK_EQUAL(fs.values[i], 0.5f * (i + 1));
+    sum_feat_sq += 0.25f * (i + 1) * (i + 1);
+  }
+  BOOST_CHECK_EQUAL(fs.sum_feat_sq, sum_feat_sq);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(persistent_dedup_cache_restores_across_runs) {
+  const std::string cache_file = "persistent_dedup_cache_test.cache";
+  std::remove(cache_file.c_str());
+  auto vw = VW::initialize("--cb_explore_adf --binary_parser --quiet", nullptr,
+                           false, nullptr, nullptr);
+  v_array<example *> examples;
+
+  {
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    auto *ex = new_example(examples, vw);
+    BOOST_CHECK(!cache.restore(0, json_0.c_str(), json_0.size(), *ex));
+    fill_example(*ex, 'A', 3);
+    cache.store(0, json_0.c_str(), json_0.size(), *ex);
+
+    // stored by this run, read back from the file
+    auto *restored = new_example(examples, vw);
+    BOOST_REQUIRE(cache.restore(0, json_0.c_str(), json_0.size(), *restored));
+    check_example(*restored, 'A', 3);
+    BOOST_CHECK_EQUAL(cache.stores(), 1);
+    BOOST_CHECK_EQUAL(cache.hits(), 1);
+  }
+
+  {
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    BOOST_CHECK_EQUAL(cache.entries(), 1);
+    auto *ex = new_example(examples, vw);
+    BOOST_REQUIRE(cache.restore(0, json_0.c_str(), json_0.size(), *ex));
+    check_example(*ex, 'A', 3);
+
+    // same id for another JSON
+    ex = new_example(examples, vw);
+    BOOST_CHECK(!cache.restore(0, json_1.c_str(), json_1.size(), *ex));
+    BOOST_CHECK_EQUAL(ex->indices.size(), 0);
+    fill_example(*ex, 'B', 2);
+    cache.store(1, json_1.c_str(), json_1.size(), *ex);
+  }
+
+  {
+    // other hashing parameters don't see the entries
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "other params"));
+    BOOST_CHECK_EQUAL(cache.entries(), 0);
+  }
+
+  {
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    BOOST_CHECK_EQUAL(cache.entries(), 2);
+    auto *ex = new_example(examples, vw);
+    BOOST_REQUIRE(cache.restore(1, json_1.c_str(), json_1.size(), *ex));
+    check_example(*ex, 'B', 2);
+  }
+
+  clear_examples(examples, vw);
+  VW::finish(*vw);
+  std::remove(cache_file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(persistent_dedup_cache_recovers_from_a_truncated_file) {
+  const std::string cache_file = "persistent_dedup_cache_truncated.cache";
+  std::remove(cache_file.c_str());
+  auto vw = VW::initialize("--cb_explore_adf --binary_parser --quiet", nullptr,
+                           false, nullptr, nullptr);
+  v_array<example *> examples;
+
+  {
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    auto *ex = new_example(examples, vw);
+    fill_example(*ex, 'A', 3);
+    cache.store(0, json_0.c_str(), json_0.size(), *ex);
+  }
+  {
+    // a run stopped in the middle of a record
+    std::ofstream file(cache_file, std::ios::binary | std::ios::app);
+    file.write("VDCR\x10\x00", 6);
+  }
+
+  {
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    BOOST_CHECK_EQUAL(cache.entries(), 1);
+    auto *ex = new_example(examples, vw);
+    fill_example(*ex, 'B', 2);
+    // written over the partial record
+    cache.store(1, json_1.c_str(), json_1.size(), *ex);
+  }
+
+  {
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    BOOST_CHECK_EQUAL(cache.entries(), 2);
+    auto *ex = new_example(examples, vw);
+    BOOST_REQUIRE(cache.restore(1, json_1.c_str(), json_1.size(), *ex));
+    check_example(*ex, 'B', 2);
+  }
+
+  clear_examples(examples, vw);
+  VW::finish(*vw);
+  std::remove(cache_file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(persistent_dedup_cache_appends_to_an_existing_cache) {
+  const std::string cache_file = "persistent_dedup_cache_existing.cache";
+  std::remove(cache_file.c_str());
+  auto vw = VW::initialize("--cb_explore_adf --binary_parser --quiet", nullptr,
+                           false, nullptr, nullptr);
+  v_array<example *> examples;
+
+  {
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    auto *ex = new_example(examples, vw);
+    fill_example(*ex, 'A', 3);
+    cache.store(0, json_0.c_str(), json_0.size(), *ex);
+  }
+
+  {
+    // the file is mapped and written to at the same time
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    BOOST_CHECK(cache.enabled());
+    auto *ex = new_example(examples, vw);
+    fill_example(*ex, 'B', 2);
+    cache.store(1, json_1.c_str(), json_1.size(), *ex);
+    BOOST_CHECK_EQUAL(cache.stores(), 1);
+
+    ex = new_example(examples, vw);
+    BOOST_REQUIRE(cache.restore(0, json_0.c_str(), json_0.size(), *ex));
+    check_example(*ex, 'A', 3);
+    ex = new_example(examples, vw);
+    BOOST_REQUIRE(cache.restore(1, json_1.c_str(), json_1.size(), *ex));
+    check_example(*ex, 'B', 2);
+  }
+
+  {
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    BOOST_CHECK_EQUAL(cache.entries(), 2);
+  }
+
+  clear_examples(examples, vw);
+  VW::finish(*vw);
+  std::remove(cache_file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(persistent_dedup_cache_writes_over_another_file) {
+  const std::string cache_file = "persistent_dedup_cache_other.cache";
+  {
+    std::ofstream file(cache_file, std::ios::binary | std::ios::trunc);
+    file << "not a dedup cache";
+  }
+  auto vw = VW::initialize("--cb_explore_adf --binary_parser --quiet", nullptr,
+                           false, nullptr, nullptr);
+  v_array<example *> examples;
+
+  {
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    BOOST_CHECK_EQUAL(cache.entries(), 0);
+    auto *ex = new_example(examples, vw);
+    fill_example(*ex, 'A', 3);
+    cache.store(0, json_0.c_str(), json_0.size(), *ex);
+  }
+
+  {
+    persistent_dedup_cache cache;
+    BOOST_REQUIRE(cache.open(cache_file, "params"));
+    BOOST_CHECK_EQUAL(cache.entries(), 1);
+  }
+
+  clear_examples(examples, vw);
+  VW::finish(*vw);
+  std::remove(cache_file.c_str());
+}
@@ -557,3 +557,52 @@ BOOST_AUTO_TEST_CASE(sum)
   BOOST_CHECK_EQUAL(rewards.at(0), 2 + 2 + 5 + 2);
 }
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(reward_functions_over_outcome_values)
+BOOST_AUTO_TEST_CASE(more_outcomes_than_lanes)
+{
+  // 20 outcomes, 1 to 20 in reverse, plus an activation that doesn't count
+  std::vector<reward::outcome_event> outcome_events(21);
+  for (size_t i = 0; i < 20; ++i) {
+    outcome_events[i].value = static_cast<float>(20 - i);
+    outcome_events[i].enqueued_time_utc = TimePoint(std::chrono::seconds(20 - i));
+  }
+  outcome_events[20].action_taken = true;
+  outcome_events[20].enqueued_time_utc = TimePoint(std::chrono::seconds(0));
+
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::sum, outcome_events, DEFAULT_REWARD), 210);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::average, outcome_events, DEFAULT_REWARD), 10.5);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::min, outcome_events, DEFAULT_REWARD), 1);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::max, outcome_events, DEFAULT_REWARD), 20);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::median, outcome_events, DEFAULT_REWARD), 10.5);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::earliest, outcome_events, DEFAULT_REWARD), 1);
+
+  outcome_events.pop_back();
+  outcome_events.pop_back();
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::median, outcome_events, DEFAULT_REWARD), 11);
+}
+
+BOOST_AUTO_TEST_CASE(negative_outcomes)
+{
+  std::vector<reward::outcome_event> outcome_events(3);
+  outcome_events[0].value = -3;
+  outcome_events[1].value = -1;
+  outcome_events[2].value = -2;
+
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::min, outcome_events, DEFAULT_REWARD), -3);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::max, outcome_events, DEFAULT_REWARD), -1);
+}
+
+BOOST_AUTO_TEST_CASE(no_outcomes)
+{
+  std::vector<reward::outcome_event> outcome_events(1);
+  outcome_events[0].action_taken = true;
+
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::sum, outcome_events, DEFAULT_REWARD), DEFAULT_REWARD);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::average, outcome_events, DEFAULT_REWARD), DEFAULT_REWARD);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::min, outcome_events, DEFAULT_REWARD), DEFAULT_REWARD);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::max, outcome_events, DEFAULT_REWARD), DEFAULT_REWARD);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::median, outcome_events, DEFAULT_REWARD), DEFAULT_REWARD);
+  BOOST_CHECK_EQUAL(reward::calculate(&reward::earliest, outcome_events, DEFAULT_REWARD), DEFAULT_REWARD);
+}
+BOOST_AUTO_TEST_SUITE_END()
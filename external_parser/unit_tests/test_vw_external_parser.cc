@@ -309,6 +309,124 @@ BOOST_AUTO_TEST_CASE(slates_compare_dsjson_with_fb_models) {
                                 buffer_dsjson_model.end());
 }
 
+void generate_fb_model(const std::string &model_name,
+                       const std::string &vw_args,
+                       const std::string &file_name) {
+  std::remove(model_name.c_str());
+
+  auto vw = VW::initialize(vw_args + " --binary_parser --quiet -f " +
+                               model_name + " -d " + file_name,
+                           nullptr, false, nullptr, nullptr);
+  VW::start_parser(*vw);
+  VW::LEARNER::generic_driver(*vw);
+  VW::end_parser(*vw);
+
+  VW::finish(*vw);
+}
+
+BOOST_AUTO_TEST_CASE(cb_compare_fb_models_with_parser_threads) {
+  std::string input_files = get_test_files_location();
+
+  std::string model_name = input_files + "/test_outputs/m_average_threads";
+  std::string file_name =
+      input_files + "/valid_joined_logs/average_reward_100_interactions.fb";
+
+  generate_fb_model(model_name + ".inline", "--cb_explore_adf ", file_name);
+  generate_fb_model(model_name + ".threads",
+                    "--cb_explore_adf --binary_parser_threads 4 ", file_name);
+
+  // examples reach vw in the same order, so the models are the same
+  auto buffer_inline_model = read_file(model_name + ".inline");
+  auto buffer_threads_model = read_file(model_name + ".threads");
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(
+      buffer_inline_model.begin(), buffer_inline_model.end(),
+      buffer_threads_model.begin(), buffer_threads_model.end());
+}
+
+BOOST_AUTO_TEST_CASE(ca_compare_fb_models_with_parser_threads) {
+  std::string input_files = get_test_files_location();
+
+  std::string model_name = input_files + "/test_outputs/m_ca_threads";
+  std::string file_name = input_files + "/valid_joined_logs/ca_loop_simple.fb";
+  const std::string ca_args =
+      "--cats 4 --min_value 1 --max_value 100 --bandwidth 1 --id N/A ";
+
+  generate_fb_model(model_name + ".inline", ca_args, file_name);
+  // the workers parse the contexts
+  generate_fb_model(model_name + ".threads",
+                    ca_args + "--binary_parser_threads 2 ", file_name);
+
+  auto buffer_inline_model = read_file(model_name + ".inline");
+  auto buffer_threads_model = read_file(model_name + ".threads");
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(
+      buffer_inline_model.begin(), buffer_inline_model.end(),
+      buffer_threads_model.begin(), buffer_threads_model.end());
+}
+
+BOOST_AUTO_TEST_CASE(cb_compare_fb_models_with_mapped_file) {
+  std::string input_files = get_test_files_location();
+
+  std::string model_name = input_files + "/test_outputs/m_average_mmap";
+  std::string file_name =
+      input_files + "/valid_joined_logs/average_reward_100_interactions.fb";
+
+  generate_fb_model(model_name + ".inline", "--cb_explore_adf ", file_name);
+  generate_fb_model(model_name + ".mmap", "--cb_explore_adf --binary_parser_mmap ",
+                    file_name);
+  generate_fb_model(model_name + ".mmap_threads",
+                    "--cb_explore_adf --binary_parser_mmap --binary_parser_threads 2 ",
+                    file_name);
+
+  auto buffer_inline_model = read_file(model_name + ".inline");
+  auto buffer_mmap_model = read_file(model_name + ".mmap");
+  auto buffer_mmap_threads_model = read_file(model_name + ".mmap_threads");
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(
+      buffer_inline_model.begin(), buffer_inline_model.end(),
+      buffer_mmap_model.begin(), buffer_mmap_model.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(
+      buffer_inline_model.begin(), buffer_inline_model.end(),
+      buffer_mmap_threads_model.begin(), buffer_mmap_threads_model.end());
+}
+
+BOOST_AUTO_TEST_CASE(cb_dedup_compressed_with_parser_threads) {
+  std::string input_files = get_test_files_location();
+
+  auto buffer =
+      read_file(input_files + "/valid_joined_logs/cb_dedup_compressed.log");
+
+  auto vw = VW::initialize(
+      "--cb_explore_adf --binary_parser --binary_parser_threads 2 --quiet",
+      nullptr, false, nullptr, nullptr);
+
+  v_array<example *> examples;
+  examples.push_back(&VW::get_unused_example(vw));
+  set_buffer_as_vw_input(buffer, vw);
+
+  size_t read_payloads = 0;
+  while (vw->example_parser->reader(vw, vw->example_parser->input, examples) > 0) {
+    ++read_payloads;
+    BOOST_CHECK_EQUAL(examples.size(), 4);
+    BOOST_CHECK_EQUAL(examples[0]->indices.size(), 1);
+    BOOST_CHECK_EQUAL(examples[0]->indices[0], 'G');
+    BOOST_CHECK_EQUAL(examples[1]->indices.size(), 1);
+    BOOST_CHECK_EQUAL(examples[1]->indices[0], 'T');
+    BOOST_CHECK_EQUAL(examples[2]->indices.size(), 1);
+    BOOST_CHECK_EQUAL(examples[2]->indices[0], 'T');
+    BOOST_CHECK_EQUAL(examples[3]->indices.size(), 0); // newline example
+
+    clear_examples(examples, vw);
+    examples.push_back(&VW::get_unused_example(vw));
+  }
+
+  BOOST_CHECK_GT(read_payloads, 0);
+
+  clear_examples(examples, vw);
+  VW::finish(*vw);
+}
+
 BOOST_AUTO_TEST_CASE(slates_skip_learn_w_activations) {
   std::string input_files = get_test_files_location();
 
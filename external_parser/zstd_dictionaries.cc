@@ -0,0 +1,52 @@
+#include "zstd_dictionaries.h"
+
+#include "zstd.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+zstd_dictionaries &zstd_dictionaries::instance() {
+  static zstd_dictionaries dictionaries;
+  return dictionaries;
+}
+
+uint32_t zstd_dictionaries::load(const std::string &file_name) {
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file.good()) {
+    throw std::runtime_error("Unable to open zstd dictionary: " + file_name);
+  }
+  std::vector<char> dict((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+
+  uint32_t dictionary_id = ZSTD_getDictID_fromDict(dict.data(), dict.size());
+  if (dictionary_id == 0) {
+    throw std::runtime_error("Not a zstd dictionary: " + file_name);
+  }
+
+  ZSTD_DDict *ddict = ZSTD_createDDict(dict.data(), dict.size());
+  if (ddict == nullptr) {
+    throw std::runtime_error("Unable to digest zstd dictionary: " + file_name);
+  }
+
+  auto it = ddicts.find(dictionary_id);
+  if (it != ddicts.end()) {
+    ZSTD_freeDDict(it->second);
+    it->second = ddict;
+  } else {
+    ddicts.emplace(dictionary_id, ddict);
+  }
+  return dictionary_id;
+}
+
+const ZSTD_DDict *zstd_dictionaries::get(uint32_t dictionary_id) const {
+  auto it = ddicts.find(dictionary_id);
+  return it == ddicts.end() ? nullptr : it->second;
+}
+
+zstd_dictionaries::~zstd_dictionaries() {
+  for (auto &entry : ddicts) {
+    ZSTD_freeDDict(entry.second);
+  }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+struct ZSTD_DDict_s;
+
+/*
+Zstd dictionaries used by the client to compress event payloads, indexed by
+dictionary id.
+Events with the ZstdDictionary encoding carry the id of the dictionary they
+were compressed with in the zstd frame header, so all dictionaries a loop has
+been using must be loaded before parsing its logs.
+*/
+struct zstd_dictionaries {
+  std::unordered_map<uint32_t, ZSTD_DDict_s *> ddicts;
+
+public:
+  // dictionaries are shared by all the joiners of the process
+  static zstd_dictionaries &instance();
+
+  // throws if the file can't be read or isn't a zstd dictionary
+  uint32_t load(const std::string &file_name);
+  // returns nullptr if the dictionary is unknown
+  const ZSTD_DDict_s *get(uint32_t dictionary_id) const;
+
+  zstd_dictionaries() = default;
+  ~zstd_dictionaries();
+  zstd_dictionaries(const zstd_dictionaries &) = delete;
+  zstd_dictionaries(zstd_dictionaries &&) = delete;
+  zstd_dictionaries &operator=(const zstd_dictionaries &) = delete;
+  zstd_dictionaries &operator=(zstd_dictionaries &&) = delete;
+};
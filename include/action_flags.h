@@ -10,6 +10,10 @@
 namespace reinforcement_learning {
   enum action_flags {
     DEFAULT = 0,
-    DEFERRED = 1
+    DEFERRED = 1,
+    //! Queue the interaction in the low priority lane, pruned first under overload (v2 only)
+    PRIORITY_LOW = 2,
+    //! Queue the interaction in the high priority lane, pruned last under overload (v2 only)
+    PRIORITY_HIGH = 4
   };
 }
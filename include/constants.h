@@ -28,6 +28,7 @@ namespace reinforcement_learning {  namespace name {
       const char *const  INTERACTION_SENDER_IMPLEMENTATION    = "interaction.sender.implementation";
       const char *const  INTERACTION_USE_COMPRESSION = "interaction.send.use_compression";
       const char *const  INTERACTION_USE_DEDUP = "interaction.send.use_dedup";
+      const char *const  INTERACTION_USE_BATCH_COMPRESSION = "interaction.send.use_batch_compression";
       const char *const  INTERACTION_QUEUE_MODE = "interaction.queue.mode";
       const char *const  INTERACTION_HTTP_API_HOST = "interaction.http.api.host";
       const char *const  INTERACTION_APIM_TASKS_LIMIT = "interaction.apim.tasks_limit";
@@ -58,20 +59,39 @@ namespace reinforcement_learning {  namespace name {
       const char *const SEND_BATCH_INTERVAL_MS      = "send.batchintervalms";
       const char *const USE_COMPRESSION             = "send.use_compression";
       const char *const USE_DEDUP                   = "send.use_dedup";
+      const char *const USE_BATCH_COMPRESSION       = "send.use_batch_compression";
       const char *const QUEUE_MODE                  = "queue.mode";
+      const char *const QUEUE_BLOCK_TIMEOUT_MS      = "queue.block_timeout_ms";     // Longest wait of a BLOCK queue before the event is rejected, 0 (default) waits until there is room
       const char *const SUBSAMPLE_RATE              = "subsample.rate";
+      const char *const SEND_BATCH_TARGET_BYTES      = "send.batch.target_bytes";      // Batch size on the wire, 0 uses send.highwatermark instead
+      const char *const SEND_BATCH_MIN_INTERVAL_MS   = "send.batch.min_interval_ms";   // Shortest flush interval under load
+      const char *const SEND_BATCH_LATENCY_BUDGET_MS = "send.batch.latency_budget_ms"; // Upper bound of queueing + round trip time, 0 for none
+      const char *const COALESCE_OUTCOMES            = "send.coalesce_outcomes";       // Merge the numeric outcomes of an event id sent in the same batch (v2 only)
+      const char *const DEFERRED_SERIALIZATION       = "send.deferred_serialization";  // Build v2 interaction payloads on the batcher thread instead of the caller's
+      const char *const QUEUE_PRIORITY_CB            = "queue.priority.cb";            // Queue lane of v2 CB interactions: LOW, NORMAL (default) or HIGH
+      const char *const QUEUE_PRIORITY_CA            = "queue.priority.ca";            // Queue lane of v2 continuous action interactions
+      const char *const QUEUE_PRIORITY_MULTI_SLOT    = "queue.priority.multislot";     // Queue lane of v2 CCB and slates interactions
+      const char *const QUEUE_PRIORITY_DEFERRED      = "queue.priority.deferred";      // Queue lane of deferred interactions, overrides the payload type's
+      const char *const QUEUE_PRIORITY_APPRENTICE    = "queue.priority.apprentice";    // Queue lane of apprentice and logging only interactions, overrides the payload type's
+      const char *const METRICS_DUMP_INTERVAL_MS     = "metrics.dump_interval_ms";     // Period of the metrics dump to the trace logger, 0 (default) for none
 
       const char *const  EH_TEST                 = "eventhub.mock";
       const char *const  TRACE_LOG_IMPLEMENTATION = "trace.logger.implementation";
       const char *const  INTERACTION_FILE_NAME = "interaction.file.name";
       const char *const  OBSERVATION_FILE_NAME = "observation.file.name";
       const char *const  TIME_PROVIDER_IMPLEMENTATION = "time_provider.implementation";
+      const char *const  TIME_PROVIDER_PRECISION_US = "time_provider.precision_us"; // Sub second precision of COARSE_CLOCK_TIME_PROVIDER, default is 1000
       const char *const  HTTP_CLIENT_DISABLE_CERT_VALIDATION  = "http.certvalidation.disable";
       const char *const  HTTP_CLIENT_TIMEOUT                  = "http.timeout"; // Timeout is in seconds, default is 30.
       const char *const  MODEL_FILE_NAME                      = "model_file_loader.file_name";
       const char *const  MODEL_FILE_MUST_EXIST                = "model_file_loader.file_must_exist";
 
       const char *const ZSTD_COMPRESSION_LEVEL = "zstd.compression_level";
+      const char *const ZSTD_DICTIONARY_FILE = "zstd.dictionary.file";
+      const char *const ZSTD_DICTIONARY_ID = "zstd.dictionary.id";
+      const char *const DEDUP_LRU_CAPACITY = "dedup.lru.capacity"; // Objects kept by the joiner across batches, 0 disables cross batch dedup
+      const char *const DEDUP_LRU_REFRESH_BATCHES = "dedup.lru.refresh_batches"; // Resend the full dictionary every N batches, default is 100, 0 never does
+      const char *const DEDUP_TARGETS = "dedup.targets"; // Comma separated list of DEDUP_TARGET_* values, default is actions only
 }}
 
 namespace reinforcement_learning {  namespace value {
@@ -90,18 +110,30 @@ namespace reinforcement_learning {  namespace value {
       const char *const CONSOLE_TRACE_LOGGER = "CONSOLE_TRACE_LOGGER";
       const char *const NULL_TIME_PROVIDER = "NULL_TIME_PROVIDER";
       const char *const CLOCK_TIME_PROVIDER = "CLOCK_TIME_PROVIDER";
+      const char *const COARSE_CLOCK_TIME_PROVIDER = "COARSE_CLOCK_TIME_PROVIDER";
       const char *const LEARNING_MODE_ONLINE = "ONLINE";
       const char *const LEARNING_MODE_APPRENTICE = "APPRENTICE";
       const char *const LEARNING_MODE_LOGGINGONLY = "LOGGINGONLY";
       const char *const CONTENT_ENCODING_IDENTITY = "IDENTITY";
       const char *const CONTENT_ENCODING_DEDUP = "DEDUP";
+      const char *const CONTENT_ENCODING_ZSTD = "ZSTD";
+      const char *const CONTENT_ENCODING_DEDUP_ZSTD = "DEDUP_ZSTD";
+      const char *const DEDUP_TARGET_ACTIONS = "actions";
+      const char *const DEDUP_TARGET_SLOTS = "slots";
+      const char *const DEDUP_TARGET_SHARED = "shared";
 
       const char *const QUEUE_MODE_DROP = "DROP";
       const char *const QUEUE_MODE_BLOCK = "BLOCK";
+      const char *const QUEUE_MODE_NONBLOCKING = "NONBLOCKING";
+
+      const char *const QUEUE_PRIORITY_LOW = "LOW";
+      const char *const QUEUE_PRIORITY_NORMAL = "NORMAL";
+      const char *const QUEUE_PRIORITY_HIGH = "HIGH";
 
       const bool DEFAULT_MODEL_BACKGROUND_REFRESH = true;
       const int DEFAULT_VW_POOL_INIT_SIZE = 4;
       const int DEFAULT_PROTOCOL_VERSION = 1;
+      const int DEFAULT_DEDUP_LRU_REFRESH_BATCHES = 100;
 
       const char *get_default_observation_sender();
       const char *get_default_interaction_sender();
@@ -49,4 +49,5 @@ ERROR_CODE_DEFINITION(47, serialize_error, "Unknown error while serializing.")
 ERROR_CODE_DEFINITION(48, extension_error, "Error from extension: ")
 ERROR_CODE_DEFINITION(49, baseline_actions_not_defined, "Baseline Actions must be defined in apprentice mode")
 ERROR_CODE_DEFINITION(50, http_api_key_not_provided, "Http api key must be provided")
+ERROR_CODE_DEFINITION(51, logging_queue_full, "The logging queue is full, the event was not logged.")
 //! [Error Definitions]
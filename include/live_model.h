@@ -16,6 +16,8 @@
 #include "factory_resolver.h"
 #include "sender.h"
 #include "future_compat.h"
+#include "queue_status.h"
+#include "metrics_snapshot.h"
 
 #include <memory>
 
@@ -358,6 +360,33 @@ namespace reinforcement_learning {
      */
     int refresh_model(api_status* status = nullptr);
 
+    /**
+     * @brief Fill level of the interaction logging queue.
+     * With queue.mode set to NONBLOCKING, or BLOCK with queue.block_timeout_ms, decision calls don't wait for room in
+     * a full queue: the decision is returned as usual, the interaction isn't logged and the call returns
+     * error_code::logging_queue_full.
+     * @param queue  Fill level and rejected event count of the queue
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int get_interaction_queue_status(queue_status& queue, api_status* status = nullptr);
+
+    /**
+     * @brief Fill level of the observation logging queue.
+     * @param queue  Fill level and rejected event count of the queue
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int get_observation_queue_status(queue_status& queue, api_status* status = nullptr);
+
+    /**
+     * @brief Counters, gauges and latency histograms of the API calls, the logging queues, the senders and the model.
+     * @param metrics  Point in time copy of the metrics, keyed by name
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int get_metrics(metrics_snapshot& metrics, api_status* status = nullptr);
+
     /**
      * @brief Error callback function.
      * When live_model is constructed, a background error callback and a
@@ -0,0 +1,39 @@
+/**
+ * @brief metrics_snapshot definition.
+ *
+ * @file metrics_snapshot.h
+ * @date 2026-10-18
+ */
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace reinforcement_learning {
+  /**
+   * @brief Distribution of the values recorded by a histogram, latencies in microseconds and sizes in bytes.
+   * Percentiles are approximated by the upper bound of their bucket, within 12.5%.
+   */
+  struct histogram_summary {
+    uint64_t count = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+    double mean = 0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+  };
+
+  /**
+   * @brief Runtime metrics of a live_model, returned by live_model::get_metrics().
+   * Names are dot separated, e.g. "api.choose_rank_us" or "interaction.queue.bytes".
+   */
+  struct metrics_snapshot {
+    //! Monotonic counts since the live_model was created
+    std::map<std::string, uint64_t> counters;
+    //! Values sampled when the snapshot was taken, e.g. the queue depth
+    std::map<std::string, double> gauges;
+    std::map<std::string, histogram_summary> histograms;
+  };
+}
@@ -10,6 +10,9 @@
 namespace reinforcement_learning {
   class ranking_response;
   class api_status;
+  namespace utility {
+    class metrics_registry;
+  }
 }
 
 namespace reinforcement_learning { namespace model_management {
@@ -78,6 +81,8 @@ namespace reinforcement_learning { namespace model_management {
       virtual int request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) = 0;
       virtual int request_multi_slot_decision(const char* event_id, const std::vector<std::string>& slot_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) = 0;
       virtual model_type_t model_type() const = 0;
+      //! Adds the metrics of the model to the registry, called once before the model is used
+      virtual void register_metrics(utility::metrics_registry& registry) {}
       virtual ~i_model() = default;
     };
 }}
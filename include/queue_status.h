@@ -0,0 +1,35 @@
+/**
+ * @brief queue_status definition.
+ *
+ * @file queue_status.h
+ * @date 2026-10-18
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace reinforcement_learning {
+  /**
+   * @brief Fill level of a logging queue, returned by live_model::get_interaction_queue_status()
+   * and live_model::get_observation_queue_status().
+   */
+  struct queue_status {
+    //! Events waiting to be sent
+    size_t queued_events = 0;
+    //! Sum of the size estimates of the queued events
+    size_t queued_bytes = 0;
+    //! Configured capacity of the queue (send.queue.maxcapacity.kb)
+    size_t max_capacity_bytes = 0;
+    //! Events not logged because the queue was full, in NONBLOCKING mode or when a BLOCK wait timed out
+    uint64_t rejected_events = 0;
+
+    /**
+     * @brief queued_bytes over max_capacity_bytes. It can go slightly over 1 since the high priority
+     * lane has some headroom over the configured capacity.
+     */
+    float fill_ratio() const {
+      return max_capacity_bytes == 0 ? 0.f : static_cast<float>(queued_bytes) / static_cast<float>(max_capacity_bytes);
+    }
+  };
+}
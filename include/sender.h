@@ -1,6 +1,7 @@
 #pragma once
 #include "configuration.h"
 #include "data_buffer.h"
+#include <cstdint>
 #include <memory>
 namespace reinforcement_learning {
   class api_status;
@@ -9,6 +10,10 @@ namespace reinforcement_learning {
     using buffer = std::shared_ptr<utility::data_buffer>;
     virtual int init(const utility::configuration& config, api_status* status) = 0;
     int send(const buffer& data, api_status* status = nullptr) { return v_send(data, status); }
+    //! Recent average time between sending a buffer and its acknowledgement in ms, 0 if the sender doesn't measure it
+    virtual int round_trip_ms() const { return 0; }
+    //! Requests sent again after a failure since the sender was created, 0 if the sender doesn't retry
+    virtual uint64_t retry_count() const { return 0; }
     virtual ~i_sender() = default;
   protected:
     virtual int v_send(const buffer& data, api_status* status = nullptr) = 0;
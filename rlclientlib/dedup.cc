@@ -3,9 +3,10 @@
 #include "serialization/payload_serializer.h"
 #include "utility/context_helper.h"
 #include "utility/config_helper.h"
+#include "utility/metrics_registry.h"
 
-#include "zstd.h"
-#include <sstream>
+#include <cstring>
+#include <random>
 
 namespace reinforcement_learning
 {
@@ -13,29 +14,49 @@ namespace u = utility;
 namespace fb = flatbuffers;
 namespace l = reinforcement_learning::logger;
 
-dedup_dict::dict_entry::dict_entry(const char* data, size_t length) : _count(1),
-                                                                      _length(length),
-                                                                      _content(data, data + length)
+static generic_event::object_id_t hash_content(const char*start, size_t size)
 {
+  return uniform_hash(start, size, 0);
 }
 
-static generic_event::object_id_t hash_content(const char*start, size_t size)
+//! Writes value in decimal to buffer, which must hold 20 chars. Returns the number of chars written
+static size_t format_uint64(uint64_t value, char* buffer)
 {
-  return uniform_hash(start, size, 0);
+  char digits[20];
+  size_t count = 0;
+  do
+  {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  for (size_t i = 0; i < count; ++i)
+    buffer[i] = digits[count - i - 1];
+  return count;
 }
 
-generic_event::object_id_t dedup_dict::add_object(const char*start, size_t length)
+void dedup_dict::add_entry(stripe& s, generic_event::object_id_t hash, const char* start, size_t length)
 {
-  auto hash = hash_content(start, length);
-  auto it = _entries.find(hash);
-  if (it == _entries.end())
+  auto it = s._entries.find(hash);
+  if (it == s._entries.end())
   {
-    _entries.insert({ hash, dict_entry(start, length) });
+    dict_entry entry;
+    entry._count = 1;
+    entry._content = std::make_shared<const std::string>(start, length);
+    s._entries.insert({ hash, std::move(entry) });
   }
   else
   {
     ++it->second._count;
   }
+}
+
+generic_event::object_id_t dedup_dict::add_object(const char*start, size_t length)
+{
+  auto hash = hash_content(start, length);
+  auto& s = _stripes[stripe_index(hash)];
+  std::lock_guard<std::mutex> lock(s._mutex);
+  add_entry(s, hash, start, length);
   return hash;
 }
 
@@ -44,24 +65,42 @@ bool dedup_dict::remove_object(generic_event::object_id_t aid, size_t count)
   if (count < 1)
     return true;
 
-  auto it = _entries.find(aid);
-  if (it == _entries.end())
+  auto& s = _stripes[stripe_index(aid)];
+  std::lock_guard<std::mutex> lock(s._mutex);
+  auto it = s._entries.find(aid);
+  if (it == s._entries.end())
     return false;
 
   count = std::min(count, it->second._count);
   it->second._count -= count;
   if (!it->second._count)
-    _entries.erase(it);
+    s._entries.erase(it);
 
   return true;
 }
 
 string_view dedup_dict::get_object(generic_event::object_id_t aid) const
 {
-  auto it = _entries.find(aid);
-  if (it == _entries.end())
+  auto& s = _stripes[stripe_index(aid)];
+  std::lock_guard<std::mutex> lock(s._mutex);
+  auto it = s._entries.find(aid);
+  if (it == s._entries.end())
     return string_view();
-  return string_view(it->second._content.data(), it->second._length);
+  return string_view(it->second._content->data(), it->second._content->size());
+}
+
+bool dedup_dict::get_objects_size(const generic_event::object_list_t& object_ids, size_t& total_size)
+{
+  bool found_all = true;
+  for_each_by_stripe(object_ids.begin(), object_ids.end(),
+    [&](stripe& s, generic_event::object_list_t::const_iterator it) {
+      auto entry = s._entries.find(*it);
+      if (entry == s._entries.end())
+        found_all = false;
+      else
+        total_size += entry->second._content->size();
+    });
+  return found_all;
 }
 
 int dedup_dict::transform_payload_and_add_objects(const char* payload, std::string& edited_payload, generic_event::object_list_t& object_ids, api_status* status)
@@ -69,83 +108,196 @@ int dedup_dict::transform_payload_and_add_objects(const char* payload, std::stri
   u::ContextInfo context_info;
   RETURN_IF_FAIL(u::get_context_info(payload, context_info, nullptr, status));
 
-  edited_payload = payload;
+  static const char AID_PREFIX[] = "{\"__aid\":";
+  static const size_t AID_PREFIX_LENGTH = sizeof(AID_PREFIX) - 1;
+  //prefix, up to 20 digits and the closing brace
+  static const size_t MAX_REFERENCE_LENGTH = AID_PREFIX_LENGTH + 20 + 1;
+
+  //(range, target id bits) of the objects to extract, in payload order
+  std::vector<std::pair<std::pair<size_t, size_t>, generic_event::object_id_t>> objects;
+  auto add_target = [&](unsigned target, const u::ContextInfo::index_vector_t& ranges, generic_event::object_id_t id_bits) {
+    if (_targets & target)
+      for (auto& p : ranges)
+        objects.emplace_back(p, id_bits);
+  };
+  add_target(TARGET_ACTIONS, context_info.actions, 0);
+  add_target(TARGET_SLOTS, context_info.slots, SLOT_ID_BITS);
+  add_target(TARGET_SHARED, context_info.shared, SHARED_ID_BITS);
+  //ranges of different targets never overlap
+  if (_targets != TARGET_ACTIONS)
+    std::sort(objects.begin(), objects.end());
+
   object_ids.clear();
-  object_ids.reserve(context_info.actions.size());
+  object_ids.reserve(objects.size());
+
+  size_t objects_length = 0;
+  for (auto& o : objects)
+  {
+    object_ids.push_back(hash_content(&payload[o.first.first], o.first.second) | o.second);
+    objects_length += o.first.second;
+  }
 
-  size_t edit_offset = 0;
-  for (auto& p : context_info.actions)
+  //hashing happens outside the locks, then each stripe is locked once to add its objects
+  for_each_by_stripe(object_ids.cbegin(), object_ids.cend(),
+    [&](stripe& s, generic_event::object_list_t::const_iterator it) {
+      const auto& range = objects[it - object_ids.cbegin()].first;
+      add_entry(s, *it, &payload[range.first], range.second);
+    });
+
+  //single pass rewrite: copy the text between objects and append a reference in place of each object
+  const size_t payload_length = std::strlen(payload);
+  edited_payload.clear();
+  edited_payload.reserve(payload_length - objects_length + MAX_REFERENCE_LENGTH * objects.size());
+
+  size_t copied = 0;
+  char digits[20];
+  for (size_t i = 0; i < objects.size(); ++i)
   {
-    auto hash = add_object(&payload[p.first], p.second);
-    object_ids.push_back(hash);
-    std::stringstream replacement;
-    replacement << "{\"__aid\":";
-    replacement << hash << "}";
-    edited_payload.replace(p.first - edit_offset, p.second, replacement.str());
-
-    //adjust the edit position based on how many bytes were deleted.
-    edit_offset += p.second - replacement.tellp();
+    const auto& p = objects[i].first;
+    edited_payload.append(payload + copied, p.first - copied);
+    edited_payload.append(AID_PREFIX, AID_PREFIX_LENGTH);
+    edited_payload.append(digits, format_uint64(object_ids[i], digits));
+    edited_payload.push_back('}');
+    copied = p.first + p.second;
   }
+  edited_payload.append(payload + copied, payload_length - copied);
 
   return error_code::success;
 }
 
 size_t dedup_dict::size() const
 {
-  return _entries.size();
+  size_t count = 0;
+  for (auto& s : _stripes)
+  {
+    std::lock_guard<std::mutex> lock(s._mutex);
+    count += s._entries.size();
+  }
+  return count;
 }
 
 
-zstd_compressor::zstd_compressor(int level): _level(level) {}
-
-int zstd_compressor::compress(generic_event::payload_buffer_t& input, api_status* status) const
+static uint64_t new_client_id()
 {
-  size_t buff_size = ZSTD_compressBound(input.size());
-
-  std::unique_ptr<uint8_t[]> data(fb::DefaultAllocator().allocate(buff_size));
-  size_t res = ZSTD_compress(data.get(), buff_size, input.data(), input.size(), _level);
+  std::random_device device;
+  uint64_t id = 0;
+  while (id == 0)
+    id = (static_cast<uint64_t>(device()) << 32) | device();
+  return id;
+}
 
-  if(ZSTD_isError(res))
-    RETURN_ERROR_ARG(nullptr, status, compression_error, ZSTD_getErrorName(res));
+dedup_lru::dedup_lru(size_t capacity, size_t refresh_batches):
+  _capacity(capacity)
+  , _refresh_batches(refresh_batches)
+  , _client_id(new_client_id()) {}
 
-  auto data_ptr = data.release();
-  input = fb::DetachedBuffer(nullptr, false, data_ptr, 0, data_ptr, res);
-  return error_code::success;
+bool dedup_lru::contains(generic_event::object_id_t oid) const
+{
+  return _positions.find(oid) != _positions.end();
 }
 
-int zstd_compressor::decompress(generic_event::payload_buffer_t& buf, api_status* status) const
+void dedup_lru::ship(generic_event::object_list_t& ids, std::vector<string_view>& values, generic_event::object_list_t& evicted, bool& incremental)
 {
-  size_t buff_size = ZSTD_getFrameContentSize(buf.data(), buf.size());
-  if(buff_size == ZSTD_CONTENTSIZE_ERROR)
-    RETURN_ERROR_ARG(nullptr, status, compression_error, "Invalid compressed content.");
-  if(buff_size == ZSTD_CONTENTSIZE_UNKNOWN)
-    RETURN_ERROR_ARG(nullptr, status, compression_error, "Unknown compressed size.");
-
-  std::unique_ptr<uint8_t[]> data(fb::DefaultAllocator().allocate(buff_size));
-  size_t res = ZSTD_decompress(data.get(), buff_size, buf.data(), buf.size());
+  //the first batch and each refresh resend everything, so a joiner that missed a batch recovers
+  incremental = _batches > 0;
+  if (_refresh_batches > 0 && _batches % _refresh_batches == 0)
+    incremental = false;
+  ++_batches;
+  if (!incremental)
+  {
+    _lru.clear();
+    _positions.clear();
+  }
 
-  if(ZSTD_isError(res))
-    RETURN_ERROR_ARG(nullptr, status, compression_error, ZSTD_getErrorName(res));
+  size_t kept = 0;
+  for (size_t i = 0; i < ids.size(); ++i)
+  {
+    auto it = _positions.find(ids[i]);
+    if (it != _positions.end())
+    {
+      //already shipped, only refresh its position
+      _lru.splice(_lru.begin(), _lru, it->second);
+      continue;
+    }
+    _lru.push_front(ids[i]);
+    _positions.emplace(ids[i], _lru.begin());
+    ids[kept] = ids[i];
+    values[kept] = values[i];
+    ++kept;
+  }
+  const size_t batch_objects = ids.size();
+  ids.resize(kept);
+  values.resize(kept);
 
-  auto data_ptr = data.release();
-  buf = fb::DetachedBuffer(nullptr, false, data_ptr, 0, data_ptr, res);
-  return error_code::success;
+  //objects of this batch are all at the front
+  while (_lru.size() > (std::max)(_capacity, batch_objects))
+  {
+    evicted.push_back(_lru.back());
+    _positions.erase(_lru.back());
+    _lru.pop_back();
+  }
 }
 
-
-dedup_state::dedup_state(const utility::configuration& c, bool use_compression, bool use_dedup, i_time_provider* time_provider):
-  _compressor(c.get_int(name::ZSTD_COMPRESSION_LEVEL, zstd_compressor::ZSTD_DEFAULT_COMPRESSION_LEVEL))
+dedup_state::dedup_state(const utility::configuration& c, bool use_compression, bool use_dedup, i_time_provider* time_provider, bool use_batch_compression):
+  _lru(c.get_int(name::DEDUP_LRU_CAPACITY, 0), c.get_int(name::DEDUP_LRU_REFRESH_BATCHES, value::DEFAULT_DEDUP_LRU_REFRESH_BATCHES))
+  , _compressor(c.get_int(name::ZSTD_COMPRESSION_LEVEL, zstd_compressor::ZSTD_DEFAULT_COMPRESSION_LEVEL))
+  , _batch_compressor(c.get_int(name::ZSTD_COMPRESSION_LEVEL, zstd_compressor::ZSTD_DEFAULT_COMPRESSION_LEVEL))
   , _time_provider(time_provider)
   , _use_compression(use_compression)
   , _use_dedup(use_dedup)
+  , _use_batch_compression(use_batch_compression)
+{
+}
+
+static int parse_dedup_targets(const char* targets, unsigned& result, api_status* status)
 {
+  result = 0;
+  std::string list(targets);
+  size_t start = 0;
+  while (start <= list.size())
+  {
+    size_t end = list.find(',', start);
+    if (end == std::string::npos)
+      end = list.size();
+    const auto target = list.substr(start, end - start);
+    if (target == value::DEDUP_TARGET_ACTIONS)
+      result |= dedup_dict::TARGET_ACTIONS;
+    else if (target == value::DEDUP_TARGET_SLOTS)
+      result |= dedup_dict::TARGET_SLOTS;
+    else if (target == value::DEDUP_TARGET_SHARED)
+      result |= dedup_dict::TARGET_SHARED;
+    else {
+      RETURN_ERROR_LS(nullptr, status, invalid_argument) << name::DEDUP_TARGETS << " has an unknown target: " << target;
+    }
+    start = end + 1;
+  }
+  return error_code::success;
+}
+
+int dedup_state::init(const utility::configuration& c, api_status* status) {
+  unsigned targets;
+  RETURN_IF_FAIL(parse_dedup_targets(c.get(name::DEDUP_TARGETS, value::DEDUP_TARGET_ACTIONS), targets, status));
+  _dict.set_targets(targets);
+
+  const char* dictionary_file = c.get(name::ZSTD_DICTIONARY_FILE, nullptr);
+  if(!_use_compression || dictionary_file == nullptr)
+    return error_code::success;
+  //batches are not compressed with the dictionary, it's trained on individual payloads
+  return _compressor.load_dictionary(dictionary_file, static_cast<uint32_t>(c.get_int(name::ZSTD_DICTIONARY_ID, 0)), status);
+}
+
+const zstd_compressor* dedup_state::get_batch_compressor() const {
+  return _use_batch_compression ? &_batch_compressor : nullptr;
 }
 
 string_view dedup_state::get_object(generic_event::object_id_t aid) {
-  std::unique_lock<std::mutex> mlock(_mutex);
   return _dict.get_object(aid);
 }
 
+bool dedup_state::get_objects_size(const generic_event::object_list_t& object_ids, size_t& total_size) {
+  return _dict.get_objects_size(object_ids, total_size);
+}
+
 float dedup_state::get_ewma_value() const {
   return _ewma.value();
 }
@@ -158,7 +310,7 @@ void dedup_state::update_ewma(float value)
 
 int dedup_state::compress(generic_event::payload_buffer_t& input, event_content_type& content_type, api_status* status) const {
   if(_use_compression) {
-    content_type = event_content_type::ZSTD;
+    content_type = _compressor.get_dictionary_id() != 0 ? event_content_type::ZSTD_DICTIONARY : event_content_type::ZSTD;
     return _compressor.compress(input, status);
   }
   content_type = event_content_type::IDENTITY;
@@ -170,7 +322,6 @@ int dedup_state::transform_payload_and_add_objects(const char* payload, std::str
     edited_payload = payload;
     return error_code::success;
   } else {
-    std::unique_lock<std::mutex> mlock(_mutex);
     return _dict.transform_payload_and_add_objects(payload, edited_payload, object_ids, status);
   }
 }
@@ -181,22 +332,31 @@ action_dict_builder::action_dict_builder(dedup_state& state):
 
 int action_dict_builder::add(const generic_event::object_list_t& object_ids, api_status* status)
 {
+  //only objects new to this batch dictionary need their size, which is looked up with one lock per stripe.
+  //objects the joiner kept from previous batches are not sent again
+  auto& lru = _state.get_lru();
+  _new_objects.clear();
   for(auto aid : object_ids) {
     auto it = _used_objects.find(aid);
     if (it == _used_objects.end())
     {
-      auto content = _state.get_object(aid);
-      if(content.size() == 0) {
-        RETURN_ERROR_LS(nullptr, status, compression_error) << "Key not found while processing event into batch dictionary";
-      }
       _used_objects.insert({ aid, 1 });
-      _size_estimate += sizeof(size_t) + content.size();
+      if(!lru.enabled() || !lru.contains(aid))
+        _new_objects.push_back(aid);
     }
     else
     {
       ++it->second;
     }
   }
+
+  size_t content_size = 0;
+  if(!_state.get_objects_size(_new_objects, content_size)) {
+    for(auto aid : _new_objects)
+      _used_objects.erase(aid);
+    RETURN_ERROR_LS(nullptr, status, compression_error) << "Key not found while processing event into batch dictionary";
+  }
+  _size_estimate += sizeof(size_t) * _new_objects.size() + content_size;
   return error_code::success;
 }
 
@@ -211,12 +371,20 @@ int action_dict_builder::finalize(generic_event& evt, api_status* status)
   generic_event::object_list_t action_ids;
   const auto now = _state.get_time_provider() != nullptr ? _state.get_time_provider()->gmt_now() : timestamp();
   std::vector<string_view> action_values;
-
-  RETURN_IF_FAIL(_state.get_all_values(_used_objects.begin(), _used_objects.end(), action_ids, action_values, status));
-  auto payload = ser.event(action_ids, action_values);
-
-  //remove used actions from the dictionary
-  RETURN_IF_FAIL(_state.remove_all_values(_used_objects.begin(), _used_objects.end(), status));
+  //keeps the action contents alive until they are serialized
+  std::vector<dedup_dict::content_ptr_t> contents;
+
+  //collect the used actions and release them from the dictionary, taking each stripe lock once
+  RETURN_IF_FAIL(_state.extract_all_values(_used_objects.begin(), _used_objects.end(), action_ids, action_values, contents, status));
+
+  generic_event::object_list_t evicted_ids;
+  bool incremental = false;
+  uint64_t client_id = 0;
+  if(_state.get_lru().enabled()) {
+    _state.get_lru().ship(action_ids, action_values, evicted_ids, incremental);
+    client_id = _state.get_lru().client_id();
+  }
+  auto payload = ser.event(action_ids, action_values, incremental, evicted_ids.empty() ? nullptr : &evicted_ids, client_id);
 
   //compress the payload
   event_content_type content_type;
@@ -248,7 +416,7 @@ struct dedup_collection_serializer
   static int message_id() { return logger::message_type::fb_generic_event_collection; }
 
   dedup_collection_serializer(buffer_t& buffer, const char* content_encoding, shared_state_t& state)
-      : _dummy(0), _ser(buffer, content_encoding, _dummy), _state(state), _builder(state) {}
+      : _state(state), _builder(state), _ser(buffer, content_encoding, state.get_batch_compressor()) {}
 
   int add(event_t& evt, api_status* status = nullptr)
   {
@@ -269,26 +437,35 @@ struct dedup_collection_serializer
     return error_code::success;
   }
 
-  int _dummy;
   shared_state_t& _state;
   action_dict_builder _builder;
   logger::fb_collection_serializer<event_t> _ser;
 };
 
+template <typename event_t>
+struct batch_compressed_collection_serializer : logger::fb_collection_serializer<event_t>
+{
+  using shared_state_t = dedup_state;
+
+  batch_compressed_collection_serializer(typename logger::fb_collection_serializer<event_t>::buffer_t& buffer, const char* content_encoding, shared_state_t& state)
+      : logger::fb_collection_serializer<event_t>(buffer, content_encoding, state.get_batch_compressor()) {}
+};
+
 class dedup_extensions : public logger::i_logger_extensions
 {
 public:
-  dedup_extensions(const utility::configuration& c, bool use_compression, bool use_dedup, i_time_provider* time_provider) :
+  dedup_extensions(const utility::configuration& c, bool use_compression, bool use_dedup, bool use_batch_compression, i_time_provider* time_provider) :
     logger::i_logger_extensions(c),
     _dedup_state(c,
                  use_compression,
                  use_dedup,
-                 time_provider
+                 time_provider,
+                 use_batch_compression
     ),
-    _use_dedup(use_dedup),
-    _use_compression(use_compression) {}
+    _use_compression(use_compression),
+    _use_dedup(use_dedup) {}
 
-  logger::i_async_batcher<generic_event>* create_batcher(logger::i_message_sender* sender, utility::watchdog& watchdog,
+  logger::i_async_batcher<logger::event_record<generic_event>>* create_batcher(logger::i_message_sender* sender, utility::watchdog& watchdog,
                                                          error_callback_fn* perror_cb, const char* section) override {
     auto config = utility::get_batcher_config(_config, section);
 
@@ -300,15 +477,24 @@ public:
           perror_cb,
           config);
     } else {
-      return new logger::async_batcher<generic_event, logger::fb_collection_serializer>(
+      return new logger::async_batcher<generic_event, batch_compressed_collection_serializer>(
           sender,
           watchdog,
-          _dummy_state,
+          _dedup_state,
           perror_cb,
           config);
     }
   }
 
+  int init(api_status* status) override {
+    return _dedup_state.init(_config, status);
+  }
+
+  void register_metrics(utility::metrics_registry& registry) override {
+    // Ratio of the serialized to the original size of recent batches
+    registry.add_gauge("interaction.dedup.compression_ratio", [this]() { return static_cast<double>(_dedup_state.get_ewma_value()); });
+  }
+
   bool is_object_extraction_enabled() const override { return _use_dedup; }
   bool is_serialization_transform_enabled() const override { return _use_compression; }
 
@@ -319,9 +505,12 @@ public:
   int transform_serialized_payload(generic_event::payload_buffer_t& input, event_content_type& content_type, api_status* status) const override {
     return _dedup_state.compress(input, content_type, status);
   }
+
+  void release_objects(const generic_event::object_list_t& objects) override {
+    _dedup_state.remove_all_values(objects.begin(), objects.end(), nullptr);
+  }
 private:
 	dedup_state _dedup_state;
-  int _dummy_state = 0;
   bool _use_compression;
   bool _use_dedup;
 };
@@ -330,13 +519,15 @@ private:
 logger::i_logger_extensions* create_dedup_logger_extension(const utility::configuration& config, const char* section, i_time_provider* time_provider) {
   if(config.get_int(name::PROTOCOL_VERSION, 1) != 2)
     return nullptr;
-  const bool use_compression = config.get_bool(section, name::USE_COMPRESSION, false);
+  const bool use_batch_compression = config.get_bool(section, name::USE_BATCH_COMPRESSION, false);
+  //compressing the whole batch supersedes compressing each event
+  const bool use_compression = !use_batch_compression && config.get_bool(section, name::USE_COMPRESSION, false);
   const bool use_dedup = config.get_bool(section, name::USE_DEDUP, false);
 
-  if(!use_compression && !use_dedup)
+  if(!use_compression && !use_dedup && !use_batch_compression)
     return nullptr;
 
-  return new dedup_extensions(config, use_compression, use_dedup, time_provider);
+  return new dedup_extensions(config, use_compression, use_dedup, use_batch_compression, time_provider);
 }
 
 }
@@ -2,23 +2,47 @@
 #include "dedup.h"
 #include "api_status.h"
 #include "rl_string_view.h"
-#include "zstd.h"
+#include "zstd_compressor.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <mutex>
+#include <string>
 
 namespace reinforcement_learning
 {
+  //! Ref counted object dictionary, lock striped so API threads adding objects and the batcher thread
+  //! collecting them mostly take different locks. The bulk operations take each stripe lock once.
   class dedup_dict {
   public:
+    static const size_t STRIPE_COUNT = 16;
+
+    //! Parts of the context replaced by {"__aid":<id>} references, see name::DEDUP_TARGETS
+    static const unsigned TARGET_ACTIONS = 1;
+    static const unsigned TARGET_SLOTS = 2;
+    static const unsigned TARGET_SHARED = 4;
+    //! Slot and shared namespace ids carry their target in the top byte, content hashes only use the low 32 bits.
+    //! Readers expand those references as text while actions are resolved by the VW parser.
+    static const generic_event::object_id_t SLOT_ID_BITS = 1ULL << 56;
+    static const generic_event::object_id_t SHARED_ID_BITS = 2ULL << 56;
+
+    //! Each content has its own buffer, shared with the batches that are serializing it
+    typedef std::shared_ptr<const std::string> content_ptr_t;
+
     dedup_dict() = default;
 
     dedup_dict(const dedup_dict&) = delete;
     dedup_dict& operator=(const dedup_dict&) = delete;
 
-    dedup_dict(dedup_dict&&) = default;
-    dedup_dict& operator=(dedup_dict&&) = default;
+    dedup_dict(dedup_dict&&) = delete;
+    dedup_dict& operator=(dedup_dict&&) = delete;
     ~dedup_dict() = default;
 
     //! Returns true if the object was found. This doesn't tell the ref count status of that object
@@ -28,49 +52,107 @@ namespace reinforcement_learning
     //! Return a string_view of the object content, or an empty view if not found
     string_view get_object(generic_event::object_id_t oid) const;
 
+    //! Adds the content sizes of object_ids to total_size. Returns false if any object is missing
+    bool get_objects_size(const generic_event::object_list_t& object_ids, size_t& total_size);
+
+    //! [start, end[ are (object id, count) pairs. Returns false if any object is missing
+    template<typename I>
+    bool get_objects(I start, I end, generic_event::object_list_t& object_ids, std::vector<string_view>& values);
+    template<typename I>
+    bool remove_objects(I start, I end);
+    //! Single pass get_objects + remove_objects. contents shares the buffers of the returned views, which stay valid
+    //! as long as contents does, even once other threads remove the objects. Contents that drop to a zero count are moved out.
+    template<typename I>
+    bool extract_objects(I start, I end, generic_event::object_list_t& object_ids, std::vector<string_view>& values, std::vector<content_ptr_t>& contents);
+
     size_t size() const;
+    //! Bitmask of TARGET_* values, only actions by default
+    void set_targets(unsigned targets) { _targets = targets; }
     int transform_payload_and_add_objects(const char* payload, std::string& edited_payload, generic_event::object_list_t& object_ids, api_status* status);
   private:
     struct dict_entry {
       size_t _count;
-      size_t _length;
-      std::vector<char> _content;
+      content_ptr_t _content;
+    };
+
+    typedef std::unordered_map<generic_event::object_id_t, dict_entry> entry_map_t;
 
-      dict_entry(const char* data, size_t length);
+    struct stripe {
+      mutable std::mutex _mutex;
+      entry_map_t _entries;
     };
-    std::unordered_map<generic_event::object_id_t, dict_entry> _entries;
+
+    static void add_entry(stripe& s, generic_event::object_id_t oid, const char* start, size_t length);
+    static size_t stripe_index(generic_event::object_id_t oid) { return oid % STRIPE_COUNT; }
+    static generic_event::object_id_t object_id(generic_event::object_id_t oid) { return oid; }
+    template<typename T>
+    static generic_event::object_id_t object_id(const std::pair<T, size_t>& item) { return item.first; }
+    static size_t object_count(generic_event::object_id_t) { return 1; }
+    template<typename T>
+    static size_t object_count(const std::pair<T, size_t>& item) { return item.second; }
+
+    //! Calls fn(stripe, it) for each iterator of [start, end[, visiting the items stripe by stripe
+    template<typename I, typename F>
+    void for_each_by_stripe(I start, I end, F fn);
+
+    std::array<stripe, STRIPE_COUNT> _stripes;
+    unsigned _targets = TARGET_ACTIONS;
   };
 
-  class ewma {
+  //! Ids of the objects the joiner keeps across batches, most recently shipped first.
+  //! Only used by the batcher thread.
+  //! Several clients usually share one joined stream, so the joiner keeps the objects per client id. The id is drawn
+  //! at random for each instance and sent with every dictionary.
+  class dedup_lru {
   public:
-    ewma(float initial = 1, float weight = 0.5): _current(initial), _weight(weight) {}
+    //! capacity 0 disables cross batch dedup, refresh_batches 0 never resends the full dictionary
+    dedup_lru(size_t capacity, size_t refresh_batches);
 
-    void update(float new_value) {
-      _current = (1 - _weight) * _current + (_weight * new_value);
-    }
+    bool enabled() const { return _capacity > 0; }
+    bool contains(generic_event::object_id_t oid) const;
+    //! Never 0, which stands for clients without cross batch dedup
+    uint64_t client_id() const { return _client_id; }
 
-    float value() const { return _current; }
+    //! Drops the objects the joiner already has from ids/values and records the new ones. Evicts the least recently
+    //! shipped objects beyond capacity, never the ones in this batch. incremental is false when the full dictionary is sent.
+    void ship(generic_event::object_list_t& ids, std::vector<string_view>& values, generic_event::object_list_t& evicted, bool& incremental);
   private:
-    float _current;
-    const float _weight;
+    typedef std::list<generic_event::object_id_t> lru_list_t;
+
+    const size_t _capacity;
+    const size_t _refresh_batches;
+    const uint64_t _client_id;
+    size_t _batches = 0;
+    lru_list_t _lru;
+    std::unordered_map<generic_event::object_id_t, lru_list_t::iterator> _positions;
   };
 
-  class zstd_compressor {
+  class ewma {
   public:
-    const static int ZSTD_DEFAULT_COMPRESSION_LEVEL = 1;
+    ewma(float initial = 1, float weight = 0.5): _current(initial), _weight(weight) {}
+
+    // Only updated by the logger thread, value() is also sampled by the metrics snapshot
+    void update(float new_value) {
+      const float current = _current.load(std::memory_order_relaxed);
+      _current.store((1 - _weight) * current + (_weight * new_value), std::memory_order_relaxed);
+    }
 
-    explicit zstd_compressor(int level);
-    int compress(generic_event::payload_buffer_t& input, api_status* status) const;
-    int decompress(generic_event::payload_buffer_t& buf, api_status* status) const;
+    float value() const { return _current.load(std::memory_order_relaxed); }
   private:
-    const int _level;
+    std::atomic<float> _current;
+    const float _weight;
   };
 
   class dedup_state {
   public:
-    dedup_state(const utility::configuration& c, bool use_compression, bool use_dedup, i_time_provider* time_provider);
+    dedup_state(const utility::configuration& c, bool use_compression, bool use_dedup, i_time_provider* time_provider, bool use_batch_compression = false);
+
+    //! Reads the DEDUP_TARGETS list and loads the zstd dictionary named by ZSTD_DICTIONARY_FILE, if any, for event compression
+    int init(const utility::configuration& c, api_status* status);
 
     string_view get_object(generic_event::object_id_t aid);
+    //! Sums the content sizes of object_ids, see dedup_dict::get_objects_size
+    bool get_objects_size(const generic_event::object_list_t& object_ids, size_t& total_size);
     float get_ewma_value() const;
 
     template<typename I>
@@ -79,11 +161,18 @@ namespace reinforcement_learning
     template<typename I>
     int remove_all_values(I start, I end, api_status* status);
 
+    //! get_all_values and remove_all_values in one pass over the dictionary, see dedup_dict::extract_objects
+    template<typename I>
+    int extract_all_values(I start, I end, generic_event::object_list_t& action_ids, std::vector<string_view>& action_values, std::vector<dedup_dict::content_ptr_t>& contents, api_status* status);
+
     void update_ewma(float value);
     int compress(generic_event::payload_buffer_t& input, event_content_type& content_type, api_status* status) const;
     int transform_payload_and_add_objects(const char* payload, std::string& edited_payload, generic_event::object_list_t& object_ids, api_status* status);
 
     i_time_provider* get_time_provider() { return _time_provider.get(); }
+    //! Returns the compressor used for whole batches, or nullptr if batch compression is disabled
+    const zstd_compressor* get_batch_compressor() const;
+    dedup_lru& get_lru() { return _lru; }
 
     //test helpers, don't use them directly
     inline dedup_dict& get_dict() { return _dict; }
@@ -91,11 +180,13 @@ namespace reinforcement_learning
   private:
     ewma _ewma;
     dedup_dict _dict;
+    dedup_lru _lru;
     zstd_compressor _compressor;
-    std::mutex _mutex;
+    zstd_compressor _batch_compressor;
     std::unique_ptr<i_time_provider> _time_provider;
     bool _use_compression;
     bool _use_dedup;
+    bool _use_batch_compression;
   };
 
   static const char* DEDUP_DICT_EVENT_ID = "3defd95a-0122-4aac-9068-0b9ac30b66d8";
@@ -111,33 +202,115 @@ namespace reinforcement_learning
     dedup_state& _state;
     size_t _size_estimate;
     std::unordered_map<generic_event::object_id_t, size_t> _used_objects;
+    //! scratch list of the objects an event adds to the batch dictionary
+    generic_event::object_list_t _new_objects;
   };
 
-  template<typename I>
-  int dedup_state::get_all_values(I start, I end, generic_event::object_list_t& action_ids, std::vector<string_view>& action_values, api_status* status) {
-    std::unique_lock<std::mutex> mlock(_mutex);
-
+  template<typename I, typename F>
+  void dedup_dict::for_each_by_stripe(I start, I end, F fn) {
+    std::vector<std::pair<size_t, I>> items;
+    items.reserve(std::distance(start, end));
     for(; start != end; ++start) {
-      auto content = _dict.get_object(start->first);
-      if(content.size() == 0) {
-        RETURN_ERROR_LS(nullptr, status, compression_error) << "Key not found while building batch dictionary";
+      items.emplace_back(stripe_index(object_id(*start)), start);
+    }
+    std::stable_sort(items.begin(), items.end(), [](const std::pair<size_t, I>& a, const std::pair<size_t, I>& b) {
+      return a.first < b.first;
+    });
+
+    for(auto it = items.begin(); it != items.end();) {
+      auto& s = _stripes[it->first];
+      std::lock_guard<std::mutex> lock(s._mutex);
+      const auto index = it->first;
+      for(; it != items.end() && it->first == index; ++it) {
+        fn(s, it->second);
       }
-      action_ids.push_back(start->first);
-      action_values.push_back(content);
     }
+  }
+
+  template<typename I>
+  bool dedup_dict::get_objects(I start, I end, generic_event::object_list_t& object_ids, std::vector<string_view>& values) {
+    bool found_all = true;
+    for_each_by_stripe(start, end, [&](stripe& s, I item_it) {
+      const auto& item = *item_it;
+      const auto oid = object_id(item);
+      auto it = s._entries.find(oid);
+      if(it == s._entries.end()) {
+        found_all = false;
+        return;
+      }
+      object_ids.push_back(oid);
+      values.emplace_back(it->second._content->data(), it->second._content->size());
+    });
+    return found_all;
+  }
+
+  template<typename I>
+  bool dedup_dict::remove_objects(I start, I end) {
+    bool found_all = true;
+    for_each_by_stripe(start, end, [&](stripe& s, I item_it) {
+      const auto& item = *item_it;
+      auto it = s._entries.find(object_id(item));
+      if(it == s._entries.end()) {
+        found_all = false;
+        return;
+      }
+      const size_t count = (std::min)(object_count(item), it->second._count);
+      it->second._count -= count;
+      if(!it->second._count) {
+        s._entries.erase(it);
+      }
+    });
+    return found_all;
+  }
 
+  template<typename I>
+  bool dedup_dict::extract_objects(I start, I end, generic_event::object_list_t& object_ids, std::vector<string_view>& values, std::vector<content_ptr_t>& contents) {
+    bool found_all = true;
+    for_each_by_stripe(start, end, [&](stripe& s, I item_it) {
+      const auto& item = *item_it;
+      const auto oid = object_id(item);
+      auto it = s._entries.find(oid);
+      if(it == s._entries.end()) {
+        found_all = false;
+        return;
+      }
+      object_ids.push_back(oid);
+      const size_t count = (std::min)(object_count(item), it->second._count);
+      it->second._count -= count;
+      const auto& content = *it->second._content;
+      values.emplace_back(content.data(), content.size());
+      if(it->second._count) {
+        //entries referenced by queued events stay in the dictionary
+        contents.push_back(it->second._content);
+      } else {
+        contents.push_back(std::move(it->second._content));
+        s._entries.erase(it);
+      }
+    });
+    return found_all;
+  }
+
+  template<typename I>
+  int dedup_state::get_all_values(I start, I end, generic_event::object_list_t& action_ids, std::vector<string_view>& action_values, api_status* status) {
+    if(!_dict.get_objects(start, end, action_ids, action_values)) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "Key not found while building batch dictionary";
+    }
     return error_code::success;
   }
 
   template<typename I>
   int dedup_state::remove_all_values(I start, I end, api_status* status) {
-    std::unique_lock<std::mutex> mlock(_mutex);
-    for(; start != end; ++start) {
-      if(!_dict.remove_object(start->first, start->second)) {
-        RETURN_ERROR_LS(nullptr, status, compression_error) << "Key not found while pruning dedup_dict";
-      }
+    if(!_dict.remove_objects(start, end)) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "Key not found while pruning dedup_dict";
     }
+    return error_code::success;
+  }
 
+  template<typename I>
+  int dedup_state::extract_all_values(I start, I end, generic_event::object_list_t& action_ids, std::vector<string_view>& action_values, std::vector<dedup_dict::content_ptr_t>& contents, api_status* status) {
+    if(!_dict.extract_objects(start, end, action_ids, action_values, contents)) {
+      RETURN_ERROR_LS(nullptr, status, compression_error) << "Key not found while building batch dictionary";
+    }
     return error_code::success;
   }
 }
@@ -123,6 +123,17 @@ namespace reinforcement_learning {
     return error_code::success;
   }
 
+  int coarse_clock_time_provider_create(i_time_provider** retval, const u::configuration& config, i_trace* trace_logger, api_status* status)
+  {
+    const auto precision_us = config.get_int(name::TIME_PROVIDER_PRECISION_US, coarse_clock_time_provider::DEFAULT_PRECISION_US);
+    if (precision_us <= 0 || precision_us > 1000000) {
+      RETURN_ERROR_LS(trace_logger, status, invalid_argument) << name::TIME_PROVIDER_PRECISION_US << " must be in [1, 1000000], got " << precision_us;
+    }
+    TRACE_INFO(trace_logger, "Coarse clock time provider created.");
+    *retval = new coarse_clock_time_provider(precision_us);
+    return error_code::success;
+  }
+
   void factory_initializer::register_default_factories() {
 #ifdef USE_AZURE_FACTORIES
     register_azure_factories();
@@ -139,6 +150,7 @@ namespace reinforcement_learning {
 
     time_provider_factory.register_type(value::NULL_TIME_PROVIDER, null_time_provider_create);
     time_provider_factory.register_type(value::CLOCK_TIME_PROVIDER, clock_time_provider_create);
+    time_provider_factory.register_type(value::COARSE_CLOCK_TIME_PROVIDER, coarse_clock_time_provider_create);
 
     // Register File loggers
     sender_factory.register_type(value::OBSERVATION_FILE_SENDER,
@@ -2,6 +2,9 @@
 #include "generic_event.h"
 #include "explore_internal.h"
 #include "hash.h"
+#include "err_constants.h"
+#include "logger/async_batcher.h"
+#include "logger/logger_extensions.h"
 
 using namespace std;
 namespace reinforcement_learning {
@@ -24,11 +27,38 @@ namespace reinforcement_learning {
     , _content_type(content_type) 
     , _app_id(app_id) {}
 
+  int generic_event::transform(const char* context, logger::i_logger_extensions* ext, const payload_builder_t& build_payload, api_status* status) {
+    if (ext == nullptr || !ext->is_object_extraction_enabled()) {
+      _payload = build_payload(context);
+    } else {
+      std::string edited_context;
+      _ext = ext;
+      RETURN_IF_FAIL(ext->transform_payload_and_extract_objects(context, edited_context, _objects, status));
+      _payload = build_payload(edited_context.c_str());
+    }
+
+    if (ext != nullptr && ext->is_serialization_transform_enabled()) {
+      RETURN_IF_FAIL(ext->transform_serialized_payload(_payload, _content_type, status));
+    } else {
+      _content_type = event_content_type::IDENTITY;
+    }
+    return error_code::success;
+  }
+
+  void generic_event::release_objects() {
+    if (_ext != nullptr && !_objects.empty()) {
+      _ext->release_objects(_objects);
+    }
+    _objects.clear();
+  }
+
   bool generic_event::try_drop(float pass_prob, int drop_pass) {
     _pass_prob *= pass_prob;
     return prg(drop_pass) > pass_prob;
   }
 
+  void generic_event::scale_pass_prob(float pass_prob) { _pass_prob *= pass_prob; }
+
   const char* generic_event::get_id() const { return _id.c_str(); }
 
   const char* generic_event::get_app_id() const { return _app_id.c_str(); }  
@@ -56,6 +86,8 @@ namespace reinforcement_learning {
     switch (_content_type) {
       case event_content_type::ZSTD:
         return encoding_type_t::EventEncoding_Zstd;
+      case event_content_type::ZSTD_DICTIONARY:
+        return encoding_type_t::EventEncoding_ZstdDictionary;
       case event_content_type::IDENTITY:
       default:
         return encoding_type_t::EventEncoding_Identity;
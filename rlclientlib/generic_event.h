@@ -1,13 +1,18 @@
 #pragma once
+#include <functional>
 #include <string>
 #include "time_helper.h"
 #include "generated/v2/Event_generated.h"
 #include <flatbuffers/flatbuffers.h>
 
 namespace reinforcement_learning {
+  class api_status;
+  namespace logger { class i_logger_extensions; }
+
   enum class event_content_type {
     IDENTITY,
-    ZSTD
+    ZSTD,
+    ZSTD_DICTIONARY
   };
 
   class generic_event {
@@ -18,6 +23,8 @@ namespace reinforcement_learning {
   public:
     using object_id_t = uint64_t;
     using object_list_t = std::vector<object_id_t>;
+    //! Serializes the (possibly edited) context into the event payload
+    using payload_builder_t = std::function<payload_buffer_t(const char* context)>;
 
     generic_event() = default;
     generic_event(const char* id, const timestamp& ts, payload_type_t type, payload_buffer_t&& payload, event_content_type content_type, object_list_t &&objects, const char* app_id, float pass_prob = 1.f);
@@ -33,6 +40,8 @@ namespace reinforcement_learning {
     float get_pass_prob() const;
     timestamp get_client_time_gmt() const;
     bool try_drop(float pass_prob, int drop_pass);
+    //! Accounts for a drop pass the event survived outside of try_drop
+    void scale_pass_prob(float pass_prob);
 
     const object_list_t& get_object_list() const;
 
@@ -45,6 +54,12 @@ namespace reinforcement_learning {
     const payload_buffer_t& get_payload() const;
 
     encoding_type_t get_encoding() const;
+
+    //! Builds the payload from context: object extraction, serialization and payload compression, as enabled by
+    //! ext (which can be null). context is only read during the call
+    int transform(const char* context, logger::i_logger_extensions* ext, const payload_builder_t& build_payload, api_status* status);
+    //! Hands the objects extracted by transform back to the extensions, for events that won't be serialized
+    void release_objects();
   protected:
     float prg(int drop_pass) const;
 
@@ -54,6 +69,8 @@ namespace reinforcement_learning {
     payload_type_t _payload_type;
     payload_buffer_t _payload;
     object_list_t _objects;
+    //! extensions that extracted _objects, if any
+    logger::i_logger_extensions* _ext = nullptr;
     float _pass_prob = 1.0;
     event_content_type _content_type;
     std::string _app_id;
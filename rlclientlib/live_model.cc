@@ -235,4 +235,22 @@ namespace reinforcement_learning
     INIT_CHECK();
     return _pimpl->refresh_model(status);
   }
+
+  int live_model::get_interaction_queue_status(queue_status& queue, api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->get_interaction_queue_status(queue, status);
+  }
+
+  int live_model::get_observation_queue_status(queue_status& queue, api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->get_observation_queue_status(queue, status);
+  }
+
+  int live_model::get_metrics(metrics_snapshot& metrics, api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->get_metrics(metrics, status);
+  }
 }
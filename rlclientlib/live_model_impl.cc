@@ -18,7 +18,9 @@
 #include "factory_resolver.h"
 #include "logger/preamble_sender.h"
 #include "sampling.h"
+#include "utility/metrics_registry.h"
 
+#include <chrono>
 #include <cstring>
 
 // Some namespace changes for more concise code
@@ -52,10 +54,12 @@ namespace reinforcement_learning {
     RETURN_IF_FAIL(init_model(status));
     RETURN_IF_FAIL(init_model_mgmt(status));
     RETURN_IF_FAIL(init_loggers(status));
+    RETURN_IF_FAIL(init_metrics(status));
 
     if (_protocol_version == 1) {
       if(_configuration.get_bool("interaction", name::USE_COMPRESSION, false) || 
         _configuration.get_bool("interaction", name::USE_DEDUP, false) ||
+        _configuration.get_bool("interaction", name::USE_BATCH_COMPRESSION, false) ||
         _configuration.get_bool("observation", name::USE_COMPRESSION, false)) {
         RETURN_ERROR_LS(_trace_logger.get(), status, content_encoding_error);
       }
@@ -69,6 +73,7 @@ namespace reinforcement_learning {
 
   int live_model_impl::choose_rank(const char* event_id, const char* context, unsigned int flags, ranking_response& response,
     api_status* status) {
+    const u::latency_scope latency(_choose_rank_latency);
     response.clear();
     //clear previous errors if any
     api_status::try_clear(status);
@@ -90,7 +95,12 @@ namespace reinforcement_learning {
       RETURN_IF_FAIL(reset_action_order(response));
     }
 
-    RETURN_IF_FAIL(_interaction_logger->log(context, flags, response, status, _learning_mode));
+    // A full logging queue (NONBLOCKING mode or BLOCK timeout) doesn't lose the decision: the response is completed
+    // and logging_queue_full is returned at the end
+    const int log_result = _interaction_logger->log(context, flags, response, status, _learning_mode);
+    if (log_result != error_code::logging_queue_full) {
+      RETURN_IF_FAIL(log_result);
+    }
 
     if (_learning_mode == APPRENTICE)
     {
@@ -103,7 +113,7 @@ namespace reinforcement_learning {
       RETURN_ERROR_LS(_trace_logger.get(), status, unhandled_background_error_occurred);
     }
 
-    return error_code::success;
+    return log_result;
   }
 
   //here the event_id is auto-generated
@@ -115,6 +125,7 @@ namespace reinforcement_learning {
 
   int live_model_impl::request_continuous_action(const char* event_id, const char* context, unsigned int flags, continuous_action_response& response, api_status* status)
   {
+    const u::latency_scope latency(_request_continuous_action_latency);
     response.clear();
     //clear previous errors if any
     api_status::try_clear(status);
@@ -125,16 +136,22 @@ namespace reinforcement_learning {
     float pdf_value;
     std::string model_version;
 
-    RETURN_IF_FAIL(_model->choose_continuous_action(context, action, pdf_value, model_version, status));
+    {
+      const u::latency_scope model_latency(_model_latency);
+      RETURN_IF_FAIL(_model->choose_continuous_action(context, action, pdf_value, model_version, status));
+    }
     RETURN_IF_FAIL(populate_response(action, pdf_value, std::string(event_id), std::string(model_version), response, _trace_logger.get(), status));
-    RETURN_IF_FAIL(_interaction_logger->log_continuous_action(context, flags, response, status));
+    const int log_result = _interaction_logger->log_continuous_action(context, flags, response, status);
+    if (log_result != error_code::logging_queue_full) {
+      RETURN_IF_FAIL(log_result);
+    }
 
     if (_watchdog.has_background_error_been_reported())
     {
       RETURN_ERROR_LS(_trace_logger.get(), status, unhandled_background_error_occurred);
     }
 
-    return error_code::success;
+    return log_result;
   }
 
   int live_model_impl::request_continuous_action(const char* context, unsigned int flags, continuous_action_response& response, api_status* status)
@@ -145,6 +162,7 @@ namespace reinforcement_learning {
 
   int live_model_impl::request_decision(const char* context_json, unsigned int flags, decision_response& resp, api_status* status)
   {
+    const u::latency_scope latency(_request_decision_latency);
     if (_learning_mode == APPRENTICE || _learning_mode == LOGGINGONLY) {
       // Apprentice mode and LoggingOnly mode are not supported here at this moment
       return error_code::not_supported;
@@ -184,16 +202,22 @@ namespace reinforcement_learning {
     }
 
     // This will behave correctly both before a model is loaded and after. Prior to a model being loaded it operates in explore only mode.
-    RETURN_IF_FAIL(_model->request_decision(event_ids, context_json, actions_ids, actions_pdfs, model_version, status));
+    {
+      const u::latency_scope model_latency(_model_latency);
+      RETURN_IF_FAIL(_model->request_decision(event_ids, context_json, actions_ids, actions_pdfs, model_version, status));
+    }
     RETURN_IF_FAIL(populate_response(actions_ids, actions_pdfs, event_ids, std::string(model_version), resp, _trace_logger.get(), status));
-    RETURN_IF_FAIL(_interaction_logger->log_decisions(event_ids, context_json, flags, actions_ids, actions_pdfs, model_version, status));
+    const int log_result = _interaction_logger->log_decisions(event_ids, context_json, flags, actions_ids, actions_pdfs, model_version, status);
+    if (log_result != error_code::logging_queue_full) {
+      RETURN_IF_FAIL(log_result);
+    }
 
     // Check watchdog for any background errors. Do this at the end of function so that the work is still done.
     if (_watchdog.has_background_error_been_reported()) {
       RETURN_ERROR_LS(_trace_logger.get(), status, unhandled_background_error_occurred);
     }
 
-    return error_code::success;
+    return log_result;
   }
 
   int live_model_impl::request_multi_slot_decision_impl(const char *event_id, const char * context_json, std::vector<std::string>& slot_ids, std::vector<std::vector<uint32_t>>& action_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status)
@@ -218,6 +242,7 @@ namespace reinforcement_learning {
     RETURN_IF_FAIL(utility::get_slot_ids(context_json, context_info.slots, found_ids, _trace_logger.get(), status));
     autogenerate_missing_uuids(found_ids, slot_ids, _seed_shift);
 
+    const u::latency_scope model_latency(_model_latency);
     RETURN_IF_FAIL(_model->request_multi_slot_decision(event_id, slot_ids, context_json, action_ids, action_pdfs, model_version, status));
     return error_code::success;
   }
@@ -230,6 +255,7 @@ namespace reinforcement_learning {
 
   int live_model_impl::request_multi_slot_decision(const char * event_id, const char * context_json, unsigned int flags, multi_slot_response& resp, const std::vector<int>& baseline_actions, api_status* status)
   {
+    const u::latency_scope latency(_request_multi_slot_decision_latency);
     resp.clear();
 
     if (_learning_mode == APPRENTICE && baseline_actions.empty())
@@ -244,7 +270,10 @@ namespace reinforcement_learning {
 
     RETURN_IF_FAIL(live_model_impl::request_multi_slot_decision_impl(event_id, context_json, slot_ids, action_ids, action_pdfs, model_version, status));
     RETURN_IF_FAIL(populate_multi_slot_response(action_ids, action_pdfs, std::string(event_id), std::string(model_version), slot_ids, resp, _trace_logger.get(), status));
-    RETURN_IF_FAIL(_interaction_logger->log_decision(event_id, context_json, flags, action_ids, action_pdfs, model_version, slot_ids, status, baseline_actions, _learning_mode));
+    const int log_result = _interaction_logger->log_decision(event_id, context_json, flags, action_ids, action_pdfs, model_version, slot_ids, status, baseline_actions, _learning_mode);
+    if (log_result != error_code::logging_queue_full) {
+      RETURN_IF_FAIL(log_result);
+    }
 
     if (_learning_mode == APPRENTICE || _learning_mode == LOGGINGONLY)
     {
@@ -257,7 +286,7 @@ namespace reinforcement_learning {
     if (_watchdog.has_background_error_been_reported()) {
       RETURN_ERROR_LS(_trace_logger.get(), status, unhandled_background_error_occurred);
     }
-    return error_code::success;
+    return log_result;
   }
 
   int live_model_impl::request_multi_slot_decision(const char * context_json, unsigned int flags, multi_slot_response_detailed& resp, const std::vector<int>& baseline_actions, api_status* status)
@@ -268,6 +297,7 @@ namespace reinforcement_learning {
 
   int live_model_impl::request_multi_slot_decision(const char * event_id, const char * context_json, unsigned int flags, multi_slot_response_detailed& resp, const std::vector<int>& baseline_actions, api_status* status)
   {
+    const u::latency_scope latency(_request_multi_slot_decision_latency);
     resp.clear();
 
     if (_learning_mode == APPRENTICE && baseline_actions.empty())
@@ -286,7 +316,10 @@ namespace reinforcement_learning {
     resp.resize(slot_ids.size());
 
     RETURN_IF_FAIL(populate_multi_slot_response_detailed(action_ids, action_pdfs, std::string(event_id), std::string(model_version), slot_ids, resp, _trace_logger.get(), status));
-    RETURN_IF_FAIL(_interaction_logger->log_decision(event_id, context_json, flags, action_ids, action_pdfs, model_version, slot_ids, status, baseline_actions, _learning_mode));
+    const int log_result = _interaction_logger->log_decision(event_id, context_json, flags, action_ids, action_pdfs, model_version, slot_ids, status, baseline_actions, _learning_mode);
+    if (log_result != error_code::logging_queue_full) {
+      RETURN_IF_FAIL(log_result);
+    }
 
     if (_learning_mode == APPRENTICE || _learning_mode == LOGGINGONLY)
     {
@@ -299,10 +332,21 @@ namespace reinforcement_learning {
     if (_watchdog.has_background_error_been_reported()) {
       RETURN_ERROR_LS(_trace_logger.get(), status, unhandled_background_error_occurred);
     }
+    return log_result;
+  }
+
+  int live_model_impl::get_interaction_queue_status(queue_status& queue, api_status* status) {
+    queue = _interaction_logger->get_queue_status();
+    return error_code::success;
+  }
+
+  int live_model_impl::get_observation_queue_status(queue_status& queue, api_status* status) {
+    queue = _outcome_logger->get_queue_status();
     return error_code::success;
   }
 
   int live_model_impl::report_action_taken(const char* event_id, api_status* status) {
+    const u::latency_scope latency(_report_action_taken_latency);
     // Clear previous errors if any
     api_status::try_clear(status);
     // Send the outcome event to the backend
@@ -361,7 +405,13 @@ namespace reinforcement_learning {
     RETURN_IF_FAIL(_model->update(md, model_ready, status));
 
     _model_ready = model_ready;
+    on_model_updated();
+
+    return error_code::success;
+  }
 
+  int live_model_impl::get_metrics(metrics_snapshot& metrics, api_status* status) {
+    _metrics.snapshot(metrics);
     return error_code::success;
   }
 
@@ -396,6 +446,41 @@ namespace reinforcement_learning {
     }
 
     _learning_mode = learning::to_learning_mode(_configuration.get(name::LEARNING_MODE, value::LEARNING_MODE_ONLINE));
+
+    _choose_rank_latency = _metrics.get_histogram("api.choose_rank_us");
+    _request_continuous_action_latency = _metrics.get_histogram("api.request_continuous_action_us");
+    _request_decision_latency = _metrics.get_histogram("api.request_decision_us");
+    _request_multi_slot_decision_latency = _metrics.get_histogram("api.request_multi_slot_decision_us");
+    _report_outcome_latency = _metrics.get_histogram("api.report_outcome_us");
+    _report_action_taken_latency = _metrics.get_histogram("api.report_action_taken_us");
+    _model_latency = _metrics.get_histogram("model.inference_us");
+    _model_updates = _metrics.get_counter("model.updates");
+  }
+
+  int live_model_impl::init_metrics(api_status* status) {
+    // Seconds since the last model update, -1 until the first one
+    _metrics.add_gauge("model.age_s", [this]() {
+      const auto updated_ms = _model_update_ms.load();
+      if (updated_ms == 0) return -1.0;
+      return static_cast<double>(steady_clock_ms() - updated_ms) / 1000.0;
+    });
+
+    const int dump_interval_ms = _configuration.get_int(name::METRICS_DUMP_INTERVAL_MS, 0);
+    if (dump_interval_ms > 0) {
+      _metrics_dumper.reset(new u::metrics_dumper(_metrics, _trace_logger.get()));
+      _metrics_dump_proc.reset(new u::periodic_background_proc<u::metrics_dumper>(dump_interval_ms, _watchdog, "Metrics dump", &_error_cb));
+      RETURN_IF_FAIL(_metrics_dump_proc->init(_metrics_dumper.get(), status));
+    }
+    return error_code::success;
+  }
+
+  int64_t live_model_impl::steady_clock_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void live_model_impl::on_model_updated() {
+    _model_updates->add();
+    _model_update_ms = steady_clock_ms();
   }
 
   int live_model_impl::init_trace(api_status* status) {
@@ -413,6 +498,7 @@ namespace reinforcement_learning {
     m::i_model* pmodel;
     RETURN_IF_FAIL(_m_factory->create(&pmodel, model_impl, _configuration, _trace_logger.get(), status));
     _model.reset(pmodel);
+    _model->register_metrics(_metrics);
     return error_code::success;
   }
 
@@ -439,12 +525,15 @@ namespace reinforcement_learning {
 
     //Create the logger extension
     _logger_extensions.reset(logger::i_logger_extensions::get_extensions(_configuration, logger_extensions_time_provider));
+    RETURN_IF_FAIL(_logger_extensions->init(status));
+    _logger_extensions->register_metrics(_metrics);
 
     i_time_provider* ranking_time_provider;
     RETURN_IF_FAIL(_time_provider_factory->create(&ranking_time_provider, time_provider_impl, _configuration, _trace_logger.get(), status));
 
     // Create a logger for interactions that will use msg sender to send interaction messages
     _interaction_logger.reset(new logger::interaction_logger_facade(_model->model_type(), _configuration, ranking_msg_sender, _watchdog, ranking_time_provider, _logger_extensions.get(), &_error_cb));
+    _interaction_logger->register_metrics(_metrics);
     RETURN_IF_FAIL(_interaction_logger->init(status));
 
     // Get the name of raw data (as opposed to message) sender for observations.
@@ -467,6 +556,7 @@ namespace reinforcement_learning {
 
     // Create a logger for observations that will use msg sender to send observation messages
     _outcome_logger.reset(new logger::observation_logger_facade(_configuration, outcome_msg_sender, _watchdog, observation_time_provider, &_error_cb));
+    _outcome_logger->register_metrics(_metrics);
     RETURN_IF_FAIL(_outcome_logger->init(status));
 
     return error_code::success;
@@ -491,6 +581,7 @@ namespace reinforcement_learning {
       return;
     }
     _model_ready = model_ready;
+    on_model_updated();
   }
 
   int live_model_impl::explore_only(const char* event_id, const char* context, ranking_response& response,
@@ -563,7 +654,10 @@ namespace reinforcement_learning {
     std::vector<float> action_pdf;
     std::string model_version;
 
-    RETURN_IF_FAIL(_model->choose_rank(seed, context, action_ids, action_pdf, model_version, status));
+    {
+      const u::latency_scope model_latency(_model_latency);
+      RETURN_IF_FAIL(_model->choose_rank(seed, context, action_ids, action_pdf, model_version, status));
+    }
 
     return sample_and_populate_response(seed, action_ids, action_pdf, std::move(model_version), response, _trace_logger.get(), status);
   }
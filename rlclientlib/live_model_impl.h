@@ -6,6 +6,8 @@
 #include "model_mgmt/model_downloader.h"
 #include "utility/periodic_background_proc.h"
 #include "multi_slot_response_detailed.h"
+#include "metrics_snapshot.h"
+#include "utility/metrics_registry.h"
 
 #include "factory_resolver.h"
 #include "utility/watchdog.h"
@@ -50,6 +52,11 @@ namespace reinforcement_learning
 
     int refresh_model(api_status* status);
 
+    int get_interaction_queue_status(queue_status& queue, api_status* status);
+    int get_observation_queue_status(queue_status& queue, api_status* status);
+
+    int get_metrics(metrics_snapshot& metrics, api_status* status);
+
     explicit live_model_impl(
       const utility::configuration& config,
       error_fn fn,
@@ -71,6 +78,9 @@ namespace reinforcement_learning
     int init_model_mgmt(api_status* status);
     int init_loggers(api_status* status);
     int init_trace(api_status* status);
+    int init_metrics(api_status* status);
+    static int64_t steady_clock_ms();
+    void on_model_updated();
     static void _handle_model_update(const model_management::model_data& data, live_model_impl* ctxt);
     void handle_model_update(const model_management::model_data& data);
     int explore_only(const char* event_id, const char* context, ranking_response& response, api_status* status) const;
@@ -98,6 +108,18 @@ namespace reinforcement_learning
     sender_factory_t* _sender_factory;
     time_provider_factory_t* _time_provider_factory;
 
+    // Declared before the objects that register gauges with it
+    utility::metrics_registry _metrics;
+    utility::metrics_histogram* _choose_rank_latency = nullptr;
+    utility::metrics_histogram* _request_continuous_action_latency = nullptr;
+    utility::metrics_histogram* _request_decision_latency = nullptr;
+    utility::metrics_histogram* _request_multi_slot_decision_latency = nullptr;
+    utility::metrics_histogram* _report_outcome_latency = nullptr;
+    utility::metrics_histogram* _report_action_taken_latency = nullptr;
+    utility::metrics_histogram* _model_latency = nullptr;
+    utility::metrics_counter* _model_updates = nullptr;
+    std::atomic<int64_t> _model_update_ms{0};
+
     std::unique_ptr<model_management::i_data_transport> _transport{nullptr};
     std::unique_ptr<model_management::i_model> _model{nullptr};
 
@@ -114,10 +136,15 @@ namespace reinforcement_learning
 
     std::unique_ptr<utility::periodic_background_proc<model_management::model_downloader>> _bg_model_proc;
     uint64_t _seed_shift;
+
+    // Declared last so that the dump thread stops before anything it reads is destroyed
+    std::unique_ptr<utility::metrics_dumper> _metrics_dumper;
+    std::unique_ptr<utility::periodic_background_proc<utility::metrics_dumper>> _metrics_dump_proc;
   };
 
   template <typename D>
   int live_model_impl::report_outcome_internal(const char* event_id, D outcome, api_status* status) {
+    const utility::latency_scope latency(_report_outcome_latency);
     // Clear previous errors if any
     api_status::try_clear(status);
 
@@ -134,6 +161,7 @@ namespace reinforcement_learning
 
   template <typename D, typename I>
   int live_model_impl::report_outcome_internal(const char* primary_id, I secondary_id, D outcome, api_status* status) {
+    const utility::latency_scope latency(_report_outcome_latency);
     // Clear previous errors if any
     api_status::try_clear(status);
 
@@ -1,22 +1,29 @@
 #pragma once
 
 #include "event_queue.h"
+#include "event_record.h"
 #include "api_status.h"
 #include "constants.h"
 #include "error_callback_fn.h"
 #include "err_constants.h"
 #include "data_buffer.h"
+#include "queue_status.h"
 #include "utility/periodic_background_proc.h"
 
 #include "serialization/fb_serializer.h"
 #include "serialization/json_serializer.h"
 #include "message_sender.h"
+#include "batch_size_controller.h"
 #include "utility/config_helper.h"
+#include "utility/metrics_registry.h"
 #include "utility/object_pool.h"
 
 // float comparisons
 #include "vw_math.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <functional>
 
 namespace reinforcement_learning {
@@ -35,15 +42,20 @@ namespace reinforcement_learning { namespace logger {
     virtual int append(TFunc& func, const char* evt_id, size_t size_estimate, api_status* status = nullptr) = 0;
 
     virtual int run_iteration(api_status* status) = 0;
+
+    virtual event_queue_lane_metrics get_lane_metrics(event_priority priority) = 0;
+    virtual queue_status get_queue_status() = 0;
+    //! Adds the batch histograms and the queue and sender gauges under prefix, must be called before init
+    virtual void register_metrics(utility::metrics_registry& registry, const std::string& prefix) = 0;
   };
 
   // This class takes uses a queue and a background thread to accumulate events, and send them by batch asynchronously.
   // A batch is shipped with TSender::send(data)
-  // TFunc : a function with the prototype int f(Event& evt, api_status* status)
+  // TFunc : a move only function with the prototype int f(Event& evt, api_status* status), see event_record
   //       return value: Error code
   //       evt    : Event type out-param
   //       status : Optional status object
-  template<typename TEvent, template<typename> class TSerializer = json_collection_serializer, typename TFunc = std::function<int(TEvent&, api_status*)>>
+  template<typename TEvent, template<typename> class TSerializer = json_collection_serializer, typename TFunc = event_record<TEvent>>
   class async_batcher: public i_async_batcher<TFunc> {
   public:
     using shared_state_t = typename TSerializer<TEvent>::shared_state_t;
@@ -55,9 +67,18 @@ namespace reinforcement_learning { namespace logger {
 
     int run_iteration(api_status* status) override;
 
+    event_queue_lane_metrics get_lane_metrics(event_priority priority) override;
+    queue_status get_queue_status() override;
+    void register_metrics(utility::metrics_registry& registry, const std::string& prefix) override;
+
   private:
+    //! Counts a rejected event, after undoing what building it did
+    int reject(TFunc& func, api_status* status);
+
     int fill_buffer(std::shared_ptr<utility::data_buffer>& retbuffer,
-      size_t& remaining, 
+      size_t& remaining,
+      size_t high_water_mark,
+      size_t& estimated_size,
       api_status* status);
 
     void flush(); //flush all batches
@@ -74,18 +95,23 @@ namespace reinforcement_learning { namespace logger {
     std::unique_ptr<i_message_sender> _sender;
 
     event_queue<TFunc> _queue;       // A queue to accumulate batch of events.
-    size_t _send_high_water_mark;
+    batch_size_controller _batch_size;
     error_callback_fn* _perror_cb;
     shared_state_t& _shared_state;
 
     utility::periodic_background_proc<async_batcher> _periodic_background_proc;
     float _pass_prob;
     queue_mode_enum _queue_mode;
+    const int _queue_block_timeout_ms;
+    std::atomic<uint64_t> _rejected{ 0 };
     std::condition_variable _cv;
     std::mutex _m;
     utility::object_pool<utility::data_buffer> _buffer_pool;
     const char* _batch_content_encoding;
     float _subsample_rate;
+    utility::metrics_histogram* _batch_events = nullptr;
+    utility::metrics_histogram* _batch_bytes = nullptr;
+    utility::metrics_histogram* _send_latency = nullptr;
   };
 
   template<typename TEvent, template<typename> class TSerializer, typename TFunc>
@@ -117,26 +143,49 @@ namespace reinforcement_learning { namespace logger {
         return error_code::success;
       }
     }
-    
-    _queue.push(std::move(evt), TSerializer<TEvent>::serializer_t::size_estimate(evt));
 
-    //block or drop events if the queue if full
-    if (_queue.is_full()) {
+    func.set_drop_seed(uniform_hash(evt_id, strlen(evt_id), 0));
+    const auto priority = func.priority();
+
+    //block or reject events while the queue is full for their lane, the lowest lane fills up first
+    if (_queue.is_full(priority)) {
       if (queue_mode_enum::BLOCK == _queue_mode) {
+        _queue.on_blocked(priority);
         std::unique_lock<std::mutex> lk(_m);
-        _cv.wait(lk, [this] { return !_queue.is_full(); });
+        const auto has_room = [this, priority] { return !_queue.is_full(priority); };
+        if (_queue_block_timeout_ms <= 0) {
+          _cv.wait(lk, has_room);
+        }
+        else if (!_cv.wait_for(lk, std::chrono::milliseconds(_queue_block_timeout_ms), has_room)) {
+          return reject(func, status);
+        }
       }
-      else if (queue_mode_enum::DROP == _queue_mode) {
-        _queue.prune(_pass_prob);
+      else if (queue_mode_enum::NONBLOCKING == _queue_mode) {
+        return reject(func, status);
       }
     }
 
+    _queue.push(std::move(func), size_estimate, priority);
+
+    //drop events if the queue is full, starting with the lowest lane
+    if (queue_mode_enum::DROP == _queue_mode && _queue.is_full(event_priority::LOW)) {
+      _queue.prune(_pass_prob);
+    }
+
     return error_code::success;
   }
 
+  template<typename TEvent, template<typename> class TSerializer, typename TFunc>
+  int async_batcher<TEvent, TSerializer, TFunc>::reject(TFunc& func, api_status* status) {
+    // the queue never sees the event, so nothing else would hand its dedup objects back
+    func.discard();
+    ++_rejected;
+    RETURN_ERROR(nullptr, status, logging_queue_full);
+  }
+
   template<typename TEvent, template<typename> class TSerializer, typename TFunc>
   int async_batcher<TEvent, TSerializer, TFunc>::append(TFunc& func, const char* evt_id, size_t size_estimate, api_status* status) {
-    return append(std::move(evt), evt_id, size_estimate, status);
+    return append(std::move(func), evt_id, size_estimate, status);
   }
 
   template<typename TEvent, template<typename> class TSerializer, typename TFunc>
@@ -145,27 +194,73 @@ namespace reinforcement_learning { namespace logger {
     return error_code::success;
   }
 
+  template<typename TEvent, template<typename> class TSerializer, typename TFunc>
+  event_queue_lane_metrics async_batcher<TEvent, TSerializer, TFunc>::get_lane_metrics(event_priority priority) {
+    return _queue.get_lane_metrics(priority);
+  }
+
+  template<typename TEvent, template<typename> class TSerializer, typename TFunc>
+  queue_status async_batcher<TEvent, TSerializer, TFunc>::get_queue_status() {
+    queue_status result;
+    result.queued_events = _queue.size();
+    result.queued_bytes = _queue.capacity();
+    result.max_capacity_bytes = _queue.max_capacity();
+    result.rejected_events = _rejected;
+    return result;
+  }
+
+  template<typename TEvent, template<typename> class TSerializer, typename TFunc>
+  void async_batcher<TEvent, TSerializer, TFunc>::register_metrics(utility::metrics_registry& registry, const std::string& prefix) {
+    _batch_events = registry.get_histogram(prefix + ".batch.events");
+    _batch_bytes = registry.get_histogram(prefix + ".batch.bytes");
+    _send_latency = registry.get_histogram(prefix + ".send_us");
+
+    registry.add_gauge(prefix + ".queue.events", [this]() { return static_cast<double>(_queue.size()); });
+    registry.add_gauge(prefix + ".queue.bytes", [this]() { return static_cast<double>(_queue.capacity()); });
+    registry.add_gauge(prefix + ".queue.rejected", [this]() { return static_cast<double>(_rejected.load()); });
+    const char* const lanes[EVENT_PRIORITY_COUNT] = { "low", "normal", "high" };
+    for (size_t l = 0; l < EVENT_PRIORITY_COUNT; ++l) {
+      const auto priority = static_cast<event_priority>(l);
+      const auto lane = prefix + ".queue." + lanes[l];
+      registry.add_gauge(lane + ".enqueued", [this, priority]() { return static_cast<double>(_queue.get_lane_metrics(priority).enqueued); });
+      registry.add_gauge(lane + ".dropped", [this, priority]() { return static_cast<double>(_queue.get_lane_metrics(priority).dropped); });
+      registry.add_gauge(lane + ".blocked", [this, priority]() { return static_cast<double>(_queue.get_lane_metrics(priority).blocked); });
+    }
+
+    registry.add_gauge(prefix + ".sender.round_trip_ms", [this]() { return static_cast<double>(_sender->round_trip_ms()); });
+    registry.add_gauge(prefix + ".sender.retries", [this]() { return static_cast<double>(_sender->retry_count()); });
+  }
+
   template<typename TEvent, template<typename> class TSerializer, typename TFunc>
   int async_batcher<TEvent, TSerializer, TFunc>::fill_buffer(
                                                       std::shared_ptr<utility::data_buffer>& buffer, 
-                                                      size_t& remaining, 
+                                                      size_t& remaining,
+                                                      size_t high_water_mark,
+                                                      size_t& estimated_size,
                                                       api_status* status)
   {
     TFunc f_evt;
     TSerializer<TEvent> collection_serializer(*buffer.get(), _batch_content_encoding, _shared_state);
 
-    while (remaining > 0 && collection_serializer.size() < _send_high_water_mark) {
+    while (remaining > 0 && collection_serializer.size() < high_water_mark) {
       if (_queue.pop(&f_evt)) {
         if (queue_mode_enum::BLOCK == _queue_mode) {
-          _cv.notify_one();
+          // producers of every lane wait on _cv, a single wakeup could go to a lane that is still full
+          _cv.notify_all();
         }
+        --remaining;
         TEvent evt;
-        RETURN_IF_FAIL(f_evt(evt, status));
+        api_status evt_status;
+        if (f_evt(evt, &evt_status) != error_code::success) {
+          // only this event is lost, the rest of the batch still goes out
+          ERROR_CALLBACK(_perror_cb, evt_status);
+          continue;
+        }
         RETURN_IF_FAIL(collection_serializer.add(evt, status));
-        --remaining;
       }
     }
 
+    estimated_size = collection_serializer.size();
     RETURN_IF_FAIL(collection_serializer.finalize(status));
 
     return error_code::success;
@@ -175,26 +270,42 @@ namespace reinforcement_learning { namespace logger {
   void async_batcher<TEvent, TSerializer, TFunc>::flush() {
     const auto queue_size = _queue.size();
 
-    // Early exit if queue is empty.
-    if (queue_size == 0) {
-      return;
-    }
-
     auto remaining = queue_size;
+    size_t full_batches = 0;
     // Handle batching
     while (remaining > 0) {
       api_status status;
 
       auto buffer = _buffer_pool.acquire();
 
-      if (fill_buffer(buffer, remaining, &status) != error_code::success) {
+      const size_t high_water_mark = _batch_size.high_water_mark();
+      size_t estimated_size = 0;
+      const auto remaining_before = remaining;
+      if (fill_buffer(buffer, remaining, high_water_mark, estimated_size, &status) != error_code::success) {
         ERROR_CALLBACK(_perror_cb, status);
       }
+      if (estimated_size >= high_water_mark) {
+        ++full_batches;
+      }
 
+      const size_t wire_size = buffer->body_filled_size();
+      const auto send_start = std::chrono::steady_clock::now();
       if (_sender->send(TSerializer<TEvent>::message_id(), buffer, &status) != error_code::success) {
         ERROR_CALLBACK(_perror_cb, status);
       }
+      const auto send_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - send_start);
+      _batch_size.on_batch_sent(estimated_size, wire_size, static_cast<int>(send_time.count() / 1000), _sender->round_trip_ms());
+
+      if (_batch_events != nullptr) {
+        _batch_events->record(remaining_before - remaining);
+        _batch_bytes->record(wire_size);
+        _send_latency->record(static_cast<uint64_t>(send_time.count()));
+      }
     }
+
+    // An empty queue lets the flush interval grow back
+    _batch_size.on_flush(full_batches);
+    _periodic_background_proc.set_interval(_batch_size.flush_interval_ms());
   }
 
   template<typename TEvent, template<typename> class TSerializer, typename TFunc>
@@ -206,12 +317,13 @@ namespace reinforcement_learning { namespace logger {
     const utility::async_batcher_config& config)
     : _sender(sender)
     , _queue(config.send_queue_max_capacity)
-    , _send_high_water_mark(config.send_high_water_mark)
+    , _batch_size(config)
     , _perror_cb(perror_cb)
     , _shared_state(shared_state)
     , _periodic_background_proc(static_cast<int>(config.send_batch_interval_ms), watchdog, "Async batcher thread", perror_cb)
     , _pass_prob(0.5)
     , _queue_mode(config.queue_mode)
+    , _queue_block_timeout_ms(config.queue_block_timeout_ms)
     , _batch_content_encoding(config.batch_content_encoding)
     , _subsample_rate(config.subsample_rate)
   {}
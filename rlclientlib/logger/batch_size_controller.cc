@@ -0,0 +1,62 @@
+#include "batch_size_controller.h"
+
+#include <algorithm>
+
+namespace reinforcement_learning { namespace logger {
+  namespace {
+    const float EWMA_WEIGHT = 0.25f;
+    // bounds the high water mark to [target / 4, target * 32]
+    const float MIN_WIRE_RATIO = 1.f / 32;
+    const float MAX_WIRE_RATIO = 4.f;
+  }
+
+  batch_size_controller::batch_size_controller(const utility::async_batcher_config& config)
+    : _fixed_high_water_mark(config.send_high_water_mark)
+    , _target_bytes((std::max)(0, config.send_batch_target_bytes))
+    , _max_interval_ms(config.send_batch_interval_ms)
+    , _min_interval_ms((std::min)(config.send_batch_min_interval_ms, config.send_batch_interval_ms))
+    , _latency_budget_ms(config.send_batch_latency_budget_ms)
+    , _interval_ms(config.send_batch_interval_ms)
+  {}
+
+  size_t batch_size_controller::high_water_mark() const {
+    if (!enabled()) return _fixed_high_water_mark;
+    return static_cast<size_t>(_target_bytes / _wire_ratio);
+  }
+
+  int batch_size_controller::flush_interval_ms() const {
+    return _interval_ms;
+  }
+
+  void batch_size_controller::on_batch_sent(size_t estimated_size, size_t wire_size, int send_time_ms, int round_trip_ms) {
+    if (!enabled()) return;
+
+    if (estimated_size > 0 && wire_size > 0) {
+      const float ratio = static_cast<float>(wire_size) / estimated_size;
+      _wire_ratio = (1 - EWMA_WEIGHT) * _wire_ratio + EWMA_WEIGHT * ratio;
+      _wire_ratio = (std::min)((std::max)(_wire_ratio, MIN_WIRE_RATIO), MAX_WIRE_RATIO);
+    }
+
+    // A sender that doesn't report round trips is only visible through the time it blocks the batcher
+    const float round_trip = static_cast<float>((std::max)(send_time_ms, round_trip_ms));
+    _round_trip_ms = (1 - EWMA_WEIGHT) * _round_trip_ms + EWMA_WEIGHT * round_trip;
+  }
+
+  void batch_size_controller::on_flush(size_t full_batch_count) {
+    if (!enabled()) return;
+
+    if (full_batch_count > 0) {
+      // events arrive faster than a target sized batch per interval, ship them sooner
+      _interval_ms = (std::max)(_min_interval_ms, _interval_ms / 2);
+    }
+    else {
+      _interval_ms = (std::min)(_max_interval_ms, _interval_ms + _interval_ms / 4 + 1);
+    }
+
+    if (_latency_budget_ms > 0) {
+      // events wait up to one interval in the queue, then a round trip
+      const int budget = _latency_budget_ms - static_cast<int>(_round_trip_ms);
+      _interval_ms = (std::max)(_min_interval_ms, (std::min)(_interval_ms, budget));
+    }
+  }
+}}
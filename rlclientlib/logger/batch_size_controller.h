@@ -0,0 +1,42 @@
+#pragma once
+
+#include "utility/config_helper.h"
+
+#include <cstddef>
+
+namespace reinforcement_learning { namespace logger {
+  // Picks the size of the batches built by an async_batcher and how often it flushes.
+  // Without a target batch size it keeps the fixed send.highwatermark and send.batchintervalms.
+  // With one, the serializer size estimate is scaled by the measured ratio of bytes put on the wire
+  // to that estimate, and the flush interval shrinks while flushes keep filling whole batches.
+  class batch_size_controller {
+  public:
+    explicit batch_size_controller(const utility::async_batcher_config& config);
+
+    bool enabled() const { return _target_bytes > 0; }
+
+    //! Serializer size at which the batch being filled is closed
+    size_t high_water_mark() const;
+    //! Milliseconds until the next flush
+    int flush_interval_ms() const;
+
+    //! estimated_size is the serializer size when the batch was closed, wire_size the bytes handed to the sender.
+    //! send_time_ms is how long the sender blocked and round_trip_ms what the sender measured, 0 if it doesn't.
+    void on_batch_sent(size_t estimated_size, size_t wire_size, int send_time_ms, int round_trip_ms);
+    //! Called at the end of each flush with the number of batches that hit the high water mark
+    void on_flush(size_t full_batch_count);
+
+  private:
+    const size_t _fixed_high_water_mark;
+    const size_t _target_bytes;
+    const int _max_interval_ms;
+    const int _min_interval_ms;
+    const int _latency_budget_ms;
+
+    //! moving average of wire size / estimated size
+    float _wire_ratio = 1.f;
+    //! moving average of the time from handing a batch to the sender to it being acknowledged
+    float _round_trip_ms = 0.f;
+    int _interval_ms;
+  };
+}}
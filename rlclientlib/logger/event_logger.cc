@@ -3,22 +3,11 @@
 #include "err_constants.h"
 #include "time_helper.h"
 
-#include <functional>
 namespace reinforcement_learning { namespace logger {
-using namespace std::placeholders;
   int interaction_logger::log(const char* event_id, const char* context, unsigned int flags, const ranking_response& response, api_status* status, learning_mode learning_mode) {
     const auto now = _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
-    // std::bind being used here to avoid needing to copy the actual event. Lambdas allow capture statements
-    // in C++14, so we can remove the bind usage at that point
-    auto evt_fn = std::bind(
-      [](ranking_event& out_evt, api_status* status, ranking_event in_evt)->int {
-        out_evt = std::move(in_evt);
-        return error_code::success;
-      },
-      _1,
-      _2,
-      ranking_event::choose_rank(event_id, context, flags, response, now, 1.0f, learning_mode)
-    );
+    event_record<ranking_event> evt_fn(event_record<ranking_event>::ready_event{
+      ranking_event::choose_rank(event_id, context, flags, response, now, 1.0f, learning_mode) });
     return append(std::move(evt_fn), event_id, 1 /*TODO: fix size estimate*/, status);
     
   }
@@ -30,22 +19,7 @@ using namespace std::placeholders;
     // Short string optimization makes this unreliable. For now, just use event_ids[0] which the event uses underneath
     // const char* evt_id = evt.get_seed_id().c_str();
     const char* evt_id = event_ids[0];
-    /*
-    // TODO: For some reason, the bind function is not properly binding to the std::function.
-    // This means we need to do a full copy of the event
-    std::function<int(decision_ranking_event&, api_status*)> evt_fn = std::bind(
-      [](decision_ranking_event& out_evt, api_status* status, decision_ranking_event in_evt)->int {
-        out_evt = std::move(in_evt);
-        return error_code::success;
-      },
-      _1,
-      _2,
-      std::move(evt)
-    );*/
-    auto evt_fn = [evt](decision_ranking_event& out_evt, api_status* status)->int {
-      out_evt = std::move(evt);
-      return error_code::success;
-    };
+    event_record<decision_ranking_event> evt_fn(event_record<decision_ranking_event>::ready_event{ std::move(evt) });
     return append(std::move(evt_fn), evt_id, 1, status);
   }
 
@@ -54,30 +28,15 @@ using namespace std::placeholders;
 
     const auto now = _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
     
-    auto evt_fn = std::bind(
-      [](multi_slot_decision_event& out_evt, api_status* status, multi_slot_decision_event in_evt)->int {
-        out_evt = std::move(in_evt);
-        return error_code::success;
-      },
-      _1,
-      _2,
-      multi_slot_decision_event::request_decision(event_id, context, flags, action_ids, pdfs, model_version, now)
-    );
+    event_record<multi_slot_decision_event> evt_fn(event_record<multi_slot_decision_event>::ready_event{
+      multi_slot_decision_event::request_decision(event_id, context, flags, action_ids, pdfs, model_version, now) });
     return append(std::move(evt_fn), event_id.c_str(), 1, status);
   }
 
   int observation_logger::report_action_taken(const char* event_id, api_status* status) {
     const auto now = _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
 
-    auto evt_fn = std::bind(
-      [](outcome_event& out_evt, api_status* status, outcome_event in_evt)->int {
-        out_evt = std::move(in_evt);
-        return error_code::success;
-      },
-      _1,
-      _2,
-      outcome_event::report_action_taken(event_id, now)
-    );
+    event_record<outcome_event> evt_fn(event_record<outcome_event>::ready_event{ outcome_event::report_action_taken(event_id, now) });
     return append(std::move(evt_fn), event_id, 1, status);
   }
 }}
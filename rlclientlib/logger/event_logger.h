@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <cstring>
 #include <functional>
 #include <memory>
 
@@ -35,6 +36,13 @@ namespace reinforcement_learning { namespace logger {
 
     int init(api_status* status);
 
+    //! Counters of a lane of the batcher queue
+    event_queue_lane_metrics get_lane_metrics(event_priority priority) { return _batcher->get_lane_metrics(priority); }
+    //! Fill level of the batcher queue
+    queue_status get_queue_status() { return _batcher->get_queue_status(); }
+    //! See i_async_batcher::register_metrics, must be called before init
+    void register_metrics(utility::metrics_registry& registry, const std::string& prefix) { _batcher->register_metrics(registry, prefix); }
+
   protected:
     int append(TFunc&& func, const char* evt_id, size_t size_estimate, api_status* status);
     int append(TFunc& func, const char* evt_id, size_t size_estimate, api_status* status);
@@ -76,26 +84,26 @@ namespace reinforcement_learning { namespace logger {
     }
 
     // Add item to the batch (will be sent later)
-    return _batcher->append(item, evt_id, size_estimate, status);
+    return _batcher->append(std::move(func), evt_id, size_estimate, status);
   }
 
   template<typename TFunc>
   int event_logger<TFunc>::append(TFunc& func, const char* evt_id, size_t size_estimate, api_status* status) {
-    return append(std::move(item), evt_id, size_estimate, status);
+    return append(std::move(func), evt_id, size_estimate, status);
   }
 
-  class interaction_logger : public event_logger<std::function<int(ranking_event&, api_status*)>> {
+  class interaction_logger : public event_logger<event_record<ranking_event>> {
   public:
-    interaction_logger(i_time_provider* time_provider, i_async_batcher<std::function<int(ranking_event&, api_status*)>>* batcher)
+    interaction_logger(i_time_provider* time_provider, i_async_batcher<event_record<ranking_event>>* batcher)
       : event_logger(time_provider, batcher)
     {}
 
     int log(const char* event_id, const char* context, unsigned int flags, const ranking_response& response, api_status* status, learning_mode learning_mode = ONLINE);
   };
 
-class ccb_logger : public event_logger<std::function<int(decision_ranking_event&, api_status*)>> {
+class ccb_logger : public event_logger<event_record<decision_ranking_event>> {
   public:
-    ccb_logger(i_time_provider* time_provider, i_async_batcher<std::function<int(decision_ranking_event&, api_status*)>>* batcher)
+    ccb_logger(i_time_provider* time_provider, i_async_batcher<event_record<decision_ranking_event>>* batcher)
       : event_logger(time_provider, batcher)
     {}
 
@@ -103,9 +111,9 @@ class ccb_logger : public event_logger<std::function<int(decision_ranking_event&
       const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status);
   };
 
-class multi_slot_logger : public event_logger<std::function<int(multi_slot_decision_event&, api_status*)>> {
+class multi_slot_logger : public event_logger<event_record<multi_slot_decision_event>> {
   public:
-    multi_slot_logger(i_time_provider* time_provider, i_async_batcher<std::function<int(multi_slot_decision_event&, api_status*)>>* batcher)
+    multi_slot_logger(i_time_provider* time_provider, i_async_batcher<event_record<multi_slot_decision_event>>* batcher)
       : event_logger(time_provider, batcher)
     {}
 
@@ -113,49 +121,84 @@ class multi_slot_logger : public event_logger<std::function<int(multi_slot_decis
       const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status);
   };
 
-  class observation_logger : public event_logger<std::function<int(outcome_event&, api_status*)>> {
+  class observation_logger : public event_logger<event_record<outcome_event>> {
   public:
-    observation_logger(i_time_provider* time_provider, i_async_batcher<std::function<int(outcome_event&, api_status*)>>* batcher)
+    observation_logger(i_time_provider* time_provider, i_async_batcher<event_record<outcome_event>>* batcher)
       : event_logger(time_provider, batcher)
     {}
 
     template <typename D>
     int log(const char* event_id, D outcome, api_status* status) {
       const auto now = _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
-      return append(outcome_event::report_outcome(event_id, outcome, now), status);
+      return append(event_record<outcome_event>(event_record<outcome_event>::ready_event{ outcome_event::report_outcome(event_id, outcome, now) }), event_id, 1, status);
     }
 
     int report_action_taken(const char* event_id, api_status* status);
   };
 
-  class generic_event_logger : public event_logger<std::function<int(generic_event&, api_status*)>> {
+  class generic_event_logger : public event_logger<event_record<generic_event>> {
   public:
-    generic_event_logger(i_time_provider* time_provider, i_async_batcher<std::function<int(generic_event&, api_status*)>>* batcher, const char* app_id)
+    generic_event_logger(i_time_provider* time_provider, i_async_batcher<event_record<generic_event>>* batcher, const char* app_id)
       : event_logger(time_provider, batcher, app_id)
     {}
 
-    template<typename TSerializer, typename... Args>
-    int log(const char* event_id, const char* context, generic_event::payload_type_t type, i_logger_extensions* ext, TSerializer& serializer, api_status* status, Args... args) {
-      const auto now = _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
-      // using std::bind for the in_evt to get in-place construction.
-      // We can replace this with a pure lambda in C++14
-      using namespace std::placeholders;
-      std::function<int(generic_event&, api_status*)> evt_fn =
-        std::bind(
-          [type, ext, serializer, args...](generic_event& out_evt, api_status* status, generic_event in_evt)->int
-          {
-            RETURN_IF_FAIL(in_evt.transform(ext, serializer, status, args...));
-            out_evt = std::move(in_evt);
-            return error_code::success;
-          },
-          _1,
-          _2,
-          generic_event(event_id, now, type, context, _app_id)
-        );
-      return append(std::move(evt_fn), event_id, 1, status);
+    //! Builds the payload on the calling thread, straight from the caller's context
+    int log(const char* event_id, const char* context, generic_event::payload_type_t type, i_logger_extensions* ext,
+      const generic_event::payload_builder_t& build_payload, api_status* status, event_priority priority = event_priority::NORMAL) {
+      generic_event evt(event_id, now(), type, generic_event::payload_buffer_t(), event_content_type::IDENTITY, _app_id);
+      const int result = evt.transform(context, ext, build_payload, status);
+      if (result != error_code::success) {
+        evt.release_objects();
+        return result;
+      }
+      return append_event(event_id, std::move(evt), status, priority);
+    }
+
+    //! Only keeps a copy of the context, the payload is built by the batcher when the event is dequeued so
+    //! build_payload must own everything it refers to
+    int log_deferred(const char* event_id, const char* context, generic_event::payload_type_t type, i_logger_extensions* ext,
+      generic_event::payload_builder_t&& build_payload, api_status* status, event_priority priority = event_priority::NORMAL) {
+      const auto size_estimate = std::strlen(context);
+      deferred_event deferred{ generic_event(event_id, now(), type, generic_event::payload_buffer_t(), event_content_type::IDENTITY, _app_id),
+        std::string(context, size_estimate), ext, std::move(build_payload) };
+      event_record<generic_event> record(std::move(deferred));
+      record.set_priority(priority);
+      return append(std::move(record), event_id, size_estimate, status);
+    }
+
+    //! Logs an already serialized payload
+    int log(const char* event_id, generic_event::payload_buffer_t&& payload, generic_event::payload_type_t type, event_content_type content_type, api_status* status) {
+      return append_event(event_id, generic_event(event_id, now(), type, std::move(payload), content_type, _app_id), status);
+    }
+
+  private:
+    struct deferred_event {
+      generic_event evt;
+      std::string context;
+      i_logger_extensions* ext;
+      generic_event::payload_builder_t build_payload;
+
+      int operator()(generic_event& out_evt, api_status* status) {
+        const int result = evt.transform(context.c_str(), ext, build_payload, status);
+        if (result != error_code::success) {
+          // the event won't be serialized, its objects would never leave the dictionary
+          evt.release_objects();
+          return result;
+        }
+        out_evt = std::move(evt);
+        return error_code::success;
+      }
+    };
+
+    timestamp now() const {
+      return _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
+    }
+
+    int append_event(const char* event_id, generic_event&& evt, api_status* status, event_priority priority = event_priority::NORMAL) {
+      const auto size_estimate = evt.get_payload().size();
+      event_record<generic_event> record(event_record<generic_event>::ready_event{ std::move(evt) });
+      record.set_priority(priority);
+      return append(std::move(record), event_id, size_estimate, status);
     }
-    // deprecated
-    //int log(const char* event_id, generic_event::payload_type_t type, event_content_type content_type, api_status* status);
-    //int log(const char* event_id, generic_event::payload_buffer_t&& payload, generic_event::payload_type_t type, event_content_type content_type, generic_event::object_list_t&& objects, api_status* status);
   };
 }}
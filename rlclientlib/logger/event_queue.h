@@ -2,21 +2,55 @@
 
 #include "ranking_event.h"
 
-#include <list>
-#include <queue>
+#include <algorithm>
+#include <cstdint>
 #include <mutex>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace reinforcement_learning {
 
+  //Queue lane of an event. Under overload the lower lanes are pruned first, and in BLOCK mode their producers wait first.
+  enum class event_priority : uint8_t {
+    LOW = 0,
+    NORMAL = 1,
+    HIGH = 2
+  };
+
+  const size_t EVENT_PRIORITY_COUNT = 3;
+
+  //Per lane counters of an event_queue
+  struct event_queue_lane_metrics {
+    size_t queued = 0;       // events in the lane
+    size_t queued_bytes = 0; // sum of their size estimates
+    uint64_t enqueued = 0;   // events pushed since the queue was created
+    uint64_t dropped = 0;    // events pruned
+    uint64_t blocked = 0;    // pushes that waited for room in BLOCK mode
+  };
+
   //a moving concurrent queue with locks and mutex
+  //Items are kept in a ring per priority lane that only grows, so pushing doesn't allocate once the queue has reached its working size.
+  //Items are popped from the highest non empty lane first, in order within a lane.
+  //The queue is full for a lane once its capacity reaches the lane limit: max_capacity for NORMAL,
+  //LANE_HEADROOM_PERCENT less for LOW and more for HIGH. With NORMAL items only it behaves as a single queue.
   template <class T>
   class event_queue {
+  public:
+    static const size_t LANE_HEADROOM_PERCENT = 10;
+
   private:
-    using queue_t = std::list<std::pair<T,size_t>>;
-    using iterator_t = typename queue_t::iterator;
+    using entry_t = std::pair<T, size_t>;
+
+    struct lane_t {
+      std::vector<entry_t> _ring;
+      size_t _head{ 0 };  // index of the oldest item
+      size_t _count{ 0 };
+      event_queue_lane_metrics _metrics;
+    };
 
-    queue_t _queue;
+    lane_t _lanes[EVENT_PRIORITY_COUNT];
+    size_t _count{ 0 };
     std::mutex _mutex;
     int _drop_pass{ 0 };
     size_t _capacity{ 0 };
@@ -30,47 +64,65 @@ namespace reinforcement_learning {
     bool pop(T* item)
     {
       std::unique_lock<std::mutex> mlock(_mutex);
-      if (!_queue.empty())
-      {
-        auto entry(std::move(_queue.front()));
-        *item = std::move(entry.first);
-        _capacity = (std::max)(0, static_cast<int>(_capacity) - static_cast<int>(entry.second));
-        _queue.pop_front();
-        return true;
+      for (size_t l = EVENT_PRIORITY_COUNT; l-- > 0;) {
+        auto& lane = _lanes[l];
+        if (lane._count > 0)
+        {
+          auto& entry = lane._ring[lane._head];
+          *item = std::move(entry.first);
+          release(lane, entry.second);
+          lane._head = next(lane, lane._head);
+          --lane._count;
+          --_count;
+          return true;
+        }
       }
       return false;
     }
 
-    void push(T& item, size_t item_size) {
-      push(std::move(item), item_size);
+    void push(T& item, size_t item_size, event_priority priority = event_priority::NORMAL) {
+      push(std::move(item), item_size, priority);
     }
 
-    void push(T&& item, size_t item_size)
+    void push(T&& item, size_t item_size, event_priority priority = event_priority::NORMAL)
     {
       std::unique_lock<std::mutex> mlock(_mutex);
+      auto& lane = _lanes[static_cast<size_t>(priority)];
+      if (lane._count == lane._ring.size()) {
+        grow(lane);
+      }
+      auto& entry = lane._ring[(lane._head + lane._count) % lane._ring.size()];
+      entry.first = std::move(item);
+      entry.second = item_size;
+      ++lane._count;
+      ++_count;
       _capacity += item_size;
-      _queue.push_back({std::forward<T>(item),item_size});
+      lane._metrics.queued_bytes += item_size;
+      ++lane._metrics.enqueued;
     }
 
+    //Drops a pass_prob sample of the lowest lane while the queue is full for it, then moves up to the next lane
     void prune(float pass_prob)
     {
       std::unique_lock<std::mutex> mlock(_mutex);
-      if (!is_full()) return;
-      for (auto it = _queue.begin(); it != _queue.end();) {
-        it = it->first.try_drop(pass_prob, _drop_pass) ? erase(it) : (++it);
+      bool pruned = false;
+      for (size_t l = 0; l < EVENT_PRIORITY_COUNT; ++l) {
+        if (_capacity < lane_limit(l)) break;
+        prune_lane(_lanes[l], pass_prob);
+        pruned = true;
       }
-      ++_drop_pass;
+      if (pruned) ++_drop_pass;
     }
 
     //approximate size
     size_t size()
     {
       std::unique_lock<std::mutex> mlock(_mutex);
-      return _queue.size();
+      return _count;
     }
 
-    bool is_full() const {
-      return capacity() >= _max_capacity;
+    bool is_full(event_priority priority = event_priority::NORMAL) const {
+      return capacity() >= lane_limit(static_cast<size_t>(priority));
     }
 
     size_t capacity() const 
@@ -78,12 +130,71 @@ namespace reinforcement_learning {
       return _capacity;
     }
 
+    size_t max_capacity() const {
+      return _max_capacity;
+    }
+
+    //Counts a push of the lane that had to wait for room
+    void on_blocked(event_priority priority) {
+      std::unique_lock<std::mutex> mlock(_mutex);
+      ++_lanes[static_cast<size_t>(priority)]._metrics.blocked;
+    }
+
+    event_queue_lane_metrics get_lane_metrics(event_priority priority) {
+      std::unique_lock<std::mutex> mlock(_mutex);
+      const auto& lane = _lanes[static_cast<size_t>(priority)];
+      auto metrics = lane._metrics;
+      metrics.queued = lane._count;
+      return metrics;
+    }
+
   private:
+    size_t lane_limit(size_t lane) const {
+      const auto normal = static_cast<size_t>(event_priority::NORMAL);
+      const auto headroom = _max_capacity * LANE_HEADROOM_PERCENT / 100;
+      return lane < normal ? _max_capacity - (normal - lane) * headroom : _max_capacity + (lane - normal) * headroom;
+    }
+
+    //thread-unsafe
+    void release(lane_t& lane, size_t item_size) {
+      _capacity = (std::max)(0, static_cast<int>(_capacity) - static_cast<int>(item_size));
+      lane._metrics.queued_bytes = (std::max)(0, static_cast<int>(lane._metrics.queued_bytes) - static_cast<int>(item_size));
+    }
+
     //thread-unsafe
-    iterator_t erase(iterator_t it) {
-      _capacity = (std::max)(0, static_cast<int>(_capacity) - static_cast<int>(it->second));
-      return _queue.erase(it);
+    void prune_lane(lane_t& lane, float pass_prob) {
+      // compact the kept items towards the head, preserving their order
+      size_t kept = 0;
+      for (size_t i = 0; i < lane._count; ++i) {
+        auto& entry = lane._ring[(lane._head + i) % lane._ring.size()];
+        if (entry.first.try_drop(pass_prob, _drop_pass)) {
+          release(lane, entry.second);
+          entry.first = T();
+          ++lane._metrics.dropped;
+          continue;
+        }
+        if (kept != i) {
+          lane._ring[(lane._head + kept) % lane._ring.size()] = std::move(entry);
+        }
+        ++kept;
+      }
+      _count -= lane._count - kept;
+      lane._count = kept;
+    }
+
+    //thread-unsafe
+    static size_t next(const lane_t& lane, size_t index) {
+      return index + 1 == lane._ring.size() ? 0 : index + 1;
+    }
+
+    //thread-unsafe
+    static void grow(lane_t& lane) {
+      std::vector<entry_t> ring((std::max)(lane._ring.size() * 2, size_t(16)));
+      for (size_t i = 0; i < lane._count; ++i) {
+        ring[i] = std::move(lane._ring[(lane._head + i) % lane._ring.size()]);
+      }
+      lane._ring.swap(ring);
+      lane._head = 0;
     }
   };
 }
-
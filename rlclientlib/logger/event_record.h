@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "err_constants.h"
+#include "event_queue.h"
+#include "explore_internal.h"
+
+namespace reinforcement_learning {
+  class api_status;
+}
+
+namespace reinforcement_learning { namespace logger {
+  // A queued event for async_batcher: a move only callable int(TEvent& out_evt, api_status* status) that
+  // produces the event when the batch is serialized. It replaces std::function, which requires copyable
+  // closures and allocates for anything but the smallest ones. Closures up to INLINE_SIZE bytes are stored
+  // in place, so queuing an event doesn't allocate.
+  template <typename TEvent>
+  class event_record {
+  public:
+    static const size_t INLINE_SIZE = 256;
+
+    event_record() = default;
+
+    template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, event_record>::value>::type>
+    event_record(F&& fn) {
+      emplace<typename std::decay<F>::type>(std::forward<F>(fn));
+    }
+
+    event_record(event_record&& other) noexcept { move_from(other); }
+
+    event_record& operator=(event_record&& other) noexcept {
+      if (this != &other) {
+        reset();
+        move_from(other);
+      }
+      return *this;
+    }
+
+    event_record(const event_record&) = delete;
+    event_record& operator=(const event_record&) = delete;
+
+    ~event_record() { reset(); }
+
+    explicit operator bool() const { return _ops != nullptr; }
+
+    int operator()(TEvent& out_evt, api_status* status) {
+      const int result = _ops->invoke(target(), out_evt, status);
+      // the drop passes the record survived in the queue, whether the event was ready or built just now
+      if (result == error_code::success && _pass_prob < 1.f) {
+        out_evt.scale_pass_prob(_pass_prob);
+      }
+      return result;
+    }
+
+    //! True if the closure lives in the record itself
+    bool is_inline() const { return _ops != nullptr && _ops->move != nullptr; }
+
+    //! Seeds try_drop, usually with a hash of the event id
+    void set_drop_seed(uint64_t seed) { _drop_seed = seed; }
+
+    //! Queue lane of the event, NORMAL by default
+    void set_priority(event_priority priority) { _priority = priority; }
+    event_priority priority() const { return _priority; }
+
+    //! Same contract as event::try_drop. The pass probability is carried into the event once it is produced.
+    bool try_drop(float pass_prob, int drop_pass) {
+      _pass_prob *= pass_prob;
+      return exploration::uniform_random_merand48(_drop_seed + drop_pass) > pass_prob;
+    }
+
+    //! Product of the pass probabilities of the drop passes so far
+    float pass_prob() const { return _pass_prob; }
+
+    //! Undoes what building the event up front did, e.g. the dedup objects extracted for a generic_event,
+    //! for a record that is dropped without being invoked
+    void discard() {
+      if (_ops != nullptr) {
+        _ops->discard(target());
+      }
+    }
+
+    void reset() {
+      if (_ops != nullptr) {
+        _ops->destroy(target());
+        _ops = nullptr;
+      }
+    }
+
+    //! Closure that hands over an event built up front
+    struct ready_event {
+      TEvent evt;
+      int operator()(TEvent& out_evt, api_status*) {
+        out_evt = std::move(evt);
+        return error_code::success;
+      }
+      void discard() { release_objects(evt, 0); }
+    };
+
+  private:
+    struct ops_t {
+      int (*invoke)(void* fn, TEvent& out_evt, api_status* status);
+      // null for closures stored on the heap, which move by pointer
+      void (*move)(void* from, void* to);
+      void (*destroy)(void* fn);
+      void (*discard)(void* fn);
+    };
+
+    // Closures and events without anything to undo don't need a discard / release_objects member
+    template <typename F>
+    static auto discard_closure(F& fn, int) -> decltype(fn.discard(), void()) { fn.discard(); }
+    template <typename F>
+    static void discard_closure(F&, long) {}
+
+    template <typename E>
+    static auto release_objects(E& evt, int) -> decltype(evt.release_objects(), void()) { evt.release_objects(); }
+    template <typename E>
+    static void release_objects(E&, long) {}
+
+    // Inline closures are moved along with the record, which is noexcept: they aren't expected to throw when moved
+    // (flatbuffers::DetachedBuffer for one doesn't declare it)
+    template <typename F>
+    struct fits_inline : std::integral_constant<bool,
+      sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t)> {};
+
+    template <typename F>
+    struct inline_ops {
+      static int invoke(void* fn, TEvent& out_evt, api_status* status) { return (*static_cast<F*>(fn))(out_evt, status); }
+      static void move(void* from, void* to) {
+        new (to) F(std::move(*static_cast<F*>(from)));
+        static_cast<F*>(from)->~F();
+      }
+      static void destroy(void* fn) { static_cast<F*>(fn)->~F(); }
+      static void discard(void* fn) { discard_closure(*static_cast<F*>(fn), 0); }
+      static const ops_t ops;
+    };
+
+    template <typename F>
+    struct heap_ops {
+      static int invoke(void* fn, TEvent& out_evt, api_status* status) { return (*static_cast<F*>(fn))(out_evt, status); }
+      static void destroy(void* fn) { delete static_cast<F*>(fn); }
+      static void discard(void* fn) { discard_closure(*static_cast<F*>(fn), 0); }
+      static const ops_t ops;
+    };
+
+    template <typename F, typename A>
+    typename std::enable_if<fits_inline<F>::value>::type emplace(A&& fn) {
+      new (&_storage) F(std::forward<A>(fn));
+      _ops = &inline_ops<F>::ops;
+    }
+
+    template <typename F, typename A>
+    typename std::enable_if<!fits_inline<F>::value>::type emplace(A&& fn) {
+      *reinterpret_cast<void**>(&_storage) = new F(std::forward<A>(fn));
+      _ops = &heap_ops<F>::ops;
+    }
+
+    void* target() {
+      return _ops->move != nullptr ? static_cast<void*>(&_storage) : *reinterpret_cast<void**>(&_storage);
+    }
+
+    void move_from(event_record& other) {
+      _drop_seed = other._drop_seed;
+      _pass_prob = other._pass_prob;
+      _priority = other._priority;
+      if (other._ops == nullptr) return;
+      if (other._ops->move != nullptr) {
+        other._ops->move(&other._storage, &_storage);
+      }
+      else {
+        *reinterpret_cast<void**>(&_storage) = *reinterpret_cast<void**>(&other._storage);
+      }
+      _ops = other._ops;
+      other._ops = nullptr;
+    }
+
+    typename std::aligned_storage<INLINE_SIZE, alignof(std::max_align_t)>::type _storage;
+    const ops_t* _ops = nullptr;
+    uint64_t _drop_seed = 0;
+    float _pass_prob = 1.f;
+    event_priority _priority = event_priority::NORMAL;
+  };
+
+  template <typename TEvent>
+  template <typename F>
+  const typename event_record<TEvent>::ops_t event_record<TEvent>::inline_ops<F>::ops = {
+    &event_record<TEvent>::inline_ops<F>::invoke,
+    &event_record<TEvent>::inline_ops<F>::move,
+    &event_record<TEvent>::inline_ops<F>::destroy,
+    &event_record<TEvent>::inline_ops<F>::discard
+  };
+
+  template <typename TEvent>
+  template <typename F>
+  const typename event_record<TEvent>::ops_t event_record<TEvent>::heap_ops<F>::ops = {
+    &event_record<TEvent>::heap_ops<F>::invoke,
+    nullptr,
+    &event_record<TEvent>::heap_ops<F>::destroy,
+    &event_record<TEvent>::heap_ops<F>::discard
+  };
+}}
@@ -17,6 +17,7 @@
 #include <pplx/pplxtasks.h>
 #include <cpprest/http_headers.h>
 
+#include <atomic>
 #include <memory>
 #include <sstream>
 #include "data_buffer.h"
@@ -35,6 +36,8 @@ namespace reinforcement_learning {
   class http_transport_client : public i_sender {
   public:
     virtual int init(const utility::configuration& config, api_status* status) override;
+    int round_trip_ms() const override;
+    uint64_t retry_count() const override;
 
     // Takes the ownership of the i_http_client and delete it at the end of lifetime
     http_transport_client(i_http_client* client, size_t tasks_count, size_t MAX_RETRIES, i_trace* trace, error_callback_fn* _error_cb);
@@ -53,7 +56,9 @@ namespace reinforcement_learning {
         const buffer& data,
         size_t max_retries = 1, // If MAX_RETRIES is set to 1, only the initial request will be attempted.
         error_callback_fn* error_callback = nullptr,
-        i_trace* trace = nullptr);
+        i_trace* trace = nullptr,
+        std::atomic<int>* round_trip_ms = nullptr,
+        std::atomic<uint64_t>* retry_count = nullptr);
 
       // The constructor kicks off an async request which captures the this variable. If this object is moved then the
       // this pointer is invalidated and causes tricky bugs.
@@ -77,6 +82,10 @@ namespace reinforcement_learning {
 
       error_callback_fn* _error_callback;
       i_trace* _trace;
+
+      std::atomic<int>* _round_trip_ms;
+      std::atomic<uint64_t>* _retry_count;
+      std::chrono::steady_clock::time_point _start;
     };
 
   private:
@@ -98,6 +107,8 @@ namespace reinforcement_learning {
     const size_t _max_retries;
     i_trace* _trace;
     error_callback_fn* _error_callback;
+    std::atomic<int> _round_trip_ms;
+    std::atomic<uint64_t> _retry_count;
   };
 
   template <typename TAuthorization>
@@ -107,13 +118,18 @@ namespace reinforcement_learning {
     const buffer& post_data,
     size_t max_retries,
     error_callback_fn* error_callback,
-    i_trace* trace)
+    i_trace* trace,
+    std::atomic<int>* round_trip_ms,
+    std::atomic<uint64_t>* retry_count)
     : _client(client),
     _headers(headers),
     _post_data(post_data),
     _max_retries(max_retries),
     _error_callback(error_callback),
-    _trace(trace)
+    _trace(trace),
+    _round_trip_ms(round_trip_ms),
+    _retry_count(retry_count),
+    _start(std::chrono::steady_clock::now())
     {
       _task = send_request(0 /* inital try */);
     }
@@ -144,6 +160,9 @@ namespace reinforcement_learning {
         // Stop condition of recurison.
         if (try_count < _max_retries) {
           TRACE_ERROR(_trace, "HTTP request failed, retrying...");
+          if (_retry_count != nullptr) {
+            ++*_retry_count;
+          }
 
           // Yes, recursively send another request inside this one. If a subsequent request returns success we are good, otherwise the failure will propagate.
           return send_request(try_count + 1).get();
@@ -158,6 +177,12 @@ namespace reinforcement_learning {
       }
 
       // We have succeeded, return success.
+      if (_round_trip_ms != nullptr) {
+        // Retries are part of the round trip. The update is racy but only loses samples of a moving average.
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start);
+        const int previous = _round_trip_ms->load();
+        _round_trip_ms->store(previous == 0 ? static_cast<int>(elapsed.count()) : (3 * previous + static_cast<int>(elapsed.count())) / 4);
+      }
       return code;
     });
   }
@@ -177,6 +202,16 @@ namespace reinforcement_learning {
     return error_code::success;
   }
 
+  template <typename TAuthorization>
+  int http_transport_client<TAuthorization>::round_trip_ms() const {
+    return _round_trip_ms.load();
+  }
+
+  template <typename TAuthorization>
+  uint64_t http_transport_client<TAuthorization>::retry_count() const {
+    return _retry_count.load();
+  }
+
   template <typename TAuthorization>
   int http_transport_client<TAuthorization>::pop_task(api_status* status) {
     // This function must be under a lock as there is a delay between popping from the queue and joining the task, but it should essentially be atomic.
@@ -208,7 +243,7 @@ namespace reinforcement_learning {
         RETURN_IF_FAIL(pop_task(status));
       }
 
-      std::unique_ptr<http_request_task> request_task(new http_request_task(_client.get(), headers, post_data, _max_retries, _error_callback, _trace));
+      std::unique_ptr<http_request_task> request_task(new http_request_task(_client.get(), headers, post_data, _max_retries, _error_callback, _trace, &_round_trip_ms, &_retry_count));
       _tasks.push(std::move(request_task));
     }
     catch (const std::exception& e) {
@@ -223,7 +258,9 @@ namespace reinforcement_learning {
     , _max_tasks_count(max_tasks_count)
     , _max_retries(max_retries)
     , _trace(trace)
-    , _error_callback(error_callback) {
+    , _error_callback(error_callback)
+    , _round_trip_ms(0)
+    , _retry_count(0) {
   }
 
   template <typename TAuthorization>
@@ -10,7 +10,7 @@ public:
 		delete provider; //We don't use it
 	}
 
-	i_async_batcher<generic_event>* create_batcher(i_message_sender* sender, utility::watchdog& watchdog, error_callback_fn* perror_cb, const char* section) override {
+	i_async_batcher<event_record<generic_event>>* create_batcher(i_message_sender* sender, utility::watchdog& watchdog, error_callback_fn* perror_cb, const char* section) override {
 		auto config = utility::get_batcher_config(_config, section);
 		return new async_batcher<generic_event, fb_collection_serializer>(
 				sender,
@@ -38,6 +38,7 @@ private:
 
 i_logger_extensions::i_logger_extensions(const utility::configuration& config): _config(config) { }
 i_logger_extensions::~i_logger_extensions() { }
+int i_logger_extensions::init(api_status* status) { return error_code::success; }
 
 
 i_logger_extensions* i_logger_extensions::get_extensions(const utility::configuration& config, i_time_provider* time_provider) {
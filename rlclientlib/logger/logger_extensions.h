@@ -8,11 +8,11 @@
 
 namespace reinforcement_learning{
 // forward declare all the types
-namespace utility { class watchdog; }
+namespace utility { class watchdog; class metrics_registry; }
 class generic_event;
 class api_status;
 class i_time_provider;
-namespace logger { class i_message_sender; }
+namespace logger { class i_message_sender; template <typename TEvent> class event_record; }
 
 namespace logger {
 
@@ -31,12 +31,21 @@ namespace logger {
 
       virtual ~i_logger_extensions();
 
+      //! Called once by live_model_impl before any batcher is created
+      virtual int init(api_status* status);
+
+      //! Adds the gauges of the extension, called once by live_model_impl after init
+      virtual void register_metrics(utility::metrics_registry& registry) {}
+
       virtual bool is_object_extraction_enabled() const = 0;
       virtual bool is_serialization_transform_enabled() const = 0;
 
-      virtual i_async_batcher<std::function<int(generic_event&, api_status*)>>* create_batcher(i_message_sender* sender, utility::watchdog& watchdog, error_callback_fn* perror_cb, const char* section) = 0;
+      virtual i_async_batcher<event_record<generic_event>>* create_batcher(i_message_sender* sender, utility::watchdog& watchdog, error_callback_fn* perror_cb, const char* section) = 0;
       virtual int transform_payload_and_extract_objects(const char* context, std::string& edited_payload, generic_event::object_list_t& objects, api_status* status) = 0;
       virtual int transform_serialized_payload(generic_event::payload_buffer_t& input, event_content_type &content_type, api_status* status) const = 0;
+      //! Gives back the objects extracted for an event that is never serialized, unlike the other calls this one can
+      //! come from any thread
+      virtual void release_objects(const generic_event::object_list_t& objects) {}
 
       static i_logger_extensions* get_extensions(const utility::configuration& config, i_time_provider* time_provider);
     };
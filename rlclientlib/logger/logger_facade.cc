@@ -1,6 +1,12 @@
 #include "logger_facade.h"
 #include "err_constants.h"
 
+#include <cstring>
+
+#ifndef _WIN32
+#define _stricmp strcasecmp
+#endif
+
 namespace err = reinforcement_learning::error_code;
 
 namespace reinforcement_learning {
@@ -12,7 +18,7 @@ namespace reinforcement_learning {
     }
 
     template<typename T>
-    i_async_batcher<T>* create_legacy_async_batcher(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog,
+    i_async_batcher<event_record<T>>* create_legacy_async_batcher(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog,
       error_callback_fn* perror_cb, const char *section, typename async_batcher<T, fb_collection_serializer>::shared_state_t &shared_state) {
 
       auto config = utility::get_batcher_config(c, section);
@@ -25,6 +31,34 @@ namespace reinforcement_learning {
       );
     }
 
+    i_async_batcher<event_record<generic_event>>* create_observation_async_batcher(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog,
+      error_callback_fn* perror_cb, int& shared_state) {
+      if (!c.get_bool(OBSERVATION_SECTION, name::COALESCE_OUTCOMES, false)) {
+        return create_legacy_async_batcher<generic_event>(c, sender, watchdog, perror_cb, OBSERVATION_SECTION, shared_state);
+      }
+
+      auto config = utility::get_batcher_config(c, OBSERVATION_SECTION);
+      return new async_batcher<generic_event, outcome_collection_serializer>(
+        sender,
+        watchdog,
+        shared_state,
+        perror_cb,
+        config
+      );
+    }
+
+    // Unknown values fall back to def, as for the queue mode
+    event_priority to_event_priority(const char* priority, event_priority def) {
+      if (_stricmp(priority, value::QUEUE_PRIORITY_LOW) == 0) return event_priority::LOW;
+      if (_stricmp(priority, value::QUEUE_PRIORITY_NORMAL) == 0) return event_priority::NORMAL;
+      if (_stricmp(priority, value::QUEUE_PRIORITY_HIGH) == 0) return event_priority::HIGH;
+      return def;
+    }
+
+    bool has_priority(const utility::configuration& c, const char* name) {
+      return std::strlen(c.get(name, "")) > 0;
+    }
+
     interaction_logger_facade::interaction_logger_facade(
       model_type_t model_type,
       const utility::configuration& c,
@@ -35,6 +69,14 @@ namespace reinforcement_learning {
       error_callback_fn* perror_cb)
     : _model_type(model_type)
     , _version(c.get_int(name::PROTOCOL_VERSION, value::DEFAULT_PROTOCOL_VERSION))
+    , _deferred_serialization(c.get_bool(INTERACTION_SECTION, name::DEFERRED_SERIALIZATION, false))
+    , _priority_cb(to_event_priority(c.get(name::QUEUE_PRIORITY_CB, ""), event_priority::NORMAL))
+    , _priority_ca(to_event_priority(c.get(name::QUEUE_PRIORITY_CA, ""), event_priority::NORMAL))
+    , _priority_multi_slot(to_event_priority(c.get(name::QUEUE_PRIORITY_MULTI_SLOT, ""), event_priority::NORMAL))
+    , _has_priority_deferred(has_priority(c, name::QUEUE_PRIORITY_DEFERRED))
+    , _priority_deferred(to_event_priority(c.get(name::QUEUE_PRIORITY_DEFERRED, ""), event_priority::NORMAL))
+    , _has_priority_apprentice(has_priority(c, name::QUEUE_PRIORITY_APPRENTICE))
+    , _priority_apprentice(to_event_priority(c.get(name::QUEUE_PRIORITY_APPRENTICE, ""), event_priority::NORMAL))
     , _serializer_shared_state(0)
     , _ext_p(ext)
     , _v1_cb(_version == 1 && _model_type == model_type_t::CB ? new interaction_logger(time_provider, create_legacy_async_batcher<ranking_event>(c, sender, watchdog, perror_cb, INTERACTION_SECTION, _serializer_shared_state)) : nullptr)
@@ -60,22 +102,74 @@ namespace reinforcement_learning {
       }
     }
 
+    // Action flags win over the deferred and apprentice settings, which win over the payload type's
+    event_priority interaction_logger_facade::get_priority(unsigned int flags, event_priority type_priority, learning_mode mode) const {
+      if ((flags & action_flags::PRIORITY_HIGH) != 0u) return event_priority::HIGH;
+      if ((flags & action_flags::PRIORITY_LOW) != 0u) return event_priority::LOW;
+      if ((flags & action_flags::DEFERRED) != 0u && _has_priority_deferred) return _priority_deferred;
+      if (mode != ONLINE && _has_priority_apprentice) return _priority_apprentice;
+      return type_priority;
+    }
 
-    template<typename TSerializer, typename... Rest>
-    int wrap_log_call(i_logger_extensions& ext, TSerializer& serializer, const char* context, generic_event::object_list_t& objects, generic_event::payload_buffer_t& payload, event_content_type &content_type, api_status* status, const Rest&... rest) {
-      if(!ext.is_object_extraction_enabled()) {
-        payload = serializer.event(context, rest...);
-      } else {
-        std::string tmp;
-        RETURN_IF_FAIL(ext.transform_payload_and_extract_objects(context, tmp, objects, status));
-        payload = serializer.event(tmp.c_str(), rest...);
+    event_queue_lane_metrics interaction_logger_facade::get_lane_metrics(event_priority priority) {
+      switch (_version) {
+        case 1:
+          switch (_model_type) {
+          case model_type_t::CB: return _v1_cb->get_lane_metrics(priority);
+          case model_type_t::CCB: return _v1_ccb->get_lane_metrics(priority);
+          case model_type_t::SLATES: return _v1_multislot->get_lane_metrics(priority);
+          default: return event_queue_lane_metrics();
+          }
+        case 2: return _v2->get_lane_metrics(priority);
+        default: return event_queue_lane_metrics();
       }
-      if(ext.is_serialization_transform_enabled()) {
-        RETURN_IF_FAIL(ext.transform_serialized_payload(payload, content_type, status));
-      } else {
-        content_type = event_content_type::IDENTITY;
+    }
+
+    queue_status interaction_logger_facade::get_queue_status() {
+      switch (_version) {
+        case 1:
+          switch (_model_type) {
+          case model_type_t::CB: return _v1_cb->get_queue_status();
+          case model_type_t::CCB: return _v1_ccb->get_queue_status();
+          case model_type_t::SLATES: return _v1_multislot->get_queue_status();
+          default: return queue_status();
+          }
+        case 2: return _v2->get_queue_status();
+        default: return queue_status();
+      }
+    }
+
+    void interaction_logger_facade::register_metrics(utility::metrics_registry& registry) {
+      switch (_version) {
+        case 1:
+          switch (_model_type) {
+          case model_type_t::CB: _v1_cb->register_metrics(registry, INTERACTION_SECTION); break;
+          case model_type_t::CCB: _v1_ccb->register_metrics(registry, INTERACTION_SECTION); break;
+          case model_type_t::SLATES: _v1_multislot->register_metrics(registry, INTERACTION_SECTION); break;
+          default: break;
+          }
+          break;
+        case 2: _v2->register_metrics(registry, INTERACTION_SECTION); break;
+        default: break;
       }
-      return error_code::success;
+    }
+
+    // The caller keeps the response, deferred payloads are built from a copy of what the serializer reads
+    std::shared_ptr<ranking_response> copy_for_payload(const ranking_response& response) {
+      auto copy = std::make_shared<ranking_response>(response.get_event_id());
+      copy->set_model_id(response.get_model_id());
+      for (const auto& r : response) {
+        copy->push_back(r.action_id, r.probability);
+      }
+      return copy;
+    }
+
+    std::shared_ptr<continuous_action_response> copy_for_payload(const continuous_action_response& response) {
+      auto copy = std::make_shared<continuous_action_response>();
+      copy->set_chosen_action(response.get_chosen_action());
+      copy->set_chosen_action_pdf_value(response.get_chosen_action_pdf_value());
+      copy->set_model_id(response.get_model_id());
+      return copy;
     }
 
     int interaction_logger_facade::log(const char* context, unsigned int flags, const ranking_response& response, api_status* status, learning_mode learning_mode) {
@@ -84,12 +178,14 @@ namespace reinforcement_learning {
         case 2: {
           v2::LearningModeType lmt;
           RETURN_IF_FAIL(get_learning_mode(learning_mode, lmt, status));
-          generic_event::object_list_t actions;
-          generic_event::payload_buffer_t payload;
-          event_content_type content_type;
-
-          RETURN_IF_FAIL(wrap_log_call(*_ext_p, _serializer_cb, context, actions, payload, content_type, status, flags, lmt, response));
-          return _v2->log(response.get_event_id(), std::move(payload), _serializer_cb.type, content_type, std::move(actions), status);
+          const auto priority = get_priority(flags, _priority_cb, learning_mode);
+          if (_deferred_serialization) {
+            const auto snapshot = copy_for_payload(response);
+            return _v2->log_deferred(response.get_event_id(), context, _serializer_cb.type, _ext_p,
+              [flags, lmt, snapshot](const char* payload_context) { return cb_serializer::event(payload_context, flags, lmt, *snapshot); }, status, priority);
+          }
+          return _v2->log(response.get_event_id(), context, _serializer_cb.type, _ext_p,
+            [&](const char* payload_context) { return _serializer_cb.event(payload_context, flags, lmt, response); }, status, priority);
         }
         default: return protocol_not_supported(status);
       }
@@ -134,12 +230,17 @@ namespace reinforcement_learning {
         generic_event::payload_type_t payload_type;
         RETURN_IF_FAIL(multi_slot_model_type_to_payload_type(_model_type, payload_type, status));
 
-        generic_event::object_list_t actions;
-        generic_event::payload_buffer_t payload;
-        event_content_type content_type;
-
-        RETURN_IF_FAIL(wrap_log_call(*_ext_p, _serializer_multislot, context, actions, payload, content_type, status, flags, action_ids, pdfs, model_version, slot_ids, baseline_actions, lmt));
-        return _v2->log(event_id.c_str(), std::move(payload), payload_type, content_type, std::move(actions), status);
+        const auto priority = get_priority(flags, _priority_multi_slot, learning_mode);
+        if (_deferred_serialization) {
+          return _v2->log_deferred(event_id.c_str(), context, payload_type, _ext_p,
+            [flags, action_ids, pdfs, model_version, slot_ids, baseline_actions, lmt](const char* payload_context) {
+              return multi_slot_serializer::event(payload_context, flags, action_ids, pdfs, model_version, slot_ids, baseline_actions, lmt);
+            }, status, priority);
+        }
+        return _v2->log(event_id.c_str(), context, payload_type, _ext_p,
+          [&](const char* payload_context) {
+            return _serializer_multislot.event(payload_context, flags, action_ids, pdfs, model_version, slot_ids, baseline_actions, lmt);
+          }, status, priority);
       }
       default: return protocol_not_supported(status);
       }
@@ -148,12 +249,14 @@ namespace reinforcement_learning {
     int interaction_logger_facade::log_continuous_action(const char* context, unsigned int flags, const continuous_action_response& response, api_status* status) {
       switch (_version) {
       case 2: {
-        generic_event::object_list_t actions;
-        generic_event::payload_buffer_t payload;
-        event_content_type content_type;
-
-        RETURN_IF_FAIL(wrap_log_call(*_ext_p, _serializer_ca, context, actions, payload, content_type, status, flags, response));
-        return _v2->log(response.get_event_id(), std::move(payload), _serializer_ca.type, content_type, std::move(actions), status);
+        const auto priority = get_priority(flags, _priority_ca, ONLINE);
+        if (_deferred_serialization) {
+          const auto snapshot = copy_for_payload(response);
+          return _v2->log_deferred(response.get_event_id(), context, _serializer_ca.type, _ext_p,
+            [flags, snapshot](const char* payload_context) { return ca_serializer::event(payload_context, flags, *snapshot); }, status, priority);
+        }
+        return _v2->log(response.get_event_id(), context, _serializer_ca.type, _ext_p,
+          [&](const char* payload_context) { return _serializer_ca.event(payload_context, flags, response); }, status, priority);
       }
       default: return protocol_not_supported(status);
       }
@@ -170,7 +273,7 @@ namespace reinforcement_learning {
     , _v1(_version == 1 ? new observation_logger(time_provider, create_legacy_async_batcher<outcome_event>(c, sender, watchdog, perror_cb, OBSERVATION_SECTION, _serializer_shared_state)) : nullptr)
     , _v2(_version == 2 ? new generic_event_logger(
       time_provider,
-      create_legacy_async_batcher<generic_event>(c, sender, watchdog, perror_cb, OBSERVATION_SECTION, _serializer_shared_state),
+      create_observation_async_batcher(c, sender, watchdog, perror_cb, _serializer_shared_state),
       c.get(name::APP_ID, "")) : nullptr) {		
     }
 
@@ -234,5 +337,29 @@ namespace reinforcement_learning {
         default: return protocol_not_supported(status);
       }
     }
+
+    event_queue_lane_metrics observation_logger_facade::get_lane_metrics(event_priority priority) {
+      switch (_version) {
+        case 1: return _v1->get_lane_metrics(priority);
+        case 2: return _v2->get_lane_metrics(priority);
+        default: return event_queue_lane_metrics();
+      }
+    }
+
+    queue_status observation_logger_facade::get_queue_status() {
+      switch (_version) {
+        case 1: return _v1->get_queue_status();
+        case 2: return _v2->get_queue_status();
+        default: return queue_status();
+      }
+    }
+
+    void observation_logger_facade::register_metrics(utility::metrics_registry& registry) {
+      switch (_version) {
+        case 1: _v1->register_metrics(registry, OBSERVATION_SECTION); break;
+        case 2: _v2->register_metrics(registry, OBSERVATION_SECTION); break;
+        default: break;
+      }
+    }
   }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "action_flags.h"
 #include "api_status.h"
 #include "configuration.h"
 #include "constants.h"
@@ -16,6 +17,7 @@
 #include "model_mgmt.h"
 
 #include "serialization/payload_serializer.h"
+#include "serialization/outcome_collection_serializer.h"
 
 #include <functional>
 
@@ -51,9 +53,27 @@ namespace reinforcement_learning
       //Continuous
       int log_continuous_action(const char* context, unsigned int flags, const continuous_action_response& response, api_status* status);
 
+      //Counters of a lane of the interaction queue
+      event_queue_lane_metrics get_lane_metrics(event_priority priority);
+      queue_status get_queue_status();
+      //Adds the metrics of the interaction batcher, must be called before init
+      void register_metrics(utility::metrics_registry& registry);
+
     private:
+      event_priority get_priority(unsigned int flags, event_priority type_priority, learning_mode mode) const;
+
       const reinforcement_learning::model_management::model_type_t _model_type;
       const int _version;
+      // v2 payloads are built by the batcher instead of the calling thread
+      const bool _deferred_serialization;
+      // Queue lanes of v2 interactions, see get_priority
+      const event_priority _priority_cb;
+      const event_priority _priority_ca;
+      const event_priority _priority_multi_slot;
+      const bool _has_priority_deferred;
+      const event_priority _priority_deferred;
+      const bool _has_priority_apprentice;
+      const event_priority _priority_apprentice;
       int _serializer_shared_state;
       // _ext_p is owned by live_model_impl
       i_logger_extensions* _ext_p;
@@ -94,6 +114,12 @@ namespace reinforcement_learning
 
       int report_action_taken(const char* event_id, api_status* status);
 
+      //Counters of a lane of the observation queue
+      event_queue_lane_metrics get_lane_metrics(event_priority priority);
+      queue_status get_queue_status();
+      //Adds the metrics of the observation batcher, must be called before init
+      void register_metrics(utility::metrics_registry& registry);
+
     private:
       const int _version;
       int _serializer_shared_state;
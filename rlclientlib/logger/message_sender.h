@@ -17,6 +17,10 @@ namespace reinforcement_learning {
       virtual ~i_message_sender() = default;
       virtual int send(const uint16_t msg_type, const buffer& db, api_status* status = nullptr) = 0;
       virtual int init(api_status* status = nullptr) = 0;
+      //! See i_sender::round_trip_ms
+      virtual int round_trip_ms() const { return 0; }
+      //! See i_sender::retry_count
+      virtual uint64_t retry_count() const { return 0; }
     };
   }
 }
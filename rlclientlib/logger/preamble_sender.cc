@@ -23,5 +23,13 @@ namespace reinforcement_learning { namespace logger {
     int preamble_message_sender::init(api_status* status) {
       return error_code::success;
     }
+
+    int preamble_message_sender::round_trip_ms() const {
+      return _sender->round_trip_ms();
+    }
+
+    uint64_t preamble_message_sender::retry_count() const {
+      return _sender->retry_count();
+    }
   }
 }
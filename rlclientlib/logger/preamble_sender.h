@@ -8,6 +8,8 @@ namespace reinforcement_learning { namespace logger {
       explicit preamble_message_sender(i_sender*);
       int send(const uint16_t msg_type, const buffer& db, api_status* status) override;
       int init(api_status* status) override;
+      int round_trip_ms() const override;
+      uint64_t retry_count() const override;
     private:
       std::unique_ptr<i_sender> _sender;
     };
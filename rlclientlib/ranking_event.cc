@@ -14,6 +14,8 @@ namespace reinforcement_learning {
     return prg(drop_pass) > pass_prob;
   }
 
+  void event::scale_pass_prob(float pass_prob) { _pass_prob *= pass_prob; }
+
   float event::get_pass_prob() const { return _pass_prob; }
   timestamp event::get_client_time_gmt() const { return _client_time_gmt; }
 
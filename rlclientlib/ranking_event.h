@@ -22,6 +22,8 @@ namespace reinforcement_learning {
     float get_pass_prob() const;
     timestamp get_client_time_gmt() const; ;
     virtual bool try_drop(float pass_prob, int drop_pass);
+    //! Accounts for a drop pass the event survived outside of try_drop
+    void scale_pass_prob(float pass_prob);
     const std::string& get_seed_id() const {
       return _seed_id;
     }
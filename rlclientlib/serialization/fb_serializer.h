@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <vector>
 #include <flatbuffers/flatbuffers.h>
 #include "logger/flatbuffer_allocator.h"
@@ -15,6 +16,7 @@
 #include "logger/message_type.h"
 #include "utility/config_helper.h"
 #include "err_constants.h"
+#include "zstd_compressor.h"
 
 using namespace reinforcement_learning::messages::flatbuff;
 namespace reinforcement_learning { namespace logger {
@@ -224,6 +226,12 @@ namespace reinforcement_learning { namespace logger {
 
     fb_collection_serializer(buffer_t& buffer, const char* content_encoding, int /*dummy*/) : fb_collection_serializer(buffer, content_encoding) {}
 
+    // When batch_compressor is not null, the whole batch is compressed during finalize
+    fb_collection_serializer(buffer_t& buffer, const char* content_encoding, const zstd_compressor* batch_compressor)
+      : fb_collection_serializer(buffer, content_encoding) {
+      _batch_compressor = batch_compressor;
+    }
+
     int add(event_t& evt, api_status* status = nullptr) {
       flatbuffers::Offset<typename serializer_t::fb_event_t> offset;
       RETURN_IF_FAIL(serializer_t::serialize(evt, _builder, offset, status));
@@ -238,6 +246,19 @@ namespace reinforcement_learning { namespace logger {
       return error_code::success;
     }
 
+    //! Keeps a place for an event serialized later with add_at. prepend must not be called until it's filled
+    size_t reserve() {
+      _event_offsets.emplace_back();
+      return _event_offsets.size() - 1;
+    }
+
+    int add_at(size_t position, event_t& evt, api_status* status = nullptr) {
+      flatbuffers::Offset<typename serializer_t::fb_event_t> offset;
+      RETURN_IF_FAIL(serializer_t::serialize(evt, _builder, offset, status));
+      _event_offsets[position] = offset;
+      return error_code::success;
+    }
+
     uint64_t size() const { return _builder.GetSize(); }
 
     void create_header() {
@@ -248,7 +269,16 @@ namespace reinforcement_learning { namespace logger {
       return;
     }
 
+    // Serialize the events into a standalone batch, compress it and restart the builder with
+    // the compressed bytes. Only supported by batch types that have room for compressed events.
+    int compress_batch(api_status* status) {
+      RETURN_ERROR_LS(nullptr, status, not_supported) << "Batch compression is not supported for this event type";
+    }
+
     int finalize(api_status* status) {
+      if (_batch_compressor != nullptr) {
+        RETURN_IF_FAIL(compress_batch(status));
+      }
       auto event_offsets = _builder.CreateVector(_event_offsets);
       create_header();
       typename serializer_t::batch_builder_t batch_builder(_builder);
@@ -271,6 +301,8 @@ namespace reinforcement_learning { namespace logger {
     buffer_t& _buffer;
     const char* _content_encoding;
     flatbuffers::Offset<v2::BatchMetadata> _batch_metadata_offset;
+    const zstd_compressor* _batch_compressor = nullptr;
+    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> _compressed_events_offset;
   };
 
   template <>
@@ -336,5 +368,46 @@ namespace reinforcement_learning { namespace logger {
   template <>
   inline void fb_collection_serializer<generic_event>::add_header(typename serializer_t::batch_builder_t& batch_builder) {
     batch_builder.add_metadata(_batch_metadata_offset);
+    if (!_compressed_events_offset.IsNull()) {
+      batch_builder.add_compressed_events(_compressed_events_offset);
+    }
+  }
+
+  template <>
+  inline int fb_collection_serializer<generic_event>::compress_batch(api_status* status) {
+    auto event_offsets = _builder.CreateVector(_event_offsets);
+    serializer_t::batch_builder_t batch_builder(_builder);
+    batch_builder.add_events(event_offsets);
+    _builder.Finish(batch_builder.Finish());
+
+    const uint8_t* events = _builder.GetBufferPointer();
+    const size_t events_size = _builder.GetSize();
+
+    // The builder fills the data_buffer from its end, so the region in front of the events is unused.
+    // Compress straight into it when it's large enough and can't overlap the compressed events
+    // vector that will be rebuilt at the end of the buffer.
+    uint8_t* front = _buffer.body_begin();
+    const size_t front_size = events - front;
+    const size_t reserved = front_size + events_size;
+    const size_t margin = 16; // vector length and alignment padding
+    const size_t capacity = reserved > margin ? (std::min)(front_size, (reserved - margin) / 2) : 0;
+
+    if (capacity >= zstd_compressor::compress_bound(events_size)) {
+      size_t compressed_size;
+      RETURN_IF_FAIL(_batch_compressor->compress(events, events_size, front, capacity, compressed_size, status));
+      _builder.Clear();
+      _event_offsets.clear();
+      _compressed_events_offset = _builder.CreateVector(front, compressed_size);
+      return error_code::success;
+    }
+
+    generic_event::payload_buffer_t compressed;
+    RETURN_IF_FAIL(_batch_compressor->compress(events, events_size, compressed, status));
+
+    // The builder memory is the data_buffer, so start over and only keep the compressed events in it
+    _builder.Clear();
+    _event_offsets.clear();
+    _compressed_events_offset = _builder.CreateVector(compressed.data(), compressed.size());
+    return error_code::success;
   }
 }}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "hash.h"
+#include "rl_string_view.h"
+#include "serialization/fb_serializer.h"
+#include "serialization/payload_serializer.h"
+
+namespace reinforcement_learning { namespace logger {
+  // Serializes a batch of v2 observations, coalescing the numeric outcomes reported for the same event id with the same
+  // pass probability into a single event at the place of the first one. Everything else is serialized as is, in order.
+  template <typename event_t>
+  struct outcome_collection_serializer {
+    using serializer_t = fb_event_serializer<event_t>;
+    using buffer_t = utility::data_buffer;
+    using shared_state_t = int;
+
+    static int message_id() { return message_type::fb_generic_event_collection; }
+
+    outcome_collection_serializer(buffer_t& buffer, const char* content_encoding, shared_state_t& /*state*/)
+      : _ser(buffer, content_encoding) {}
+
+    int add(event_t& evt, api_status* status = nullptr) {
+      float outcome;
+      if (evt.get_payload_type() != generic_event::payload_type_t::PayloadType_Outcome ||
+        evt.get_encoding() != generic_event::encoding_type_t::EventEncoding_Identity ||
+        !outcome_serializer::try_get_numeric(evt.get_payload(), outcome)) {
+        return _ser.add(evt, status);
+      }
+
+      const auto it = _index.find(string_view(evt.get_id()));
+      if (it != _index.end()) {
+        auto& group = _groups[it->second];
+        // the coalesced event has a single pass probability, outcomes throttled differently are kept apart
+        if (group._first.get_pass_prob() != evt.get_pass_prob()) {
+          return _ser.add(evt, status);
+        }
+        group._outcomes.push_back(outcome);
+        _pending_size += sizeof(float);
+        return error_code::success;
+      }
+
+      _pending_size += serializer_t::size_estimate(evt);
+      _groups.emplace_back(std::move(evt), outcome, _ser.reserve());
+      // the key points into the id of the grouped event, deque elements don't move
+      _index.emplace(string_view(_groups.back()._first.get_id()), _groups.size() - 1);
+      return error_code::success;
+    }
+
+    uint64_t size() const {
+      return _ser.size() + _pending_size;
+    }
+
+    int finalize(api_status* status) {
+      for (auto& group : _groups) {
+        if (group._outcomes.size() > 1) {
+          const auto& first = group._first;
+          // Metadata is taken from the first outcome of the event id
+          event_t coalesced(first.get_id(), first.get_client_time_gmt(), first.get_payload_type(),
+            outcome_serializer::numeric_event(group._outcomes), event_content_type::IDENTITY,
+            first.get_app_id(), first.get_pass_prob());
+          RETURN_IF_FAIL(_ser.add_at(group._position, coalesced, status));
+        }
+        else {
+          RETURN_IF_FAIL(_ser.add_at(group._position, group._first, status));
+        }
+      }
+      return _ser.finalize(status);
+    }
+
+  private:
+    struct outcome_group {
+      outcome_group(event_t&& first, float outcome, size_t position)
+        : _first(std::move(first)), _outcomes(1, outcome), _position(position) {}
+
+      event_t _first;
+      std::vector<float> _outcomes;
+      //! place of the first outcome among the serialized events
+      size_t _position;
+    };
+
+    struct id_hash {
+      size_t operator()(string_view id) const { return static_cast<size_t>(uniform_hash(id.data(), id.size(), 0)); }
+    };
+
+    fb_collection_serializer<event_t> _ser;
+    std::unordered_map<string_view, size_t, id_hash> _index;
+    std::deque<outcome_group> _groups;
+    uint64_t _pending_size = 0;
+  };
+}}
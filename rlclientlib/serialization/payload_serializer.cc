@@ -1,8 +1,48 @@
 #include "payload_serializer.h"
 
+#include <cstring>
+
 namespace reinforcement_learning {
   using namespace messages::flatbuff;
   namespace logger {
+    namespace {
+      // Numeric outcomes without index all share the same layout, only the 4 bytes of the value differ
+      class numeric_outcome_template {
+      public:
+        numeric_outcome_template() {
+          // Any value that can't collide with the rest of the buffer will do
+          const float marker = -1.234567e-30f;
+          flatbuffers::FlatBufferBuilder fbb;
+          const auto evt = v2::CreateNumericOutcome(fbb, marker).Union();
+          fbb.Finish(v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_numeric, evt));
+          _bytes.assign(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+
+          uint8_t marker_bytes[sizeof(float)];
+          flatbuffers::WriteScalar(marker_bytes, marker);
+          _value_offset = 0;
+          while (std::memcmp(_bytes.data() + _value_offset, marker_bytes, sizeof(float)) != 0) ++_value_offset;
+        }
+
+        generic_event::payload_buffer_t stamp(float value) const {
+          const size_t size = _bytes.size();
+          auto* data = new uint8_t[size];
+          std::memcpy(data, _bytes.data(), size);
+          flatbuffers::WriteScalar(data + _value_offset, value);
+          // A null allocator releases the buffer with delete[]
+          return flatbuffers::DetachedBuffer(nullptr, false, data, size, data, size);
+        }
+
+      private:
+        std::vector<uint8_t> _bytes;
+        size_t _value_offset;
+      };
+    }
+
+    generic_event::payload_buffer_t outcome_serializer::numeric_event(float outcome) {
+      static const numeric_outcome_template numeric_template;
+      return numeric_template.stamp(outcome);
+    }
+
     int get_learning_mode(learning_mode mode_in, v2::LearningModeType& mode_out, api_status* status) {
       switch (mode_in) {
         case APPRENTICE: mode_out = v2::LearningModeType_Apprentice; return error_code::success;
@@ -89,7 +89,8 @@ namespace reinforcement_learning {
     };
 
     struct dedup_info_serializer : payload_serializer<generic_event::payload_type_t::PayloadType_DedupInfo> {
-      static generic_event::payload_buffer_t event(const std::vector<generic_event::object_id_t>& object_ids, const std::vector<string_view>& object_values) {
+      static generic_event::payload_buffer_t event(const std::vector<generic_event::object_id_t>& object_ids, const std::vector<string_view>& object_values,
+        bool incremental = false, const std::vector<generic_event::object_id_t>* evicted_ids = nullptr, uint64_t client_id = 0) {
         flatbuffers::FlatBufferBuilder fbb;
         std::vector<flatbuffers::Offset<flatbuffers::String>> vals;
         vals.reserve(object_values.size());
@@ -99,21 +100,36 @@ namespace reinforcement_learning {
           vals.push_back(fbb.CreateString(sv.begin(), sv.size()));
         }
 
-        auto fb = v2::CreateDedupInfoDirect(fbb, &object_ids, &vals);
+        auto fb = v2::CreateDedupInfoDirect(fbb, &object_ids, &vals, incremental, evicted_ids, client_id);
         fbb.Finish(fb);
         return fbb.Release();
       }
     };
 
     struct outcome_serializer : payload_serializer<generic_event::payload_type_t::PayloadType_Outcome> {
-      static generic_event::payload_buffer_t numeric_event(float outcome) {
+      //! Copies a prebuilt payload and patches the value in, no FlatBufferBuilder is involved
+      static generic_event::payload_buffer_t numeric_event(float outcome);
+
+      //! Payload of several numeric outcomes coalesced for one event id, outcomes must not be empty
+      static generic_event::payload_buffer_t numeric_event(const std::vector<float>& outcomes) {
         flatbuffers::FlatBufferBuilder fbb;
-        const auto evt = v2::CreateNumericOutcome(fbb, outcome).Union();
-        auto fb = v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_numeric, evt);
+        const auto evt = v2::CreateNumericOutcome(fbb, outcomes[0]).Union();
+        const auto more = fbb.CreateVector(outcomes.data() + 1, outcomes.size() - 1);
+        auto fb = v2::CreateOutcomeEvent(fbb, v2::OutcomeValue_numeric, evt, v2::IndexValue_NONE, 0, false, more);
         fbb.Finish(fb);
         return fbb.Release();
       }
 
+      //! True if payload holds a single numeric outcome without index, which can be coalesced with others
+      static bool try_get_numeric(const generic_event::payload_buffer_t& payload, float& outcome) {
+        const auto* evt = flatbuffers::GetRoot<v2::OutcomeEvent>(payload.data());
+        if (evt->value_type() != v2::OutcomeValue_numeric || evt->index_type() != v2::IndexValue_NONE ||
+          evt->action_taken() || evt->numeric_values() != nullptr)
+          return false;
+        outcome = evt->value_as_numeric()->value();
+        return true;
+      }
+
       static generic_event::payload_buffer_t string_event(const char* outcome) {
         flatbuffers::FlatBufferBuilder fbb;
         const auto evt = fbb.CreateString(outcome).Union();
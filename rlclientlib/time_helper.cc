@@ -1,5 +1,11 @@
 #include "time_helper.h"
 #include "date.h"
+
+#include <algorithm>
+#include <chrono>
+#ifdef __linux__
+#include <time.h>
+#endif
 namespace reinforcement_learning
 {
   timestamp clock_time_provider::gmt_now() {
@@ -17,4 +23,71 @@ namespace reinforcement_learning
     ts.sub_second = time.subseconds().count();
     return ts;
   }
-}
\ No newline at end of file
+
+  namespace {
+    // timestamp::sub_second is expressed in 100ns ticks
+    const int64_t TICKS_PER_SECOND = 10000000;
+    const int64_t TICKS_PER_US = 10;
+  }
+
+  coarse_clock_time_provider::coarse_clock_time_provider(int precision_us)
+    : _precision_ticks((std::max)(precision_us, 1) * TICKS_PER_US)
+    , _offset_ns(0) {
+#ifdef __linux__
+    // The coarse clock is only good enough when it ticks at least as often as the requested precision
+    timespec res;
+    _use_coarse_clock = clock_getres(CLOCK_MONOTONIC_COARSE, &res) == 0 &&
+      res.tv_sec == 0 && res.tv_nsec <= (std::max)(precision_us, 1) * 1000L;
+#endif
+    anchor();
+  }
+
+  int64_t coarse_clock_time_provider::monotonic_now_ns() const {
+#ifdef __linux__
+    if (_use_coarse_clock) {
+      timespec now;
+      clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+      return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+    }
+#endif
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void coarse_clock_time_provider::anchor() {
+    const auto system_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    _offset_ns.store(system_ns - monotonic_now_ns(), std::memory_order_relaxed);
+  }
+
+  timestamp coarse_clock_time_provider::gmt_now() {
+    // Calendar fields of the last second seen by this thread. They only depend on the wall clock, so all instances share them.
+    struct cached_second {
+      int64_t second = -1;
+      timestamp ts;
+    };
+    static thread_local cached_second cache;
+
+    int64_t ticks = (monotonic_now_ns() + _offset_ns.load(std::memory_order_relaxed)) / 100;
+    if (ticks / TICKS_PER_SECOND != cache.second) {
+      // Follow system clock adjustments once per second
+      anchor();
+      ticks = (monotonic_now_ns() + _offset_ns.load(std::memory_order_relaxed)) / 100;
+      cache.second = ticks / TICKS_PER_SECOND;
+
+      const date::sys_seconds tp{ std::chrono::seconds(cache.second) };
+      const auto dp = date::floor<date::days>(tp);
+      const auto ymd = date::year_month_day(dp);
+      const auto time = date::make_time(tp - dp);
+      cache.ts.year = int(ymd.year());
+      cache.ts.month = unsigned(ymd.month());
+      cache.ts.day = unsigned(ymd.day());
+      cache.ts.hour = time.hours().count();
+      cache.ts.minute = time.minutes().count();
+      cache.ts.second = time.seconds().count();
+    }
+
+    timestamp ts = cache.ts;
+    const int64_t sub_second = ticks % TICKS_PER_SECOND;
+    ts.sub_second = static_cast<uint32_t>(sub_second - sub_second % _precision_ticks);
+    return ts;
+  }
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 namespace reinforcement_learning {
 
@@ -22,4 +23,23 @@ namespace reinforcement_learning {
   public:
     timestamp gmt_now() override;
   };
+
+  // Reads a monotonic clock anchored to the system clock instead of converting the system clock on every call.
+  // The calendar fields only change once per second so they are cached, and sub_second is truncated to precision_us.
+  class coarse_clock_time_provider : public i_time_provider {
+  public:
+    static const int DEFAULT_PRECISION_US = 1000;
+
+    explicit coarse_clock_time_provider(int precision_us = DEFAULT_PRECISION_US);
+    timestamp gmt_now() override;
+
+  private:
+    int64_t monotonic_now_ns() const;
+    void anchor();
+
+    const int64_t _precision_ticks;
+    bool _use_coarse_clock = false;
+    // system clock - monotonic clock, refreshed along with the calendar fields
+    std::atomic<int64_t> _offset_ns;
+  };
 }
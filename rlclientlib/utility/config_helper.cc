@@ -14,6 +14,8 @@ namespace reinforcement_learning
   queue_mode_enum to_queue_mode_enum(const char *queue_mode) {
     if (_stricmp(queue_mode, "BLOCK") == 0) {
       return queue_mode_enum::BLOCK;
+    } else if (_stricmp(queue_mode, "NONBLOCKING") == 0) {
+      return queue_mode_enum::NONBLOCKING;
     } else {
       return queue_mode_enum::DROP;
     }
@@ -67,8 +69,16 @@ async_batcher_config get_batcher_config(const configuration &config, const char
   res.send_batch_interval_ms = get_int(config, section, name::SEND_BATCH_INTERVAL_MS, 1000);
   res.send_queue_max_capacity = get_int(config, section, name::SEND_QUEUE_MAX_CAPACITY_KB, 16 * 1024) * 1024;
   res.queue_mode = to_queue_mode_enum(get_str(config, section, name::QUEUE_MODE, value::QUEUE_MODE_DROP));
-  res.batch_content_encoding = config.get_bool(section, name::USE_DEDUP, false) ? value::CONTENT_ENCODING_DEDUP : value::CONTENT_ENCODING_IDENTITY;
+  res.queue_block_timeout_ms = get_int(config, section, name::QUEUE_BLOCK_TIMEOUT_MS, 0);
+  const bool use_dedup = config.get_bool(section, name::USE_DEDUP, false);
+  if(config.get_bool(section, name::USE_BATCH_COMPRESSION, false))
+    res.batch_content_encoding = use_dedup ? value::CONTENT_ENCODING_DEDUP_ZSTD : value::CONTENT_ENCODING_ZSTD;
+  else
+    res.batch_content_encoding = use_dedup ? value::CONTENT_ENCODING_DEDUP : value::CONTENT_ENCODING_IDENTITY;
   res.subsample_rate = get_float(config, section, name::SUBSAMPLE_RATE, 1.f);
+  res.send_batch_target_bytes = get_int(config, section, name::SEND_BATCH_TARGET_BYTES, 0);
+  res.send_batch_min_interval_ms = get_int(config, section, name::SEND_BATCH_MIN_INTERVAL_MS, 50);
+  res.send_batch_latency_budget_ms = get_int(config, section, name::SEND_BATCH_LATENCY_BUDGET_MS, 0);
   return res;
 }
 
@@ -5,7 +5,8 @@ namespace reinforcement_learning {
   //this enum sets the behavior of the queue managed by the async_batcher
   enum class queue_mode_enum {
     DROP,//queue drops events if it is full (default)
-    BLOCK//queue block if it is full
+    BLOCK,//queue block if it is full, up to queue_block_timeout_ms if set
+    NONBLOCKING//events are rejected with error_code::logging_queue_full if the queue is full
   };
 
   // Section constants to be used with get_batcher_config
@@ -19,10 +20,14 @@ namespace utility {
     int send_batch_interval_ms;
     int send_queue_max_capacity;
     queue_mode_enum queue_mode;
+    int queue_block_timeout_ms = 0;         // 0 = BLOCK waits until there is room
     // bool use_compression;
     // bool use_dedup;
     const char *batch_content_encoding;
     float subsample_rate = 1.f;   // percentage of kept events. 0 = drop all events, 1 = keep all events
+    int send_batch_target_bytes = 0;        // 0 = batches close at send_high_water_mark
+    int send_batch_min_interval_ms = 50;
+    int send_batch_latency_budget_ms = 0;   // 0 = no latency budget
   };
 
   async_batcher_config get_batcher_config(const configuration& config, const char* section);
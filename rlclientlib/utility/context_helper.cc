@@ -71,6 +71,7 @@ namespace reinforcement_learning { namespace utility {
     int _array_level = 0;
     bool _is_multi = false;
     bool _is_slots = false;
+    bool _is_shared = false;
     size_t _item_start = 0;
 
     MessageHandler(rj::InsituStringStream &is, ContextInfo &info) : 
@@ -87,6 +88,7 @@ namespace reinforcement_learning { namespace utility {
       if(_level == 1 && _array_level == 0) {
         _is_multi = !strcmp(str, multi);
         _is_slots = !strcmp(str, slots);
+        _is_shared = length > 0 && str[0] != '_';
       }
       return true;
     }
@@ -95,6 +97,8 @@ namespace reinforcement_learning { namespace utility {
     {
       if((_is_multi | _is_slots) && _level == 1 && _array_level == 1)
         _item_start = _is.Tell() - 1;
+      if(_is_shared && _level == 1 && _array_level == 0)
+        _item_start = _is.Tell() - 1;
 
       ++_level;
       return true;
@@ -111,6 +115,8 @@ namespace reinforcement_learning { namespace utility {
         if(_is_slots)
           _info.slots.push_back(std::make_pair(_item_start, item_end));
       }
+      if(_is_shared && _level == 1 && _array_level == 0)
+        _info.shared.push_back(std::make_pair(_item_start, _is.Tell() - _item_start));
       return true;
     }
 
@@ -132,6 +138,7 @@ namespace reinforcement_learning { namespace utility {
     std::string copy(context);
     info.actions.clear();
     info.slots.clear();
+    info.shared.clear();
 
     rj::InsituStringStream iss((char*)copy.c_str());
     MessageHandler mh(iss, info);
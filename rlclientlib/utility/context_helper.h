@@ -18,6 +18,8 @@ namespace reinforcement_learning {
       index_vector_t actions;
       //! The index to each element in the _slots array
       index_vector_t slots;
+      //! The index to each top level namespace object, IE "ns": { ... } with a name that doesn't start with '_'
+      index_vector_t shared;
   };
 
   int get_event_ids(const char* context, std::map<size_t, std::string>& event_ids, i_trace* trace, api_status* status);
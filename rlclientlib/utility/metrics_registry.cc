@@ -0,0 +1,152 @@
+#include "metrics_registry.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <cmath>
+#include <sstream>
+
+namespace reinforcement_learning { namespace utility {
+  const size_t metrics_counter::STRIPES;
+  const size_t metrics_histogram::SUB_BUCKETS;
+  const size_t metrics_histogram::LINEAR_BUCKETS;
+  const size_t metrics_histogram::BUCKETS;
+
+  uint64_t metrics_counter::value() const {
+    uint64_t total = 0;
+    for (const auto& s : _stripes) {
+      total += s.value.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  size_t metrics_counter::stripe_index() {
+    static std::atomic<size_t> next_thread{ 0 };
+    static thread_local const size_t index = next_thread.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+    return index;
+  }
+
+  void metrics_histogram::record(uint64_t value) {
+    _buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+
+    auto current = _min.load(std::memory_order_relaxed);
+    while (value < current && !_min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    current = _max.load(std::memory_order_relaxed);
+    while (value > current && !_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+  }
+
+  size_t metrics_histogram::bucket_index(uint64_t value) {
+    if (value < LINEAR_BUCKETS) {
+      return static_cast<size_t>(value);
+    }
+    size_t msb = 4;
+    while (msb < 63 && (value >> (msb + 1)) != 0) {
+      ++msb;
+    }
+    const auto sub_bucket = static_cast<size_t>(value >> (msb - 3)) & (SUB_BUCKETS - 1);
+    return LINEAR_BUCKETS + (msb - 4) * SUB_BUCKETS + sub_bucket;
+  }
+
+  uint64_t metrics_histogram::bucket_upper_bound(size_t index) {
+    if (index < LINEAR_BUCKETS) {
+      return index;
+    }
+    const auto msb = 4 + (index - LINEAR_BUCKETS) / SUB_BUCKETS;
+    const auto sub_bucket = (index - LINEAR_BUCKETS) % SUB_BUCKETS;
+    const uint64_t width = uint64_t(1) << (msb - 3);
+    return ((SUB_BUCKETS + sub_bucket) << (msb - 3)) + (width - 1);
+  }
+
+  histogram_summary metrics_histogram::summary() const {
+    histogram_summary result;
+    // Buckets are read one by one while other threads record, so the count is taken from them for the
+    // percentiles to be consistent
+    uint64_t counts[BUCKETS];
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      counts[i] = _buckets[i].load(std::memory_order_relaxed);
+      result.count += counts[i];
+    }
+    if (result.count == 0) {
+      return result;
+    }
+    result.min = _min.load(std::memory_order_relaxed);
+    result.max = _max.load(std::memory_order_relaxed);
+    result.mean = static_cast<double>(_sum.load(std::memory_order_relaxed)) / static_cast<double>(_count.load(std::memory_order_relaxed));
+
+    const double quantiles[] = { 0.5, 0.9, 0.99 };
+    uint64_t* const targets[] = { &result.p50, &result.p90, &result.p99 };
+    size_t q = 0;
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < BUCKETS && q < 3; ++i) {
+      cumulative += counts[i];
+      while (q < 3 && cumulative >= static_cast<uint64_t>(std::ceil(quantiles[q] * result.count))) {
+        *targets[q++] = (std::min)(bucket_upper_bound(i), result.max);
+      }
+    }
+    return result;
+  }
+
+  metrics_counter* metrics_registry::get_counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& counter = _counters[name];
+    if (!counter) {
+      counter.reset(new metrics_counter());
+    }
+    return counter.get();
+  }
+
+  metrics_histogram* metrics_registry::get_histogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& histogram = _histograms[name];
+    if (!histogram) {
+      histogram.reset(new metrics_histogram());
+    }
+    return histogram.get();
+  }
+
+  void metrics_registry::add_gauge(const std::string& name, gauge_fn gauge) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _gauges[name] = std::move(gauge);
+  }
+
+  void metrics_registry::snapshot(metrics_snapshot& snapshot) const {
+    snapshot = metrics_snapshot();
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& counter : _counters) {
+      snapshot.counters[counter.first] = counter.second->value();
+    }
+    for (const auto& gauge : _gauges) {
+      snapshot.gauges[gauge.first] = gauge.second();
+    }
+    for (const auto& histogram : _histograms) {
+      snapshot.histograms[histogram.first] = histogram.second->summary();
+    }
+  }
+
+  std::string to_string(const metrics_snapshot& snapshot) {
+    std::ostringstream out;
+    for (const auto& counter : snapshot.counters) {
+      out << counter.first << ' ' << counter.second << '\n';
+    }
+    for (const auto& gauge : snapshot.gauges) {
+      out << gauge.first << ' ' << gauge.second << '\n';
+    }
+    for (const auto& histogram : snapshot.histograms) {
+      const auto& h = histogram.second;
+      out << histogram.first << " count=" << h.count << " min=" << h.min << " mean=" << h.mean
+        << " p50=" << h.p50 << " p90=" << h.p90 << " p99=" << h.p99 << " max=" << h.max << '\n';
+    }
+    return out.str();
+  }
+
+  metrics_dumper::metrics_dumper(const metrics_registry& registry, i_trace* trace)
+    : _registry(registry), _trace(trace) {}
+
+  int metrics_dumper::run_iteration(api_status* status) {
+    metrics_snapshot snapshot;
+    _registry.snapshot(snapshot);
+    TRACE_INFO(_trace, "Metrics\n" + to_string(snapshot));
+    return error_code::success;
+  }
+}}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "metrics_snapshot.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+}
+
+namespace reinforcement_learning { namespace utility {
+  // Counter striped over cache lines: each thread adds to its own stripe, so concurrent API calls don't
+  // contend on the same atomic. Reading sums the stripes.
+  class metrics_counter {
+  public:
+    static const size_t STRIPES = 16;
+
+    void add(uint64_t n = 1) {
+      _stripes[stripe_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const;
+
+  private:
+    static size_t stripe_index();
+
+    // Padded rather than aligned, over-aligned new isn't available before C++17. Values 64 bytes apart never share
+    // a cache line either way.
+    struct stripe {
+      std::atomic<uint64_t> value{ 0 };
+      char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+    stripe _stripes[STRIPES];
+  };
+
+  // Lock free log-linear histogram, in the spirit of HdrHistogram: values below 16 get a bucket each, larger values
+  // get 8 buckets per power of two, i.e. 12.5% relative precision over the whole uint64_t range.
+  class metrics_histogram {
+  public:
+    static const size_t SUB_BUCKETS = 8;
+    static const size_t LINEAR_BUCKETS = 2 * SUB_BUCKETS;
+    static const size_t BUCKETS = LINEAR_BUCKETS + (64 - 4) * SUB_BUCKETS;
+
+    void record(uint64_t value);
+    histogram_summary summary() const;
+
+    static size_t bucket_index(uint64_t value);
+    //! Largest value of a bucket
+    static uint64_t bucket_upper_bound(size_t index);
+
+  private:
+    std::atomic<uint64_t> _buckets[BUCKETS] = {};
+    std::atomic<uint64_t> _count{ 0 };
+    std::atomic<uint64_t> _sum{ 0 };
+    std::atomic<uint64_t> _min{ UINT64_MAX };
+    std::atomic<uint64_t> _max{ 0 };
+  };
+
+  // Records the time spent in a scope into a histogram, in microseconds. A null histogram records nothing.
+  class latency_scope {
+  public:
+    explicit latency_scope(metrics_histogram* histogram)
+      : _histogram(histogram), _start(std::chrono::steady_clock::now()) {}
+    ~latency_scope() {
+      if (_histogram != nullptr) {
+        const auto elapsed = std::chrono::steady_clock::now() - _start;
+        _histogram->record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+      }
+    }
+
+    latency_scope(const latency_scope&) = delete;
+    latency_scope& operator=(const latency_scope&) = delete;
+
+  private:
+    metrics_histogram* _histogram;
+    const std::chrono::steady_clock::time_point _start;
+  };
+
+  // Named metrics of a live_model. Counters and histograms are created once, usually at init, and updated without
+  // locks through the returned pointers which stay valid for the lifetime of the registry. Gauges are callbacks
+  // sampled by snapshot(): their owner must outlive the registry or at least every call to snapshot().
+  class metrics_registry {
+  public:
+    using gauge_fn = std::function<double()>;
+
+    metrics_counter* get_counter(const std::string& name);
+    metrics_histogram* get_histogram(const std::string& name);
+    void add_gauge(const std::string& name, gauge_fn gauge);
+
+    void snapshot(metrics_snapshot& snapshot) const;
+
+  private:
+    mutable std::mutex _mutex;
+    std::map<std::string, std::unique_ptr<metrics_counter>> _counters;
+    std::map<std::string, std::unique_ptr<metrics_histogram>> _histograms;
+    std::map<std::string, gauge_fn> _gauges;
+  };
+
+  //! One "name value" line per counter and gauge, and one line per histogram with its summary
+  std::string to_string(const metrics_snapshot& snapshot);
+
+  // Periodically writes a snapshot of the registry to the trace logger, see name::METRICS_DUMP_INTERVAL_MS
+  class metrics_dumper {
+  public:
+    metrics_dumper(const metrics_registry& registry, i_trace* trace);
+    int run_iteration(api_status* status);
+
+  private:
+    const metrics_registry& _registry;
+    i_trace* _trace;
+  };
+}}
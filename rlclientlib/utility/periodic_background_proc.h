@@ -6,6 +6,7 @@
 
 #include "utility/watchdog.h"
 
+#include <atomic>
 #include <thread>
 #include <string>
 
@@ -30,6 +31,10 @@ namespace reinforcement_learning {
       ~periodic_background_proc();
       void stop();
 
+      //! Changes the sleep between iterations, starting with the next one. Must not exceed the initial interval
+      //! since the watchdog timeout is derived from it.
+      void set_interval(int interval_ms);
+
       // Cannot copy, assign
       periodic_background_proc(const periodic_background_proc&) = delete;
       periodic_background_proc(periodic_background_proc&&) = delete;
@@ -43,7 +48,7 @@ namespace reinforcement_learning {
     private:
       // Internal state
       bool _thread_is_running;
-      int _interval_ms;
+      std::atomic<int> _interval_ms;
       std::thread _background_thread;
       interruptable_sleeper _sleeper;
 
@@ -100,6 +105,11 @@ namespace reinforcement_learning {
       }
     }
 
+    template <typename BgProc>
+    void periodic_background_proc<BgProc>::set_interval(int interval_ms) {
+      _interval_ms = interval_ms;
+    }
+
     template <typename BGProc>
     periodic_background_proc<BGProc>::~periodic_background_proc() {
       stop();
@@ -108,7 +118,7 @@ namespace reinforcement_learning {
     template <typename BGProc>
     void periodic_background_proc<BGProc>::time_loop() {
       // The first action of the thread should be registering itself with the watchdog.
-      _watchdog.register_thread(std::this_thread::get_id(), _proc_name, static_cast<long long>(_interval_ms * timeout_grace_multiplier_c));
+      _watchdog.register_thread(std::this_thread::get_id(), _proc_name, static_cast<long long>(_interval_ms.load() * timeout_grace_multiplier_c));
 
       do {
         api_status status;
@@ -121,7 +131,7 @@ namespace reinforcement_learning {
           ERROR_CALLBACK(_perror_cb, status);
         }
         // Cancelable sleep for interval
-      } while (_sleeper.sleep(std::chrono::milliseconds(_interval_ms)));
+      } while (_sleeper.sleep(std::chrono::milliseconds(_interval_ms.load())));
     }
   }
 }
@@ -1,5 +1,9 @@
 #pragma once
+#include "metrics_registry.h"
+
+#include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 namespace reinforcement_learning { namespace utility {
@@ -131,6 +135,8 @@ namespace reinforcement_learning { namespace utility {
     std::mutex _mutex;
     using impl_type = versioned_object_pool_unsafe<TObject, TFactory>;
     std::unique_ptr<impl_type> _impl;
+    metrics_counter* _checkouts = nullptr;
+    metrics_counter* _creations = nullptr;
 
   public:
     versioned_object_pool(TFactory* factory, int init_size = 0)
@@ -148,7 +154,17 @@ namespace reinforcement_learning { namespace utility {
 
     pooled_object<TObject>* get_or_create() {
       std::lock_guard<std::mutex> lock(_mutex);
-      return _impl->get_or_create();
+      if (_checkouts == nullptr) {
+        return _impl->get_or_create();
+      }
+
+      _checkouts->add();
+      const int objects_count = _impl->size();
+      auto* obj = _impl->get_or_create();
+      if (_impl->size() != objects_count) {
+        _creations->add();
+      }
+      return obj;
     }
 
     void return_to_pool(pooled_object<TObject>* obj) {
@@ -156,6 +172,16 @@ namespace reinforcement_learning { namespace utility {
       _impl->return_to_pool(obj);
     }
 
+    // Counts checkouts and the objects created because the pool was empty, must be called before the pool is shared
+    void register_metrics(metrics_registry& registry, const std::string& prefix) {
+      _checkouts = registry.get_counter(prefix + ".checkouts");
+      _creations = registry.get_counter(prefix + ".creations");
+      registry.add_gauge(prefix + ".objects", [this]() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _impl ? static_cast<double>(_impl->size()) : 0.0;
+      });
+    }
+
     // takes owner-ship of factory (and will free using delete) - !!!!THREAD-UNSAFE!!!!
     void update_factory(TFactory* new_factory) {
       int objects_count = 0;
@@ -14,6 +14,10 @@ namespace reinforcement_learning { namespace model_management {
     , _trace_logger(trace_logger) {
   }
 
+  void vw_model::register_metrics(utility::metrics_registry& registry) {
+    _vw_pool.register_metrics(registry, "model.vw_pool");
+  }
+
   int vw_model::update(const model_data& data, bool& model_ready, api_status* status) {
     try {
       TRACE_INFO(_trace_logger, utility::concat("Received new model data. With size ", data.data_sz()));
@@ -21,6 +21,7 @@ namespace reinforcement_learning { namespace model_management {
     int request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override;
     int request_multi_slot_decision(const char *event_id, const std::vector<std::string>& slot_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override;
     model_type_t model_type() const override;
+    void register_metrics(utility::metrics_registry& registry) override;
 
   private:
     const std::string _initial_command_line;
@@ -0,0 +1,219 @@
+#include "zstd_compressor.h"
+#include "err_constants.h"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "zstd.h"
+
+namespace reinforcement_learning
+{
+namespace fb = flatbuffers;
+
+namespace {
+  struct cctx_deleter {
+    void operator()(ZSTD_CCtx* ctx) const { ZSTD_freeCCtx(ctx); }
+  };
+
+  struct dctx_deleter {
+    void operator()(ZSTD_DCtx* ctx) const { ZSTD_freeDCtx(ctx); }
+  };
+
+  // Compression is called from every thread logging events, so each one keeps its own context
+  ZSTD_CCtx* get_thread_cctx() {
+    static thread_local std::unique_ptr<ZSTD_CCtx, cctx_deleter> ctx(ZSTD_createCCtx());
+    return ctx.get();
+  }
+
+  ZSTD_DCtx* get_thread_dctx() {
+    static thread_local std::unique_ptr<ZSTD_DCtx, dctx_deleter> ctx(ZSTD_createDCtx());
+    return ctx.get();
+  }
+
+  // Output buffers are sized by ZSTD_compressBound and released by the logger thread once the event
+  // is serialized, so blocks are recycled by power of two size class instead of going back to the heap.
+  class buffer_pool : public fb::Allocator {
+  public:
+    static const size_t MIN_BLOCK_SIZE = 256;
+    static const size_t MAX_BLOCK_SIZE = 1024 * 1024;
+    static const size_t MAX_BLOCKS_PER_CLASS = 64;
+
+    static buffer_pool& instance() {
+      // Never destroyed: payloads can outlive static destruction order
+      static buffer_pool* pool = new buffer_pool();
+      return *pool;
+    }
+
+    static size_t block_size(size_t size) {
+      size_t block = MIN_BLOCK_SIZE;
+      while(block < size) block <<= 1;
+      return block;
+    }
+
+    uint8_t* allocate(size_t size) override {
+      if(size > MAX_BLOCK_SIZE)
+        return new uint8_t[size];
+      auto& blocks = _free_blocks[size_class(size)];
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!blocks.empty()) {
+          auto block = blocks.back();
+          blocks.pop_back();
+          return block;
+        }
+      }
+      return new uint8_t[size];
+    }
+
+    void deallocate(uint8_t* p, size_t size) override {
+      if(size <= MAX_BLOCK_SIZE) {
+        auto& blocks = _free_blocks[size_class(size)];
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(blocks.size() < MAX_BLOCKS_PER_CLASS) {
+          blocks.push_back(p);
+          return;
+        }
+      }
+      delete[] p;
+    }
+
+  private:
+    // only called with sizes returned by block_size
+    static size_t size_class(size_t size) {
+      size_t index = 0;
+      for(size_t block = MIN_BLOCK_SIZE; block < size; block <<= 1) ++index;
+      return index;
+    }
+
+    std::mutex _mutex;
+    std::vector<uint8_t*> _free_blocks[13];
+  };
+
+  // Wraps [data, data+size[ of a pooled block of block_size bytes
+  generic_event::payload_buffer_t make_pooled_buffer(uint8_t* data, size_t block_size, size_t size) {
+    return fb::DetachedBuffer(&buffer_pool::instance(), false, data, block_size, data, size);
+  }
+}
+
+zstd_compressor::zstd_compressor(int level): _level(level) {}
+
+zstd_compressor::~zstd_compressor() {
+  ZSTD_freeCDict(_cdict);
+  ZSTD_freeDDict(_ddict);
+}
+
+int zstd_compressor::load_dictionary(const char* file_name, uint32_t expected_id, api_status* status)
+{
+  std::ifstream in_strm(file_name, std::ios::in | std::ios::binary | std::ios::ate);
+  if(!in_strm.good()) {
+    RETURN_ERROR_LS(nullptr, status, file_open_error) << " file_name = " << file_name;
+  }
+
+  const auto file_size = in_strm.tellg();
+  std::vector<char> dict(file_size);
+  in_strm.seekg(0, std::ios::beg);
+  if(!in_strm.read(dict.data(), file_size)) {
+    RETURN_ERROR_LS(nullptr, status, file_read_error) << " file_name = " << file_name;
+  }
+
+  const uint32_t dict_id = ZSTD_getDictID_fromDict(dict.data(), dict.size());
+  if(dict_id == 0) {
+    RETURN_ERROR_LS(nullptr, status, compression_error) << "Not a zstd dictionary: " << file_name;
+  }
+  if(expected_id != 0 && expected_id != dict_id) {
+    RETURN_ERROR_LS(nullptr, status, compression_error) << "Dictionary id mismatch, expected " << expected_id << " found " << dict_id;
+  }
+
+  ZSTD_CDict* cdict = ZSTD_createCDict(dict.data(), dict.size(), _level);
+  ZSTD_DDict* ddict = ZSTD_createDDict(dict.data(), dict.size());
+  if(cdict == nullptr || ddict == nullptr) {
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeDDict(ddict);
+    RETURN_ERROR_LS(nullptr, status, compression_error) << "Unable to digest dictionary: " << file_name;
+  }
+
+  ZSTD_freeCDict(_cdict);
+  ZSTD_freeDDict(_ddict);
+  _cdict = cdict;
+  _ddict = ddict;
+  _dictionary_id = dict_id;
+  return error_code::success;
+}
+
+uint32_t zstd_compressor::get_dictionary_id() const {
+  return _dictionary_id;
+}
+
+size_t zstd_compressor::compress_bound(size_t size) {
+  return ZSTD_compressBound(size);
+}
+
+int zstd_compressor::compress(const uint8_t* input, size_t size, uint8_t* output, size_t capacity, size_t& compressed_size, api_status* status) const
+{
+  size_t res = _cdict != nullptr ?
+    ZSTD_compress_usingCDict(get_thread_cctx(), output, capacity, input, size, _cdict) :
+    ZSTD_compressCCtx(get_thread_cctx(), output, capacity, input, size, _level);
+
+  if(ZSTD_isError(res))
+    RETURN_ERROR_ARG(nullptr, status, compression_error, ZSTD_getErrorName(res));
+
+  compressed_size = res;
+  return error_code::success;
+}
+
+int zstd_compressor::compress(const uint8_t* input, size_t size, generic_event::payload_buffer_t& output, api_status* status) const
+{
+  auto& pool = buffer_pool::instance();
+  const size_t block_size = buffer_pool::block_size(ZSTD_compressBound(size));
+  uint8_t* data = pool.allocate(block_size);
+
+  size_t res;
+  const int ret = compress(input, size, data, block_size, res, status);
+  if(ret != error_code::success) {
+    pool.deallocate(data, block_size);
+    return ret;
+  }
+
+  output = make_pooled_buffer(data, block_size, res);
+  return error_code::success;
+}
+
+int zstd_compressor::compress(generic_event::payload_buffer_t& input, api_status* status) const
+{
+  generic_event::payload_buffer_t output;
+  RETURN_IF_FAIL(compress(input.data(), input.size(), output, status));
+  input = std::move(output);
+  return error_code::success;
+}
+
+int zstd_compressor::decompress(generic_event::payload_buffer_t& buf, api_status* status) const
+{
+  size_t buff_size = ZSTD_getFrameContentSize(buf.data(), buf.size());
+  if(buff_size == ZSTD_CONTENTSIZE_ERROR)
+    RETURN_ERROR_ARG(nullptr, status, compression_error, "Invalid compressed content.");
+  if(buff_size == ZSTD_CONTENTSIZE_UNKNOWN)
+    RETURN_ERROR_ARG(nullptr, status, compression_error, "Unknown compressed size.");
+
+  const uint32_t frame_dict_id = ZSTD_getDictID_fromFrame(buf.data(), buf.size());
+  if(frame_dict_id != 0 && frame_dict_id != _dictionary_id) {
+    RETURN_ERROR_LS(nullptr, status, compression_error) << "Content compressed with unknown dictionary " << frame_dict_id;
+  }
+
+  auto& pool = buffer_pool::instance();
+  const size_t block_size = buffer_pool::block_size(buff_size);
+  uint8_t* data = pool.allocate(block_size);
+  size_t res = frame_dict_id != 0 ?
+    ZSTD_decompress_usingDDict(get_thread_dctx(), data, buff_size, buf.data(), buf.size(), _ddict) :
+    ZSTD_decompressDCtx(get_thread_dctx(), data, buff_size, buf.data(), buf.size());
+
+  if(ZSTD_isError(res)) {
+    pool.deallocate(data, block_size);
+    RETURN_ERROR_ARG(nullptr, status, compression_error, ZSTD_getErrorName(res));
+  }
+
+  buf = make_pooled_buffer(data, block_size, res);
+  return error_code::success;
+}
+}
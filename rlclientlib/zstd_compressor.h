@@ -0,0 +1,40 @@
+#pragma once
+#include "api_status.h"
+#include "generic_event.h"
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace reinforcement_learning
+{
+  class zstd_compressor {
+  public:
+    const static int ZSTD_DEFAULT_COMPRESSION_LEVEL = 1;
+
+    explicit zstd_compressor(int level);
+    ~zstd_compressor();
+
+    zstd_compressor(const zstd_compressor&) = delete;
+    zstd_compressor& operator=(const zstd_compressor&) = delete;
+
+    //! Load a dictionary produced by the zstd_dict_trainer tool. If expected_id is not 0 it must match the id stored in the dictionary.
+    int load_dictionary(const char* file_name, uint32_t expected_id, api_status* status);
+    //! Id of the loaded dictionary, or 0 if compression doesn't use a dictionary
+    uint32_t get_dictionary_id() const;
+
+    //! Largest compressed size of size bytes of input
+    static size_t compress_bound(size_t size);
+
+    //! Compress [data, data+size[ into the caller's [output, output+capacity[, e.g. straight into a batch buffer
+    int compress(const uint8_t* data, size_t size, uint8_t* output, size_t capacity, size_t& compressed_size, api_status* status) const;
+    //! Compress [data, data+size[ into a pooled output buffer
+    int compress(const uint8_t* data, size_t size, generic_event::payload_buffer_t& output, api_status* status) const;
+    int compress(generic_event::payload_buffer_t& input, api_status* status) const;
+    int decompress(generic_event::payload_buffer_t& buf, api_status* status) const;
+  private:
+    const int _level;
+    uint32_t _dictionary_id = 0;
+    ZSTD_CDict_s* _cdict = nullptr;
+    ZSTD_DDict_s* _ddict = nullptr;
+  };
+}
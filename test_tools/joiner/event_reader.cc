@@ -0,0 +1,267 @@
+#include "event_reader.h"
+#include <iostream>
+#include <stdexcept>
+#include "err_constants.h"
+#include "../../rlclientlib/logger/preamble.h"
+#include "../../rlclientlib/logger/message_type.h"
+#include "../../rlclientlib/generated/v1/RankingEvent_generated.h"
+#include "../../rlclientlib/generated/v1/OutcomeEvent_generated.h"
+#include "../../rlclientlib/generated/v2/CbEvent_generated.h"
+#include "../../rlclientlib/generated/v2/OutcomeEvent_generated.h"
+// namespace aliases
+namespace rlog = reinforcement_learning::logger;
+namespace flat = reinforcement_learning::messages::flatbuff;
+namespace v2 = reinforcement_learning::messages::flatbuff::v2;
+////
+
+namespace reinforcement_learning { namespace joiner {
+  namespace {
+    // raw logs are read sequentially in large chunks
+    const size_t FILE_BUFFER_SIZE = 1 << 20;
+
+    v2::TimeStamp to_v2(const flat::Metadata* meta) {
+      if (meta == nullptr || meta->client_time_utc() == nullptr) {
+        return v2::TimeStamp();
+      }
+      const auto* ts = meta->client_time_utc();
+      return v2::TimeStamp(ts->year(), ts->month(), ts->day(), ts->hour(), ts->minute(), ts->second(),
+        ts->subsecond());
+    }
+
+    flatbuffers::Offset<flatbuffers::String> app_id(flatbuffers::FlatBufferBuilder& fbb, const flat::Metadata* meta) {
+      return meta != nullptr && meta->app_id() != nullptr ? fbb.CreateString(meta->app_id()) : 0;
+    }
+
+    // days since 1970-01-01 of a date of the proleptic Gregorian calendar
+    int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+      y -= m <= 2;
+      const int64_t era = (y >= 0 ? y : y - 399) / 400;
+      const unsigned yoe = static_cast<unsigned>(y - era * 400);
+      const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+      const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+      return era * 146097 + static_cast<int64_t>(doe) - 719468;
+    }
+  }
+
+  int64_t to_seconds(const v2::TimeStamp& ts) {
+    if (ts.year() == 0) {
+      return 0;
+    }
+    return days_from_civil(ts.year(), ts.month(), ts.day()) * 86400 + ts.hour() * 3600 + ts.minute() * 60 +
+      ts.second();
+  }
+
+  event_reader::event_reader(const std::string& file)
+    : _file_name(file)
+    , _file_buffer(FILE_BUFFER_SIZE)
+    , _compressor(zstd_compressor::ZSTD_DEFAULT_COMPRESSION_LEVEL) {
+    _file.rdbuf()->pubsetbuf(_file_buffer.data(), _file_buffer.size());
+    _file.open(file, std::ios_base::binary);
+    if (!_file.is_open()) {
+      throw std::runtime_error("Unable to open file: " + file);
+    }
+  }
+
+  bool event_reader::read_batch(std::vector<logged_event>& events) {
+    while (true) {
+      events.clear();
+
+      uint8_t raw_preamble[rlog::preamble::size()];
+      _file.read(reinterpret_cast<char*>(raw_preamble), sizeof(raw_preamble));
+      if (_file.gcount() == 0 && _file.eof()) {
+        return false;
+      }
+
+      rlog::preamble p;
+      if (_file.gcount() != sizeof(raw_preamble) || !p.read_from_bytes(raw_preamble, sizeof(raw_preamble))) {
+        std::cerr << "Truncated message preamble in " << _file_name << std::endl;
+        return false;
+      }
+
+      _message.resize(p.msg_size);
+      _file.read(reinterpret_cast<char*>(_message.data()), p.msg_size);
+      if (static_cast<uint32_t>(_file.gcount()) != p.msg_size) {
+        std::cerr << "Truncated message of " << p.msg_size << " bytes in " << _file_name << std::endl;
+        return false;
+      }
+
+      bool read = false;
+      switch (p.msg_type) {
+      case rlog::message_type::fb_generic_event_collection:
+        read = read_event_batch(_message.data(), _message.size(), events, false);
+        break;
+      case rlog::message_type::fb_ranking_event_collection:
+      case rlog::message_type::fb_ranking_learning_mode_event_collection:
+        read = read_ranking_batch(_message.data(), _message.size(), events);
+        break;
+      case rlog::message_type::fb_outcome_event_collection:
+        read = read_outcome_batch(_message.data(), _message.size(), events);
+        break;
+      default:
+        // v1 decision and slates batches can't be converted to v2 events
+        break;
+      }
+
+      if (read) {
+        return true;
+      }
+      ++_skipped_batches;
+    }
+  }
+
+  bool event_reader::read_event_batch(const uint8_t* data, size_t size, std::vector<logged_event>& events,
+    bool compressed) {
+    flatbuffers::Verifier verifier(data, size);
+    if (!v2::VerifyEventBatchBuffer(verifier)) {
+      return false;
+    }
+
+    const auto* batch = v2::GetEventBatch(data);
+    if (batch->compressed_events() != nullptr && batch->compressed_events()->size() > 0) {
+      if (compressed) {
+        return false;
+      }
+      // the buffer doesn't own the compressed events, decompress swaps in one that owns its content
+      generic_event::payload_buffer_t buffer(nullptr, false, nullptr, 0,
+        const_cast<uint8_t*>(batch->compressed_events()->data()), batch->compressed_events()->size());
+      if (_compressor.decompress(buffer, nullptr) != error_code::success) {
+        return false;
+      }
+      return read_event_batch(buffer.data(), buffer.size(), events, true);
+    }
+
+    if (batch->events() == nullptr) {
+      return true;
+    }
+
+    for (const auto* serialized : *batch->events()) {
+      const auto* payload = serialized->payload();
+      if (payload == nullptr) {
+        continue;
+      }
+
+      flatbuffers::Verifier event_verifier(payload->data(), payload->size());
+      if (!event_verifier.VerifyBuffer<v2::Event>(nullptr)) {
+        return false;
+      }
+      const auto* meta = flatbuffers::GetRoot<v2::Event>(payload->data())->meta();
+      if (meta == nullptr) {
+        return false;
+      }
+
+      events.emplace_back();
+      auto& e = events.back();
+      e.id = meta->id() != nullptr ? meta->id()->str() : std::string();
+      e.payload_type = meta->payload_type();
+      e.client_time = meta->client_time_utc() != nullptr ? *meta->client_time_utc() : v2::TimeStamp();
+      e.time = to_seconds(e.client_time);
+      e.event.assign(payload->begin(), payload->end());
+    }
+    return true;
+  }
+
+  bool event_reader::read_ranking_batch(const uint8_t* data, size_t size, std::vector<logged_event>& events) {
+    flatbuffers::Verifier verifier(data, size);
+    if (!flat::VerifyRankingEventBatchBuffer(verifier)) {
+      return false;
+    }
+
+    const auto* batch = flat::GetRankingEventBatch(data);
+    if (batch->events() == nullptr) {
+      return true;
+    }
+
+    for (const auto* ranking : *batch->events()) {
+      _payload_builder.Clear();
+      auto& pb = _payload_builder;
+      const auto action_ids = ranking->action_ids() != nullptr ?
+        pb.CreateVector(ranking->action_ids()->data(), ranking->action_ids()->size()) : 0;
+      const auto context = ranking->context() != nullptr ?
+        pb.CreateVector(ranking->context()->data(), ranking->context()->size()) : 0;
+      const auto probabilities = ranking->probabilities() != nullptr ?
+        pb.CreateVector(ranking->probabilities()->data(), ranking->probabilities()->size()) : 0;
+      const auto model_id = ranking->model_id() != nullptr ? pb.CreateString(ranking->model_id()) : 0;
+      pb.Finish(v2::CreateCbEvent(pb, ranking->deferred_action(), action_ids, context, probabilities, model_id,
+        static_cast<v2::LearningModeType>(ranking->learning_mode())));
+
+      _event_builder.Clear();
+      auto& eb = _event_builder;
+      const auto client_time = to_v2(ranking->meta());
+      const auto meta = v2::CreateMetadata(eb,
+        ranking->event_id() != nullptr ? eb.CreateString(ranking->event_id()) : 0, &client_time,
+        app_id(eb, ranking->meta()), v2::PayloadType_CB, ranking->pass_probability(), v2::EventEncoding_Identity);
+      eb.Finish(v2::CreateEvent(eb, meta, eb.CreateVector(pb.GetBufferPointer(), pb.GetSize())));
+      add_built_event(events);
+    }
+    return true;
+  }
+
+  bool event_reader::read_outcome_batch(const uint8_t* data, size_t size, std::vector<logged_event>& events) {
+    flatbuffers::Verifier verifier(data, size);
+    if (!flat::VerifyOutcomeEventBatchBuffer(verifier)) {
+      return false;
+    }
+
+    const auto* batch = flat::GetOutcomeEventBatch(data);
+    if (batch->events() == nullptr) {
+      return true;
+    }
+
+    for (const auto* outcome : *batch->events()) {
+      _payload_builder.Clear();
+      auto& pb = _payload_builder;
+      flatbuffers::Offset<void> value = 0;
+      auto value_type = v2::OutcomeValue_NONE;
+      bool action_taken = false;
+      switch (outcome->the_event_type()) {
+      case flat::OutcomeEvent_NumericEvent:
+        value = v2::CreateNumericOutcome(pb, outcome->the_event_as_NumericEvent()->value()).Union();
+        value_type = v2::OutcomeValue_numeric;
+        break;
+      case flat::OutcomeEvent_StringEvent: {
+        const auto* str = outcome->the_event_as_StringEvent()->value();
+        value = (str != nullptr ? pb.CreateString(str) : pb.CreateString("")).Union();
+        value_type = v2::OutcomeValue_literal;
+        break;
+      }
+      case flat::OutcomeEvent_ActionTakenEvent:
+        action_taken = outcome->the_event_as_ActionTakenEvent()->value();
+        break;
+      default:
+        break;
+      }
+
+      v2::OutcomeEventBuilder outcome_builder(pb);
+      if (value_type != v2::OutcomeValue_NONE) {
+        outcome_builder.add_value_type(value_type);
+        outcome_builder.add_value(value);
+      }
+      outcome_builder.add_action_taken(action_taken);
+      pb.Finish(outcome_builder.Finish());
+
+      _event_builder.Clear();
+      auto& eb = _event_builder;
+      const auto client_time = to_v2(outcome->meta());
+      const auto meta = v2::CreateMetadata(eb,
+        outcome->event_id() != nullptr ? eb.CreateString(outcome->event_id()) : 0, &client_time,
+        app_id(eb, outcome->meta()), v2::PayloadType_Outcome, outcome->pass_probability(),
+        v2::EventEncoding_Identity);
+      eb.Finish(v2::CreateEvent(eb, meta, eb.CreateVector(pb.GetBufferPointer(), pb.GetSize())));
+      add_built_event(events);
+    }
+    return true;
+  }
+
+  void event_reader::add_built_event(std::vector<logged_event>& events) {
+    const uint8_t* data = _event_builder.GetBufferPointer();
+    const auto* meta = flatbuffers::GetRoot<v2::Event>(data)->meta();
+
+    events.emplace_back();
+    auto& e = events.back();
+    e.id = meta->id() != nullptr ? meta->id()->str() : std::string();
+    e.payload_type = meta->payload_type();
+    e.client_time = *meta->client_time_utc();
+    e.time = to_seconds(e.client_time);
+    e.event.assign(data, data + _event_builder.GetSize());
+  }
+}}
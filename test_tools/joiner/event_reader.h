@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <flatbuffers/flatbuffers.h>
+#include "../../rlclientlib/zstd_compressor.h"
+#include "../../rlclientlib/generated/v2/Event_generated.h"
+
+namespace reinforcement_learning { namespace joiner {
+  // A v2 event read from a raw log, copied out of its batch
+  struct logged_event {
+    std::string id;
+    messages::flatbuff::v2::PayloadType payload_type;
+    messages::flatbuff::v2::TimeStamp client_time;
+    // seconds since epoch of client_time
+    int64_t time = 0;
+    // the serialized v2 Event
+    std::vector<uint8_t> event;
+  };
+
+  // Reads the preamble framed batches written by the file logger one batch at a time. v2 event batches
+  // are unpacked, zstd compressed ones decompressed, and v1 ranking and outcome batches converted to v2
+  // CB and outcome events. Dedup info events are kept in place, the context of the events after them is
+  // left as logged.
+  class event_reader {
+  public:
+    explicit event_reader(const std::string& file);
+
+    event_reader(const event_reader&) = delete;
+    event_reader& operator=(const event_reader&) = delete;
+
+    //! Replaces events with the events of the next batch, false at the end of the file or on a read error
+    bool read_batch(std::vector<logged_event>& events);
+
+    //! Batches of message types that can't be joined, or that failed to be verified or decompressed
+    size_t skipped_batches() const { return _skipped_batches; }
+
+  private:
+    bool read_event_batch(const uint8_t* data, size_t size, std::vector<logged_event>& events, bool compressed);
+    bool read_ranking_batch(const uint8_t* data, size_t size, std::vector<logged_event>& events);
+    bool read_outcome_batch(const uint8_t* data, size_t size, std::vector<logged_event>& events);
+    // copies the finished _event_builder into a new event
+    void add_built_event(std::vector<logged_event>& events);
+
+    const std::string _file_name;
+    std::ifstream _file;
+    std::vector<char> _file_buffer;
+    std::vector<uint8_t> _message;
+    zstd_compressor _compressor;
+    flatbuffers::FlatBufferBuilder _payload_builder;
+    flatbuffers::FlatBufferBuilder _event_builder;
+    size_t _skipped_batches = 0;
+  };
+
+  //! Seconds since epoch of a UTC timestamp, 0 for an empty one
+  int64_t to_seconds(const messages::flatbuff::v2::TimeStamp& ts);
+}}
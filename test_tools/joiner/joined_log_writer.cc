@@ -0,0 +1,107 @@
+#include "joined_log_writer.h"
+#include <ctime>
+#include <stdexcept>
+// namespace aliases
+namespace v2 = reinforcement_learning::messages::flatbuff::v2;
+////
+
+namespace reinforcement_learning { namespace joiner {
+  namespace {
+    // message types and version of external_parser/parse_example_binary.h
+    const uint32_t MSG_TYPE_FILEMAGIC = 0x42465756; //'VWFB'
+    const uint32_t MSG_TYPE_HEADER = 0x55555555;
+    const uint32_t MSG_TYPE_REGULAR = 0xFFFFFFFF;
+    const uint32_t MSG_TYPE_CHECKPOINT = 0x11111111;
+    const uint32_t MSG_TYPE_EOF = 0xAAAAAAAA;
+    const uint32_t BINARY_PARSER_VERSION = 1;
+
+    const size_t FILE_BUFFER_SIZE = 1 << 20;
+
+    v2::TimeStamp utc_now() {
+      const std::time_t now = std::time(nullptr);
+      std::tm tm_now;
+#ifdef _WIN32
+      gmtime_s(&tm_now, &now);
+#else
+      gmtime_r(&now, &tm_now);
+#endif
+      return v2::TimeStamp(static_cast<uint16_t>(tm_now.tm_year + 1900), static_cast<uint8_t>(tm_now.tm_mon + 1),
+        static_cast<uint8_t>(tm_now.tm_mday), static_cast<uint8_t>(tm_now.tm_hour),
+        static_cast<uint8_t>(tm_now.tm_min), static_cast<uint8_t>(tm_now.tm_sec), 0);
+    }
+  }
+
+  joined_log_writer::joined_log_writer(const std::string& file)
+    : _file_name(file)
+    , _file_buffer(FILE_BUFFER_SIZE) {
+    _file.rdbuf()->pubsetbuf(_file_buffer.data(), _file_buffer.size());
+    _file.open(file, std::ios_base::binary | std::ios_base::trunc);
+    if (!_file.is_open()) {
+      throw std::runtime_error("Unable to open file: " + file);
+    }
+
+    write_uint32(MSG_TYPE_FILEMAGIC);
+    write_uint32(BINARY_PARSER_VERSION);
+
+    const auto join_time = utc_now();
+    _builder.Finish(v2::CreateFileHeader(_builder, &join_time));
+    write_message(MSG_TYPE_HEADER, _builder.GetBufferPointer(), _builder.GetSize());
+    _builder.Clear();
+  }
+
+  joined_log_writer::~joined_log_writer() {
+    if (!_closed) {
+      try {
+        close();
+      }
+      catch (const std::exception&) {
+      }
+    }
+  }
+
+  void joined_log_writer::write_checkpoint(v2::RewardFunctionType reward_function, float default_reward,
+    v2::LearningModeType learning_mode, v2::ProblemType problem_type) {
+    write_payload();
+    _builder.Finish(v2::CreateCheckpointInfo(_builder, reward_function, default_reward, learning_mode, problem_type));
+    write_message(MSG_TYPE_CHECKPOINT, _builder.GetBufferPointer(), _builder.GetSize());
+    _builder.Clear();
+  }
+
+  void joined_log_writer::add(const logged_event& e) {
+    const auto event = _builder.CreateVector(e.event.data(), e.event.size());
+    _joined_events.push_back(v2::CreateJoinedEvent(_builder, event, &e.client_time));
+  }
+
+  void joined_log_writer::write_payload() {
+    if (_joined_events.empty()) {
+      return;
+    }
+    _builder.Finish(v2::CreateJoinedPayload(_builder, _builder.CreateVector(_joined_events)));
+    write_message(MSG_TYPE_REGULAR, _builder.GetBufferPointer(), _builder.GetSize());
+    _builder.Clear();
+    _joined_events.clear();
+    ++_messages_written;
+  }
+
+  void joined_log_writer::close() {
+    _closed = true;
+    write_payload();
+    write_uint32(MSG_TYPE_EOF);
+    _file.close();
+    if (_file.fail()) {
+      throw std::runtime_error("Error writing to file: " + _file_name);
+    }
+  }
+
+  void joined_log_writer::write_message(uint32_t type, const uint8_t* data, uint32_t size) {
+    static const char padding[8] = {};
+    write_uint32(type);
+    write_uint32(size);
+    _file.write(reinterpret_cast<const char*>(data), size);
+    _file.write(padding, size % 8);
+  }
+
+  void joined_log_writer::write_uint32(uint32_t value) {
+    _file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+}}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <flatbuffers/flatbuffers.h>
+#include "event_reader.h"
+#include "../../rlclientlib/generated/v2/FileFormat_generated.h"
+
+namespace reinforcement_learning { namespace joiner {
+  // Writes the joined binary log read by the external parser: the file magic and version, a header,
+  // then checkpoint and regular messages each made of a type, a size and a flatbuffer padded by size % 8
+  // bytes, and an EOF message.
+  class joined_log_writer {
+  public:
+    explicit joined_log_writer(const std::string& file);
+    ~joined_log_writer();
+
+    joined_log_writer(const joined_log_writer&) = delete;
+    joined_log_writer& operator=(const joined_log_writer&) = delete;
+
+    //! The checkpoint the joined events are read with, written before the first regular message
+    void write_checkpoint(messages::flatbuff::v2::RewardFunctionType reward_function, float default_reward,
+      messages::flatbuff::v2::LearningModeType learning_mode, messages::flatbuff::v2::ProblemType problem_type);
+
+    //! Adds an event to the regular message being built
+    void add(const logged_event& e);
+    size_t pending_events() const { return _joined_events.size(); }
+    //! Writes the events added so far as one regular message
+    void write_payload();
+
+    //! Writes the pending events and the EOF message
+    void close();
+
+    size_t messages_written() const { return _messages_written; }
+
+  private:
+    void write_message(uint32_t type, const uint8_t* data, uint32_t size);
+    void write_uint32(uint32_t value);
+
+    const std::string _file_name;
+    std::ofstream _file;
+    std::vector<char> _file_buffer;
+    flatbuffers::FlatBufferBuilder _builder;
+    std::vector<flatbuffers::Offset<messages::flatbuff::v2::JoinedEvent>> _joined_events;
+    size_t _messages_written = 0;
+    bool _closed = false;
+  };
+}}
@@ -0,0 +1,245 @@
+#include "log_joiner.h"
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "event_reader.h"
+#include "joined_log_writer.h"
+// namespace aliases
+namespace v2 = reinforcement_learning::messages::flatbuff::v2;
+////
+
+namespace reinforcement_learning { namespace joiner {
+  namespace {
+    const int64_t END_OF_FILE = std::numeric_limits<int64_t>::max();
+
+    size_t memory_of(const logged_event& e) {
+      return e.id.size() + e.event.size();
+    }
+
+    bool is_interaction(v2::PayloadType type) {
+      return type == v2::PayloadType_CB || type == v2::PayloadType_CCB || type == v2::PayloadType_Slates ||
+        type == v2::PayloadType_CA;
+    }
+
+    v2::ProblemType to_problem_type(v2::PayloadType type) {
+      switch (type) {
+      case v2::PayloadType_CB: return v2::ProblemType_CB;
+      case v2::PayloadType_CCB: return v2::ProblemType_CCB;
+      case v2::PayloadType_Slates: return v2::ProblemType_SLATES;
+      case v2::PayloadType_CA: return v2::ProblemType_CA;
+      default: return v2::ProblemType_UNKNOWN;
+      }
+    }
+
+    // an interaction with its observations, or a dedup info event that is written as is
+    struct held_event {
+      logged_event event;
+      std::vector<logged_event> observations;
+    };
+
+    class log_joiner {
+    public:
+      explicit log_joiner(const join_options& options)
+        : _options(options)
+        , _writer(options.output_file) {}
+
+      void run() {
+        event_reader interactions(_options.interactions_file);
+        event_reader observations(_options.observations_file);
+        int64_t interactions_time = 0;
+        int64_t observations_time = 0;
+        std::vector<logged_event> batch;
+
+        while (interactions_time != END_OF_FILE || observations_time != END_OF_FILE) {
+          const bool from_interactions = interactions_time <= observations_time;
+          auto& reader = from_interactions ? interactions : observations;
+          auto& time = from_interactions ? interactions_time : observations_time;
+
+          if (!reader.read_batch(batch)) {
+            time = END_OF_FILE;
+          }
+          for (auto& e : batch) {
+            time = std::max(time, e.time);
+            add(std::move(e));
+          }
+
+          release_interactions(observations_time);
+          expire_observations(interactions_time);
+          while (_memory > _options.max_memory && !_held.empty()) {
+            release_front(true);
+          }
+          while (_memory > _options.max_memory && !_waiting_order.empty()) {
+            expire_front();
+          }
+        }
+
+        release_interactions(END_OF_FILE);
+        expire_observations(END_OF_FILE);
+        _writer.close();
+
+        std::cout << "Interactions: " << _interactions << std::endl;
+        std::cout << "Observations: " << _observations << std::endl;
+        std::cout << "Joined observations: " << _joined_observations << std::endl;
+        std::cout << "Observations after the window: " << _late_observations << std::endl;
+        std::cout << "Observations without interaction: " << _orphaned_observations << std::endl;
+        std::cout << "Interactions released early: " << _early_releases << std::endl;
+        std::cout << "Skipped events: " << _skipped_events << std::endl;
+        std::cout << "Skipped batches: " << interactions.skipped_batches() + observations.skipped_batches()
+          << std::endl;
+        std::cout << "Messages written: " << _writer.messages_written() << std::endl;
+      }
+
+    private:
+      void add(logged_event&& e) {
+        if (e.payload_type == v2::PayloadType_DedupInfo) {
+          _memory += memory_of(e);
+          _held.push_back({std::move(e), {}});
+        }
+        else if (e.payload_type == v2::PayloadType_Outcome) {
+          ++_observations;
+          add_observation(std::move(e));
+        }
+        else if (is_interaction(e.payload_type) && (_problem_type == v2::ProblemType_UNKNOWN ||
+          _problem_type == to_problem_type(e.payload_type))) {
+          _problem_type = to_problem_type(e.payload_type);
+          ++_interactions;
+          add_interaction(std::move(e));
+        }
+        else {
+          // multistep episodes and interactions of another problem type than the first one
+          ++_skipped_events;
+        }
+      }
+
+      void add_interaction(logged_event&& e) {
+        _memory += memory_of(e);
+        _held.push_back({std::move(e), {}});
+        auto& held = _held.back();
+        if (_pending.find(held.event.id) != _pending.end()) {
+          // observations of a duplicate id go to the first interaction
+          return;
+        }
+        _pending.emplace(held.event.id, &held);
+
+        auto waiting = _waiting.find(held.event.id);
+        if (waiting != _waiting.end()) {
+          _joined_observations += waiting->second.size();
+          held.observations = std::move(waiting->second);
+          _waiting.erase(waiting);
+        }
+      }
+
+      void add_observation(logged_event&& e) {
+        auto pending = _pending.find(e.id);
+        if (pending != _pending.end() && e.time > pending->second->event.time + _options.window) {
+          // read before the interaction was due, but too late to be joined to it
+          ++_late_observations;
+          return;
+        }
+
+        _memory += memory_of(e);
+        if (pending != _pending.end()) {
+          ++_joined_observations;
+          pending->second->observations.push_back(std::move(e));
+          return;
+        }
+
+        auto& waiting = _waiting[e.id];
+        if (waiting.empty()) {
+          _waiting_order.emplace_back(e.time, e.id);
+        }
+        waiting.push_back(std::move(e));
+      }
+
+      // writes the interactions that can't get more observations, in read order
+      void release_interactions(int64_t observations_time) {
+        while (!_held.empty() && (_held.front().event.payload_type == v2::PayloadType_DedupInfo ||
+          observations_time == END_OF_FILE || _held.front().event.time + _options.window <= observations_time)) {
+          release_front(false);
+        }
+      }
+
+      void release_front(bool early) {
+        auto& held = _held.front();
+        if (!_checkpoint_written) {
+          _writer.write_checkpoint(_options.reward_function, _options.default_reward, _options.learning_mode,
+            _problem_type);
+          _checkpoint_written = true;
+        }
+
+        _writer.add(held.event);
+        _memory -= memory_of(held.event);
+        for (const auto& observation : held.observations) {
+          _writer.add(observation);
+          _memory -= memory_of(observation);
+        }
+        // an interaction and its observations are never split between messages
+        if (_writer.pending_events() >= _options.batch_size) {
+          _writer.write_payload();
+        }
+
+        if (held.event.payload_type != v2::PayloadType_DedupInfo) {
+          auto pending = _pending.find(held.event.id);
+          if (pending != _pending.end() && pending->second == &held) {
+            _pending.erase(pending);
+          }
+          if (early) {
+            ++_early_releases;
+          }
+        }
+        _held.pop_front();
+      }
+
+      // drops the observations whose interaction should have been read by now
+      void expire_observations(int64_t interactions_time) {
+        while (!_waiting_order.empty() && (interactions_time == END_OF_FILE ||
+          _waiting_order.front().first + _options.window < interactions_time)) {
+          expire_front();
+        }
+      }
+
+      void expire_front() {
+        const auto& order = _waiting_order.front();
+        auto waiting = _waiting.find(order.second);
+        // observations joined since are gone already, or wait again from a later time
+        if (waiting != _waiting.end() && waiting->second.front().time == order.first) {
+          _orphaned_observations += waiting->second.size();
+          for (const auto& observation : waiting->second) {
+            _memory -= memory_of(observation);
+          }
+          _waiting.erase(waiting);
+        }
+        _waiting_order.pop_front();
+      }
+
+      const join_options& _options;
+      joined_log_writer _writer;
+      bool _checkpoint_written = false;
+      v2::ProblemType _problem_type = v2::ProblemType_UNKNOWN;
+
+      // deque references stay valid while elements are added and removed at the ends
+      std::deque<held_event> _held;
+      std::unordered_map<std::string, held_event*> _pending;
+      // observations waiting for their interaction, by event id and in read order
+      std::unordered_map<std::string, std::vector<logged_event>> _waiting;
+      std::deque<std::pair<int64_t, std::string>> _waiting_order;
+      size_t _memory = 0;
+
+      size_t _interactions = 0;
+      size_t _observations = 0;
+      size_t _joined_observations = 0;
+      size_t _late_observations = 0;
+      size_t _orphaned_observations = 0;
+      size_t _early_releases = 0;
+      size_t _skipped_events = 0;
+    };
+  }
+
+  void join_logs(const join_options& options) {
+    log_joiner joiner(options);
+    joiner.run();
+  }
+}}
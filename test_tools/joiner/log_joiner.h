@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "../../rlclientlib/generated/v2/FileFormat_generated.h"
+
+namespace reinforcement_learning { namespace joiner {
+  struct join_options {
+    std::string interactions_file = "interaction.fb.data";
+    std::string observations_file = "observation.fb.data";
+    std::string output_file = "joined.fb.data";
+    // seconds an interaction waits for its observations after its client time
+    int64_t window = 600;
+    // bytes of held events, the oldest interactions are released early past it
+    size_t max_memory = size_t(1024) << 20;
+    // joined events per regular message
+    size_t batch_size = 1024;
+    messages::flatbuff::v2::RewardFunctionType reward_function = messages::flatbuff::v2::RewardFunctionType_Earliest;
+    float default_reward = 0.f;
+    messages::flatbuff::v2::LearningModeType learning_mode = messages::flatbuff::v2::LearningModeType_Online;
+  };
+
+  // Joins the raw interaction and observation logs of the file logger into a joined binary log.
+  //
+  // Both files are read a batch at a time, from whichever is behind in client time. Interactions are held
+  // in the order they were read, along with the dedup info events between them, and observations are
+  // attached to the held interaction with the same event id. An interaction is written with its
+  // observations once the observation file is past its client time plus the window, or early when the held
+  // events go over max_memory. Observations read before their interaction wait for it until the
+  // interaction file is past their client time plus the window. Keeping the read order means dedup info
+  // events are always written before the interactions that use them.
+  void join_logs(const join_options& options);
+}}
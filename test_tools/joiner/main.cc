@@ -2,17 +2,22 @@
 //
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include <boost/program_options.hpp>
 #include "text_converter.h"
+#include "log_joiner.h"
 
 // namespace aliases
 namespace po = boost::program_options;
 namespace joiner = reinforcement_learning::joiner;
+namespace v2 = reinforcement_learning::messages::flatbuff::v2;
 ////
 
 // Forward declarations
 bool is_help(const po::variables_map& vm);
 void parse_and_run(int argc, char** argv);
+joiner::join_options get_join_options(const po::variables_map& vm);
 ////
 
 // Entry point
@@ -39,7 +44,25 @@ void parse_and_run(int argc, char** argv) {
     ("print,p", po::value<bool>()->default_value(false),
       "Print out contents of raw log files.  (interaction.fb.data, observation.fb.data)")
     ("join,j", po::value<bool>()->default_value(false),
-        "Join the interaction and observation files and create a file to be consumed by vw for training");
+        "Join the interaction and observation files and create a file to be consumed by vw for training")
+    ("interactions", po::value<std::string>()->default_value("interaction.fb.data"),
+      "Raw interaction log to join")
+    ("observations", po::value<std::string>()->default_value("observation.fb.data"),
+      "Raw observation log to join")
+    ("output,o", po::value<std::string>()->default_value("joined.fb.data"),
+      "Joined binary log to write")
+    ("window", po::value<int>()->default_value(600),
+      "Seconds an interaction waits for its observations")
+    ("max_memory", po::value<int>()->default_value(1024),
+      "MB of events held while joining, the oldest interactions are written early past it")
+    ("batch_size", po::value<int>()->default_value(1024),
+      "Joined events per message of the joined log")
+    ("reward_function", po::value<std::string>()->default_value("earliest"),
+      "Reward function of the joined log: earliest, average, median, sum, min or max")
+    ("default_reward", po::value<float>()->default_value(0.f),
+      "Reward of interactions without observations")
+    ("learning_mode", po::value<std::string>()->default_value("online"),
+      "Learning mode of the joined log: online, apprentice or loggingonly");
 
   po::variables_map vm;
   store(parse_command_line(argc, argv, desc), vm);
@@ -52,9 +75,45 @@ void parse_and_run(int argc, char** argv) {
                               "observation.fb.data" });
   }
   else if (vm["join"].as<bool>()) {
-    std::cout << "Coming soon..." << std::endl;
+    joiner::join_logs(get_join_options(vm));
   }
   else {
     std::cout << desc << std::endl;
   }
+}
+
+joiner::join_options get_join_options(const po::variables_map& vm) {
+  joiner::join_options options;
+  options.interactions_file = vm["interactions"].as<std::string>();
+  options.observations_file = vm["observations"].as<std::string>();
+  options.output_file = vm["output"].as<std::string>();
+
+  const int window = vm["window"].as<int>();
+  const int max_memory = vm["max_memory"].as<int>();
+  const int batch_size = vm["batch_size"].as<int>();
+  if (window <= 0 || max_memory <= 0 || batch_size <= 0) {
+    throw std::runtime_error("window, max_memory and batch_size must be positive");
+  }
+  options.window = window;
+  options.max_memory = static_cast<size_t>(max_memory) << 20;
+  options.batch_size = static_cast<size_t>(batch_size);
+
+  const auto& reward_function = vm["reward_function"].as<std::string>();
+  if (reward_function == "earliest") { options.reward_function = v2::RewardFunctionType_Earliest; }
+  else if (reward_function == "average") { options.reward_function = v2::RewardFunctionType_Average; }
+  else if (reward_function == "median") { options.reward_function = v2::RewardFunctionType_Median; }
+  else if (reward_function == "sum") { options.reward_function = v2::RewardFunctionType_Sum; }
+  else if (reward_function == "min") { options.reward_function = v2::RewardFunctionType_Min; }
+  else if (reward_function == "max") { options.reward_function = v2::RewardFunctionType_Max; }
+  else { throw std::runtime_error("Unknown reward function: " + reward_function); }
+
+  options.default_reward = vm["default_reward"].as<float>();
+
+  const auto& learning_mode = vm["learning_mode"].as<std::string>();
+  if (learning_mode == "online") { options.learning_mode = v2::LearningModeType_Online; }
+  else if (learning_mode == "apprentice") { options.learning_mode = v2::LearningModeType_Apprentice; }
+  else if (learning_mode == "loggingonly") { options.learning_mode = v2::LearningModeType_LoggingOnly; }
+  else { throw std::runtime_error("Unknown learning mode: " + learning_mode); }
+
+  return options;
 }
\ No newline at end of file
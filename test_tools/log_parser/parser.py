@@ -212,8 +212,10 @@ def dump_event_batch(buf):
     batch = EventBatch.GetRootAsEventBatch(buf, 0)
     meta = batch.Metadata()
     enc = meta.ContentEncoding().decode('utf-8')
+    if enc in ('ZSTD', 'DEDUP_ZSTD'):
+        batch = EventBatch.GetRootAsEventBatch(zstd.decompress(batch.CompressedEventsAsNumpy()), 0)
     print(f'event-batch evt-count:{batch.EventsLength()} enc:{enc}')
-    is_dedup = b'DEDUP' == meta.ContentEncoding()
+    is_dedup = enc.startswith('DEDUP')
     for i in range(0, batch.EventsLength()):
         dump_event(batch.Events(i).PayloadAsNumpy(), i)
     print("----\n")
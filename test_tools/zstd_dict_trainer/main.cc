@@ -0,0 +1,193 @@
+// main.cc : Trains a zstd dictionary from the payloads of logged v2 events.
+// The dictionary is used by the client through the zstd.dictionary.file setting
+// and by the external parser through --zstd_dictionary.
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include "../../rlclientlib/logger/preamble.h"
+#include "../../rlclientlib/logger/message_type.h"
+#include "../../rlclientlib/generated/v2/Event_generated.h"
+
+#include "zstd.h"
+#define ZDICT_STATIC_LINKING_ONLY
+#include "zdict.h"
+
+// namespace aliases
+namespace po = boost::program_options;
+namespace rlog = reinforcement_learning::logger;
+namespace v2 = reinforcement_learning::messages::flatbuff::v2;
+////
+
+// Samples are kept back to back, as expected by ZDICT
+struct samples {
+  std::vector<char> data;
+  std::vector<size_t> sizes;
+
+  void add(const uint8_t* start, size_t size) {
+    data.insert(data.end(), start, start + size);
+    sizes.push_back(size);
+  }
+};
+
+// Forward declarations
+void parse_and_run(int argc, char** argv);
+bool collect_samples(const std::string& file, samples& out);
+void collect_batch_samples(const v2::EventBatch* batch, samples& out);
+void print_compression_ratio(const samples& in, const std::vector<char>& dict, int level);
+////
+
+// Entry point
+int main(const int argc, char** argv)
+{
+  try {
+    parse_and_run(argc, argv);
+  }
+  catch (const std::exception& e) {
+    std::cout << "Error: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+void parse_and_run(int argc, char** argv) {
+  std::vector<std::string> inputs;
+  std::string output;
+  size_t dict_size;
+  unsigned int dict_id;
+  int level;
+
+  po::options_description desc("Options");
+  desc.add_options()
+    ("help", "produce help message")
+    ("input,i", po::value<std::vector<std::string>>(&inputs)->multitoken(),
+      "Raw interaction log files (preamble framed v2 event batches) to sample payloads from")
+    ("output,o", po::value<std::string>(&output)->default_value("zstd.dict"), "Dictionary file to write")
+    ("size,s", po::value<size_t>(&dict_size)->default_value(64 * 1024), "Maximum dictionary size in bytes")
+    ("id", po::value<unsigned int>(&dict_id)->default_value(0),
+      "Dictionary id to stamp in the dictionary, 0 picks a random one")
+    ("level,l", po::value<int>(&level)->default_value(1), "Compression level the dictionary is tuned for");
+
+  po::variables_map vm;
+  store(parse_command_line(argc, argv, desc), vm);
+  notify(vm);
+
+  if (vm.count("help") > 0 || inputs.empty()) {
+    std::cout << desc << std::endl;
+    return;
+  }
+
+  samples training_set;
+  for (const auto& file : inputs) {
+    if (!collect_samples(file, training_set)) {
+      throw std::runtime_error("Unable to read input file: " + file);
+    }
+  }
+  if (training_set.sizes.empty()) {
+    throw std::runtime_error("No uncompressed payloads found in the input files");
+  }
+  std::cout << "Collected " << training_set.sizes.size() << " payloads, "
+            << training_set.data.size() << " bytes" << std::endl;
+
+  ZDICT_fastCover_params_t params{};
+  params.d = 8;
+  params.steps = 4;
+  params.zParams.compressionLevel = level;
+  params.zParams.dictID = dict_id;
+
+  std::vector<char> dict(dict_size);
+  size_t res = ZDICT_optimizeTrainFromBuffer_fastCover(dict.data(), dict.size(),
+    training_set.data.data(), training_set.sizes.data(), static_cast<unsigned>(training_set.sizes.size()), &params);
+  if (ZDICT_isError(res)) {
+    throw std::runtime_error(std::string("Dictionary training failed: ") + ZDICT_getErrorName(res));
+  }
+  dict.resize(res);
+
+  std::ofstream out(output, std::ios::binary);
+  out.write(dict.data(), dict.size());
+  if (!out.good()) {
+    throw std::runtime_error("Unable to write dictionary file: " + output);
+  }
+
+  std::cout << "Wrote dictionary " << ZSTD_getDictID_fromDict(dict.data(), dict.size())
+            << " (" << dict.size() << " bytes) to " << output << std::endl;
+  print_compression_ratio(training_set, dict, level);
+}
+
+bool collect_samples(const std::string& file, samples& out) {
+  std::ifstream in_strm(file, std::ios::binary);
+  if (!in_strm.good()) {
+    return false;
+  }
+
+  while (true) {
+    uint8_t raw_preamble[8];
+    if (!in_strm.read(reinterpret_cast<char*>(raw_preamble), rlog::preamble::size())) {
+      return true;
+    }
+    rlog::preamble p;
+    p.read_from_bytes(raw_preamble, rlog::preamble::size());
+
+    std::vector<uint8_t> msg(p.msg_size);
+    if (!in_strm.read(reinterpret_cast<char*>(msg.data()), p.msg_size)) {
+      return false;
+    }
+    if (p.msg_type != rlog::message_type::fb_generic_event_collection) {
+      continue;
+    }
+
+    const auto* batch = v2::GetEventBatch(msg.data());
+    if (batch->compressed_events() != nullptr) {
+      const auto* compressed = batch->compressed_events();
+      size_t size = ZSTD_getFrameContentSize(compressed->data(), compressed->size());
+      if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN) {
+        return false;
+      }
+      std::vector<uint8_t> inner(size);
+      if (ZSTD_isError(ZSTD_decompress(inner.data(), inner.size(), compressed->data(), compressed->size()))) {
+        return false;
+      }
+      collect_batch_samples(v2::GetEventBatch(inner.data()), out);
+    }
+    else {
+      collect_batch_samples(batch, out);
+    }
+  }
+}
+
+void collect_batch_samples(const v2::EventBatch* batch, samples& out) {
+  if (batch->events() == nullptr) {
+    return;
+  }
+  for (const auto* serialized : *batch->events()) {
+    const auto* event = flatbuffers::GetRoot<v2::Event>(serialized->payload()->data());
+    // Payloads that were already compressed carry no structure to learn from
+    if (event->meta()->encoding() != v2::EventEncoding_Identity || event->payload() == nullptr) {
+      continue;
+    }
+    out.add(event->payload()->data(), event->payload()->size());
+  }
+}
+
+void print_compression_ratio(const samples& in, const std::vector<char>& dict, int level) {
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  ZSTD_CDict* cdict = ZSTD_createCDict(dict.data(), dict.size(), level);
+  std::vector<char> dst(ZSTD_compressBound(*std::max_element(in.sizes.begin(), in.sizes.end())));
+
+  size_t plain = 0;
+  size_t with_dict = 0;
+  size_t offset = 0;
+  for (auto size : in.sizes) {
+    const char* src = in.data.data() + offset;
+    plain += ZSTD_compressCCtx(cctx, dst.data(), dst.size(), src, size, level);
+    with_dict += ZSTD_compress_usingCDict(cctx, dst.data(), dst.size(), src, size, cdict);
+    offset += size;
+  }
+  ZSTD_freeCDict(cdict);
+  ZSTD_freeCCtx(cctx);
+
+  std::cout << "Compressed size without dictionary: " << plain << " bytes, with dictionary: " << with_dict << " bytes" << std::endl;
+}
@@ -268,3 +268,125 @@ BOOST_AUTO_TEST_CASE(queue_config_drop_rate_test)
   BOOST_REQUIRE(!items.empty());
   BOOST_CHECK_EQUAL(items[0], "0.00\n0.69\n0.70\n");
 }
+
+namespace {
+  using undroppable_record = logger::event_record<test_undroppable_event>;
+
+  int append_undroppable(logger::async_batcher<test_undroppable_event>& batcher, const std::string& id, api_status* status) {
+    return batcher.append(undroppable_record(undroppable_record::ready_event{ test_undroppable_event(id) }), id.c_str(), 1, status);
+  }
+
+  utility::async_batcher_config full_queue_config(queue_mode_enum queue_mode) {
+    utility::async_batcher_config config;
+    config.send_high_water_mark = 262143;
+    config.send_batch_interval_ms = 60 * 1000; // nothing is sent while the test runs
+    config.send_queue_max_capacity = 2;
+    config.queue_mode = queue_mode;
+    return config;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(queue_nonblocking_rejects_when_full)
+{
+  std::vector<std::string> items;
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  int dummy = 0;
+  logger::async_batcher<test_undroppable_event> batcher(new message_sender(items), watchdog, dummy, &error_fn,
+    full_queue_config(queue_mode_enum::NONBLOCKING));
+  BOOST_REQUIRE_EQUAL(batcher.init(nullptr), error_code::success);
+
+  api_status status;
+  BOOST_CHECK_EQUAL(append_undroppable(batcher, "1", &status), error_code::success);
+  BOOST_CHECK_EQUAL(append_undroppable(batcher, "2", &status), error_code::success);
+  BOOST_CHECK_EQUAL(append_undroppable(batcher, "3", &status), error_code::logging_queue_full);
+  BOOST_CHECK_EQUAL(status.get_error_code(), error_code::logging_queue_full);
+
+  const auto queue = batcher.get_queue_status();
+  BOOST_CHECK_EQUAL(queue.queued_events, 2);
+  BOOST_CHECK_EQUAL(queue.queued_bytes, 2);
+  BOOST_CHECK_EQUAL(queue.max_capacity_bytes, 2);
+  BOOST_CHECK_EQUAL(queue.rejected_events, 1);
+  BOOST_CHECK_CLOSE(queue.fill_ratio(), 1.f, 0.001f);
+}
+
+BOOST_AUTO_TEST_CASE(queue_block_timeout_rejects_when_full)
+{
+  std::vector<std::string> items;
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  int dummy = 0;
+  auto config = full_queue_config(queue_mode_enum::BLOCK);
+  config.queue_block_timeout_ms = 20;
+  logger::async_batcher<test_undroppable_event> batcher(new message_sender(items), watchdog, dummy, &error_fn, config);
+  BOOST_REQUIRE_EQUAL(batcher.init(nullptr), error_code::success);
+
+  BOOST_CHECK_EQUAL(append_undroppable(batcher, "1", nullptr), error_code::success);
+  BOOST_CHECK_EQUAL(append_undroppable(batcher, "2", nullptr), error_code::success);
+
+  const auto start = std::chrono::steady_clock::now();
+  BOOST_CHECK_EQUAL(append_undroppable(batcher, "3", nullptr), error_code::logging_queue_full);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+  BOOST_CHECK_EQUAL(batcher.get_queue_status().rejected_events, 1);
+  BOOST_CHECK_EQUAL(batcher.get_lane_metrics(event_priority::NORMAL).blocked, 1);
+}
+
+BOOST_AUTO_TEST_CASE(batch_size_controller_fixed_without_target)
+{
+  utility::async_batcher_config config;
+  config.send_high_water_mark = 1000;
+  config.send_batch_interval_ms = 200;
+  logger::batch_size_controller controller(config);
+
+  BOOST_CHECK(!controller.enabled());
+  controller.on_batch_sent(1000, 100, 10, 50);
+  controller.on_flush(3);
+  BOOST_CHECK_EQUAL(1000, controller.high_water_mark());
+  BOOST_CHECK_EQUAL(200, controller.flush_interval_ms());
+}
+
+BOOST_AUTO_TEST_CASE(batch_size_controller_tracks_wire_size)
+{
+  utility::async_batcher_config config;
+  config.send_batch_interval_ms = 200;
+  config.send_batch_min_interval_ms = 20;
+  config.send_batch_target_bytes = 1000;
+  logger::batch_size_controller controller(config);
+
+  BOOST_CHECK_EQUAL(1000, controller.high_water_mark());
+  // batches compress to a quarter of the estimate, so they can hold more events
+  for (int i = 0; i < 50; ++i) {
+    controller.on_batch_sent(1000, 250, 0, 0);
+  }
+  BOOST_CHECK_CLOSE(4000.f, static_cast<float>(controller.high_water_mark()), 1.f);
+
+  // full batches shorten the interval down to its minimum, idle flushes let it grow back
+  controller.on_flush(2);
+  BOOST_CHECK_EQUAL(100, controller.flush_interval_ms());
+  for (int i = 0; i < 10; ++i) {
+    controller.on_flush(1);
+  }
+  BOOST_CHECK_EQUAL(20, controller.flush_interval_ms());
+  for (int i = 0; i < 50; ++i) {
+    controller.on_flush(0);
+  }
+  BOOST_CHECK_EQUAL(200, controller.flush_interval_ms());
+}
+
+BOOST_AUTO_TEST_CASE(batch_size_controller_latency_budget)
+{
+  utility::async_batcher_config config;
+  config.send_batch_interval_ms = 1000;
+  config.send_batch_min_interval_ms = 10;
+  config.send_batch_target_bytes = 1000;
+  config.send_batch_latency_budget_ms = 300;
+  logger::batch_size_controller controller(config);
+
+  // the slower of the blocking time and the reported round trip counts
+  for (int i = 0; i < 50; ++i) {
+    controller.on_batch_sent(1000, 1000, 5, 100);
+  }
+  controller.on_flush(0);
+  BOOST_CHECK_LE(controller.flush_interval_ms(), 201);
+  BOOST_CHECK_GE(controller.flush_interval_ms(), 199);
+}
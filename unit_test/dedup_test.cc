@@ -5,6 +5,16 @@
 
 #include <boost/test/unit_test.hpp>
 #include "dedup_internals.h"
+#include "logger/event_logger.h"
+#include "logger/logger_extensions.h"
+#include "utility/watchdog.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "zstd.h"
+#define ZDICT_STATIC_LINKING_ONLY
+#include "zdict.h"
 
 namespace r = reinforcement_learning;
 namespace err = reinforcement_learning::error_code;
@@ -121,6 +131,62 @@ BOOST_AUTO_TEST_CASE(dedup_simple_json)
   BOOST_CHECK_EQUAL(false, dict.remove_object(178626470));
 }
 
+BOOST_AUTO_TEST_CASE(dedup_shared_and_slots)
+{
+  r::dedup_dict dict;
+  dict.set_targets(r::dedup_dict::TARGET_ACTIONS | r::dedup_dict::TARGET_SLOTS | r::dedup_dict::TARGET_SHARED);
+  std::string payload = R"({"User":{"id":"a"},"_multi":[{ "b_": "1" }],"_slots":[{"s":1}],"_label":{"x":1}})";
+
+  std::string p_out;
+  r::generic_event::object_list_t a_out;
+
+  BOOST_CHECK_EQUAL(err::success, dict.transform_payload_and_add_objects(payload.c_str(), p_out, a_out, nullptr));
+  //objects are listed in payload order, the action id is the same as with actions only
+  BOOST_CHECK_EQUAL(3, a_out.size());
+  BOOST_CHECK_EQUAL(r::dedup_dict::SHARED_ID_BITS, a_out[0] & ~0xFFFFFFFFULL);
+  BOOST_CHECK_EQUAL(989852256, a_out[1]);
+  BOOST_CHECK_EQUAL(r::dedup_dict::SLOT_ID_BITS, a_out[2] & ~0xFFFFFFFFULL);
+
+  const auto transformed_payload = R"({"User":{"__aid":)" + std::to_string(a_out[0]) +
+    R"(},"_multi":[{"__aid":989852256}],"_slots":[{"__aid":)" + std::to_string(a_out[2]) +
+    R"(}],"_label":{"x":1}})";
+  BOOST_CHECK_EQUAL(transformed_payload, p_out);
+  BOOST_CHECK_EQUAL(R"({"id":"a"})", dict.get_object(a_out[0]));
+  BOOST_CHECK_EQUAL(R"({"s":1})", dict.get_object(a_out[2]));
+}
+
+BOOST_AUTO_TEST_CASE(dedup_state_invalid_targets)
+{
+  r::utility::configuration c;
+  c.set(r::name::DEDUP_TARGETS, "actions,users");
+  r::dedup_state state(c, false, true, nullptr);
+  BOOST_CHECK_EQUAL(err::invalid_argument, state.init(c, nullptr));
+
+  c.set(r::name::DEDUP_TARGETS, "shared,slots");
+  BOOST_CHECK_EQUAL(err::success, state.init(c, nullptr));
+}
+
+BOOST_AUTO_TEST_CASE(dedup_extracted_values_outlive_the_dictionary)
+{
+  r::dedup_dict dict;
+  const std::string content(1024, 'x');
+  auto id = dict.add_object(content.c_str(), content.size());
+  dict.add_object(content.c_str(), content.size());
+
+  std::vector<std::pair<r::generic_event::object_id_t, size_t>> batch = { { id, 1 } };
+  r::generic_event::object_list_t ids;
+  std::vector<r::string_view> values;
+  std::vector<r::dedup_dict::content_ptr_t> contents;
+  BOOST_CHECK(dict.extract_objects(batch.begin(), batch.end(), ids, values, contents));
+  BOOST_CHECK_EQUAL(1, dict.size());
+
+  //another thread drops the last reference while the batch is serialized
+  BOOST_CHECK(dict.remove_object(id));
+  BOOST_CHECK_EQUAL(0, dict.size());
+  dict.add_object("other", 5);
+  BOOST_CHECK_EQUAL(content, values[0].to_string());
+}
+
 BOOST_AUTO_TEST_CASE(compression_transformer)
 {
   r::zstd_compressor compressor(1);
@@ -183,6 +249,68 @@ BOOST_AUTO_TEST_CASE(action_dict_builder_missing_actions_in_dict)
 }
 
 
+BOOST_AUTO_TEST_CASE(dedup_lru_ships_new_objects_only)
+{
+  r::dedup_lru lru(2, 0);
+  std::vector<r::string_view> values = { "a", "b" };
+  r::generic_event::object_list_t ids = { 1, 2 };
+  r::generic_event::object_list_t evicted;
+  bool incremental = true;
+
+  //the first batch always carries the full dictionary
+  lru.ship(ids, values, evicted, incremental);
+  BOOST_CHECK(!incremental);
+  BOOST_CHECK_EQUAL(2, ids.size());
+  BOOST_CHECK(evicted.empty());
+
+  //1 was shipped already, 3 pushes 2 out
+  ids = { 1, 3 };
+  values = { "a", "c" };
+  lru.ship(ids, values, evicted, incremental);
+  BOOST_CHECK(incremental);
+  BOOST_CHECK_EQUAL(1, ids.size());
+  BOOST_CHECK_EQUAL(3, ids[0]);
+  BOOST_CHECK_EQUAL("c", values[0]);
+  BOOST_CHECK_EQUAL(1, evicted.size());
+  BOOST_CHECK_EQUAL(2, evicted[0]);
+  BOOST_CHECK(lru.contains(1));
+  BOOST_CHECK(!lru.contains(2));
+
+  //objects of the current batch are kept even above capacity
+  ids = { 4, 5, 6 };
+  values = { "d", "e", "f" };
+  evicted.clear();
+  lru.ship(ids, values, evicted, incremental);
+  BOOST_CHECK_EQUAL(3, ids.size());
+  BOOST_CHECK_EQUAL(2, evicted.size());
+  BOOST_CHECK(lru.contains(4) && lru.contains(5) && lru.contains(6));
+}
+
+BOOST_AUTO_TEST_CASE(dedup_lru_refresh)
+{
+  r::dedup_lru lru(10, 2);
+  r::generic_event::object_list_t evicted;
+  bool incremental;
+
+  for (int batch = 0; batch < 4; ++batch) {
+    std::vector<r::string_view> values = { "a" };
+    r::generic_event::object_list_t ids = { 1 };
+    lru.ship(ids, values, evicted, incremental);
+    //every other batch resends its objects
+    BOOST_CHECK_EQUAL(batch % 2 != 0, incremental);
+    BOOST_CHECK_EQUAL(incremental ? 0 : 1, ids.size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dedup_lru_client_ids)
+{
+  //the joiner keeps the objects of each instance apart
+  r::dedup_lru first(10, 0);
+  r::dedup_lru second(10, 0);
+  BOOST_CHECK(first.client_id() != 0);
+  BOOST_CHECK(first.client_id() != second.client_id());
+}
+
 BOOST_AUTO_TEST_CASE(ewma_test)
 {
   r::ewma e(1, .5f);
@@ -269,6 +397,46 @@ BOOST_AUTO_TEST_CASE(dedup_state_and_bad_state)
   BOOST_CHECK_EQUAL(0, state.get_dict().get_object(id).size());
 }
 
+BOOST_AUTO_TEST_CASE(dedup_state_extract_all_values)
+{
+  r::utility::configuration c;
+  r::dedup_state state(c, true, true, nullptr);
+
+  //enough objects to land in several stripes
+  std::unordered_map<r::generic_event::object_id_t, size_t> batch_actions;
+  for (int i = 0; i < 64; ++i) {
+    const auto content = "action_" + std::to_string(i);
+    batch_actions[state.get_dict().add_object(content.c_str(), content.size())] = 1;
+  }
+  //still referenced by an event that isn't in this batch
+  auto shared = state.get_dict().add_object("action_0", 8);
+  BOOST_CHECK_EQUAL(64, state.get_dict().size());
+
+  size_t total_size = 0;
+  r::generic_event::object_list_t ids = { shared };
+  BOOST_CHECK(state.get_objects_size(ids, total_size));
+  BOOST_CHECK_EQUAL(8, total_size);
+
+  r::generic_event::object_list_t action_ids;
+  std::vector<r::string_view> action_values;
+  std::vector<r::dedup_dict::content_ptr_t> contents;
+  BOOST_CHECK_EQUAL(err::success, state.extract_all_values(batch_actions.begin(), batch_actions.end(), action_ids, action_values, contents, nullptr));
+
+  BOOST_CHECK_EQUAL(64, action_ids.size());
+  //action_1 to action_63 are moved out, action_0 stays in the dictionary
+  BOOST_CHECK_EQUAL(64, contents.size());
+  for (size_t i = 0; i < action_ids.size(); ++i) {
+    BOOST_CHECK_EQUAL(0, std::string(action_values[i].data(), action_values[i].size()).find("action_"));
+    BOOST_CHECK_EQUAL(contents[i]->data(), action_values[i].data());
+  }
+
+  BOOST_CHECK_EQUAL(1, state.get_dict().size());
+  BOOST_CHECK_EQUAL(8, state.get_object(shared).size());
+
+  ids.push_back(shared + 1);
+  BOOST_CHECK(!state.get_objects_size(ids, total_size));
+}
+
 BOOST_AUTO_TEST_CASE(dedup_enable_compression)
 {
   r::utility::configuration c;
@@ -291,6 +459,131 @@ BOOST_AUTO_TEST_CASE(dedup_enable_compression)
   BOOST_CHECK_EQUAL(input, (char*)in.data());
 }
 
+BOOST_AUTO_TEST_CASE(zstd_compress_into_caller_buffer)
+{
+  r::zstd_compressor compressor(1);
+  const std::string input(512, 'a');
+  const auto* data = reinterpret_cast<const uint8_t*>(input.c_str());
+
+  std::vector<uint8_t> output(r::zstd_compressor::compress_bound(input.size() + 1));
+  size_t compressed_size = 0;
+  BOOST_CHECK_EQUAL(err::success, compressor.compress(data, input.size() + 1, output.data(), output.size(), compressed_size, nullptr));
+  BOOST_CHECK_GT(compressed_size, 0);
+  BOOST_CHECK_LT(compressed_size, input.size());
+
+  //Contexts are reused by the thread, compressing again must give the same result
+  std::vector<uint8_t> second(output.size());
+  size_t second_size = 0;
+  BOOST_CHECK_EQUAL(err::success, compressor.compress(data, input.size() + 1, second.data(), second.size(), second_size, nullptr));
+  BOOST_CHECK_EQUAL_COLLECTIONS(output.begin(), output.begin() + compressed_size, second.begin(), second.begin() + second_size);
+
+  uint8_t* copy = fb::DefaultAllocator().allocate(compressed_size);
+  memcpy(copy, output.data(), compressed_size);
+  fb::DetachedBuffer buf(nullptr, false, copy, 0, copy, compressed_size);
+  BOOST_CHECK_EQUAL(err::success, compressor.decompress(buf, nullptr));
+  BOOST_CHECK_EQUAL(input, (char*)buf.data());
+
+  size_t too_small_size = 0;
+  BOOST_CHECK_EQUAL(err::compression_error, compressor.compress(data, input.size() + 1, output.data(), 4, too_small_size, nullptr));
+}
+
+BOOST_AUTO_TEST_CASE(dedup_compression_dictionary_file)
+{
+  r::utility::configuration c;
+  c.set(r::name::ZSTD_DICTIONARY_FILE, "no_such_zstd_dictionary.bin");
+
+  r::dedup_state state(c, true, true, nullptr);
+  BOOST_CHECK_EQUAL(err::file_open_error, state.init(c, nullptr));
+
+  //The dictionary is only loaded when compression is enabled
+  r::dedup_state no_compression_state(c, false, true, nullptr);
+  BOOST_CHECK_EQUAL(err::success, no_compression_state.init(c, nullptr));
+}
+
+namespace {
+  //! Trains a small dictionary on context like samples, the way zstd_dict_trainer does on logged payloads
+  std::vector<char> train_dictionary(unsigned dict_id)
+  {
+    std::string samples;
+    std::vector<size_t> sizes;
+    for (int i = 0; i < 256; ++i) {
+      const auto sample = R"({"GUser":{"id":"user_)" + std::to_string(i % 17) + R"(","major":"engineering","hobby":"hiking"},)"
+        R"("_multi":[{"TAction":{"topic":"politics_)" + std::to_string(i % 5) + R"("}},{"TAction":{"topic":"sports"}}]})";
+      samples += sample;
+      sizes.push_back(sample.size());
+    }
+
+    ZDICT_fastCover_params_t params{};
+    params.k = 64;
+    params.d = 8;
+    params.zParams.dictID = dict_id;
+    std::vector<char> dict(4 * 1024);
+    const size_t res = ZDICT_trainFromBuffer_fastCover(dict.data(), dict.size(), samples.data(), sizes.data(), static_cast<unsigned>(sizes.size()), params);
+    BOOST_REQUIRE(!ZDICT_isError(res));
+    dict.resize(res);
+    return dict;
+  }
+
+  void write_file(const char* file_name, const std::vector<char>& content)
+  {
+    std::ofstream out(file_name, std::ios::binary);
+    out.write(content.data(), content.size());
+  }
+
+  fb::DetachedBuffer copy_buff(const fb::DetachedBuffer& buff)
+  {
+    uint8_t* copy = fb::DefaultAllocator().allocate(buff.size());
+    memcpy(copy, buff.data(), buff.size());
+    return fb::DetachedBuffer(nullptr, false, copy, 0, copy, buff.size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dedup_compression_dictionary_round_trip)
+{
+  const char* dictionary_file = "dedup_test_dictionary.bin";
+  const char* other_dictionary_file = "dedup_test_other_dictionary.bin";
+  write_file(dictionary_file, train_dictionary(1234));
+  write_file(other_dictionary_file, train_dictionary(5678));
+
+  r::utility::configuration c;
+  c.set(r::name::ZSTD_DICTIONARY_FILE, dictionary_file);
+  c.set(r::name::ZSTD_DICTIONARY_ID, "1234");
+  r::dedup_state state(c, true, true, nullptr);
+  BOOST_REQUIRE_EQUAL(err::success, state.init(c, nullptr));
+
+  const char* input = R"({"GUser":{"id":"user_3","major":"engineering","hobby":"hiking"},"_multi":[{"TAction":{"topic":"sports"}}]})";
+  auto compressed = str_to_buff(input);
+  auto content_type = r::event_content_type::IDENTITY;
+  BOOST_CHECK_EQUAL(err::success, state.compress(compressed, content_type, nullptr));
+  BOOST_CHECK_EQUAL((int)r::event_content_type::ZSTD_DICTIONARY, (int)content_type);
+  //readers pick the dictionary from the id stamped in the frame
+  BOOST_CHECK_EQUAL(1234, ZSTD_getDictID_fromFrame(compressed.data(), compressed.size()));
+
+  r::zstd_compressor reader(1);
+  BOOST_REQUIRE_EQUAL(err::success, reader.load_dictionary(dictionary_file, 1234, nullptr));
+  auto decompressed = copy_buff(compressed);
+  BOOST_CHECK_EQUAL(err::success, reader.decompress(decompressed, nullptr));
+  BOOST_CHECK_EQUAL(input, (char*)decompressed.data());
+
+  //neither another dictionary nor no dictionary at all can read it
+  r::zstd_compressor other_reader(1);
+  BOOST_REQUIRE_EQUAL(err::success, other_reader.load_dictionary(other_dictionary_file, 0, nullptr));
+  auto other = copy_buff(compressed);
+  BOOST_CHECK_EQUAL(err::compression_error, other_reader.decompress(other, nullptr));
+
+  r::zstd_compressor no_dictionary_reader(1);
+  auto none = copy_buff(compressed);
+  BOOST_CHECK_EQUAL(err::compression_error, no_dictionary_reader.decompress(none, nullptr));
+
+  //the client refuses a dictionary file that doesn't hold the configured id
+  c.set(r::name::ZSTD_DICTIONARY_ID, "5678");
+  r::dedup_state mismatched_state(c, true, true, nullptr);
+  BOOST_CHECK_EQUAL(err::compression_error, mismatched_state.init(c, nullptr));
+
+  std::remove(dictionary_file);
+  std::remove(other_dictionary_file);
+}
+
 BOOST_AUTO_TEST_CASE(dedup_state_no_dedup)
 {
   //This test the expected usage of it
@@ -331,4 +624,68 @@ BOOST_AUTO_TEST_CASE(dedup_disable_compression)
   BOOST_CHECK_EQUAL((int)r::event_content_type::IDENTITY, (int)content_type);
   BOOST_CHECK_EQUAL(old_len, in.size());
   BOOST_CHECK_EQUAL(ptr1, in.data());
-}
\ No newline at end of file
+}
+
+namespace {
+  //! Keeps the raw batches the logger sends
+  class batch_collector : public r::logger::i_message_sender {
+  public:
+    explicit batch_collector(std::vector<std::string>& batches) : _batches(batches) {}
+
+    int send(const uint16_t msg_type, const buffer& db, r::api_status* status) override {
+      _batches.emplace_back(reinterpret_cast<const char*>(db->body_begin()), db->body_filled_size());
+      return err::success;
+    }
+    int init(r::api_status* status) override { return err::success; }
+  private:
+    std::vector<std::string>& _batches;
+  };
+
+  void count_errors(const r::api_status&, void* errors) { ++*static_cast<int*>(errors); }
+
+  fb::DetachedBuffer context_payload(const char* context) {
+    fb::FlatBufferBuilder fbb;
+    fbb.Finish(fbb.CreateString(context));
+    return fbb.Release();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dedup_deferred_bad_context_keeps_the_batch)
+{
+  namespace v2 = r::messages::flatbuff::v2;
+  r::utility::configuration c;
+  c.set(r::name::PROTOCOL_VERSION, "2");
+  c.set(r::name::INTERACTION_USE_DEDUP, "true");
+  std::unique_ptr<r::logger::i_logger_extensions> ext(r::logger::i_logger_extensions::get_extensions(c, nullptr));
+  BOOST_REQUIRE_EQUAL(err::success, ext->init(nullptr));
+
+  std::vector<std::string> batches;
+  int errors = 0;
+  r::error_callback_fn error_fn(count_errors, &errors);
+  r::utility::watchdog watchdog(nullptr);
+  {
+    r::logger::generic_event_logger logger(nullptr,
+      ext->create_batcher(new batch_collector(batches), watchdog, &error_fn, r::INTERACTION_SECTION), "app_id");
+    BOOST_REQUIRE_EQUAL(err::success, logger.init(nullptr));
+
+    const char* context = R"({"_multi":[{"a":1},{"a":2}]})";
+    BOOST_CHECK_EQUAL(err::success, logger.log_deferred("good_1", context, v2::PayloadType_CB, ext.get(), context_payload, nullptr));
+    //the context is only parsed by the batcher
+    BOOST_CHECK_EQUAL(err::success, logger.log_deferred("bad", "{ invalid }", v2::PayloadType_CB, ext.get(), context_payload, nullptr));
+    BOOST_CHECK_EQUAL(err::success, logger.log_deferred("good_2", context, v2::PayloadType_CB, ext.get(), context_payload, nullptr));
+  } //the batcher flushes the queue on destruction
+
+  std::vector<std::string> ids;
+  for (const auto& batch : batches) {
+    const auto* events = v2::GetEventBatch(batch.data())->events();
+    for (size_t i = 0; i < events->size(); ++i) {
+      const auto* evt = fb::GetRoot<v2::Event>(events->Get(i)->payload()->data());
+      if (evt->meta()->id()->str() != r::DEDUP_DICT_EVENT_ID) {
+        ids.push_back(evt->meta()->id()->str());
+      }
+    }
+  }
+  const std::vector<std::string> expected = { "good_1", "good_2" };
+  BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), ids.begin(), ids.end());
+  BOOST_CHECK_EQUAL(1, errors);
+}
@@ -5,7 +5,9 @@
 
 #include "data_buffer.h"
 #include "logger/event_queue.h"
+#include "logger/event_record.h"
 #include <boost/test/unit_test.hpp>
+#include <memory>
 
 using namespace reinforcement_learning;
 using namespace std;
@@ -154,4 +156,198 @@ BOOST_AUTO_TEST_CASE(queue_capacity_test)
   test_event item;
   queue.pop(&item);
   BOOST_CHECK_EQUAL(queue.capacity(), 0);
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(queue_wraps_around)
+{
+  reinforcement_learning::event_queue<test_event> queue(1000);
+  test_event item;
+
+  // interleave pushes and pops so the items wrap around the end of the ring and it has to grow
+  int next_pop = 0;
+  for (int i = 0; i < 100; ++i) {
+    queue.push(test_event(std::to_string(i)), 1);
+    if (i % 3 == 0) {
+      queue.pop(&item);
+      BOOST_CHECK_EQUAL(item.get_event_id(), std::to_string(next_pop++));
+    }
+  }
+  while (queue.pop(&item)) {
+    BOOST_CHECK_EQUAL(item.get_event_id(), std::to_string(next_pop++));
+  }
+  BOOST_CHECK_EQUAL(next_pop, 100);
+  BOOST_CHECK_EQUAL(queue.capacity(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(event_record_inline_and_heap_closures)
+{
+  using record_t = logger::event_record<test_event>;
+
+  record_t ready(record_t::ready_event{ test_event("ready") });
+  BOOST_CHECK(ready.is_inline());
+
+  struct large_closure {
+    char padding[record_t::INLINE_SIZE];
+    std::unique_ptr<std::string> id;
+    int operator()(test_event& out_evt, api_status*) {
+      out_evt = test_event(*id);
+      return error_code::success;
+    }
+  };
+  large_closure large;
+  large.id.reset(new std::string("large"));
+  record_t heap(std::move(large));
+  BOOST_CHECK(!heap.is_inline());
+
+  event_queue<record_t> queue(1000);
+  queue.push(std::move(ready), 1);
+  queue.push(std::move(heap), 1);
+  BOOST_CHECK(!ready);
+  BOOST_CHECK(!heap);
+
+  record_t record;
+  test_event evt;
+  BOOST_REQUIRE(queue.pop(&record));
+  BOOST_CHECK_EQUAL(record(evt, nullptr), error_code::success);
+  BOOST_CHECK_EQUAL(evt.get_event_id(), "ready");
+
+  BOOST_REQUIRE(queue.pop(&record));
+  BOOST_CHECK_EQUAL(record(evt, nullptr), error_code::success);
+  BOOST_CHECK_EQUAL(evt.get_event_id(), "large");
+}
+
+BOOST_AUTO_TEST_CASE(event_record_carries_the_pass_probability)
+{
+  using record_t = logger::event_record<test_event>;
+
+  //the first seed whose record survives two drop passes
+  for (uint64_t seed = 0; seed < 1000; ++seed) {
+    record_t record(record_t::ready_event{ test_event("kept") });
+    record.set_drop_seed(seed);
+    if (record.try_drop(0.5f, 0) || record.try_drop(0.5f, 1)) continue;
+
+    //moves through the queue keep it
+    event_queue<record_t> queue(1000);
+    queue.push(std::move(record), 1);
+    record_t popped;
+    BOOST_REQUIRE(queue.pop(&popped));
+    BOOST_CHECK_CLOSE(popped.pass_prob(), 0.25f, 0.0001f);
+
+    test_event evt;
+    BOOST_REQUIRE_EQUAL(popped(evt, nullptr), error_code::success);
+    BOOST_CHECK_CLOSE(evt.get_pass_prob(), 0.25f, 0.0001f);
+    return;
+  }
+  BOOST_FAIL("no record survived the drop passes");
+}
+
+BOOST_AUTO_TEST_CASE(queue_pops_highest_lane_first)
+{
+  event_queue<test_event> queue(1000);
+  queue.push(test_event("low_1"), 1, event_priority::LOW);
+  queue.push(test_event("normal_1"), 1);
+  queue.push(test_event("high_1"), 1, event_priority::HIGH);
+  queue.push(test_event("low_2"), 1, event_priority::LOW);
+  queue.push(test_event("high_2"), 1, event_priority::HIGH);
+  BOOST_CHECK_EQUAL(queue.size(), 5);
+  BOOST_CHECK_EQUAL(queue.capacity(), 5);
+
+  test_event item;
+  for (const auto& expected : { "high_1", "high_2", "normal_1", "low_1", "low_2" }) {
+    BOOST_REQUIRE(queue.pop(&item));
+    BOOST_CHECK_EQUAL(item.get_event_id(), expected);
+  }
+  BOOST_CHECK(!queue.pop(&item));
+  BOOST_CHECK_EQUAL(queue.capacity(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(queue_prunes_lowest_lane_first)
+{
+  // lane limits are 90 for LOW, 100 for NORMAL and 110 for HIGH
+  event_queue<test_event> queue(100);
+  queue.push(test_event("drop_low_1"), 20, event_priority::LOW);
+  queue.push(test_event("drop_low_2"), 20, event_priority::LOW);
+  queue.push(test_event("drop_normal_1"), 20);
+  queue.push(test_event("no_drop_normal_2"), 20);
+  queue.push(test_event("drop_high_1"), 5, event_priority::HIGH);
+  BOOST_CHECK(!queue.is_full(event_priority::LOW));
+
+  queue.push(test_event("drop_high_2"), 5, event_priority::HIGH);
+  BOOST_CHECK(queue.is_full(event_priority::LOW));
+  BOOST_CHECK(!queue.is_full(event_priority::NORMAL));
+  BOOST_CHECK(!queue.is_full(event_priority::HIGH));
+
+  // only the low lane goes, which is enough to get under the normal limit
+  queue.prune(1.0);
+  BOOST_CHECK_EQUAL(queue.size(), 4);
+  BOOST_CHECK_EQUAL(queue.capacity(), 50);
+  BOOST_CHECK_EQUAL(queue.get_lane_metrics(event_priority::LOW).dropped, 2);
+  BOOST_CHECK_EQUAL(queue.get_lane_metrics(event_priority::NORMAL).dropped, 0);
+
+  queue.push(test_event("drop_normal_3"), 60);
+  BOOST_CHECK(queue.is_full(event_priority::NORMAL));
+  queue.prune(1.0);
+  BOOST_CHECK_EQUAL(queue.size(), 3);
+  BOOST_CHECK_EQUAL(queue.capacity(), 30);
+
+  const auto normal = queue.get_lane_metrics(event_priority::NORMAL);
+  BOOST_CHECK_EQUAL(normal.queued, 1);
+  BOOST_CHECK_EQUAL(normal.queued_bytes, 20);
+  BOOST_CHECK_EQUAL(normal.enqueued, 3);
+  BOOST_CHECK_EQUAL(normal.dropped, 2);
+  const auto high = queue.get_lane_metrics(event_priority::HIGH);
+  BOOST_CHECK_EQUAL(high.queued, 2);
+  BOOST_CHECK_EQUAL(high.dropped, 0);
+
+  test_event item;
+  for (const auto& expected : { "drop_high_1", "drop_high_2", "no_drop_normal_2" }) {
+    BOOST_REQUIRE(queue.pop(&item));
+    BOOST_CHECK_EQUAL(item.get_event_id(), expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(event_record_keeps_priority)
+{
+  using record_t = logger::event_record<test_event>;
+
+  record_t record(record_t::ready_event{ test_event("high") });
+  BOOST_CHECK(record.priority() == event_priority::NORMAL);
+  record.set_priority(event_priority::HIGH);
+
+  event_queue<record_t> queue(1000);
+  const auto priority = record.priority();
+  queue.push(std::move(record), 1, priority);
+  BOOST_CHECK_EQUAL(queue.get_lane_metrics(event_priority::HIGH).enqueued, 1);
+
+  record_t popped;
+  BOOST_REQUIRE(queue.pop(&popped));
+  BOOST_CHECK(popped.priority() == event_priority::HIGH);
+}
+
+class releasing_event : public test_event {
+public:
+  releasing_event() {}
+  explicit releasing_event(int* released) : test_event("releasing"), _released(released) {}
+
+  void release_objects() { ++*_released; }
+private:
+  int* _released = nullptr;
+};
+
+BOOST_AUTO_TEST_CASE(event_record_discard_releases_ready_events)
+{
+  using record_t = logger::event_record<releasing_event>;
+
+  int released = 0;
+  record_t ready(record_t::ready_event{ releasing_event(&released) });
+  ready.discard();
+  BOOST_CHECK_EQUAL(released, 1);
+
+  //closures that build the event when invoked have nothing to release yet
+  record_t deferred([](releasing_event& out_evt, api_status*) { return error_code::success; });
+  deferred.discard();
+  BOOST_CHECK_EQUAL(released, 1);
+
+  logger::event_record<test_event> plain(logger::event_record<test_event>::ready_event{ test_event("plain") });
+  plain.discard();
+}
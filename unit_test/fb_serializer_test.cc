@@ -10,6 +10,7 @@
 #include "constants.h"
 #include "serialization/fb_serializer.h"
 #include "serialization/payload_serializer.h"
+#include "serialization/outcome_collection_serializer.h"
 
 using namespace reinforcement_learning;
 using namespace logger;
@@ -168,3 +169,109 @@ BOOST_AUTO_TEST_CASE(fb_serializer_generic_event_metadata) {
   BOOST_CHECK_EQUAL(metadata.app_id()->c_str(), "app_id");
  }
 }
+
+BOOST_AUTO_TEST_CASE(fb_serializer_generic_event_batch_compression) {
+  data_buffer db;
+  zstd_compressor compressor(zstd_compressor::ZSTD_DEFAULT_COMPRESSION_LEVEL);
+  fb_collection_serializer<generic_event> collection_serializer(db, value::CONTENT_ENCODING_ZSTD, &compressor);
+  const char* event_id("event_id");
+  const timestamp ts;
+  cb_serializer serializer;
+  ranking_response rr(event_id);
+  rr.set_model_id("model_id");
+  rr.push_back(1, 0.2);
+  rr.push_back(0, 0.8);
+
+  auto buffer = serializer.event("my_context", action_flags::DEFERRED, v2::LearningModeType_Apprentice, rr);
+
+  generic_event ge(event_id, ts, v2::PayloadType_CB, std::move(buffer), event_content_type::IDENTITY, "app_id");
+  collection_serializer.add(ge);
+  BOOST_CHECK_EQUAL(reinforcement_learning::error_code::success, collection_serializer.finalize(nullptr));
+
+  flatbuffers::Verifier v(db.body_begin(), db.body_filled_size());
+  const v2::EventBatch *event_batch = v2::GetEventBatch(db.body_begin());
+  BOOST_CHECK(event_batch->Verify(v));
+  BOOST_CHECK_EQUAL(event_batch->metadata()->content_encoding()->c_str(), value::CONTENT_ENCODING_ZSTD);
+  BOOST_CHECK(event_batch->events() == nullptr || event_batch->events()->size() == 0);
+  BOOST_REQUIRE(event_batch->compressed_events() != nullptr);
+
+  generic_event::payload_buffer_t inner = flatbuffers::DetachedBuffer(nullptr, false, nullptr, 0,
+    const_cast<uint8_t*>(event_batch->compressed_events()->data()), event_batch->compressed_events()->size());
+  BOOST_CHECK_EQUAL(reinforcement_learning::error_code::success, compressor.decompress(inner, nullptr));
+
+  flatbuffers::Verifier inner_verifier(inner.data(), inner.size());
+  const v2::EventBatch *inner_batch = v2::GetEventBatch(inner.data());
+  BOOST_CHECK(inner_batch->Verify(inner_verifier));
+  BOOST_REQUIRE_EQUAL(inner_batch->events()->size(), 1);
+  const v2::Event *event = flatbuffers::GetRoot<v2::Event>(inner_batch->events()->Get(0)->payload()->data());
+  BOOST_CHECK_EQUAL(event->meta()->id()->c_str(), event_id);
+}
+
+BOOST_AUTO_TEST_CASE(fb_serializer_coalesce_outcomes) {
+  data_buffer db;
+  int state = 0;
+  outcome_collection_serializer<generic_event> collection_serializer(db, value::CONTENT_ENCODING_IDENTITY, state);
+  const timestamp ts;
+  outcome_serializer serializer;
+
+  generic_event first("event_a", ts, v2::PayloadType_Outcome, serializer.numeric_event(1.f), event_content_type::IDENTITY, "app_id");
+  generic_event other("event_b", ts, v2::PayloadType_Outcome, serializer.numeric_event(5.f), event_content_type::IDENTITY, "app_id");
+  generic_event indexed("event_a", ts, v2::PayloadType_Outcome, serializer.numeric_event(1, 7.f), event_content_type::IDENTITY, "app_id");
+  generic_event second("event_a", ts, v2::PayloadType_Outcome, serializer.numeric_event(2.f), event_content_type::IDENTITY, "app_id");
+  generic_event throttled("event_a", ts, v2::PayloadType_Outcome, serializer.numeric_event(3.f), event_content_type::IDENTITY, "app_id", 0.5f);
+  BOOST_CHECK_EQUAL(reinforcement_learning::error_code::success, collection_serializer.add(first));
+  BOOST_CHECK_EQUAL(reinforcement_learning::error_code::success, collection_serializer.add(other));
+  BOOST_CHECK_EQUAL(reinforcement_learning::error_code::success, collection_serializer.add(indexed));
+  BOOST_CHECK_EQUAL(reinforcement_learning::error_code::success, collection_serializer.add(throttled));
+  BOOST_CHECK_EQUAL(reinforcement_learning::error_code::success, collection_serializer.add(second));
+  BOOST_CHECK_EQUAL(reinforcement_learning::error_code::success, collection_serializer.finalize(nullptr));
+
+  flatbuffers::Verifier v(db.body_begin(), db.body_filled_size());
+  const v2::EventBatch *event_batch = v2::GetEventBatch(db.body_begin());
+  BOOST_CHECK(event_batch->Verify(v));
+  const auto& events = *(event_batch->events());
+  // the coalesced outcomes take the place of the first one, the others keep theirs
+  BOOST_REQUIRE_EQUAL(events.size(), 4);
+
+  const v2::Event *coalesced_event = flatbuffers::GetRoot<v2::Event>(events.Get(0)->payload()->data());
+  BOOST_CHECK_EQUAL(coalesced_event->meta()->id()->c_str(), "event_a");
+  const auto* coalesced = v2::GetOutcomeEvent(coalesced_event->payload()->data());
+  BOOST_CHECK_EQUAL(coalesced->value_as_numeric()->value(), 1.f);
+  BOOST_REQUIRE(coalesced->numeric_values() != nullptr);
+  BOOST_REQUIRE_EQUAL(coalesced->numeric_values()->size(), 1);
+  BOOST_CHECK_EQUAL(coalesced->numeric_values()->Get(0), 2.f);
+
+  const v2::Event *single_event = flatbuffers::GetRoot<v2::Event>(events.Get(1)->payload()->data());
+  BOOST_CHECK_EQUAL(single_event->meta()->id()->c_str(), "event_b");
+  BOOST_CHECK(v2::GetOutcomeEvent(single_event->payload()->data())->numeric_values() == nullptr);
+
+  const v2::Event *indexed_event = flatbuffers::GetRoot<v2::Event>(events.Get(2)->payload()->data());
+  BOOST_CHECK_EQUAL(v2::GetOutcomeEvent(indexed_event->payload()->data())->index_type(), v2::IndexValue_numeric);
+
+  // an outcome with another pass probability isn't folded into the coalesced event
+  const v2::Event *throttled_event = flatbuffers::GetRoot<v2::Event>(events.Get(3)->payload()->data());
+  BOOST_CHECK_EQUAL(throttled_event->meta()->id()->c_str(), "event_a");
+  BOOST_CHECK_EQUAL(throttled_event->meta()->pass_probability(), 0.5f);
+  BOOST_CHECK_EQUAL(v2::GetOutcomeEvent(throttled_event->payload()->data())->value_as_numeric()->value(), 3.f);
+  BOOST_CHECK_EQUAL(coalesced_event->meta()->pass_probability(), 1.f);
+}
+
+BOOST_AUTO_TEST_CASE(fb_serializer_generic_event_deferred_payload) {
+  const timestamp ts;
+  cb_serializer serializer;
+  ranking_response rr("event_id");
+  rr.set_model_id("model_id");
+  rr.push_back(1, 0.2);
+  rr.push_back(0, 0.8);
+
+  generic_event ge("event_id", ts, v2::PayloadType_CB, generic_event::payload_buffer_t(), event_content_type::IDENTITY, "app_id");
+  BOOST_CHECK_EQUAL(ge.get_payload().size(), 0);
+  BOOST_CHECK_EQUAL(reinforcement_learning::error_code::success, ge.transform("my_context", nullptr,
+    [&](const char* context) { return serializer.event(context, action_flags::DEFAULT, v2::LearningModeType_Online, rr); }, nullptr));
+  BOOST_CHECK_EQUAL(ge.get_encoding(), v2::EventEncoding_Identity);
+
+  const auto* event = v2::GetCbEvent(ge.get_payload().data());
+  BOOST_CHECK_EQUAL(std::string(event->context()->begin(), event->context()->end()), "my_context");
+  BOOST_CHECK_EQUAL(event->model_id()->c_str(), "model_id");
+  BOOST_CHECK_EQUAL(event->action_ids()->size(), 2);
+}
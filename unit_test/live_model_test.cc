@@ -141,6 +141,15 @@ BOOST_AUTO_TEST_CASE(schema_v1_with_global_use_dedup) {
   BOOST_CHECK_EQUAL(ds.init(&status), err::content_encoding_error);
 }
 
+BOOST_AUTO_TEST_CASE(schema_v1_with_batch_compression) {
+  u::configuration config;
+  cfg::create_from_json(JSON_CFG, config);
+  config.set(r::name::INTERACTION_USE_BATCH_COMPRESSION, "true");
+  r::api_status status;
+  r::live_model ds = create_mock_live_model(config, nullptr, nullptr, nullptr, r::model_management::model_type_t::CB);
+  BOOST_CHECK_EQUAL(ds.init(&status), err::content_encoding_error);
+}
+
 BOOST_AUTO_TEST_CASE(schema_v2_with_zstd_and_dedup_content_encoding) {
   u::configuration config;
   cfg::create_from_json(JSON_CFG, config);
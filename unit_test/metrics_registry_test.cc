@@ -0,0 +1,76 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "utility/metrics_registry.h"
+
+#include <thread>
+#include <vector>
+
+using namespace reinforcement_learning;
+
+BOOST_AUTO_TEST_CASE(metrics_counter_sums_threads) {
+  utility::metrics_registry registry;
+  auto* counter = registry.get_counter("test.counter");
+  BOOST_CHECK_EQUAL(counter, registry.get_counter("test.counter"));
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([counter]() {
+      for (int i = 0; i < 1000; ++i) counter->add();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  metrics_snapshot snapshot;
+  registry.snapshot(snapshot);
+  BOOST_CHECK_EQUAL(snapshot.counters["test.counter"], 4000);
+}
+
+BOOST_AUTO_TEST_CASE(metrics_histogram_percentiles) {
+  utility::metrics_histogram histogram;
+  for (uint64_t v = 1; v <= 1000; ++v) histogram.record(v);
+
+  const auto summary = histogram.summary();
+  BOOST_CHECK_EQUAL(summary.count, 1000);
+  BOOST_CHECK_EQUAL(summary.min, 1);
+  BOOST_CHECK_EQUAL(summary.max, 1000);
+  BOOST_CHECK_CLOSE(summary.mean, 500.5, 0.01);
+  // Buckets are 12.5% wide
+  BOOST_CHECK_CLOSE(static_cast<double>(summary.p50), 500.0, 12.5);
+  BOOST_CHECK_CLOSE(static_cast<double>(summary.p90), 900.0, 12.5);
+  BOOST_CHECK_CLOSE(static_cast<double>(summary.p99), 990.0, 12.5);
+}
+
+BOOST_AUTO_TEST_CASE(metrics_histogram_bucket_bounds) {
+  for (uint64_t v : { 0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, ~0ull }) {
+    const auto index = utility::metrics_histogram::bucket_index(v);
+    BOOST_CHECK_LT(index, utility::metrics_histogram::BUCKETS);
+    BOOST_CHECK_GE(utility::metrics_histogram::bucket_upper_bound(index), v);
+    if (index > 0) {
+      BOOST_CHECK_LT(utility::metrics_histogram::bucket_upper_bound(index - 1), v);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(metrics_gauges_are_sampled_by_snapshot) {
+  utility::metrics_registry registry;
+  double value = 1.0;
+  registry.add_gauge("test.gauge", [&value]() { return value; });
+  registry.get_histogram("test.latency_us")->record(42);
+
+  metrics_snapshot snapshot;
+  registry.snapshot(snapshot);
+  BOOST_CHECK_EQUAL(snapshot.gauges["test.gauge"], 1.0);
+  BOOST_CHECK_EQUAL(snapshot.histograms["test.latency_us"].count, 1);
+
+  value = 2.0;
+  registry.snapshot(snapshot);
+  BOOST_CHECK_EQUAL(snapshot.gauges["test.gauge"], 2.0);
+
+  const auto text = utility::to_string(snapshot);
+  BOOST_CHECK(text.find("test.gauge") != std::string::npos);
+  BOOST_CHECK(text.find("test.latency_us") != std::string::npos);
+}
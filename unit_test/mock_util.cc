@@ -101,6 +101,7 @@ std::unique_ptr<fakeit::Mock<m::i_model>> get_mock_model(m::model_type_t model_t
   When(Method((*mock), request_decision)).AlwaysDo(request_decision_fn);
   When(Method((*mock), request_multi_slot_decision)).AlwaysDo(request_multi_slot_decision_fn);
   When(Method((*mock), model_type)).AlwaysDo(get_model_type);
+  Fake(Method((*mock), register_metrics));
 
   Fake(Dtor((*mock)));
 
@@ -139,6 +139,37 @@ BOOST_AUTO_TEST_CASE(outcome_float_single_payload_serializer_test) {
   BOOST_CHECK_CLOSE(1.5, event->value_as_numeric()->value(), tolerance);
 }
 
+BOOST_AUTO_TEST_CASE(outcome_float_payloads_are_independent_test) {
+  outcome_serializer serializer;
+
+  const auto first = serializer.numeric_event(0.f);
+  const auto second = serializer.numeric_event(-2.5);
+
+  flatbuffers::Verifier v(first.data(), first.size());
+  BOOST_CHECK(v2::VerifyOutcomeEventBuffer(v));
+  BOOST_CHECK_EQUAL(0.f, v2::GetOutcomeEvent(first.data())->value_as_numeric()->value());
+  BOOST_CHECK_CLOSE(-2.5, v2::GetOutcomeEvent(second.data())->value_as_numeric()->value(), tolerance);
+}
+
+BOOST_AUTO_TEST_CASE(outcome_float_coalesced_payload_serializer_test) {
+  outcome_serializer serializer;
+
+  const auto buffer = serializer.numeric_event(std::vector<float>{ 1.5f, 2.f, 3.f });
+
+  const auto event = v2::GetOutcomeEvent(buffer.data());
+  BOOST_CHECK_EQUAL(v2::OutcomeValue_numeric, event->value_type());
+  BOOST_CHECK_CLOSE(1.5, event->value_as_numeric()->value(), tolerance);
+  BOOST_REQUIRE(event->numeric_values() != nullptr);
+  BOOST_CHECK_EQUAL(2, event->numeric_values()->size());
+  BOOST_CHECK_CLOSE(3.f, event->numeric_values()->Get(1), tolerance);
+
+  float outcome;
+  BOOST_CHECK(!outcome_serializer::try_get_numeric(buffer, outcome));
+  BOOST_CHECK(outcome_serializer::try_get_numeric(serializer.numeric_event(4.f), outcome));
+  BOOST_CHECK_CLOSE(4.f, outcome, tolerance);
+  BOOST_CHECK(!outcome_serializer::try_get_numeric(serializer.numeric_event(1, 4.f), outcome));
+}
+
 BOOST_AUTO_TEST_CASE(outcome_string_indexed_payload_serializer_test) {
   outcome_serializer serializer;
 
@@ -6,6 +6,7 @@
 #include <boost/test/unit_test.hpp>
 #include "vw_model/safe_vw.h"
 #include "utility/versioned_object_pool.h"
+#include "utility/metrics_registry.h"
 #include "model_mgmt.h"
 #include "data.h"
 
@@ -104,6 +105,29 @@ BOOST_AUTO_TEST_CASE(factory_with_initial_model)
   }
 }
 
+BOOST_AUTO_TEST_CASE(pool_metrics_count_checkouts) {
+  model_management::model_data model_data;
+  get_model_data_from_raw((const char*)cb_data_5_model, cb_data_5_model_len, &model_data);
+  versioned_object_pool<safe_vw, safe_vw_factory> pool(new safe_vw_factory(model_data), 1);
+  metrics_registry registry;
+  pool.register_metrics(registry, "model.vw_pool");
+
+  {
+    pooled_vw first(pool, pool.get_or_create());
+    // the pool is empty while the first one is checked out
+    pooled_vw second(pool, pool.get_or_create());
+  }
+  {
+    pooled_vw again(pool, pool.get_or_create());
+  }
+
+  metrics_snapshot snapshot;
+  registry.snapshot(snapshot);
+  BOOST_CHECK_EQUAL(snapshot.counters["model.vw_pool.checkouts"], 3);
+  BOOST_CHECK_EQUAL(snapshot.counters["model.vw_pool.creations"], 1);
+  BOOST_CHECK_EQUAL(snapshot.gauges["model.vw_pool.objects"], 2);
+}
+
 BOOST_AUTO_TEST_CASE(factory_with_empty_model) {
   const auto json = R"({"a":{"0":1,"5":2},"_multi":[{"b":{"0":1}},{"b":{"0":2}},{"b":{"0":3}}]})";
   std::vector<float> ranking_expected = { .8f, .1f, .1f };
@@ -23,6 +23,30 @@ BOOST_AUTO_TEST_CASE(time_usage) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(coarse_time_usage) {
+  r::coarse_clock_time_provider ctp(1000);
+  r::clock_time_provider reference;
+  const uint16_t NUM_ITER = 1000;
+  for (int i = 0; i < NUM_ITER; ++i) {
+    const auto ts = ctp.gmt_now();
+    BOOST_CHECK(ts.year > 0);
+    BOOST_CHECK(ts.month >= 1 && ts.month <= 12);
+    BOOST_CHECK(ts.day >= 1 && ts.day <= 31);
+    BOOST_CHECK(ts.hour <= 23);
+    BOOST_CHECK(ts.minute <= 59);
+    BOOST_CHECK(ts.second <= 60);
+    BOOST_CHECK(ts.sub_second <= 9999999);
+    // truncated to the millisecond
+    BOOST_CHECK_EQUAL(ts.sub_second % 10000, 0);
+  }
+
+  const auto expected = reference.gmt_now();
+  const auto actual = ctp.gmt_now();
+  BOOST_CHECK_EQUAL(expected.year, actual.year);
+  BOOST_CHECK_EQUAL(expected.month, actual.month);
+  BOOST_CHECK_EQUAL(expected.day, actual.day);
+}
+
 //BOOST_AUTO_TEST_CASE(time_loop) {
 //	r::clock_time_provider ctp;
 //	const uint16_t NUM_ITER = 1000;